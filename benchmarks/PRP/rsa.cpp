@@ -0,0 +1,82 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// benchmarks/PRP/rsa.cpp - RSA operations per second on a single core: CRT private
+//                    operations, single verifications and batched verifications
+
+#include "PRP/rsa.hpp"
+#include "utils/benchmark.hpp"
+
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+    using namespace cpp11crypto;
+
+    template <std::size_t Bits>
+    void report(std::mt19937_64& generator) {
+        typedef arith::uint<Bits> value;
+        PRP::rsa_private_key<Bits> key = PRP::generate_rsa_key<Bits>(generator);
+        const std::size_t count = 64;
+        std::vector<value> messages, signatures;
+        for (std::size_t i = 0; i != count; ++i) {
+            value m;
+            for (std::size_t j = 0; j + 1 < value::limb_count; ++j) {
+                m.limb(j) = generator();
+            }
+            messages.push_back(m);
+            signatures.push_back(key.sign(m));
+        }
+        std::unique_ptr<bool[]> valid {new bool[count]};
+
+        std::size_t i = 0;
+        const double sign = benchmarks::seconds_per_call([&]() {
+            const value s = key.sign(messages[i++ % count]);
+            benchmarks::keep(&s);
+        },0.5);
+        const double verify = benchmarks::seconds_per_call([&]() {
+            const bool ok = key.public_key().verify(signatures[i % count],messages[i % count]);
+            ++i;
+            benchmarks::keep(&ok);
+        },0.5);
+        const double batch = benchmarks::seconds_per_call([&]() {
+            PRP::verify_batch(key.public_key(),signatures.data(),messages.data(),valid.get(),count);
+            benchmarks::keep(valid.get());
+        },0.5);
+        std::cout << std::setw(6) << Bits << std::setw(12) << 1/sign << std::setw(12) << 1/verify
+                  << std::setw(12) << count/batch << '\n';
+    }
+}
+
+int main() {
+    std::mt19937_64 generator {2013};
+    std::cout << "Operations per second, public exponent 65537, batches of 64 with the "
+              << (arith::lane_engine::avx512ifma == arith::best_lane_engine() ? "avx512ifma"
+                  : arith::lane_engine::avx2 == arith::best_lane_engine() ? "avx2" : "scalar") << " kernel\n"
+              << std::setw(6) << "bits" << std::setw(12) << "sign" << std::setw(12) << "verify"
+              << std::setw(12) << "batch" << '\n' << std::fixed << std::setprecision(0);
+    report<1024>(generator);
+    report<2048>(generator);
+    report<3072>(generator);
+    report<4096>(generator);
+    return 0;
+}
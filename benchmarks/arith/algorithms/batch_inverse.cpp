@@ -0,0 +1,68 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// benchmarks/arith/algorithms/batch_inverse.cpp - Batch inversion against
+//                    one inversion per element, by batch size and threads
+
+#include "arith/algorithms/batch_inverse.hpp"
+#include "utils/benchmark.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+int main(int argc,char *argv[]) {
+    using namespace cpp11crypto;
+    const unsigned max_threads = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 8;
+    const std::uint64_t p = ~std::uint64_t {0}-58;
+    std::mt19937_64 generator {2013};
+
+    std::cout << "Nanoseconds per element modulo 2^64-59\n"
+              << std::setw(10) << "elements" << std::setw(12) << "single";
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+        std::cout << std::setw(9) << "batch x" << threads;
+    }
+    std::cout << '\n' << std::fixed << std::setprecision(1);
+
+    for (std::size_t n = 16; n <= (std::size_t {1} << 20); n *= 8) {
+        std::vector<std::uint64_t,core::allocator<std::uint64_t>> values(n), inverses(n);
+        for (auto& x : values) {
+            x = generator() % p;
+        }
+        const double single = benchmarks::seconds_per_call([&]() {
+            for (std::size_t i = 0; i != n; ++i) {
+                inverses[i] = arith::algorithms::safegcd::inverse(values[i],p);
+            }
+            benchmarks::keep(inverses.data());
+        },0.1);
+        std::cout << std::setw(10) << n << std::setw(12) << single/n*1e9;
+        for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+            const double batch = benchmarks::seconds_per_call([&]() {
+                arith::algorithms::batch_inverse(values.begin(),values.end(),p,inverses.begin(),threads);
+                benchmarks::keep(inverses.data());
+            },0.1);
+            std::cout << std::setw(10) << batch/n*1e9;
+        }
+        std::cout << '\n';
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// benchmarks/arith/algorithms/euclid.cpp - Recursive, binary and Lehmer
+//                    (extended) gcd on 32, 64 and 128-bit operands
+
+#include "arith/algorithms/euclid.hpp"
+#include "utils/benchmark.hpp"
+
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <tuple>
+#include <vector>
+
+namespace {
+    using namespace cpp11crypto;
+    namespace euclid = arith::algorithms::euclid;
+
+    constexpr std::size_t operand_count = 1024;
+
+    template <typename T>
+    std::vector<T> random_operands(std::mt19937_64& generator) {
+        std::vector<T> result(operand_count);
+        for (auto& x : result) {
+            x = static_cast<T>(generator()) | 1;
+        }
+        return result;
+    }
+
+#ifdef CPP11CRYPTO_HAS_UINT128
+    template <>
+    std::vector<utils::uint128_t> random_operands<utils::uint128_t>(std::mt19937_64& generator) {
+        std::vector<utils::uint128_t> result(operand_count);
+        for (auto& x : result) {
+            const utils::uint128_t high = generator();
+            x = (high << 64) | generator() | 1;
+        }
+        return result;
+    }
+#endif
+
+    /// Nanoseconds per call of an operation over all operand pairs
+    template <typename T, typename F>
+    double nanoseconds(const std::vector<T>& a,const std::vector<T>& b,F f) {
+        return benchmarks::seconds_per_call([&]() {
+            T sink {};
+            for (std::size_t i = 0; i != operand_count; ++i) {
+                sink ^= f(a[i],b[i]);
+            }
+            benchmarks::keep(&sink);
+        },0.1)/operand_count*1e9;
+    }
+
+    template <typename T>
+    void report(const char * const name,std::mt19937_64& generator) {
+        const std::vector<T> a = random_operands<T>(generator);
+        const std::vector<T> b = random_operands<T>(generator);
+        std::cout << std::setw(8) << name
+                  << std::setw(12) << nanoseconds(a,b,[](T x,T y) {
+            return euclid::gcd(x,y,euclid::recursive_tag {});
+        })
+                << std::setw(12) << nanoseconds(a,b,[](T x,T y) {
+            return euclid::gcd(x,y,euclid::binary_tag {});
+        })
+                << std::setw(12) << nanoseconds(a,b,[](T x,T y) {
+            return std::get<0>(euclid::extended_gcd(x,y,euclid::recursive_tag {}));
+        })
+                << std::setw(12) << nanoseconds(a,b,[](T x,T y) {
+            return std::get<0>(euclid::extended_gcd(x,y,euclid::lehmer_tag {}));
+        })
+                << '\n';
+    }
+}
+
+int main() {
+    std::mt19937_64 generator {2013};
+    std::cout << "Nanoseconds per call on random odd operands\n"
+              << std::setw(8) << "bits" << std::setw(12) << "recursive" << std::setw(12) << "binary"
+              << std::setw(12) << "ext recur" << std::setw(12) << "ext lehmer" << '\n'
+              << std::fixed << std::setprecision(1);
+    report<std::uint32_t>("32",generator);
+    report<std::uint64_t>("64",generator);
+#ifdef CPP11CRYPTO_HAS_UINT128
+    report<utils::uint128_t>("128",generator);
+#endif
+    return 0;
+}
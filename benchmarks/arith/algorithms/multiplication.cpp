@@ -0,0 +1,116 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// benchmarks/arith/algorithms/multiplication.cpp - Finds the Karatsuba and
+//                    Toom-3 crossover points on this machine, then times the
+//                    2048 to 32768-bit products with the default and tuned thresholds
+
+#include "arith/algorithms/multiplication.hpp"
+#include "utils/benchmark.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+    using namespace cpp11crypto;
+    namespace multiplication = arith::algorithms::multiplication;
+
+    constexpr std::size_t never = ~std::size_t {0};
+
+    /// Microseconds per product of two n-limb operands, arena excluded
+    double microseconds(const std::size_t n,const multiplication::thresholds& limits,std::mt19937_64& generator) {
+        std::vector<std::uint64_t> a(n), b(n), r(2*n);
+        for (std::size_t i = 0; i != n; ++i) {
+            a[i] = generator();
+            b[i] = generator();
+        }
+        multiplication::arena scratch {multiplication::scratch_size(n,n,limits)};
+        return 1e6*benchmarks::seconds_per_call([&]() {
+            multiplication::multiply(r.data(),a.data(),n,b.data(),n,scratch,limits);
+            benchmarks::keep(r.data());
+        },0.02);
+    }
+
+    /// First length from which splitting at the top level wins twice in a row
+    /// @param first shortest length tried
+    /// @param last longest length tried
+    /// @param step length increment
+    /// @param below thresholds without the split
+    /// @param split thresholds with the split from a given length
+    template <typename Split>
+    std::size_t crossover(const std::size_t first,const std::size_t last,const std::size_t step,
+                          const multiplication::thresholds& below,Split split,std::mt19937_64& generator) {
+        std::size_t candidate = never;
+        for (std::size_t n = first; n <= last; n += step) {
+            const double without = microseconds(n,below,generator);
+            const double with = microseconds(n,split(n),generator);
+            std::cout << std::setw(8) << n << std::setw(12) << without << std::setw(12) << with << '\n';
+            if (with < without) {
+                if (candidate != never) {
+                    return candidate;
+                }
+                candidate = n;
+            } else {
+                candidate = never;
+            }
+        }
+        return candidate == never ? last : candidate;
+    }
+}
+
+int main() {
+    std::mt19937_64 generator {2013};
+    std::cout << std::fixed << std::setprecision(3)
+              << "Karatsuba crossover, microseconds per product\n"
+              << std::setw(8) << "limbs" << std::setw(12) << "schoolbook" << std::setw(12) << "karatsuba" << '\n';
+    const std::size_t karatsuba = crossover(4,64,2,multiplication::thresholds {never,never},[](const std::size_t n) {
+        return multiplication::thresholds {n,never};
+    },generator);
+
+    std::cout << "Toom-3 crossover over Karatsuba from " << karatsuba << " limbs, microseconds per product\n"
+              << std::setw(8) << "limbs" << std::setw(12) << "karatsuba" << std::setw(12) << "toom-3" << '\n';
+    const std::size_t toom3 = crossover(karatsuba,400,karatsuba/2+1,multiplication::thresholds {karatsuba,never},[=](const std::size_t n) {
+        return multiplication::thresholds {karatsuba,n};
+    },generator);
+
+    const multiplication::thresholds defaults;
+    std::cout << "Crossovers on this machine: karatsuba " << karatsuba << " limbs, toom-3 " << toom3
+              << " limbs (defaults " << defaults.karatsuba << ", " << defaults.toom3 << ")\n"
+              << std::setw(8) << "bits" << std::setw(12) << "schoolbook" << std::setw(12) << "defaults" << std::setw(12) << "tuned" << '\n';
+    // the three settings take turns, and each keeps its best time: on a shared
+    // machine single runs of the larger sizes vary by more than the settings do
+    for (std::size_t bits : {2048,4096,8192,16384,32768}) {
+        const std::size_t n = bits/64;
+        const multiplication::thresholds settings[] = {multiplication::thresholds {never,never},defaults,
+                                                       multiplication::thresholds {karatsuba,toom3}};
+        double best[3] = {1e300,1e300,1e300};
+        for (unsigned run = 0; run != 10; ++run) {
+            for (unsigned i = 0; i != 3; ++i) {
+                best[i] = std::min(best[i],microseconds(n,settings[i],generator));
+            }
+        }
+        std::cout << std::setw(8) << bits << std::setw(12) << best[0] << std::setw(12) << best[1]
+                  << std::setw(12) << best[2] << '\n';
+    }
+    return 0;
+}
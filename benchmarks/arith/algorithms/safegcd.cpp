@@ -0,0 +1,151 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// benchmarks/arith/algorithms/safegcd.cpp - Cycles per constant time
+//                    inversion, against Fermat inversion by exponentiation
+
+#include "arith/algorithms/safegcd.hpp"
+#include "utils/benchmark.hpp"
+
+#include <array>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+namespace {
+    using namespace cpp11crypto;
+    namespace safegcd = arith::algorithms::safegcd;
+
+    template <std::size_t N>
+    using words = std::array<std::uint64_t,N>;
+
+    /// Montgomery multiplication, CIOS, as a reference point for Fermat inversion
+    template <std::size_t N>
+    words<N> montgomery_multiply(const words<N>& a,const words<N>& b,const words<N>& m,const std::uint64_t m_prime) {
+        std::uint64_t t[N+2] = {};
+        for (std::size_t i = 0; i != N; ++i) {
+            std::uint64_t carry = 0;
+            for (std::size_t j = 0; j != N; ++j) {
+                const utils::uint128_t s = static_cast<utils::uint128_t>(a[j])*b[i] + t[j] + carry;
+                t[j] = static_cast<std::uint64_t>(s);
+                carry = static_cast<std::uint64_t>(s >> 64);
+            }
+            utils::uint128_t s = static_cast<utils::uint128_t>(t[N]) + carry;
+            t[N] = static_cast<std::uint64_t>(s);
+            t[N+1] = static_cast<std::uint64_t>(s >> 64);
+            const std::uint64_t k = t[0]*m_prime;
+            s = static_cast<utils::uint128_t>(k)*m[0] + t[0];
+            carry = static_cast<std::uint64_t>(s >> 64);
+            for (std::size_t j = 1; j != N; ++j) {
+                s = static_cast<utils::uint128_t>(k)*m[j] + t[j] + carry;
+                t[j-1] = static_cast<std::uint64_t>(s);
+                carry = static_cast<std::uint64_t>(s >> 64);
+            }
+            s = static_cast<utils::uint128_t>(t[N]) + carry;
+            t[N-1] = static_cast<std::uint64_t>(s);
+            t[N] = t[N+1] + static_cast<std::uint64_t>(s >> 64);
+        }
+        // final subtraction, masked
+        words<N> result;
+        std::uint64_t borrow = 0;
+        for (std::size_t j = 0; j != N; ++j) {
+            const utils::uint128_t d = static_cast<utils::uint128_t>(t[j]) - m[j] - borrow;
+            result[j] = static_cast<std::uint64_t>(d);
+            borrow = static_cast<std::uint64_t>(d >> 64) & 1;
+        }
+        const std::uint64_t keep_t = 0-static_cast<std::uint64_t>(borrow > t[N]);
+        for (std::size_t j = 0; j != N; ++j) {
+            result[j] = (t[j] & keep_t) | (result[j] & ~keep_t);
+        }
+        return result;
+    }
+
+    /// x^(m-2) in the Montgomery domain. Conversions in and out are left out,
+    /// which only favours this method.
+    template <std::size_t N>
+    words<N> fermat_inverse(const words<N>& x,const words<N>& m,const std::uint64_t m_prime) {
+        words<N> exponent = m;
+        exponent[0] -= 2;
+        words<N> result = x;
+        for (int bit = 64*N-2; bit >= 0; --bit) {
+            result = montgomery_multiply(result,result,m,m_prime);
+            if (0 != ((exponent[bit/64] >> (bit%64)) & 1)) {
+                result = montgomery_multiply(result,x,m,m_prime);
+            }
+        }
+        return result;
+    }
+
+    template <std::size_t N, typename F>
+    double cycles_per_call(F f) {
+        constexpr int calls = 2000;
+        std::uint64_t best = ~std::uint64_t {0};
+        for (int run = 0; run != 5; ++run) {
+            const std::uint64_t start = benchmarks::cycles();
+            for (int i = 0; i != calls; ++i) {
+                f();
+            }
+            const std::uint64_t elapsed = benchmarks::cycles()-start;
+            best = elapsed < best ? elapsed : best;
+        }
+        return static_cast<double>(best)/calls;
+    }
+
+    /// Reports both methods modulo 2^(64N)-c, which must be prime
+    template <std::size_t N>
+    void report(const std::uint64_t c,std::mt19937_64& generator) {
+        words<N> m;
+        m.fill(~std::uint64_t {0});
+        m[0] -= c-1;
+        std::uint64_t m_prime = m[0];
+        for (int i = 0; i != 5; ++i) {
+            m_prime *= 2-m[0]*m_prime;
+        }
+        m_prime = 0-m_prime;
+        words<N> x;
+        for (auto& w : x) {
+            w = generator();
+        }
+        x[N-1] >>= 1;
+
+        const safegcd::inverter<N> inverter {m};
+        const double divsteps = cycles_per_call<N>([&]() {
+            x = inverter(x);
+            benchmarks::keep(&x);
+        });
+        const double fermat = cycles_per_call<N>([&]() {
+            x = fermat_inverse(x,m,m_prime);
+            benchmarks::keep(&x);
+        });
+        std::cout << std::setw(6) << 64*N << std::setw(14) << divsteps << std::setw(14) << fermat
+                  << std::setw(10) << fermat/divsteps << '\n';
+    }
+}
+
+int main() {
+    std::mt19937_64 generator {2013};
+    std::cout << "Cycles per inversion modulo a prime\n"
+              << std::setw(6) << "bits" << std::setw(14) << "safegcd" << std::setw(14) << "fermat"
+              << std::setw(10) << "speedup" << '\n' << std::fixed << std::setprecision(1);
+    report<1>(59,generator);
+    report<4>(189,generator);
+    report<8>(569,generator);
+    return 0;
+}
@@ -0,0 +1,80 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// benchmarks/arith/modexp.cpp - Milliseconds per constant time modular
+//                    exponentiation for every window size, against the automatic one
+
+#include "arith/modexp.hpp"
+#include "utils/benchmark.hpp"
+
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+namespace {
+    using namespace cpp11crypto;
+
+    template <std::size_t Bits>
+    arith::uint<Bits> random_uint(std::mt19937_64& generator) {
+        arith::uint<Bits> x;
+        for (std::size_t i = 0; i != arith::uint<Bits>::limb_count; ++i) {
+            x.limb(i) = generator();
+        }
+        return x;
+    }
+
+    /// Exponent as long as the modulus, as for private keys
+    template <std::size_t Bits>
+    void report(std::mt19937_64& generator) {
+        typedef arith::uint<Bits> value;
+        const value n = random_uint<Bits>(generator) | value {1};
+        const arith::montgomery_context<Bits> context {n};
+        value x = context.to_montgomery(random_uint<Bits>(generator) % n);
+        const value e = random_uint<Bits>(generator);
+
+        std::cout << std::setw(6) << Bits;
+        for (unsigned w = 1; w <= arith::max_window; ++w) {
+            std::cout << std::setw(9) << 1e3*benchmarks::seconds_per_call([&]() {
+                x = arith::fixed_window_power(context,x,e,w);
+                benchmarks::keep(&x);
+            },0.3);
+        }
+        std::cout << std::setw(6) << arith::window_size(Bits,Bits) << std::setw(9) << 1e3*benchmarks::seconds_per_call([&]() {
+            x = context.power(x,e);
+            benchmarks::keep(&x);
+        },0.3) << '\n';
+    }
+}
+
+int main() {
+    std::mt19937_64 generator {2013};
+    std::cout << "Milliseconds per exponentiation by window size, automatic choice and bit by bit masked power\n"
+              << std::setw(6) << "bits";
+    for (unsigned w = 1; w <= arith::max_window; ++w) {
+        std::cout << std::setw(8) << "w=" << w;
+    }
+    std::cout << std::setw(6) << "auto" << std::setw(9) << "bitwise" << '\n' << std::fixed << std::setprecision(3);
+    report<256>(generator);
+    report<1024>(generator);
+    report<2048>(generator);
+    report<3072>(generator);
+    report<4096>(generator);
+    return 0;
+}
@@ -0,0 +1,95 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// benchmarks/arith/montgomery.cpp - Nanoseconds per modular product by
+//                    division, Barrett and Montgomery, and context setup cost
+
+#include "arith/barrett.hpp"
+#include "arith/context_cache.hpp"
+#include "arith/montgomery.hpp"
+#include "utils/benchmark.hpp"
+
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+namespace {
+    using namespace cpp11crypto;
+
+    template <std::size_t Bits>
+    arith::uint<Bits> random_uint(std::mt19937_64& generator) {
+        arith::uint<Bits> x;
+        for (std::size_t i = 0; i != arith::uint<Bits>::limb_count; ++i) {
+            x.limb(i) = generator();
+        }
+        return x;
+    }
+
+    template <typename F>
+    double nanoseconds_per_call(F&& f) {
+        return 1e9*benchmarks::seconds_per_call(f);
+    }
+
+    template <std::size_t Bits>
+    void report(std::mt19937_64& generator) {
+        typedef arith::uint<Bits> value;
+        const value n = random_uint<Bits>(generator) | value {1};
+        value a = random_uint<Bits>(generator) % n;
+        const value b = random_uint<Bits>(generator) % n;
+        const arith::montgomery_context<Bits> montgomery {n};
+        const arith::barrett_context<Bits> barrett {n};
+
+        const double division = nanoseconds_per_call([&]() {
+            a = value(wide_multiply(a,b) % arith::uint<2*Bits>(n));
+            benchmarks::keep(&a);
+        });
+        const double reduction = nanoseconds_per_call([&]() {
+            a = barrett.multiply(a,b);
+            benchmarks::keep(&a);
+        });
+        const double product = nanoseconds_per_call([&]() {
+            a = montgomery.multiply(a,b);
+            benchmarks::keep(&a);
+        });
+        const double setup = nanoseconds_per_call([&]() {
+            const arith::montgomery_context<Bits> context {n};
+            benchmarks::keep(&context);
+        });
+        const double cached = nanoseconds_per_call([&]() {
+            const auto context = arith::shared_context<arith::montgomery_context<Bits>>(n);
+            benchmarks::keep(context.get());
+        });
+        std::cout << std::setw(6) << Bits << std::setw(11) << division << std::setw(11) << reduction
+                  << std::setw(11) << product << std::setw(11) << setup << std::setw(11) << cached << '\n';
+    }
+}
+
+int main() {
+    std::mt19937_64 generator {2013};
+    std::cout << "Nanoseconds per modular product, and per Montgomery context setup\n"
+              << std::setw(6) << "bits" << std::setw(11) << "division" << std::setw(11) << "barrett"
+              << std::setw(11) << "montgomery" << std::setw(11) << "setup" << std::setw(11) << "cached"
+              << '\n' << std::fixed << std::setprecision(1);
+    report<256>(generator);
+    report<384>(generator);
+    report<2048>(generator);
+    report<4096>(generator);
+    return 0;
+}
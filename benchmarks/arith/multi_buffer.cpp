@@ -0,0 +1,94 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// benchmarks/arith/multi_buffer.cpp - Exponentiations per second on a single core
+//                    for every lane kernel, with public and private exponent lengths
+
+#include "arith/multi_buffer.hpp"
+#include "utils/benchmark.hpp"
+
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+    using namespace cpp11crypto;
+
+    template <std::size_t Bits>
+    arith::uint<Bits> random_uint(std::mt19937_64& generator) {
+        arith::uint<Bits> x;
+        for (std::size_t i = 0; i != arith::uint<Bits>::limb_count; ++i) {
+            x.limb(i) = generator();
+        }
+        return x;
+    }
+
+    const arith::lane_engine all_engines[] = {
+        arith::lane_engine::scalar,arith::lane_engine::avx2,arith::lane_engine::avx512ifma
+    };
+
+    /// 16 exponentiations per call, each with its own modulus
+    template <std::size_t Bits, std::size_t EBits>
+    void report(std::mt19937_64& generator,const char * const label) {
+        typedef arith::uint<Bits> value;
+        const std::size_t count = 16;
+        std::vector<std::unique_ptr<arith::montgomery_context<Bits>>> contexts;
+        std::vector<const arith::montgomery_context<Bits> *> pointers;
+        std::vector<value> bases, results(count);
+        std::vector<arith::uint<EBits>> exponents;
+        for (std::size_t i = 0; i != count; ++i) {
+            const value n = random_uint<Bits>(generator) | value {1};
+            contexts.emplace_back(new arith::montgomery_context<Bits> {n});
+            pointers.push_back(contexts.back().get());
+            bases.push_back(random_uint<Bits>(generator) % n);
+            exponents.push_back(EBits == 64 ? arith::uint<EBits> {65537} : random_uint<EBits>(generator));
+        }
+
+        std::cout << std::setw(6) << Bits << std::setw(10) << label;
+        for (const arith::lane_engine engine : all_engines) {
+            if (!arith::is_supported(engine)) {
+                std::cout << std::setw(12) << "-";
+                continue;
+            }
+            const double seconds = benchmarks::seconds_per_call([&]() {
+                arith::multi_modexp(results.data(),pointers.data(),bases.data(),exponents.data(),count,engine);
+                benchmarks::keep(results.data());
+            },0.3);
+            std::cout << std::setw(12) << count/seconds;
+        }
+        std::cout << '\n';
+    }
+}
+
+int main() {
+    std::mt19937_64 generator {2013};
+    std::cout << "Exponentiations per second, independent moduli\n"
+              << std::setw(6) << "bits" << std::setw(10) << "exponent"
+              << std::setw(12) << "scalar" << std::setw(12) << "avx2" << std::setw(12) << "avx512ifma" << '\n'
+              << std::fixed << std::setprecision(0);
+    report<1024,64>(generator,"65537");
+    report<1024,1024>(generator,"full");
+    report<2048,64>(generator,"65537");
+    report<2048,2048>(generator,"full");
+    report<4096,64>(generator,"65537");
+    return 0;
+}
@@ -0,0 +1,108 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// benchmarks/arith/p256.cpp - P-256 operations per second on a single core: scalar
+//                    multiplications, ECDSA signatures and checks, ECDH agreements
+
+#include "arith/p256.hpp"
+#include "utils/benchmark.hpp"
+
+#include <array>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+    using namespace cpp11crypto;
+    typedef arith::p256::value_type value;
+
+    value random_value(std::mt19937_64& generator) {
+        value x;
+        for (std::size_t i = 0; i != value::limb_count; ++i) {
+            x.limb(i) = generator();
+        }
+        return x;
+    }
+
+    void row(const char * const name,const double seconds) {
+        std::cout << std::setw(16) << name << std::setw(12) << 1/seconds << std::setw(12) << 1e6*seconds << '\n';
+    }
+}
+
+int main() {
+    std::mt19937_64 generator {2013};
+    // the first call builds the generator tables
+    const auto start = benchmarks::clock::now();
+    benchmarks::keep(&arith::p256::details::generator_tables());
+    const double tables = benchmarks::seconds_since(start);
+
+    const std::size_t count = 64;
+    const arith::p256::private_key key = arith::p256::generate_key(generator);
+    const arith::p256::private_key peer = arith::p256::generate_key(generator);
+    std::vector<std::array<std::uint8_t,32>> digests(count);
+    std::vector<arith::p256::signature> signatures;
+    std::vector<value> scalars;
+    for (std::size_t i = 0; i != count; ++i) {
+        for (std::uint8_t& b: digests[i]) {
+            b = static_cast<std::uint8_t>(generator());
+        }
+        signatures.push_back(key.sign(digests[i],generator));
+        scalars.push_back(random_value(generator));
+    }
+    const arith::p256::point q = key.public_key().value();
+
+    std::size_t i = 0;
+    std::cout << "P-256 operations per second and microseconds per operation\n"
+              << std::setw(16) << "operation" << std::setw(12) << "ops/s" << std::setw(12) << "us" << '\n'
+              << std::fixed << std::setprecision(1);
+    row("k*P",benchmarks::seconds_per_call([&]() {
+        const arith::p256::point r = arith::p256::multiply(scalars[i++ % count],q);
+        benchmarks::keep(&r);
+    },0.5));
+    row("k*G comb",benchmarks::seconds_per_call([&]() {
+        const arith::p256::point r = arith::p256::multiply_base(scalars[i++ % count]);
+        benchmarks::keep(&r);
+    },0.5));
+    row("u1*G+u2*P",benchmarks::seconds_per_call([&]() {
+        const arith::p256::point r = arith::p256::multiply_public(scalars[i % count],scalars[(i+1) % count],q);
+        ++i;
+        benchmarks::keep(&r);
+    },0.5));
+    row("inversion",benchmarks::seconds_per_call([&]() {
+        const value r = arith::p256::field().invert(scalars[i++ % count] >> 1);
+        benchmarks::keep(&r);
+    },0.5));
+    row("ECDSA sign",benchmarks::seconds_per_call([&]() {
+        const arith::p256::signature s = key.sign(digests[i++ % count],generator);
+        benchmarks::keep(&s);
+    },0.5));
+    row("ECDSA verify",benchmarks::seconds_per_call([&]() {
+        const bool ok = key.public_key().verify(digests[i % count],signatures[i % count]);
+        ++i;
+        benchmarks::keep(&ok);
+    },0.5));
+    row("ECDH",benchmarks::seconds_per_call([&]() {
+        const value z = key.agree(peer.public_key());
+        benchmarks::keep(&z);
+    },0.5));
+    std::cout << "generator tables built in " << 1e3*tables << " ms\n";
+    return 0;
+}
@@ -0,0 +1,76 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// benchmarks/arith/prime.cpp - Candidates per second and distribution of the time
+//                    to a prime, with one thread and with one per core
+
+#include "arith/prime.hpp"
+#include "utils/benchmark.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+    using namespace cpp11crypto;
+
+    /// Quantile of sorted samples
+    double quantile(const std::vector<double>& sorted,const double q) {
+        return sorted[static_cast<std::size_t>(q*(sorted.size()-1)+0.5)];
+    }
+
+    template <std::size_t Bits>
+    void report(std::mt19937_64& generator,const unsigned threads,const unsigned samples) {
+        arith::prime_statistics statistics;
+        std::vector<double> times;
+        double total = 0;
+        for (unsigned i = 0; i != samples; ++i) {
+            const auto start = benchmarks::clock::now();
+            const arith::uint<Bits> p = arith::generate_prime<Bits>(generator,arith::prime_options {threads},statistics);
+            benchmarks::keep(&p);
+            times.push_back(1e3*benchmarks::seconds_since(start));
+            total += times.back()/1e3;
+        }
+        std::sort(times.begin(),times.end());
+        std::cout << std::setw(6) << Bits << std::setw(8) << threads << std::setw(8) << samples
+                  << std::setw(12) << statistics.candidates/total << std::setw(10) << statistics.tested/total
+                  << std::setw(9) << times.front() << std::setw(9) << quantile(times,0.5)
+                  << std::setw(9) << quantile(times,0.9) << std::setw(9) << times.back() << '\n';
+    }
+}
+
+int main() {
+    std::mt19937_64 generator {2013};
+    const unsigned cores = std::max(1u,std::thread::hardware_concurrency());
+    std::cout << "Candidates and Miller-Rabin tests per second, milliseconds to a prime (min, median, 90%, max)\n"
+              << std::setw(6) << "bits" << std::setw(8) << "threads" << std::setw(8) << "primes"
+              << std::setw(12) << "cand/s" << std::setw(10) << "tests/s"
+              << std::setw(9) << "min" << std::setw(9) << "median" << std::setw(9) << "90%" << std::setw(9) << "max" << '\n'
+              << std::fixed << std::setprecision(1);
+    for (unsigned threads = 1; threads <= cores; threads = threads < cores ? std::min(cores,2*threads) : cores+1) {
+        report<512>(generator,threads,50);
+        report<1024>(generator,threads,20);
+        report<1536>(generator,threads,10);
+        report<2048>(generator,threads,5);
+    }
+    return 0;
+}
@@ -0,0 +1,98 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// benchmarks/arith/uint.cpp - Nanoseconds per operation of fixed width
+//                    integers at 256, 384, 2048 and 4096 bits
+
+#include "arith/uint.hpp"
+#include "utils/benchmark.hpp"
+
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+namespace {
+    using namespace cpp11crypto;
+
+    template <std::size_t Bits>
+    arith::uint<Bits> random_uint(std::mt19937_64& generator) {
+        arith::uint<Bits> x;
+        for (std::size_t i = 0; i != arith::uint<Bits>::limb_count; ++i) {
+            x.limb(i) = generator();
+        }
+        return x;
+    }
+
+    template <typename F>
+    double nanoseconds_per_call(F&& f) {
+        return 1e9*benchmarks::seconds_per_call(f);
+    }
+
+    template <std::size_t Bits>
+    void report(std::mt19937_64& generator) {
+        typedef arith::uint<Bits> value;
+        value a = random_uint<Bits>(generator);
+        const value b = random_uint<Bits>(generator);
+        const value divisor = random_uint<Bits>(generator) >> (Bits/2);
+        bool less = false;
+
+        const double add = nanoseconds_per_call([&]() {
+            a += b;
+            benchmarks::keep(&a);
+        });
+        const double subtract = nanoseconds_per_call([&]() {
+            a -= b;
+            benchmarks::keep(&a);
+        });
+        const double multiply = nanoseconds_per_call([&]() {
+            a = a*b;
+            benchmarks::keep(&a);
+        });
+        const double wide = nanoseconds_per_call([&]() {
+            const arith::uint<2*Bits> product = wide_multiply(a,b);
+            benchmarks::keep(&product);
+        });
+        const double compare = nanoseconds_per_call([&]() {
+            less ^= a < b;
+            a.limb(0) += less;
+            benchmarks::keep(&a);
+        });
+        const double divide = nanoseconds_per_call([&]() {
+            const value remainder = (a|b) % divisor;
+            benchmarks::keep(&remainder);
+        });
+        std::cout << std::setw(6) << Bits << std::setw(10) << add << std::setw(10) << subtract
+                  << std::setw(10) << multiply << std::setw(10) << wide << std::setw(10) << compare
+                  << std::setw(10) << divide << '\n';
+    }
+}
+
+int main() {
+    std::mt19937_64 generator {2013};
+    std::cout << "Nanoseconds per operation\n"
+              << std::setw(6) << "bits" << std::setw(10) << "add" << std::setw(10) << "sub"
+              << std::setw(10) << "mul" << std::setw(10) << "widemul" << std::setw(10) << "less"
+              << std::setw(10) << "mod" << '\n' << std::fixed << std::setprecision(1);
+    report<256>(generator);
+    report<384>(generator);
+    report<2048>(generator);
+    report<4096>(generator);
+    return 0;
+}
@@ -0,0 +1,77 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// benchmarks/block/aes.cpp - AES cycles per byte on every implementation the
+//                    processor supports, for each key length and direction
+
+#include "block/aes.hpp"
+#include "utils/benchmark.hpp"
+
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace {
+    using namespace cpp11crypto;
+
+    const char * name(const block::aes_engine engine) {
+        return block::aes_engine::vaes == engine ? "vaes"
+               : block::aes_engine::aesni == engine ? "aesni"
+               : block::aes_engine::bitsliced_avx2 == engine ? "avx2"
+               : block::aes_engine::bitsliced_sse2 == engine ? "sse2" : "bitsliced";
+    }
+
+    template <typename Cipher>
+    void report(const block::aes_engine engine,std::vector<std::uint8_t>& buffer) {
+        const std::vector<std::uint8_t> key(Cipher::key_size,0x2b);
+        const Cipher aes {key,engine};
+        const std::size_t blocks = buffer.size()/Cipher::block_size;
+        const double encrypt = benchmarks::cycles_per_byte([&]() {
+            aes.encrypt(buffer.data(),buffer.data(),blocks);
+            benchmarks::keep(buffer.data());
+        },buffer.size());
+        const double decrypt = benchmarks::cycles_per_byte([&]() {
+            aes.decrypt(buffer.data(),buffer.data(),blocks);
+            benchmarks::keep(buffer.data());
+        },buffer.size());
+        std::cout << std::setw(10) << name(engine) << std::setw(6) << 8*Cipher::key_size
+                  << std::setw(10) << encrypt << std::setw(10) << decrypt << '\n';
+    }
+}
+
+int main() {
+    std::vector<std::uint8_t> buffer(16384,0x5a);
+    const block::aes_engine engines[] = {block::aes_engine::bitsliced,block::aes_engine::bitsliced_sse2,
+                                         block::aes_engine::bitsliced_avx2,block::aes_engine::aesni,
+                                         block::aes_engine::vaes};
+    std::cout << "AES cycles per byte on " << buffer.size() << "-byte buffers, "
+              << name(block::best_aes_engine()) << " selected by default\n"
+              << std::setw(10) << "engine" << std::setw(6) << "key" << std::setw(10) << "encrypt"
+              << std::setw(10) << "decrypt" << '\n' << std::fixed << std::setprecision(2);
+    for (const block::aes_engine engine : engines) {
+        if (!block::is_supported(engine)) {
+            continue;
+        }
+        report<block::aes128>(engine,buffer);
+        report<block::aes192>(engine,buffer);
+        report<block::aes256>(engine,buffer);
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// benchmarks/block/modes.cpp - AES-128 cycles per byte in the modes of
+//                    operation, serial CBC encryption against the batched modes
+
+#include "block/aes.hpp"
+#include "block/modes.hpp"
+#include "stream/ctr.hpp"
+#include "utils/benchmark.hpp"
+
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace {
+    using namespace cpp11crypto;
+
+    const char * name(const block::aes_engine engine) {
+        return block::aes_engine::vaes == engine ? "vaes"
+               : block::aes_engine::aesni == engine ? "aesni"
+               : block::aes_engine::bitsliced_avx2 == engine ? "avx2"
+               : block::aes_engine::bitsliced_sse2 == engine ? "sse2" : "bitsliced";
+    }
+
+    void report(const block::aes_engine engine,std::vector<std::uint8_t>& buffer) {
+        const std::vector<std::uint8_t> key(16,0x2b), iv(16,0x01);
+        const block::aes128 aes {key,engine}, tweak {iv,engine};
+        std::uint8_t * const data = buffer.data();
+        const std::size_t bytes = buffer.size();
+        const block::ecb<block::aes128> ecb {aes};
+        block::cbc<block::aes128> cbc {aes,iv};
+        stream::ctr<block::aes128> ctr {aes,iv};
+        const block::xts<block::aes128> xts {aes,tweak};
+        std::cout << std::setw(10) << name(engine)
+                  << std::setw(10) << benchmarks::cycles_per_byte([&]() {
+                         ecb.encrypt(data,data,bytes);
+                         benchmarks::keep(data);
+                     },bytes)
+                  << std::setw(10) << benchmarks::cycles_per_byte([&]() {
+                         cbc.encrypt(data,data,bytes);
+                         benchmarks::keep(data);
+                     },bytes)
+                  << std::setw(10) << benchmarks::cycles_per_byte([&]() {
+                         cbc.decrypt(data,data,bytes);
+                         benchmarks::keep(data);
+                     },bytes)
+                  << std::setw(10) << benchmarks::cycles_per_byte([&]() {
+                         ctr.process(data,data,bytes);
+                         benchmarks::keep(data);
+                     },bytes)
+                  << std::setw(10) << benchmarks::cycles_per_byte([&]() {
+                         xts.encrypt(0,data,data,bytes);
+                         benchmarks::keep(data);
+                     },bytes)
+                  << std::setw(10) << benchmarks::cycles_per_byte([&]() {
+                         xts.decrypt(0,data,data,bytes);
+                         benchmarks::keep(data);
+                     },bytes) << '\n';
+    }
+}
+
+int main() {
+    std::vector<std::uint8_t> buffer(16384,0x5a);
+    const block::aes_engine engines[] = {block::aes_engine::bitsliced,block::aes_engine::bitsliced_sse2,
+                                         block::aes_engine::bitsliced_avx2,block::aes_engine::aesni,
+                                         block::aes_engine::vaes};
+    std::cout << "AES-128 cycles per byte on " << buffer.size() << "-byte buffers, "
+              << block::parallel_blocks << " blocks per batch\n"
+              << std::setw(10) << "engine" << std::setw(10) << "ecb" << std::setw(10) << "cbc enc"
+              << std::setw(10) << "cbc dec" << std::setw(10) << "ctr" << std::setw(10) << "xts enc"
+              << std::setw(10) << "xts dec" << '\n' << std::fixed << std::setprecision(2);
+    for (const block::aes_engine engine : engines) {
+        if (block::is_supported(engine)) {
+            report(engine,buffer);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// benchmarks/core/secure_array.cpp - Cost and allocator calls of inline
+//                    secure buffers against zeroizing vectors
+
+#include "core/secure_array.hpp"
+#include "core/zeroizing.hpp"
+#include "utils/benchmark.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace {
+    /// Calls to the global allocation functions
+    std::size_t allocator_calls = 0;
+}
+
+void *operator new(const std::size_t size) {
+    ++allocator_calls;
+    if (void * const p = std::malloc(0 == size ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void * const p) noexcept {
+    if (nullptr != p) {
+        ++allocator_calls;
+    }
+    std::free(p);
+}
+
+namespace {
+    using namespace cpp11crypto;
+
+    /// One hot path step: fill a key, then move it to its user
+    template <typename Key>
+    void key_round(const std::uint8_t seed) {
+        Key key(32);
+        for (std::size_t i = 0; i != 32; ++i) {
+            key[i] = static_cast<std::uint8_t>(seed+i);
+        }
+        Key moved {std::move(key)};
+        benchmarks::keep(&moved[0]);
+    }
+
+    /// Same step for inline buffers, which have no runtime size
+    template <>
+    void key_round<core::secure_buffer<32>>(const std::uint8_t seed) {
+        core::secure_buffer<32> key;
+        for (std::size_t i = 0; i != 32; ++i) {
+            key[i] = static_cast<std::uint8_t>(seed+i);
+        }
+        core::secure_buffer<32> moved {std::move(key)};
+        benchmarks::keep(moved.data());
+    }
+
+    template <typename Key>
+    void report(const char * const name) {
+        constexpr std::size_t rounds = 100000;
+        const std::size_t calls_before = allocator_calls;
+        for (std::size_t i = 0; i != rounds; ++i) {
+            key_round<Key>(static_cast<std::uint8_t>(i));
+        }
+        const std::size_t calls = allocator_calls - calls_before;
+        const double seconds = benchmarks::seconds_per_call([]() {
+            for (std::size_t i = 0; i != rounds; ++i) {
+                key_round<Key>(static_cast<std::uint8_t>(i));
+            }
+        },0.2);
+        std::cout << std::setw(34) << name
+                  << std::setw(12) << std::setprecision(2) << seconds/rounds*1e9
+                  << std::setw(16) << std::setprecision(3) << static_cast<double>(calls)/rounds << '\n';
+    }
+}
+
+int main() {
+    std::cout << std::setw(34) << "32-byte key" << std::setw(12) << "ns/op"
+              << std::setw(16) << "alloc calls/op" << '\n' << std::fixed;
+    report<core::secure_buffer<32>>("core::secure_buffer<32>");
+    report<std::vector<std::uint8_t,core::allocator<std::uint8_t>>>("vector<uint8_t,core::allocator>");
+    return 0;
+}
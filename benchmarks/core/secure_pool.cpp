@@ -0,0 +1,132 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// benchmarks/core/secure_pool.cpp - Multithreaded allocation throughput of
+//                    ZeroizingBase objects under each base operator
+
+#include "core/secure_pool.hpp"
+#include "core/zeroizing.hpp"
+#include "utils/benchmark.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace {
+    using namespace cpp11crypto;
+
+    /// Every object goes to the shared arena, behind its single mutex
+    struct arena_direct {
+        static void *get_new(const std::size_t size) {
+            return core::secure_arena::instance().allocate(size);
+        }
+        static void do_delete(void * const p,const std::size_t size) {
+            core::secure_arena::instance().deallocate(p,size);
+        }
+        static void *get_new_array(const std::size_t size) {
+            return get_new(size);
+        }
+        static void do_delete_array(void * const p,const std::size_t size) {
+            do_delete(p,size);
+        }
+    };
+
+    template <typename base_operator>
+    struct session_key : public core::ZeroizingBase<base_operator> {
+        std::array<std::uint64_t,4> key;
+    };
+
+    constexpr std::size_t live_objects = 16;
+    constexpr std::size_t rounds_per_thread = 20000;
+
+    /// Allocates and frees a small working set, round after round
+    template <typename base_operator>
+    void churn() {
+        using object = session_key<base_operator>;
+        std::array<object *,live_objects> live;
+        for (std::size_t round = 0; round != rounds_per_thread; ++round) {
+            for (auto& p : live) {
+                p = new object();
+                p->key[0] = round;
+            }
+            benchmarks::keep(live.data());
+            for (auto p : live) {
+                delete p;
+            }
+        }
+    }
+
+    /// Each thread runs one untimed pass, which maps regions and fills its
+    /// magazines, and waits at a start barrier. The clock runs from the release
+    /// of the barrier to the end of the last thread.
+    /// @return million allocations per second, all threads together
+    template <typename base_operator>
+    double million_allocations_per_second(const unsigned thread_count) {
+        std::atomic<unsigned> ready {0};
+        std::atomic<bool> go {false};
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t != thread_count; ++t) {
+            threads.emplace_back([&ready,&go]() {
+                churn<base_operator>();
+                ready.fetch_add(1);
+                while (!go.load()) {
+                    std::this_thread::yield();
+                }
+                churn<base_operator>();
+            });
+        }
+        while (ready.load() != thread_count) {
+            std::this_thread::yield();
+        }
+        const auto start = benchmarks::clock::now();
+        go.store(true);
+        for (auto& t : threads) {
+            t.join();
+        }
+        const double seconds = benchmarks::seconds_since(start);
+        return thread_count*rounds_per_thread*live_objects/seconds/1e6;
+    }
+}
+
+int main(int argc,char *argv[]) {
+    const unsigned max_threads = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 64;
+    std::cout << "Allocation+free throughput of 32-byte ZeroizingBase objects, in millions/s\n"
+              << "(hardware threads: " << std::thread::hardware_concurrency() << ")\n";
+    std::cout << std::setw(8) << "threads" << std::setw(14) << "standard"
+              << std::setw(14) << "arena_direct" << std::setw(14) << "thread_cached"
+              << std::setw(12) << "scaling" << '\n' << std::fixed << std::setprecision(2);
+    double single = 0;
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+        const double cached = million_allocations_per_second<core::thread_cached>(threads);
+        if (1 == threads) {
+            single = cached;
+        }
+        std::cout << std::setw(8) << threads
+                  << std::setw(14) << million_allocations_per_second<core::standard>(threads)
+                  << std::setw(14) << million_allocations_per_second<arena_direct>(threads)
+                  << std::setw(14) << cached
+                  << std::setw(11) << cached/single << "x\n";
+    }
+    return 0;
+}
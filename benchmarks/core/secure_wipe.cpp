@@ -0,0 +1,101 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// benchmarks/core/secure_wipe.cpp - Wiping throughput of every kernel
+//                    against the former fill-and-verify zeroizer
+
+#include "core/secure_wipe.hpp"
+#include "utils/aligned_as_integral.hpp"
+#include "utils/benchmark.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace {
+    using namespace cpp11crypto;
+
+    /// Zeroizer as it was before the vector kernels: fill with the integral
+    /// type aligned as U, then scan until the whole block reads back as zero
+    template <typename U>
+    void legacy_zeroize(void * const start,const std::size_t len) {
+        using casted_to = typename utils::aligned_as_integral<U>::type;
+        casted_to * const first = static_cast<casted_to *>(start);
+        const std::size_t count = len/sizeof(casted_to);
+        do {
+            std::uninitialized_fill_n(first,count,casted_to {});
+        } while (first+count != std::find_if(first,first+count,[](const casted_to c) {
+        return casted_to {} != c;
+    }));
+    }
+
+    double gigabytes_per_second(void (*wipe)(void *,std::size_t),std::uint8_t * const p,const std::size_t len) {
+        const double seconds = benchmarks::seconds_per_call([&]() {
+            wipe(p,len);
+            benchmarks::keep(p);
+        },0.05);
+        return len/seconds/1e9;
+    }
+}
+
+int main() {
+    constexpr std::size_t max_size = std::size_t {64} << 20;
+    std::vector<std::uint8_t> buffer(max_size+64,0xa5);
+    // odd start, so every kernel goes through its unaligned head
+    std::uint8_t * const p = buffer.data()+1;
+
+    const std::pair<const char *,core::wipe_engine> engines[] = {
+        {"scalar",core::wipe_engine::scalar},{"sse2",core::wipe_engine::sse2},
+        {"avx2",core::wipe_engine::avx2},{"avx512",core::wipe_engine::avx512}
+    };
+
+    const char *best = "";
+    for (const auto& e : engines) {
+        if (core::best_wipe_engine() == e.second) {
+            best = e.first;
+        }
+    }
+    std::cout << "Wipe throughput in GB/s, best engine: " << best << " below " << core::vector_wipe_limit
+              << " bytes, scalar from there\n";
+    std::cout << std::setw(10) << "bytes" << std::setw(10) << "legacy8" << std::setw(10) << "legacy64";
+    for (const auto& e : engines) {
+        std::cout << std::setw(10) << e.first;
+    }
+    std::cout << std::setw(10) << "auto" << '\n' << std::fixed << std::setprecision(2);
+
+    for (std::size_t len = 16; len <= max_size; len *= 4) {
+        std::cout << std::setw(10) << len
+                  << std::setw(10) << gigabytes_per_second(&legacy_zeroize<std::uint8_t>,p,len)
+                  << std::setw(10) << gigabytes_per_second(&legacy_zeroize<std::uint64_t>,buffer.data(),len);
+        for (const auto& e : engines) {
+            if (core::is_supported(e.second)) {
+                const auto kernel = core::details::wipe_function_for(e.second);
+                std::cout << std::setw(10) << gigabytes_per_second(kernel,p,len);
+            } else {
+                std::cout << std::setw(10) << "-";
+            }
+        }
+        std::cout << std::setw(10) << gigabytes_per_second(static_cast<void (*)(void *,std::size_t)>(&core::secure_wipe),p,len)
+                  << '\n';
+    }
+    return 0;
+}
@@ -0,0 +1,112 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// benchmarks/hash/sha2.cpp - SHA-256 and SHA-512 in messages per second against
+//                    message length, one at a time and with each multi-buffer kernel
+
+#include "hash/sha2.hpp"
+#include "utils/benchmark.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace {
+    using namespace cpp11crypto;
+
+    /// Messages hashed per call
+    const std::size_t batch = 256;
+
+    const hash::multi_engine multi_engines[] = {hash::multi_engine::sse2,hash::multi_engine::avx2,
+                                                hash::multi_engine::avx512};
+
+    /// Runs of each measurement, taken in turns
+    const unsigned runs = 5;
+
+    /// Messages per second of a function hashing a batch, for one run
+    template <typename F>
+    double messages_per_second(F&& f) {
+        return batch/benchmarks::seconds_per_call(f,0.05);
+    }
+
+    template <typename Hash,typename Multi>
+    void table(const char * const title,const bool shani,Multi&& multi) {
+        std::cout << title << ", " << batch << " messages of each length, messages per second, best of "
+                  << runs << " runs\n" << std::setw(8) << "bytes" << std::setw(12) << "scalar" << std::setw(12) << "shani"
+                  << std::setw(12) << "sse2" << std::setw(12) << "avx2" << std::setw(12) << "avx512" << '\n';
+        std::vector<std::uint8_t> data(batch*16384,0x5a), digests(batch*Hash::digest_size);
+        for (std::size_t bytes = 16; bytes <= 16384; bytes *= 4) {
+            std::vector<utils::span<std::uint8_t>> messages;
+            for (std::size_t i = 0; i != batch; ++i) {
+                messages.push_back(utils::make_span(data.data()+i*bytes,bytes));
+            }
+            const hash::sha_engine engines[] = {hash::sha_engine::scalar,hash::sha_engine::shani};
+            const bool usable[5] = {true,shani && hash::is_supported(hash::sha_engine::shani),
+                                    hash::is_supported(multi_engines[0]),hash::is_supported(multi_engines[1]),
+                                    hash::is_supported(multi_engines[2])};
+            // the kernels take turns, so that a slow spell of a shared machine
+            // does not fall on one of them only
+            double best[5] = {};
+            for (unsigned run = 0; run != runs; ++run) {
+                for (unsigned i = 0; i != 2; ++i) {
+                    if (usable[i]) {
+                        best[i] = std::max(best[i],messages_per_second([&]() {
+                            for (std::size_t j = 0; j != batch; ++j) {
+                                Hash::digest(messages[j].data(),bytes,digests.data()+j*Hash::digest_size,engines[i]);
+                            }
+                            benchmarks::keep(digests.data());
+                        }));
+                    }
+                }
+                for (unsigned i = 0; i != 3; ++i) {
+                    if (usable[2+i]) {
+                        best[2+i] = std::max(best[2+i],messages_per_second([&]() {
+                            multi(messages.data(),digests.data(),batch,multi_engines[i]);
+                            benchmarks::keep(digests.data());
+                        }));
+                    }
+                }
+            }
+            std::cout << std::setw(8) << bytes;
+            for (unsigned i = 0; i != 5; ++i) {
+                if (usable[i]) {
+                    std::cout << std::setw(12) << best[i];
+                } else {
+                    std::cout << std::setw(12) << "-";
+                }
+            }
+            std::cout << '\n';
+        }
+    }
+}
+
+int main() {
+    std::cout << std::fixed << std::setprecision(0);
+    table<hash::sha256>("SHA-256",true,[](const utils::span<std::uint8_t> * const messages,std::uint8_t * const digests,
+                                          const std::size_t count,const hash::multi_engine engine) {
+        hash::multi_sha256(messages,digests,count,engine);
+    });
+    table<hash::sha512>("SHA-512",false,[](const utils::span<std::uint8_t> * const messages,std::uint8_t * const digests,
+                                           const std::size_t count,const hash::multi_engine engine) {
+        hash::multi_sha512(messages,digests,count,engine);
+    });
+    return 0;
+}
@@ -0,0 +1,90 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// benchmarks/mac/chacha20_poly1305.cpp - ChaCha20, Poly1305 and their AEAD in
+//                    cycles per byte, each vector kernel against the scalar one
+
+#include "mac/chacha20_poly1305.hpp"
+#include "utils/benchmark.hpp"
+
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace {
+    using namespace cpp11crypto;
+
+    const char * name(const stream::chacha_engine engine) {
+        return stream::chacha_engine::avx512 == engine ? "avx512"
+               : stream::chacha_engine::avx2 == engine ? "avx2"
+               : stream::chacha_engine::sse2 == engine ? "sse2" : "scalar";
+    }
+}
+
+int main() {
+    const std::vector<std::uint8_t> key(32,0x2b), nonce(12,0x01), aad(16,0x02);
+    std::vector<std::uint8_t> buffer(16384,0x5a);
+    std::uint8_t * const data = buffer.data();
+    std::uint8_t tag[16];
+    const stream::chacha_engine engines[] = {stream::chacha_engine::scalar,stream::chacha_engine::sse2,
+                                             stream::chacha_engine::avx2,stream::chacha_engine::avx512};
+    const mac::poly1305_engine hashes[] = {mac::poly1305_engine::scalar,mac::poly1305_engine::avx2};
+
+    std::cout << "Cycles per byte on " << buffer.size() << "-byte buffers\n" << std::setw(10) << "chacha20" << '\n'
+              << std::fixed << std::setprecision(2);
+    for (const stream::chacha_engine engine : engines) {
+        if (stream::is_supported(engine)) {
+            stream::chacha20 chacha {key,nonce,0,engine};
+            std::cout << std::setw(10) << name(engine) << std::setw(10) << benchmarks::cycles_per_byte([&]() {
+                             chacha.process(data,data,buffer.size());
+                             benchmarks::keep(data);
+                         },buffer.size()) << '\n';
+        }
+    }
+
+    std::cout << std::setw(10) << "poly1305" << '\n';
+    for (const mac::poly1305_engine hash : hashes) {
+        if (mac::is_supported(hash)) {
+            std::cout << std::setw(10) << (mac::poly1305_engine::avx2 == hash ? "avx2" : "scalar")
+                      << std::setw(10) << benchmarks::cycles_per_byte([&]() {
+                             mac::poly1305 poly {key,hash};
+                             poly.update(data,buffer.size());
+                             poly.finalize(tag);
+                             benchmarks::keep(tag);
+                         },buffer.size()) << '\n';
+        }
+    }
+
+    const mac::chacha20_poly1305 reference {key,stream::chacha_engine::scalar,mac::poly1305_engine::scalar}, fast {key};
+    std::cout << "ChaCha20-Poly1305 encryption, 16 bytes of associated data\n" << std::setw(10) << "bytes"
+              << std::setw(10) << "scalar" << std::setw(10) << "best" << '\n';
+    for (std::size_t bytes = 64; bytes <= buffer.size(); bytes *= 4) {
+        std::cout << std::setw(10) << bytes
+                  << std::setw(10) << benchmarks::cycles_per_byte([&]() {
+                         reference.encrypt(nonce,aad,data,data,bytes,tag);
+                         benchmarks::keep(data);
+                     },bytes)
+                  << std::setw(10) << benchmarks::cycles_per_byte([&]() {
+                         fast.encrypt(nonce,aad,data,data,bytes,tag);
+                         benchmarks::keep(data);
+                     },bytes) << '\n';
+    }
+    return 0;
+}
@@ -0,0 +1,66 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// benchmarks/mac/gcm.cpp - AES-128-GCM cycles per byte from 64 bytes to 1 MiB,
+//                    stitched AES-NI and PCLMULQDQ against the table fallback
+
+#include "mac/gcm.hpp"
+#include "utils/benchmark.hpp"
+
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace {
+    using namespace cpp11crypto;
+}
+
+int main() {
+    const std::vector<std::uint8_t> key(16,0x2b), nonce(12,0x01), aad(16,0x02);
+    const mac::aes128_gcm fast {key}, table {key,block::best_aes_engine(),mac::ghash_engine::table};
+    std::vector<std::uint8_t> buffer(1 << 20,0x5a), sealed(buffer.size());
+    std::uint8_t * const data = buffer.data();
+    std::uint8_t tag[16], sealed_tag[16];
+    const bool stitched = mac::ghash_engine::pclmul == fast.hash_engine()
+                          && (block::aes_engine::aesni == fast.cipher_in_use().engine()
+                              || block::aes_engine::vaes == fast.cipher_in_use().engine());
+    std::cout << "AES-128-GCM cycles per byte, 16 bytes of associated data, "
+              << (stitched ? "stitched" : "not stitched") << '\n'
+              << std::setw(10) << "bytes" << std::setw(10) << "encrypt" << std::setw(10) << "decrypt"
+              << std::setw(10) << "table" << '\n' << std::fixed << std::setprecision(2);
+    for (std::size_t bytes = 64; bytes <= buffer.size(); bytes *= 4) {
+        fast.encrypt(nonce,aad,data,sealed.data(),bytes,sealed_tag);
+        bool opened = true;
+        std::cout << std::setw(10) << bytes
+                  << std::setw(10) << benchmarks::cycles_per_byte([&]() {
+                         fast.encrypt(nonce,aad,data,data,bytes,tag);
+                         benchmarks::keep(data);
+                     },bytes)
+                  << std::setw(10) << benchmarks::cycles_per_byte([&]() {
+                         opened &= fast.decrypt(nonce,aad,sealed.data(),data,bytes,sealed_tag);
+                         benchmarks::keep(data);
+                     },bytes)
+                  << std::setw(10) << benchmarks::cycles_per_byte([&]() {
+                         table.encrypt(nonce,aad,data,data,bytes,tag);
+                         benchmarks::keep(data);
+                     },bytes) << (opened ? "" : "  (tag rejected)") << '\n';
+    }
+    return 0;
+}
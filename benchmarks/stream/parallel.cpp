@@ -0,0 +1,64 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// benchmarks/stream/parallel.cpp - AES-128 CTR throughput on a large buffer
+//                    by number of threads, and the cost of a seek
+
+#include "block/aes.hpp"
+#include "stream/ctr.hpp"
+#include "stream/parallel.hpp"
+#include "utils/benchmark.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+int main() {
+    using namespace cpp11crypto;
+    std::vector<std::uint8_t> buffer(std::size_t {1} << 26,0x5a);
+    const std::vector<std::uint8_t> key(16,0x2b), iv(16,0x01);
+    const block::aes128 aes {key};
+    stream::ctr<block::aes128> ctr {aes,iv};
+
+    const unsigned cores = std::max(1u,std::thread::hardware_concurrency());
+    std::cout << "AES-128 CTR on " << (buffer.size() >> 20) << " MiB, " << cores << " cores, chunks of "
+              << stream::parallel_chunk_bytes << " bytes\n"
+              << std::setw(10) << "threads" << std::setw(10) << "GB/s" << '\n' << std::fixed << std::setprecision(2);
+    for (unsigned threads = 1; threads <= 2*cores; threads *= 2) {
+        utils::work_stealing_pool pool {threads};
+        const double seconds = benchmarks::seconds_per_call([&]() {
+            stream::process_parallel(ctr,buffer.data(),buffer.data(),buffer.size(),pool);
+            benchmarks::keep(buffer.data());
+        },0.5);
+        std::cout << std::setw(10) << threads << std::setw(10) << buffer.size()/seconds/1e9 << '\n';
+    }
+
+    // one block from a far position, seek included
+    std::uint64_t position = 0;
+    const double seek = benchmarks::seconds_per_call([&]() {
+        ctr.seek(position += 0x123456789ULL);
+        ctr.process(buffer.data(),buffer.data(),16);
+        benchmarks::keep(buffer.data());
+    });
+    std::cout << "seek and one block: " << std::setprecision(0) << seek*1e9 << " ns\n";
+    return 0;
+}
@@ -0,0 +1,102 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// benchmarks/utils/benchmark.hpp - Timing helpers shared by all benchmarks
+
+#ifndef CPP11CRYPTO_BENCHMARKS_UTILS_BENCHMARK_HPP
+#define CPP11CRYPTO_BENCHMARKS_UTILS_BENCHMARK_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace cpp11crypto {
+    namespace benchmarks {
+
+        /// Clock used for all measurements
+        using clock = std::chrono::steady_clock;
+
+        /// Seconds elapsed since a time point
+        /// @param start time point
+        /// @return elapsed seconds
+        inline double seconds_since(const clock::time_point start) {
+            return std::chrono::duration<double>(clock::now()-start).count();
+        }
+
+        /// Runs an operation repeatedly, doubling the batch until it lasts long enough
+        /// @tparam F nullary callable
+        /// @param f operation to measure
+        /// @param min_seconds minimum duration of the measured batch
+        /// @return seconds per call
+        template <typename F>
+        double seconds_per_call(F&& f,const double min_seconds = 0.1) {
+            for (std::size_t batch = 1;; batch *= 2) {
+                const auto start = clock::now();
+                for (std::size_t i = 0; i != batch; ++i) {
+                    f();
+                }
+                const double elapsed = seconds_since(start);
+                if (elapsed >= min_seconds) {
+                    return elapsed/batch;
+                }
+            }
+        }
+
+        /// Prevents the compiler from discarding a computed value
+        /// @param p address of the value
+        inline void keep(const void * const p) {
+#if defined(__GNUC__)
+            __asm__ __volatile__("" : : "r"(p) : "memory");
+#else
+            static_cast<const volatile char *>(p)[0];
+#endif
+        }
+
+        /// Reads the processor time stamp counter, or 0 where unavailable
+        /// @return current cycle count
+        inline std::uint64_t cycles() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+            unsigned lo, hi;
+            __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+            return (static_cast<std::uint64_t>(hi) << 32) | lo;
+#else
+            return 0;
+#endif
+        }
+
+        /// Cycles per byte of an operation on a buffer, over every call of the timed batches
+        /// @tparam F nullary callable
+        /// @param f operation to measure
+        /// @param bytes length of the buffer
+        /// @return time stamp counter cycles per byte, 0 where the counter is unavailable
+        template <typename F>
+        double cycles_per_byte(F&& f,const std::size_t bytes) {
+            std::size_t calls = 0;
+            const std::uint64_t start = cycles();
+            seconds_per_call([&]() {
+                ++calls;
+                f();
+            },0.2);
+            return static_cast<double>(cycles()-start)/calls/bytes;
+        }
+
+    }
+}
+
+#endif // CPP11CRYPTO_BENCHMARKS_UTILS_BENCHMARK_HPP
@@ -0,0 +1,285 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// PRP/rsa.hpp - RSA trapdoor permutation: CRT private operations with blinding,
+//                    single and batched public operations. Raw values, no padding.
+
+#ifndef CPP11CRYPTO_PRP_RSA_HPP
+#define CPP11CRYPTO_PRP_RSA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+#include "arith/algorithms/euclid.hpp"
+#include "arith/algorithms/safegcd.hpp"
+#include "arith/modexp.hpp"
+#include "arith/montgomery.hpp"
+#include "arith/multi_buffer.hpp"
+#include "arith/prime.hpp"
+#include "arith/uint.hpp"
+#include "core/zeroizing.hpp"
+
+namespace cpp11crypto {
+    namespace PRP {
+
+        /// RSA public key: modulus n and word-sized exponent e
+        /// @tparam Bits width of the modulus
+        template <::std::size_t Bits>
+        class rsa_public_key {
+        public:
+            /// Type of values and of the modulus
+            typedef arith::uint<Bits> value_type;
+
+            /// Constructor, prepares the Montgomery context once
+            /// @param modulus odd modulus
+            /// @param exponent odd public exponent, at least 3
+            /// @throw std::invalid_argument if the modulus is even or the exponent invalid
+            explicit rsa_public_key(const value_type& modulus,const unsigned long long exponent = 65537)
+                : n_context {modulus}, e {checked(exponent)} {}
+
+            /// @return modulus
+            const value_type& modulus() const noexcept {
+                return n_context.modulus();
+            }
+            /// @return public exponent
+            unsigned long long exponent() const noexcept {
+                return e;
+            }
+            /// @return Montgomery context of the modulus
+            const arith::montgomery_context<Bits>& context() const noexcept {
+                return n_context;
+            }
+
+            /// Public permutation, encryption and signature recovery
+            /// @param x value below the modulus
+            /// @return x^e mod n
+            /// @throw std::domain_error if x is not below the modulus
+            value_type encrypt(const value_type& x) const {
+                if (!(x < modulus())) {
+                    throw ::std::domain_error("RSA input not below the modulus");
+                }
+                value_type y;
+                const arith::montgomery_context<Bits> * const context = &n_context;
+                arith::multi_modexp_public(&y,&context,&x,e,1,arith::lane_engine::scalar);
+                return y;
+            }
+
+            /// Signature check
+            /// @param signature signature
+            /// @param message encoded message the signature should recover
+            /// @return true if signature^e mod n is the message
+            bool verify(const value_type& signature,const value_type& message) const {
+                return signature < modulus() && encrypt(signature) == message;
+            }
+
+        private:
+            static unsigned long long checked(const unsigned long long exponent) {
+                if (exponent < 3 || 0 == (exponent & 1)) {
+                    throw ::std::invalid_argument("RSA public exponent must be odd and at least 3");
+                }
+                return exponent;
+            }
+
+            arith::montgomery_context<Bits> n_context;
+            unsigned long long e;
+        };
+
+        /// Checks many signatures under one key. The Montgomery context of the key is
+        /// set up once and the exponentiations run side by side in the vector lanes of
+        /// @ref arith::multi_modexp_public.
+        /// @param key public key
+        /// @param signatures signatures, count of them
+        /// @param messages encoded messages, count of them
+        /// @param valid receives the outcome of each check, count of them
+        /// @param count number of signatures
+        /// @return number of valid signatures
+        template <::std::size_t Bits>
+        ::std::size_t verify_batch(const rsa_public_key<Bits>& key,const arith::uint<Bits> * const signatures,
+                                   const arith::uint<Bits> * const messages,bool * const valid,const ::std::size_t count) {
+            typedef arith::uint<Bits> value_type;
+            // bounded chunks keep memory small for any count
+            constexpr ::std::size_t chunk = 64;
+            const ::std::vector<const arith::montgomery_context<Bits> *> contexts(chunk,&key.context());
+            ::std::vector<value_type> bases(chunk), powers(chunk);
+            ::std::size_t valid_count = 0;
+            for (::std::size_t first = 0; first < count; first += chunk) {
+                const ::std::size_t n = ::std::min(chunk,count-first);
+                for (::std::size_t i = 0; i != n; ++i) {
+                    // out of range signatures are replaced by 0 and rejected below
+                    bases[i] = signatures[first+i] < key.modulus() ? signatures[first+i] : value_type {};
+                }
+                arith::multi_modexp_public(powers.data(),contexts.data(),bases.data(),key.exponent(),n);
+                for (::std::size_t i = 0; i != n; ++i) {
+                    valid[first+i] = signatures[first+i] < key.modulus() && powers[i] == messages[first+i];
+                    valid_count += valid[first+i] ? 1 : 0;
+                }
+            }
+            return valid_count;
+        }
+
+        /// RSA private key with the CRT parameters of two primes p and q of Bits/2
+        /// bits each. Private operations work modulo p and q with two half-size
+        /// Montgomery contexts and constant time exponentiations, on blinded inputs,
+        /// and are checked with the public exponent before returning. The blinding
+        /// pair (r^e, r^-1) is refreshed after every operation by squaring both.
+        /// Objects wipe their memory when destroyed, heap ones included.
+        /// Private operations update the blinding pair: a key must not be used by
+        /// several threads at once.
+        /// @tparam Bits width of the modulus, a multiple of 128
+        template <::std::size_t Bits>
+        class rsa_private_key : public core::ZeroizingBase<> {
+            static_assert(0 == Bits%128,"Primes must be whole limbs");
+        public:
+            /// Type of values and of the modulus
+            typedef arith::uint<Bits> value_type;
+            /// Type of the primes
+            typedef arith::uint<Bits/2> prime_type;
+
+            /// Constructor
+            /// @param p first prime
+            /// @param q second prime, different from p
+            /// @param exponent public exponent, coprime with p-1 and q-1
+            /// @param generator uniform random bit generator of 64-bit words, for the first blinding pair
+            /// @throw std::invalid_argument if p and q are equal or even, or the exponent is invalid
+            template <typename Generator>
+            rsa_private_key(const prime_type& p,const prime_type& q,const unsigned long long exponent,Generator& generator)
+                : key {modulus_of(p,q),exponent}, p_context {p}, q_context {q},
+                  dp {crt_exponent(p,exponent)}, dq {crt_exponent(q,exponent)},
+                  q_inverse {p_context.invert(p_context.multiply(reduce(p_context,value_type(q)),p_context.r_squared()))} {
+                reblind(generator);
+            }
+
+            /// @return public key
+            const rsa_public_key<Bits>& public_key() const noexcept {
+                return key;
+            }
+
+            /// Private permutation, decryption
+            /// @param x value below the modulus
+            /// @return x^d mod n
+            /// @throw std::domain_error if x is not below the modulus
+            /// @throw std::runtime_error if the result fails the public check, as after a fault
+            value_type decrypt(const value_type& x) {
+                if (!(x < key.modulus())) {
+                    throw ::std::domain_error("RSA input not below the modulus");
+                }
+                const arith::montgomery_context<Bits>& n = key.context();
+                // (x*r^e)^d == x^d*r
+                const value_type blinded = n.multiply(x,blind);
+                const value_type y = n.multiply(crt(blinded),unblind);
+                blind = n.square(blind);
+                unblind = n.square(unblind);
+                if (key.encrypt(y) != x) {
+                    throw ::std::runtime_error("RSA private operation failed its check");
+                }
+                return y;
+            }
+
+            /// Signature, see @ref decrypt
+            /// @param message encoded message below the modulus
+            /// @return message^d mod n
+            value_type sign(const value_type& message) {
+                return decrypt(message);
+            }
+
+            /// Draws a new blinding pair
+            /// @param generator uniform random bit generator of 64-bit words
+            template <typename Generator>
+            void reblind(Generator& generator) {
+                const arith::montgomery_context<Bits>& n = key.context();
+                value_type r, r_inverse;
+                do {
+                    r = arith::details::random_below(generator,key.modulus());
+                    r_inverse = n.invert(n.to_montgomery(r));
+                } while (r_inverse == value_type {});
+                // kept in the domain, so that a single product applies them
+                blind = n.to_montgomery(key.encrypt(r));
+                unblind = r_inverse;
+            }
+
+        private:
+            /// @return p*q
+            static value_type modulus_of(const prime_type& p,const prime_type& q) {
+                if (p == q || !p.bit(0) || !q.bit(0)) {
+                    throw ::std::invalid_argument("RSA primes must be odd and different");
+                }
+                return arith::wide_multiply(p,q);
+            }
+
+            /// e^-1 mod p-1. With t = (p-1) mod e and k = -t^-1 mod e, k*(p-1)+1 is a
+            /// multiple of e, and its quotient is below p-1.
+            /// @throw std::invalid_argument if e and p-1 are not coprime
+            static prime_type crt_exponent(const prime_type& p,const unsigned long long e) {
+                const prime_type p_minus_one = p-prime_type {1};
+                const unsigned long long t = arith::details::remainder(p_minus_one,e);
+                if (e < 3 || 1 != arith::algorithms::euclid::gcd<unsigned long long>(e,t)) {
+                    throw ::std::invalid_argument("RSA public exponent must be coprime with p-1 and q-1");
+                }
+                const unsigned long long k = e-arith::algorithms::safegcd::inverse<unsigned long long>(t,e);
+                typedef arith::uint<Bits/2+64> wide;
+                return prime_type((wide(p_minus_one)*wide {k}+wide {1})/wide {e});
+            }
+
+            /// Reduction of a full width value by a prime: with x = h*R+l, R = 2^(Bits/2),
+            /// h*R^2*R^-1 plus l*R*R^-1
+            static prime_type reduce(const arith::montgomery_context<Bits/2>& context,const value_type& x) noexcept {
+                return context.add(context.multiply(prime_type(x >> (Bits/2)),context.r_squared()),
+                                   context.multiply(prime_type(x),context.one()));
+            }
+
+            /// x^d mod n by Garner's recombination: m2+q*((m1-m2)*q^-1 mod p)
+            value_type crt(const value_type& x) const {
+                const prime_type m1 = arith::modexp(p_context,reduce(p_context,x),dp);
+                const prime_type m2 = arith::modexp(q_context,reduce(q_context,x),dq);
+                const prime_type difference = p_context.subtract(m1,p_context.multiply(m2,p_context.one()));
+                const prime_type h = p_context.multiply(difference,q_inverse);
+                return arith::wide_multiply(h,q_context.modulus())+value_type(m2);
+            }
+
+            rsa_public_key<Bits> key;
+            arith::montgomery_context<Bits/2> p_context, q_context;
+            prime_type dp, dq;
+            /// q^-1 mod p, in the domain of p
+            prime_type q_inverse;
+            /// r^e and r^-1, in the domain of n
+            value_type blind, unblind;
+        };
+
+        /// Generates a key with two random primes of Bits/2 bits, see @ref arith::generate_prime
+        /// @param generator uniform random bit generator of 64-bit words
+        /// @param exponent public exponent
+        /// @param options prime search options, their public exponent is replaced
+        /// @return private key
+        template <::std::size_t Bits, typename Generator>
+        rsa_private_key<Bits> generate_rsa_key(Generator& generator,const unsigned long long exponent = 65537,
+                                               arith::prime_options options = arith::prime_options()) {
+            options.public_exponent = exponent;
+            const arith::uint<Bits/2> p = arith::generate_prime<Bits/2>(generator,options);
+            arith::uint<Bits/2> q;
+            do {
+                q = arith::generate_prime<Bits/2>(generator,options);
+            } while (q == p);
+            return rsa_private_key<Bits> {p,q,exponent,generator};
+        }
+
+    }
+}
+
+#endif // CPP11CRYPTO_PRP_RSA_HPP
@@ -0,0 +1,258 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// arith/algorithms/batch_inverse.hpp - Inversion of many values at the
+//                    cost of one, by Montgomery's trick
+
+#ifndef CPP11CRYPTO_ARITH_ALGORITHMS_BATCH_INVERSE_HPP
+#define CPP11CRYPTO_ARITH_ALGORITHMS_BATCH_INVERSE_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "arith/algorithms/safegcd.hpp"
+#include "core/zeroizing.hpp"
+#include "utils/bits.hpp"
+
+namespace cpp11crypto {
+    namespace arith {
+        namespace algorithms {
+
+            /// Arithmetic modulo an odd word-sized modulus, as needed by batch_inverse.
+            /// The product is Montgomery's on one word, a*b*R^-1 with R = 2^64, and
+            /// one() is its identity R: Montgomery's trick yields exact inverses with
+            /// any product scaled by a constant, as the scales of the prefix products
+            /// cancel out. Neither products nor inversion, by safegcd, divide or take
+            /// a time that depends on the values, which is why values must already be
+            /// reduced below the modulus: nothing here reduces them.
+            /// @tparam T unsigned integral type, up to 64 bits
+            template <typename T>
+            class word_field {
+                static_assert(::std::is_unsigned<T>::value && sizeof(T) <= 8,"Word fields are up to 64 bits");
+            public:
+                /// Element type
+                typedef T value_type;
+
+                /// Constructor
+                /// @param modulus odd modulus, greater than one
+                /// @throw std::invalid_argument if modulus is even or one
+                explicit word_field(const T modulus)
+                    : modulus {checked(modulus)}, n_prime {inverse_negated(modulus)},
+                      r_mod_n {static_cast<T>((0-static_cast<::std::uint64_t>(modulus)) % modulus)} {}
+
+                /// @return identity of the product, R modulo the modulus
+                T one() const noexcept {
+                    return r_mod_n;
+                }
+                /// Montgomery product, of values below the modulus, checked in debug
+                /// builds; a larger one can leave the sum above twice the modulus,
+                /// beyond the single final subtraction
+                /// @return a*b*R^-1 modulo the modulus
+                T multiply(const T a,const T b) const noexcept {
+                    assert(a < modulus && b < modulus);
+                    const utils::uint128_t t = static_cast<utils::uint128_t>(a)*b;
+                    const ::std::uint64_t low = static_cast<::std::uint64_t>(t);
+                    const utils::uint128_t m = static_cast<utils::uint128_t>(low*n_prime)*modulus;
+                    // low+m cancels the low word, carrying unless both are zero
+                    const utils::uint128_t sum = (t >> 64)+(m >> 64)+(0 != low);
+                    // below 2*modulus: subtract it unless that borrows
+                    const utils::uint128_t reduced = sum-modulus;
+                    const ::std::uint64_t borrow = 0-static_cast<::std::uint64_t>(reduced >> 127);
+                    return static_cast<T>((static_cast<::std::uint64_t>(sum) & borrow) | (static_cast<::std::uint64_t>(reduced) & ~borrow));
+                }
+                /// Modular inverse
+                /// @return a^-1 modulo the modulus, 0 if not invertible
+                T invert(const T a) const noexcept {
+                    return safegcd::inverse(a,modulus);
+                }
+
+            private:
+                /// Modulus, once known to be valid
+                static T checked(const T modulus) {
+                    if (0 == (modulus & 1) || 1 == modulus) {
+                        throw ::std::invalid_argument("Montgomery modulus must be odd and greater than one");
+                    }
+                    return modulus;
+                }
+
+                /// -n^-1 modulo 2^64 by Hensel lifting, as montgomery_context does
+                static ::std::uint64_t inverse_negated(const ::std::uint64_t n) noexcept {
+                    ::std::uint64_t inverse = n;
+                    for (int i = 0; i != 5; ++i) {
+                        inverse *= 2-n*inverse;
+                    }
+                    return 0-inverse;
+                }
+
+                T modulus;
+                ::std::uint64_t n_prime;
+                T r_mod_n;
+            };
+
+            namespace details {
+                /// Reports a batch holding an element without inverse
+                /// @param invertible result of the inversions
+                /// @throw std::invalid_argument if not invertible
+                inline void check(const bool invertible) {
+                    if (!invertible) {
+                        throw ::std::invalid_argument("Batch inversion of an element without inverse");
+                    }
+                }
+
+                /// Selection by mask rather than by branch, on words
+                template <typename T>
+                typename ::std::enable_if<::std::is_unsigned<T>::value,T>::type
+                select(const bool condition,const T if_true,const T if_false) noexcept {
+                    const T mask = static_cast<T>(0-static_cast<T>(condition));
+                    return static_cast<T>((if_true & mask) | (if_false & static_cast<T>(~mask)));
+                }
+                /// Selection by mask, on the field's own values
+                template <typename T>
+                typename ::std::enable_if<!::std::is_unsigned<T>::value,T>::type
+                select(const bool condition,const T& if_true,const T& if_false) noexcept {
+                    return conditional_select(condition,if_true,if_false);
+                }
+
+                /// Montgomery's trick on one range: prefix products, one inversion, then
+                /// a backward pass. Zeros take part as ones and come out as zeros, by
+                /// masks, so that the work does not depend on where they are.
+                /// @param first first element
+                /// @param n number of elements
+                /// @param out first output, may be first itself
+                /// @param field arithmetic
+                /// @param prefix scratch space for n products
+                /// @return false, with nothing written, if the product of the nonzero
+                ///         elements has no inverse: one of them has none
+                template <typename InputIt, typename OutputIt, typename Field, typename Scratch>
+                bool batch_inverse_range(const InputIt first,const ::std::size_t n,const OutputIt out,
+                                         const Field& field,Scratch& prefix) {
+                    typedef typename Field::value_type value_type;
+                    if (0 == n) {
+                        return true;
+                    }
+                    const value_type zero {};
+                    value_type running = field.one();
+                    for (::std::size_t i = 0; i != n; ++i) {
+                        const value_type x = first[i];
+                        running = field.multiply(running,select(x == zero,field.one(),x));
+                        prefix[i] = running;
+                    }
+                    value_type inverse = field.invert(running);
+                    if (inverse == zero) {
+                        return false;
+                    }
+                    for (::std::size_t i = n-1; i != 0; --i) {
+                        // read before writing, out may alias first
+                        const value_type x = first[i];
+                        const bool skipped = x == zero;
+                        const value_type y = field.multiply(inverse,prefix[i-1]);
+                        inverse = field.multiply(inverse,select(skipped,field.one(),x));
+                        out[i] = select(skipped,zero,y);
+                    }
+                    out[0] = select(first[0] == zero,zero,inverse);
+                    return true;
+                }
+            }
+
+            /// Inverts every element of a range with a single inversion and about 3(n-1)
+            /// multiplications per thread. Zeros are left as zero. Intermediate products
+            /// are kept in zeroizing storage.
+            /// @param first first element, random access; elements must be reduced below
+            ///              the modulus, as the field's products expect, or a multiple of
+            ///              it would not be taken for zero
+            /// @param last past the last element
+            /// @param out first output, random access, may be first for in place inversion
+            /// @param field arithmetic: value_type, one(), multiply(a,b), invert(a), and a
+            ///              conditional_select(condition,a,b) found by ADL unless values are words
+            /// @param threads number of threads, each one inverting a contiguous part with its
+            ///                own inversion; only worth it for tens of thousands of elements
+            /// @throw std::invalid_argument if a nonzero element has no inverse, which only
+            ///        happens with composite moduli; the output is then unspecified
+            template <typename InputIt, typename OutputIt, typename Field,
+                      typename = decltype(::std::declval<const Field&>().one())>
+            void batch_inverse(const InputIt first,const InputIt last,const OutputIt out,
+                               const Field& field,unsigned threads = 1) {
+                typedef typename Field::value_type value_type;
+                const ::std::size_t n = static_cast<::std::size_t>(::std::distance(first,last));
+                threads = static_cast<unsigned>(::std::max<::std::size_t>(1,::std::min<::std::size_t>(threads,n)));
+                // allocated up front, so that worker threads cannot throw
+                ::std::vector<value_type,core::allocator<value_type>> prefix(n);
+                if (1 == threads) {
+                    details::check(details::batch_inverse_range(first,n,out,field,prefix));
+                    return;
+                }
+
+                const ::std::size_t chunk = (n+threads-1)/threads;
+                ::std::vector<::std::thread> workers;
+                workers.reserve(threads-1);
+                ::std::vector<char> invertible(threads,1);
+                try {
+                    for (unsigned t = 1; t != threads; ++t) {
+                        const ::std::size_t begin = ::std::min(n,t*chunk);
+                        const ::std::size_t count = ::std::min(n,begin+chunk)-begin;
+                        workers.emplace_back([=,&field,&prefix,&invertible]() {
+                            value_type * const scratch = prefix.data()+begin;
+                            invertible[t] = details::batch_inverse_range(first+begin,count,out+begin,field,scratch);
+                        });
+                    }
+                    value_type * const scratch = prefix.data();
+                    invertible[0] = details::batch_inverse_range(first,::std::min(n,chunk),out,field,scratch);
+                } catch (...) {
+                    // threads already started must finish before prefix goes away
+                    for (auto& worker : workers) {
+                        worker.join();
+                    }
+                    throw;
+                }
+                for (auto& worker : workers) {
+                    worker.join();
+                }
+                details::check(::std::all_of(invertible.begin(),invertible.end(),[](const char ok) {
+                    return 0 != ok;
+                }));
+            }
+
+            /// Inverts every element of a range modulo a word-sized odd modulus,
+            /// see @ref batch_inverse(InputIt,InputIt,OutputIt,const Field&,unsigned)
+            /// @param first first element, random access; elements below the modulus
+            /// @param last past the last element
+            /// @param modulus odd modulus
+            /// @param out first output, may be first for in place inversion
+            /// @param threads number of threads
+            /// @throw std::invalid_argument if the modulus is even or one, or if a nonzero
+            ///        element shares a factor with the modulus
+            template <typename InputIt, typename OutputIt, typename T,
+                      typename = typename ::std::enable_if<::std::is_unsigned<T>::value>::type>
+            void batch_inverse(const InputIt first,const InputIt last,const T modulus,const OutputIt out,
+                               const unsigned threads = 1) {
+                batch_inverse(first,last,out,word_field<T>(modulus),threads);
+            }
+
+        }
+    }
+}
+
+#endif // CPP11CRYPTO_ARITH_ALGORITHMS_BATCH_INVERSE_HPP
@@ -17,18 +17,29 @@
    along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
 **/
 
-// arith/algorithms/euclid.hpp - Normal and extended Euclid algorithms
+// arith/algorithms/euclid.hpp - Normal and extended Euclid algorithms, with
+//                    binary (Stein) and Lehmer variants selected by tag
 
 #ifndef CPP11CRYPTO_ARITH_ALGORITHMS_EUCLID_HPP
 #define CPP11CRYPTO_ARITH_ALGORITHMS_EUCLID_HPP
 
+#include <limits>
 #include <tuple>
+#include <utility>
+#include "utils/bits.hpp"
 
 namespace cpp11crypto {
     namespace arith {
         namespace algorithms {
             namespace euclid {
 
+                /// Selects the classic algorithm, one division per step
+                struct recursive_tag {};
+                /// Selects Stein's algorithm, shifts and subtractions only
+                struct binary_tag {};
+                /// Selects Lehmer's algorithm, which does most steps on leading words
+                struct lehmer_tag {};
+
                 template <typename T>
                 constexpr T gcd(T a, T b) {
                     return b==T {} ? a : gcd(b, a%b);
@@ -45,6 +56,204 @@ namespace cpp11crypto {
                     return std::tuple<T,T>(std::get<1>(previous),std::get<0>(previous)-q*std::get<1>(previous));
                 }
 
+                /// Greatest common divisor, classic algorithm
+                /// @param a first operand
+                /// @param b second operand
+                /// @return gcd(a,b)
+                template <typename T>
+                constexpr T gcd(T a, T b, recursive_tag) {
+                    return gcd(a,b);
+                }
+
+                /// Extended Euclid, classic algorithm
+                /// @param a first operand
+                /// @param b second operand
+                /// @return (x,y) such that a*x+b*y == gcd(a,b)
+                template <typename T>
+                std::tuple<T,T> extended_gcd(T a, T b, recursive_tag) {
+                    return extended_gcd(a,b);
+                }
+
+                namespace details {
+                    using utils::trailing_zeros;
+
+                    /// Drops the trailing zero bits of a value
+                    /// @param x value, not zero
+                    /// @return x divided by its greatest power of two divisor
+                    template <typename T>
+                    constexpr T odd_part(T x) {
+                        return x >> trailing_zeros(x);
+                    }
+
+                    template <typename T>
+                    constexpr T binary_gcd_step(T u, T v);
+
+                    /// One step of Stein's algorithm, keeps the smaller operand and their difference
+                    /// @param u odd operand
+                    /// @param v odd operand
+                    /// @return gcd(u,v)
+                    template <typename T>
+                    constexpr T binary_gcd_odd(T u, T v) {
+                        return binary_gcd_step(u < v ? u : v, T((u < v ? v : u) - (u < v ? u : v)));
+                    }
+
+                    /// Stein's algorithm once the common powers of two are gone. Every call is
+                    /// a tail call and every choice a conditional move, so optimized builds run
+                    /// it as a branch free loop.
+                    /// @param u odd operand
+                    /// @param v any operand
+                    /// @return gcd(u,v)
+                    template <typename T>
+                    constexpr T binary_gcd_step(T u, T v) {
+                        return v == T {} ? u : binary_gcd_odd(u, odd_part(v));
+                    }
+
+                    /// Common power of two divisor of two values
+                    /// @param a first operand, not zero
+                    /// @param b second operand, not zero
+                    /// @return exponent of the greatest power of two dividing both
+                    template <typename T>
+                    constexpr unsigned common_twos(T a, T b) {
+                        return trailing_zeros(T(a|b));
+                    }
+
+                    /// Converts a signed word to T with two's complement wraparound,
+                    /// the arithmetic extended_gcd uses for coefficients
+                    /// @param v value to convert
+                    /// @return v modulo the range of T
+                    template <typename T>
+                    T from_signed(const long long v) {
+                        return v < 0 ? T {} - static_cast<T>(static_cast<unsigned long long>(-v))
+                               : static_cast<T>(static_cast<unsigned long long>(v));
+                    }
+                }
+
+                /// Greatest common divisor, Stein's binary algorithm. Works on
+                /// non-negative operands, without divisions.
+                /// @param a first operand
+                /// @param b second operand
+                /// @return gcd(a,b)
+                template <typename T>
+                constexpr T gcd(T a, T b, binary_tag) {
+                    return a == T {} ? b
+                           : b == T {} ? a
+                           : T(details::binary_gcd_step(details::odd_part(a),b)
+                               << details::common_twos(a,b));
+                }
+
+                namespace details {
+                    /// Lehmer's algorithm, see @ref extended_gcd(T,T,lehmer_tag)
+                    /// @param a first operand, non-negative
+                    /// @param b second operand, non-negative
+                    /// @return (gcd(a,b),x,y) such that a*x+b*y == gcd(a,b)
+                    template <typename T>
+                    std::tuple<T,T,T> lehmer(T a, T b) {
+                        using utils::bit_length;
+                        // leading digits small enough for their cofactor sums to fit a long long
+                        constexpr unsigned digit_bits = 62;
+
+                        T x0 = T {}+1, y0 = T {};
+                        T x1 = T {}, y1 = T {}+1;
+                        if (a < b) {
+                            // the first quotient is zero, leading digits are taken from the larger operand
+                            std::swap(a,b);
+                            std::swap(x0,x1);
+                            std::swap(y0,y1);
+                        }
+                        // words gain nothing from leading digits, and signed overflow is undefined:
+                        // both only take the word sized path
+                        constexpr bool multi_word = sizeof(T) > sizeof(unsigned long long)
+                                                    && !std::numeric_limits<T>::is_signed;
+                        while (multi_word && b != T {} && bit_length(a) > digit_bits) {
+                            const unsigned shift = bit_length(a) - digit_bits;
+                            long long ah = static_cast<long long>(static_cast<unsigned long long>(a >> shift));
+                            long long bh = static_cast<long long>(static_cast<unsigned long long>(b >> shift));
+                            long long A = 1, B = 0, C = 0, D = 1;
+                            // Collins' condition: stop when the leading digits cannot tell the quotient
+                            while (bh+C != 0 && bh+D != 0) {
+                                const long long q = (ah+A)/(bh+C);
+                                if (q != (ah+B)/(bh+D)) {
+                                    break;
+                                }
+                                long long t = A-q*C;
+                                A = C;
+                                C = t;
+                                t = B-q*D;
+                                B = D;
+                                D = t;
+                                t = ah-q*bh;
+                                ah = bh;
+                                bh = t;
+                            }
+                            if (B == 0) {
+                                // no quotient known, one full precision step
+                                const T q = a/b;
+                                T t = a%b;
+                                a = b;
+                                b = t;
+                                t = x0-q*x1;
+                                x0 = x1;
+                                x1 = t;
+                                t = y0-q*y1;
+                                y0 = y1;
+                                y1 = t;
+                            } else {
+                                // the batch of steps as one 2x2 matrix, exact modulo the range of T
+                                const T tA = from_signed<T>(A), tB = from_signed<T>(B);
+                                const T tC = from_signed<T>(C), tD = from_signed<T>(D);
+                                T t = tA*a+tB*b;
+                                b = tC*a+tD*b;
+                                a = t;
+                                t = tA*x0+tB*x1;
+                                x1 = tC*x0+tD*x1;
+                                x0 = t;
+                                t = tA*y0+tB*y1;
+                                y1 = tC*y0+tD*y1;
+                                y0 = t;
+                            }
+                        }
+                        // word sized tail, single precision quotients
+                        while (b != T {}) {
+                            const bool word = multi_word && bit_length(a) <= 64;
+                            const T q = word ? T(static_cast<unsigned long long>(a)/static_cast<unsigned long long>(b)) : a/b;
+                            T t = word ? T(static_cast<unsigned long long>(a)%static_cast<unsigned long long>(b)) : a%b;
+                            a = b;
+                            b = t;
+                            t = x0-q*x1;
+                            x0 = x1;
+                            x1 = t;
+                            t = y0-q*y1;
+                            y0 = y1;
+                            y1 = t;
+                        }
+                        return std::tuple<T,T,T>(a,x0,y0);
+                    }
+                }
+
+                /// Extended Euclid, Lehmer's algorithm. While the operands are wider than
+                /// a word, the quotient sequence is computed on their leading 62 bits and
+                /// applied to the full operands once per batch of steps. Unsigned
+                /// coefficients are computed modulo the range of T, as in the classic
+                /// algorithm. Multi-word types need shifts, bit_length found by lookup,
+                /// and conversions from and to unsigned long long.
+                /// @param a first operand, non-negative
+                /// @param b second operand, non-negative
+                /// @return (x,y) such that a*x+b*y == gcd(a,b)
+                template <typename T>
+                std::tuple<T,T> extended_gcd(T a, T b, lehmer_tag) {
+                    const std::tuple<T,T,T> result = details::lehmer(a,b);
+                    return std::tuple<T,T>(std::get<1>(result),std::get<2>(result));
+                }
+
+                /// Greatest common divisor, Lehmer's algorithm
+                /// @param a first operand, non-negative
+                /// @param b second operand, non-negative
+                /// @return gcd(a,b)
+                template <typename T>
+                T gcd(T a, T b, lehmer_tag) {
+                    return std::get<0>(details::lehmer(a,b));
+                }
+
             }
         }
     }
@@ -0,0 +1,417 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// arith/algorithms/multiplication.hpp - Schoolbook, Karatsuba and Toom-3
+//                    multiplication of limb arrays, chosen by operand length
+
+#ifndef CPP11CRYPTO_ARITH_ALGORITHMS_MULTIPLICATION_HPP
+#define CPP11CRYPTO_ARITH_ALGORITHMS_MULTIPLICATION_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include "arith/uint.hpp"
+#include "core/bump_arena.hpp"
+
+namespace cpp11crypto {
+    namespace arith {
+        namespace algorithms {
+            namespace multiplication {
+
+                /// Limb type
+                typedef arith::details::limb limb;
+                /// Scratch space of all algorithms
+                typedef core::bump_arena<limb> arena;
+
+                /// Operand lengths, in limbs, from which each algorithm takes over.
+                /// The defaults are the crossovers found by
+                /// benchmarks/arith/algorithms/multiplication on an x86-64 with mulx,
+                /// 22 and 130 limbs. They move with the processor, by a few limbs for
+                /// Karatsuba and several tens for Toom-3, for products within a few
+                /// percent of each other; run the benchmark to tune them for a machine.
+                struct thresholds {
+                    /// Constructor
+                    /// @param karatsuba shortest operands split in two
+                    /// @param toom3 shortest operands split in three
+                    explicit thresholds(const ::std::size_t karatsuba = 22,const ::std::size_t toom3 = 130) noexcept
+                        : karatsuba {karatsuba}, toom3 {toom3} {}
+                    /// Shortest operands split in two
+                    ::std::size_t karatsuba;
+                    /// Shortest operands split in three
+                    ::std::size_t toom3;
+                };
+
+                namespace details {
+                    using arith::details::add_carry;
+                    using arith::details::sub_borrow;
+                    using arith::details::multiply_add;
+
+                    /// Algorithm for balanced operands of n limbs
+                    enum class algorithm {schoolbook, karatsuba, toom3};
+
+                    /// Recursion needs shorter parts: Karatsuba halves from 2 limbs,
+                    /// Toom-3 parts of n/3+1 limbs from 5
+                    inline algorithm choose(const ::std::size_t n,const thresholds& limits) noexcept {
+                        return n >= limits.toom3 && n >= 5 ? algorithm::toom3
+                               : n >= limits.karatsuba && n >= 2 ? algorithm::karatsuba
+                               : algorithm::schoolbook;
+                    }
+
+                    /// r = a+b, n limbs
+                    /// @return carry
+                    inline limb add_n(limb * const r,const limb * const a,const limb * const b,const ::std::size_t n) noexcept {
+                        unsigned char carry = 0;
+                        for (::std::size_t i = 0; i != n; ++i) {
+                            carry = add_carry(carry,a[i],b[i],r[i]);
+                        }
+                        return carry;
+                    }
+
+                    /// r = a-b, n limbs
+                    /// @return borrow
+                    inline limb sub_n(limb * const r,const limb * const a,const limb * const b,const ::std::size_t n) noexcept {
+                        unsigned char borrow = 0;
+                        for (::std::size_t i = 0; i != n; ++i) {
+                            borrow = sub_borrow(borrow,a[i],b[i],r[i]);
+                        }
+                        return borrow;
+                    }
+
+                    /// r[0..n) += a[0..m), m <= n
+                    /// @return carry out of r
+                    inline limb add_to(limb * const r,const ::std::size_t n,const limb * const a,const ::std::size_t m) noexcept {
+                        limb carry = add_n(r,r,a,m);
+                        for (::std::size_t i = m; i != n && 0 != carry; ++i) {
+                            carry = add_carry(0,r[i],carry,r[i]);
+                        }
+                        return carry;
+                    }
+
+                    /// r[0..n) -= a[0..m), m <= n
+                    /// @return borrow out of r
+                    inline limb sub_from(limb * const r,const ::std::size_t n,const limb * const a,const ::std::size_t m) noexcept {
+                        limb borrow = sub_n(r,r,a,m);
+                        for (::std::size_t i = m; i != n && 0 != borrow; ++i) {
+                            borrow = sub_borrow(0,r[i],borrow,r[i]);
+                        }
+                        return borrow;
+                    }
+
+                    /// Two's complement negation in place, n limbs
+                    inline void negate(limb * const r,const ::std::size_t n) noexcept {
+                        unsigned char borrow = 0;
+                        for (::std::size_t i = 0; i != n; ++i) {
+                            borrow = sub_borrow(borrow,0,r[i],r[i]);
+                        }
+                    }
+
+                    /// Copy of a[0..m) into r[0..n), padded with zeros
+                    inline void copy_padded(limb * const r,const ::std::size_t n,const limb * const a,const ::std::size_t m) noexcept {
+                        ::std::copy(a,a+m,r);
+                        ::std::fill(r+m,r+n,limb {0});
+                    }
+
+                    /// r[0..m) = |a[0..m)-b[0..h)|, h <= m
+                    /// @return whether a is below b
+                    inline bool abs_diff(limb * const r,const limb * const a,const ::std::size_t m,
+                                         const limb * const b,const ::std::size_t h) noexcept {
+                        bool less = false;
+                        bool high_zero = true;
+                        for (::std::size_t i = h; i != m; ++i) {
+                            high_zero = high_zero && 0 == a[i];
+                        }
+                        if (high_zero) {
+                            for (::std::size_t i = h; i-- != 0;) {
+                                if (a[i] != b[i]) {
+                                    less = a[i] < b[i];
+                                    break;
+                                }
+                            }
+                        }
+                        if (less) {
+                            sub_n(r,b,a,h);
+                            ::std::fill(r+h,r+m,limb {0});
+                        } else {
+                            copy_padded(r,m,a,m);
+                            sub_from(r,m,b,h);
+                        }
+                        return less;
+                    }
+
+                    /// Arithmetic shift right by one bit of a two's complement value, n limbs
+                    inline void halve(limb * const r,const ::std::size_t n) noexcept {
+                        for (::std::size_t i = 0; i+1 != n; ++i) {
+                            r[i] = (r[i] >> 1) | (r[i+1] << 63);
+                        }
+                        r[n-1] = static_cast<limb>(static_cast<long long>(r[n-1]) >> 1);
+                    }
+
+                    /// Exact division by 3 of a two's complement value, n limbs, by the inverse
+                    /// of 3 modulo 2^64 limb by limb (Jebelean)
+                    inline void divide_by_3(limb * const r,const ::std::size_t n) noexcept {
+                        constexpr limb inverse_3 = 0xaaaaaaaaaaaaaaabULL;
+                        limb borrow = 0;
+                        for (::std::size_t i = 0; i != n; ++i) {
+                            limb s;
+                            const limb b1 = sub_borrow(0,r[i],borrow,s);
+                            const limb q = s*inverse_3;
+                            r[i] = q;
+                            limb high;
+                            arith::details::multiply_wide(q,3,high);
+                            borrow = high+b1;
+                        }
+                    }
+
+                    /// Schoolbook product, r[0..na+nb) = a*b, r apart from a and b
+                    inline void schoolbook(limb * const r,const limb * const a,const ::std::size_t na,
+                                           const limb * const b,const ::std::size_t nb) noexcept {
+                        limb carry = 0;
+                        for (::std::size_t j = 0; j != na; ++j) {
+                            r[j] = multiply_add(a[j],b[0],0,carry);
+                        }
+                        r[na] = carry;
+                        for (::std::size_t i = 1; i != nb; ++i) {
+                            carry = 0;
+                            for (::std::size_t j = 0; j != na; ++j) {
+                                r[i+j] = multiply_add(a[j],b[i],r[i+j],carry);
+                            }
+                            r[i+na] = carry;
+                        }
+                    }
+
+                    inline void balanced(limb * r,const limb * a,const limb * b,::std::size_t n,arena& scratch,const thresholds& limits);
+
+                    /// Karatsuba, by the difference of halves: a0*b1+a1*b0 = a0*b0+a1*b1-(a0-a1)(b0-b1)
+                    inline void karatsuba(limb * const r,const limb * const a,const limb * const b,const ::std::size_t n,
+                                          arena& scratch,const thresholds& limits) {
+                        const ::std::size_t m = (n+1)/2, h = n-m;
+                        const arena::scope frame {scratch};
+                        limb * const da = scratch.allocate(m);
+                        limb * const db = scratch.allocate(m);
+                        limb * const dd = scratch.allocate(2*m);
+                        limb * const middle = scratch.allocate(2*m+1);
+                        const bool negative = abs_diff(da,a,m,a+m,h) != abs_diff(db,b,m,b+m,h);
+                        balanced(dd,da,db,m,scratch,limits);
+                        balanced(r,a,b,m,scratch,limits);
+                        balanced(r+2*m,a+m,b+m,h,scratch,limits);
+
+                        copy_padded(middle,2*m+1,r,2*m);
+                        add_to(middle,2*m+1,r+2*m,2*h);
+                        if (negative) {
+                            add_to(middle,2*m+1,dd,2*m);
+                        } else {
+                            sub_from(middle,2*m+1,dd,2*m);
+                        }
+                        // the middle term is below 2^(64n+1), its top limbs past r are zero
+                        add_to(r+m,2*n-m,middle,::std::min(2*m+1,2*n-m));
+                    }
+
+                    /// Product of two signed parts: magnitudes multiplied, sign applied after
+                    inline void signed_product(limb * const r,limb * const a,limb * const b,const ::std::size_t e,
+                                               arena& scratch,const thresholds& limits) {
+                        const bool a_negative = 0 != (a[e-1] >> 63), b_negative = 0 != (b[e-1] >> 63);
+                        if (a_negative) {
+                            negate(a,e);
+                        }
+                        if (b_negative) {
+                            negate(b,e);
+                        }
+                        balanced(r,a,b,e,scratch,limits);
+                        if (a_negative != b_negative) {
+                            negate(r,2*e);
+                        }
+                    }
+
+                    /// Values of a0+a1*x+a2*x^2 at 1, -1 and -2, e limbs each, the last two
+                    /// in two's complement
+                    inline void evaluate(limb * const p1,limb * const pm1,limb * const pm2,
+                                         const limb * const a,const ::std::size_t k,const ::std::size_t s,const ::std::size_t e) noexcept {
+                        // a0+a2, kept in pm2 for a while
+                        copy_padded(pm2,e,a,k);
+                        add_to(pm2,e,a+2*k,s);
+                        copy_padded(p1,e,pm2,e);
+                        add_to(p1,e,a+k,k);
+                        copy_padded(pm1,e,pm2,e);
+                        sub_from(pm1,e,a+k,k);
+                        // (pm1+a2)*2-a0
+                        copy_padded(pm2,e,pm1,e);
+                        add_to(pm2,e,a+2*k,s);
+                        add_n(pm2,pm2,pm2,e);
+                        sub_from(pm2,e,a,k);
+                    }
+
+                    /// Toom-3 on points 0, 1, -1, -2 and infinity, Bodrato's interpolation
+                    inline void toom3(limb * const r,const limb * const a,const limb * const b,const ::std::size_t n,
+                                      arena& scratch,const thresholds& limits) {
+                        const ::std::size_t k = (n+2)/3, s = n-2*k, e = k+1, l = 2*e;
+                        const arena::scope frame {scratch};
+                        limb * const ap1 = scratch.allocate(e);
+                        limb * const apm1 = scratch.allocate(e);
+                        limb * const apm2 = scratch.allocate(e);
+                        limb * const bp1 = scratch.allocate(e);
+                        limb * const bpm1 = scratch.allocate(e);
+                        limb * const bpm2 = scratch.allocate(e);
+                        limb * const r0 = scratch.allocate(l);
+                        limb * const r1 = scratch.allocate(l);
+                        limb * const r2 = scratch.allocate(l);
+                        limb * const r3 = scratch.allocate(l);
+                        limb * const r4 = scratch.allocate(l);
+                        evaluate(ap1,apm1,apm2,a,k,s,e);
+                        evaluate(bp1,bpm1,bpm2,b,k,s,e);
+
+                        ::std::fill(r0+2*k,r0+l,limb {0});
+                        balanced(r0,a,b,k,scratch,limits);
+                        balanced(r1,ap1,bp1,e,scratch,limits);
+                        signed_product(r2,apm1,bpm1,e,scratch,limits);
+                        signed_product(r3,apm2,bpm2,e,scratch,limits);
+                        ::std::fill(r4+2*s,r4+l,limb {0});
+                        balanced(r4,a+2*k,b+2*k,s,scratch,limits);
+
+                        // r3 = (r(-2)-r(1))/3
+                        sub_n(r3,r3,r1,l);
+                        divide_by_3(r3,l);
+                        // r1 = (r(1)-r(-1))/2
+                        sub_n(r1,r1,r2,l);
+                        halve(r1,l);
+                        // r2 = r(-1)-r(0)
+                        sub_n(r2,r2,r0,l);
+                        // r3 = (r2-r3)/2+2*r(inf)
+                        sub_n(r3,r2,r3,l);
+                        halve(r3,l);
+                        add_n(r3,r3,r4,l);
+                        add_n(r3,r3,r4,l);
+                        // r2 = r2+r1-r(inf)
+                        add_n(r2,r2,r1,l);
+                        sub_n(r2,r2,r4,l);
+                        // r1 = r1-r3
+                        sub_n(r1,r1,r3,l);
+
+                        // all coefficients are now non-negative, below 3*2^(128k)
+                        ::std::fill(r,r+2*n,limb {0});
+                        const limb * const coefficients[] = {r0,r1,r2,r3,r4};
+                        for (::std::size_t i = 0; i != 5; ++i) {
+                            const ::std::size_t offset = i*k;
+                            add_to(r+offset,2*n-offset,coefficients[i],::std::min(l,2*n-offset));
+                        }
+                    }
+
+                    /// Product of operands of the same length, r apart from a and b
+                    inline void balanced(limb * const r,const limb * const a,const limb * const b,const ::std::size_t n,
+                                         arena& scratch,const thresholds& limits) {
+                        switch (choose(n,limits)) {
+                        case algorithm::toom3:
+                            toom3(r,a,b,n,scratch,limits);
+                            break;
+                        case algorithm::karatsuba:
+                            karatsuba(r,a,b,n,scratch,limits);
+                            break;
+                        default:
+                            schoolbook(r,a,n,b,n);
+                        }
+                    }
+
+                    /// Scratch needed by balanced, exactly as it recurses
+                    inline ::std::size_t balanced_scratch(const ::std::size_t n,const thresholds& limits) noexcept {
+                        switch (choose(n,limits)) {
+                        case algorithm::toom3:
+                            // six evaluations of e = n/3+1 limbs and five products of 2e
+                            return 16*((n+2)/3+1)+balanced_scratch((n+2)/3+1,limits);
+                        case algorithm::karatsuba:
+                            return 6*((n+1)/2)+1+balanced_scratch((n+1)/2,limits);
+                        default:
+                            return 0;
+                        }
+                    }
+
+                    /// Product of operands of any length, na >= nb, by slices of nb limbs
+                    inline void unbalanced(limb * const r,const limb * const a,const ::std::size_t na,
+                                           const limb * const b,const ::std::size_t nb,arena& scratch,const thresholds& limits) {
+                        if (na == nb) {
+                            balanced(r,a,b,nb,scratch,limits);
+                            return;
+                        }
+                        if (choose(nb,limits) == algorithm::schoolbook) {
+                            schoolbook(r,a,na,b,nb);
+                            return;
+                        }
+                        const arena::scope frame {scratch};
+                        limb * const slice = scratch.allocate(2*nb);
+                        ::std::fill(r,r+na+nb,limb {0});
+                        for (::std::size_t offset = 0; offset < na; offset += nb) {
+                            const ::std::size_t length = ::std::min(nb,na-offset);
+                            if (length == nb) {
+                                balanced(slice,a+offset,b,nb,scratch,limits);
+                            } else {
+                                unbalanced(slice,b,nb,a+offset,length,scratch,limits);
+                            }
+                            add_to(r+offset,na+nb-offset,slice,nb+length);
+                        }
+                    }
+
+                    /// Scratch needed by unbalanced, exactly as it recurses
+                    inline ::std::size_t unbalanced_scratch(const ::std::size_t na,const ::std::size_t nb,const thresholds& limits) noexcept {
+                        return na == nb ? balanced_scratch(nb,limits)
+                               : choose(nb,limits) == algorithm::schoolbook ? 0
+                               : 2*nb+::std::max(balanced_scratch(nb,limits),
+                                                 0 == na%nb ? ::std::size_t {0} : unbalanced_scratch(nb,na%nb,limits));
+                    }
+                }
+
+                /// Scratch limbs needed to multiply operands of given lengths
+                /// @param na length of the first operand
+                /// @param nb length of the second operand
+                /// @param limits algorithm thresholds
+                /// @return arena capacity in limbs
+                inline ::std::size_t scratch_size(const ::std::size_t na,const ::std::size_t nb,const thresholds& limits = thresholds()) noexcept {
+                    return na >= nb ? details::unbalanced_scratch(na,nb,limits) : details::unbalanced_scratch(nb,na,limits);
+                }
+
+                /// Full product of limb arrays, least significant limb first. Operands are
+                /// cut in halves (Karatsuba) or thirds (Toom-3) while long enough, and
+                /// multiplied by the schoolbook method below that. All temporaries come from
+                /// the arena, which must hold scratch_size(na,nb,limits) free limbs.
+                /// @param r result, na+nb limbs, apart from a and b
+                /// @param a first operand
+                /// @param na length of the first operand, at least 1
+                /// @param b second operand
+                /// @param nb length of the second operand, at least 1
+                /// @param scratch scratch space
+                /// @param limits algorithm thresholds
+                inline void multiply(limb * const r,const limb * const a,const ::std::size_t na,const limb * const b,const ::std::size_t nb,
+                                     arena& scratch,const thresholds& limits = thresholds()) {
+                    if (na >= nb) {
+                        details::unbalanced(r,a,na,b,nb,scratch,limits);
+                    } else {
+                        details::unbalanced(r,b,nb,a,na,scratch,limits);
+                    }
+                }
+
+                /// Full product of limb arrays, with an arena of its own, see
+                /// @ref multiply(limb*,const limb*,std::size_t,const limb*,std::size_t,arena&,const thresholds&)
+                inline void multiply(limb * const r,const limb * const a,const ::std::size_t na,const limb * const b,const ::std::size_t nb,
+                                     const thresholds& limits = thresholds()) {
+                    arena scratch {scratch_size(na,nb,limits)};
+                    multiply(r,a,na,b,nb,scratch,limits);
+                }
+
+            }
+        }
+    }
+}
+
+#endif // CPP11CRYPTO_ARITH_ALGORITHMS_MULTIPLICATION_HPP
@@ -0,0 +1,346 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// arith/algorithms/safegcd.hpp - Constant time modular inversion by
+//                    Bernstein-Yang divsteps
+
+#ifndef CPP11CRYPTO_ARITH_ALGORITHMS_SAFEGCD_HPP
+#define CPP11CRYPTO_ARITH_ALGORITHMS_SAFEGCD_HPP
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include "core/secure_array.hpp"
+#include "utils/bits.hpp"
+
+#ifndef CPP11CRYPTO_HAS_UINT128
+#error "safegcd needs a 128-bit integer type"
+#endif
+
+namespace cpp11crypto {
+    namespace arith {
+        namespace algorithms {
+            namespace safegcd {
+
+                namespace details {
+                    /// Bits per limb of the signed representation, and divsteps per batch
+                    constexpr unsigned limb_bits = 62;
+                    /// Mask of the bits of a limb
+                    constexpr ::std::int64_t limb_mask = (::std::int64_t {1} << limb_bits) - 1;
+
+                    /// Divsteps that bring g to zero for any inputs of d bits (Bernstein-Yang,
+                    /// theorem 11.2)
+                    /// @param d bits of the modulus
+                    /// @return iteration count
+                    constexpr unsigned iterations(const unsigned d) {
+                        return d < 46 ? (49*d+80)/17 : (49*d+57)/17;
+                    }
+
+                    /// Limbs of 62 bits holding values of 64*N bits plus sign and headroom
+                    /// @param N number of 64-bit words
+                    /// @return limb count
+                    constexpr ::std::size_t signed_limbs(const ::std::size_t N) {
+                        return 64*N/limb_bits+1;
+                    }
+
+                    /// Transition matrix of a batch of divsteps, scaled by 2^62
+                    struct transition {
+                        ::std::int64_t u, v, q, r;
+                    };
+
+                    /// Runs up to 62 divsteps on the low words of f and g, without branches.
+                    /// The matrix starts scaled so that it always ends scaled by 2^62.
+                    /// @param delta divstep state
+                    /// @param f low word of f, odd
+                    /// @param g low word of g
+                    /// @param steps number of divsteps, public
+                    /// @param t receives the transition matrix
+                    /// @return updated delta
+                    inline ::std::int64_t divsteps(::std::int64_t delta,::std::uint64_t f,::std::uint64_t g,
+                                                   const unsigned steps,transition& t) noexcept {
+                        ::std::int64_t u = ::std::int64_t {1} << (limb_bits-steps), v = 0, q = 0, r = u;
+                        for (unsigned i = 0; i != steps; ++i) {
+                            // all ones when delta > 0, then when also g is odd (swap)
+                            ::std::uint64_t c1 = static_cast<::std::uint64_t>((-delta) >> 63);
+                            const ::std::uint64_t c2 = 0-(g & 1);
+                            // g += ±f when g is odd, -f if swapping
+                            g += ((f ^ c1) - c1) & c2;
+                            q += ((u ^ static_cast<::std::int64_t>(c1)) - static_cast<::std::int64_t>(c1))
+                                 & static_cast<::std::int64_t>(c2);
+                            r += ((v ^ static_cast<::std::int64_t>(c1)) - static_cast<::std::int64_t>(c1))
+                                 & static_cast<::std::int64_t>(c2);
+                            c1 &= c2;
+                            const ::std::int64_t swap = static_cast<::std::int64_t>(c1);
+                            delta = ((delta ^ swap) - swap) + 1;
+                            // f takes the former g when swapping
+                            f += g & c1;
+                            u += q & swap;
+                            v += r & swap;
+                            g >>= 1;
+                            u *= 2;
+                            v *= 2;
+                        }
+                        t.u = u;
+                        t.v = v;
+                        t.q = q;
+                        t.r = r;
+                        return delta;
+                    }
+
+                    /// Applies a transition to the full f and g, dividing by 2^62
+                    /// @param f signed limbs of f
+                    /// @param g signed limbs of g
+                    /// @param t transition
+                    template <::std::size_t L>
+                    void update_fg(core::secure_array<::std::int64_t,L>& f,core::secure_array<::std::int64_t,L>& g,
+                                   const transition& t) noexcept {
+                        utils::int128_t cf = utils::int128_t {t.u}*f[0] + utils::int128_t {t.v}*g[0];
+                        utils::int128_t cg = utils::int128_t {t.q}*f[0] + utils::int128_t {t.r}*g[0];
+                        // the low limb is zero by construction
+                        cf >>= limb_bits;
+                        cg >>= limb_bits;
+                        for (::std::size_t i = 1; i != L; ++i) {
+                            cf += utils::int128_t {t.u}*f[i] + utils::int128_t {t.v}*g[i];
+                            cg += utils::int128_t {t.q}*f[i] + utils::int128_t {t.r}*g[i];
+                            f[i-1] = static_cast<::std::int64_t>(cf) & limb_mask;
+                            g[i-1] = static_cast<::std::int64_t>(cg) & limb_mask;
+                            cf >>= limb_bits;
+                            cg >>= limb_bits;
+                        }
+                        f[L-1] = static_cast<::std::int64_t>(cf);
+                        g[L-1] = static_cast<::std::int64_t>(cg);
+                    }
+
+                    /// Applies a transition to d and e, dividing by 2^62 modulo m. Keeps both
+                    /// within (-2m,m).
+                    /// @param d signed limbs of d
+                    /// @param e signed limbs of e
+                    /// @param t transition
+                    /// @param m signed limbs of the modulus
+                    /// @param m_inverse inverse of the modulus modulo 2^62
+                    template <::std::size_t L>
+                    void update_de(core::secure_array<::std::int64_t,L>& d,core::secure_array<::std::int64_t,L>& e,
+                                   const transition& t,const ::std::array<::std::int64_t,L>& m,
+                                   const ::std::uint64_t m_inverse) noexcept {
+                        const ::std::int64_t sd = d[L-1] >> 63;
+                        const ::std::int64_t se = e[L-1] >> 63;
+                        // multiples of m that bring negative d and e back into range
+                        ::std::int64_t md = (t.u & sd) + (t.v & se);
+                        ::std::int64_t me = (t.q & sd) + (t.r & se);
+                        utils::int128_t cd = utils::int128_t {t.u}*d[0] + utils::int128_t {t.v}*e[0];
+                        utils::int128_t ce = utils::int128_t {t.q}*d[0] + utils::int128_t {t.r}*e[0];
+                        // and those that clear the low limb
+                        md -= static_cast<::std::int64_t>((m_inverse*static_cast<::std::uint64_t>(cd)
+                                                           + static_cast<::std::uint64_t>(md))
+                                                          & static_cast<::std::uint64_t>(limb_mask));
+                        me -= static_cast<::std::int64_t>((m_inverse*static_cast<::std::uint64_t>(ce)
+                                                           + static_cast<::std::uint64_t>(me))
+                                                          & static_cast<::std::uint64_t>(limb_mask));
+                        cd += utils::int128_t {m[0]}*md;
+                        ce += utils::int128_t {m[0]}*me;
+                        cd >>= limb_bits;
+                        ce >>= limb_bits;
+                        for (::std::size_t i = 1; i != L; ++i) {
+                            cd += utils::int128_t {t.u}*d[i] + utils::int128_t {t.v}*e[i] + utils::int128_t {m[i]}*md;
+                            ce += utils::int128_t {t.q}*d[i] + utils::int128_t {t.r}*e[i] + utils::int128_t {m[i]}*me;
+                            d[i-1] = static_cast<::std::int64_t>(cd) & limb_mask;
+                            e[i-1] = static_cast<::std::int64_t>(ce) & limb_mask;
+                            cd >>= limb_bits;
+                            ce >>= limb_bits;
+                        }
+                        d[L-1] = static_cast<::std::int64_t>(cd);
+                        e[L-1] = static_cast<::std::int64_t>(ce);
+                    }
+
+                    /// Moves the carries of limbs out of their range into the next limb
+                    /// @param x signed limbs
+                    template <::std::size_t L>
+                    void propagate(core::secure_array<::std::int64_t,L>& x) noexcept {
+                        for (::std::size_t i = 0; i+1 != L; ++i) {
+                            x[i+1] += x[i] >> limb_bits;
+                            x[i] &= limb_mask;
+                        }
+                    }
+
+                    /// Adds m when x is negative
+                    /// @param x signed limbs
+                    /// @param m signed limbs of the modulus
+                    template <::std::size_t L>
+                    void add_if_negative(core::secure_array<::std::int64_t,L>& x,
+                                         const ::std::array<::std::int64_t,L>& m) noexcept {
+                        const ::std::int64_t negative = x[L-1] >> 63;
+                        for (::std::size_t i = 0; i != L; ++i) {
+                            x[i] += m[i] & negative;
+                        }
+                        propagate(x);
+                    }
+
+                    /// Negates x when a mask is all ones
+                    /// @param x signed limbs
+                    /// @param mask all ones or zero
+                    template <::std::size_t L>
+                    void negate_if(core::secure_array<::std::int64_t,L>& x,const ::std::int64_t mask) noexcept {
+                        for (::std::size_t i = 0; i != L; ++i) {
+                            x[i] = (x[i] ^ mask) - mask;
+                        }
+                        propagate(x);
+                    }
+
+                    /// Splits 64-bit words into 62-bit limbs
+                    /// @param words little endian words
+                    /// @param limbs receives the limbs
+                    template <::std::size_t N, typename Limbs>
+                    void to_limbs(const ::std::array<::std::uint64_t,N>& words,Limbs& limbs) noexcept {
+                        for (::std::size_t j = 0; j != signed_limbs(N); ++j) {
+                            const ::std::size_t bit = j*limb_bits, w = bit/64, s = bit%64;
+                            ::std::uint64_t value = w < N ? words[w] >> s : 0;
+                            if (s > 64-limb_bits && w+1 < N) {
+                                value |= words[w+1] << (64-s);
+                            }
+                            limbs[j] = static_cast<::std::int64_t>(value) & limb_mask;
+                        }
+                    }
+
+                    /// Joins non-negative 62-bit limbs into 64-bit words
+                    /// @param limbs normalized limbs
+                    /// @return little endian words
+                    template <::std::size_t N, ::std::size_t L>
+                    ::std::array<::std::uint64_t,N> from_limbs(const core::secure_array<::std::int64_t,L>& limbs) noexcept {
+                        ::std::array<::std::uint64_t,N> words;
+                        utils::uint128_t accumulator = 0;
+                        unsigned bits = 0;
+                        ::std::size_t j = 0;
+                        for (::std::size_t w = 0; w != N; ++w) {
+                            for (; bits < 64 && j != L; ++j, bits += limb_bits) {
+                                accumulator |= static_cast<utils::uint128_t>(limbs[j]) << bits;
+                            }
+                            words[w] = static_cast<::std::uint64_t>(accumulator);
+                            accumulator >>= 64;
+                            bits -= 64;
+                        }
+                        return words;
+                    }
+                }
+
+                /// Constant time inversion modulo a fixed odd modulus of N 64-bit words.
+                /// Runs a fixed number of divsteps, the bound for any input of 64*N bits, in
+                /// batches of up to 62 on the low words, each batch then applied to the full
+                /// numbers as a 2x2 matrix. The running time does not depend on the value
+                /// inverted, and intermediate values are wiped.
+                /// @tparam N number of words, little endian
+                template <::std::size_t N>
+                class inverter {
+                    static constexpr ::std::size_t L = details::signed_limbs(N);
+                public:
+                    /// Words of an operand, least significant first
+                    using value_type = ::std::array<::std::uint64_t,N>;
+
+                    /// Constructor
+                    /// @param modulus odd modulus
+                    explicit inverter(const value_type& modulus) noexcept {
+                        assert(1 == (modulus[0] & 1));
+                        details::to_limbs(modulus,m);
+                        // Newton iteration, each step doubles the correct low bits, from 3
+                        ::std::uint64_t x = modulus[0];
+                        for (int i = 0; i != 5; ++i) {
+                            x *= 2-modulus[0]*x;
+                        }
+                        m_inverse = x & static_cast<::std::uint64_t>(details::limb_mask);
+                    }
+
+                    /// Inverse of a value
+                    /// @param x value, less than the modulus
+                    /// @return x^-1 modulo the modulus, 0 if x is not invertible
+                    value_type operator()(const value_type& x) const noexcept {
+                        core::secure_array<::std::int64_t,L> f, g, d, e;
+                        for (::std::size_t i = 0; i != L; ++i) {
+                            f[i] = m[i];
+                        }
+                        details::to_limbs(x,g);
+                        e[0] = 1;
+                        ::std::int64_t delta = 1;
+                        for (unsigned done = 0; done != details::iterations(64*N);) {
+                            const unsigned steps = ::std::min(details::iterations(64*N)-done,details::limb_bits);
+                            done += steps;
+                            details::transition t;
+                            delta = details::divsteps(delta,static_cast<::std::uint64_t>(f[0]),
+                                                      static_cast<::std::uint64_t>(g[0]),steps,t);
+                            details::update_de(d,e,t,m,m_inverse);
+                            details::update_fg(f,g,t);
+                        }
+
+                        // g is zero and f is +-gcd(x,m); d*x == f modulo m
+                        const ::std::int64_t f_negative = f[L-1] >> 63;
+                        details::add_if_negative(d,m);
+                        details::negate_if(d,f_negative);
+                        details::add_if_negative(d,m);
+                        details::negate_if(f,f_negative);
+
+                        ::std::uint64_t not_one = static_cast<::std::uint64_t>(f[0] ^ 1);
+                        for (::std::size_t i = 1; i != L; ++i) {
+                            not_one |= static_cast<::std::uint64_t>(f[i]);
+                        }
+                        // all ones when f is 1, zero otherwise
+                        const ::std::uint64_t invertible = ((not_one | (0-not_one)) >> 63) - 1;
+                        value_type result = details::from_limbs<N>(d);
+                        for (auto& word : result) {
+                            word &= invertible;
+                        }
+                        return result;
+                    }
+
+                private:
+                    ::std::array<::std::int64_t,L> m;
+                    ::std::uint64_t m_inverse;
+                };
+
+                template <::std::size_t N>
+                constexpr ::std::size_t inverter<N>::L;
+
+                /// Constant time inverse modulo a multi-word odd modulus
+                /// @param x value, less than the modulus
+                /// @param modulus odd modulus
+                /// @return x^-1 modulo the modulus, 0 if x is not invertible
+                template <::std::size_t N>
+                ::std::array<::std::uint64_t,N> inverse(const ::std::array<::std::uint64_t,N>& x,
+                                                        const ::std::array<::std::uint64_t,N>& modulus) noexcept {
+                    return inverter<N>(modulus)(x);
+                }
+
+                /// Constant time inverse modulo a word-sized odd modulus
+                /// @param x value, less than the modulus
+                /// @param modulus odd modulus
+                /// @return x^-1 modulo the modulus, 0 if x is not invertible
+                template <typename T, typename = typename ::std::enable_if<::std::is_unsigned<T>::value
+                                                                           && (sizeof(T) <= 8)>::type>
+                T inverse(const T x,const T modulus) noexcept {
+                    const ::std::array<::std::uint64_t,1> result =
+                        inverter<1>(::std::array<::std::uint64_t,1> {{modulus}})(::std::array<::std::uint64_t,1> {{x}});
+                    return static_cast<T>(result[0]);
+                }
+
+            }
+        }
+    }
+}
+
+#endif // CPP11CRYPTO_ARITH_ALGORITHMS_SAFEGCD_HPP
@@ -0,0 +1,142 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// arith/barrett.hpp - Modular arithmetic without divisions, by Barrett
+//                    reduction with a precomputed reciprocal
+
+#ifndef CPP11CRYPTO_ARITH_BARRETT_HPP
+#define CPP11CRYPTO_ARITH_BARRETT_HPP
+
+#include <cstddef>
+#include <stdexcept>
+#include "arith/uint.hpp"
+
+namespace cpp11crypto {
+    namespace arith {
+
+        /// Precomputed data for modular arithmetic by Barrett reduction. Unlike the
+        /// Montgomery domain, values stay as they are and the modulus may be even.
+        /// Reductions take a time that only depends on Bits and on the bit length of
+        /// the modulus, which is public. Contexts never change after construction, so
+        /// a single one may be shared by any number of threads.
+        /// @tparam Bits width of the modulus
+        template <::std::size_t Bits>
+        class barrett_context {
+        public:
+            /// Type of values and of the modulus
+            typedef uint<Bits> value_type;
+            /// Type of unreduced products
+            typedef uint<2*Bits> product_type;
+
+            /// Constructor, does the only division
+            /// @param modulus modulus, greater than one
+            /// @throw std::invalid_argument if modulus is zero or one
+            explicit barrett_context(const value_type& modulus)
+                : n {modulus}, n_wide {modulus}, length {checked(modulus)}, mu {reciprocal(modulus,length)} {}
+
+            /// @return modulus
+            const value_type& modulus() const noexcept {
+                return n;
+            }
+            /// @return floor(2^(2k)/n), k the bit length of the modulus
+            const uint<Bits+64>& reciprocal() const noexcept {
+                return mu;
+            }
+
+            /// @return one, values need no conversion
+            value_type one() const noexcept {
+                return value_type {1};
+            }
+
+            /// Barrett reduction
+            /// @param x value below n^2, such as the product of two reduced values
+            /// @return x mod n
+            value_type reduce(const product_type& x) const noexcept {
+                typedef uint<Bits+64> wide;
+                // q estimates x/n from below by at most 2
+                const wide q {wide_multiply(wide(x >> (length-1)),mu) >> (length+1)};
+                wide r = wide(x)-q*n_wide;
+                r = conditional_select(r < n_wide,r,r-n_wide);
+                r = conditional_select(r < n_wide,r,r-n_wide);
+                return value_type(r);
+            }
+
+            /// Modular product
+            /// @param a value below the modulus
+            /// @param b value below the modulus
+            /// @return a*b mod n
+            value_type multiply(const value_type& a,const value_type& b) const noexcept {
+                return reduce(wide_multiply(a,b));
+            }
+            /// Modular square
+            /// @param a value below the modulus
+            /// @return a*a mod n
+            value_type square(const value_type& a) const noexcept {
+                return multiply(a,a);
+            }
+            /// Modular sum
+            value_type add(const value_type& a,const value_type& b) const noexcept {
+                return add_mod(a,b,n);
+            }
+            /// Modular difference
+            value_type subtract(const value_type& a,const value_type& b) const noexcept {
+                return subtract_mod(a,b,n);
+            }
+
+            /// Exponentiation by squaring, multiplying at every bit and keeping the
+            /// product by masked selection, so that time does not depend on the exponent
+            /// @param base value below the modulus
+            /// @param exponent exponent, all of its EBits bits are scanned
+            /// @return base^exponent mod n
+            template <::std::size_t EBits>
+            value_type power(const value_type& base,const uint<EBits>& exponent) const noexcept {
+                value_type result = one();
+                for (::std::size_t i = EBits; i-- != 0;) {
+                    result = square(result);
+                    result = conditional_select(exponent.bit(i),multiply(result,base),result);
+                }
+                return result;
+            }
+
+        private:
+            /// Bit length of a valid modulus
+            static unsigned checked(const value_type& modulus) {
+                const unsigned k = bit_length(modulus);
+                if (k < 2) {
+                    throw ::std::invalid_argument("Barrett modulus must be greater than one");
+                }
+                return k;
+            }
+
+            /// floor(2^(2k)/n), at most k+1 bits since n >= 2^(k-1)
+            static uint<Bits+64> reciprocal(const value_type& modulus,const unsigned k) {
+                typedef uint<2*Bits+64> wide;
+                return uint<Bits+64>((wide {1} << (2*k))/wide(modulus));
+            }
+
+            value_type n;
+            uint<Bits+64> n_wide;
+            unsigned length;
+            uint<Bits+64> mu;
+        };
+
+    }
+}
+
+#endif // CPP11CRYPTO_ARITH_BARRETT_HPP
@@ -0,0 +1,111 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// arith/context_cache.hpp - Modular arithmetic contexts shared by modulus,
+//                    so that setup is done once per key
+
+#ifndef CPP11CRYPTO_ARITH_CONTEXT_CACHE_HPP
+#define CPP11CRYPTO_ARITH_CONTEXT_CACHE_HPP
+
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace cpp11crypto {
+    namespace arith {
+
+        /// Bounded, thread safe cache of immutable contexts, keyed by modulus. When
+        /// full, the context inserted first is dropped; users still holding it keep it.
+        /// @tparam Context montgomery_context or barrett_context
+        template <typename Context>
+        class context_cache {
+        public:
+            /// Modulus type
+            typedef typename Context::value_type modulus_type;
+
+            /// Constructor
+            /// @param capacity maximum number of contexts kept
+            explicit context_cache(const ::std::size_t capacity = 64) : capacity {capacity} {}
+
+            context_cache(const context_cache&) = delete;
+            context_cache& operator=(const context_cache&) = delete;
+
+            /// Context for a modulus, built on the first request
+            /// @param modulus modulus
+            /// @return shared context
+            /// @throw whatever the context constructor throws for invalid moduli
+            ::std::shared_ptr<const Context> get(const modulus_type& modulus) {
+                {
+                    ::std::lock_guard<::std::mutex> lock {mutex};
+                    const auto found = contexts.find(modulus);
+                    if (found != contexts.end()) {
+                        return found->second;
+                    }
+                }
+                // built unlocked, setup costs divisions; a concurrent build of the same
+                // modulus is simply discarded
+                ::std::shared_ptr<const Context> built = ::std::make_shared<const Context>(modulus);
+                ::std::lock_guard<::std::mutex> lock {mutex};
+                const auto inserted = contexts.insert(::std::make_pair(modulus,built));
+                if (inserted.second) {
+                    order.push_back(modulus);
+                    if (order.size() > capacity) {
+                        contexts.erase(order.front());
+                        order.pop_front();
+                    }
+                }
+                return inserted.first->second;
+            }
+
+            /// @return number of contexts kept
+            ::std::size_t size() const {
+                ::std::lock_guard<::std::mutex> lock {mutex};
+                return contexts.size();
+            }
+
+            /// Drops all contexts
+            void clear() {
+                ::std::lock_guard<::std::mutex> lock {mutex};
+                contexts.clear();
+                order.clear();
+            }
+
+        private:
+            const ::std::size_t capacity;
+            mutable ::std::mutex mutex;
+            ::std::map<modulus_type,::std::shared_ptr<const Context>> contexts;
+            ::std::deque<modulus_type> order;
+        };
+
+        /// Context for a modulus from a process wide cache
+        /// @tparam Context montgomery_context or barrett_context
+        /// @param modulus modulus
+        /// @return shared context
+        template <typename Context>
+        ::std::shared_ptr<const Context> shared_context(const typename Context::value_type& modulus) {
+            static context_cache<Context> cache;
+            return cache.get(modulus);
+        }
+
+    }
+}
+
+#endif // CPP11CRYPTO_ARITH_CONTEXT_CACHE_HPP
@@ -0,0 +1,150 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// arith/modexp.hpp - Constant time modular exponentiation by fixed windows,
+//                    with tables read in full on every lookup
+
+#ifndef CPP11CRYPTO_ARITH_MODEXP_HPP
+#define CPP11CRYPTO_ARITH_MODEXP_HPP
+
+#include <cstddef>
+#include <vector>
+#include "arith/montgomery.hpp"
+#include "arith/uint.hpp"
+#include "core/zeroizing.hpp"
+
+namespace cpp11crypto {
+    namespace arith {
+
+        /// Widest window considered, a table of 128 values
+        constexpr unsigned max_window = 7;
+        /// Widest window chosen by @ref window_size. Wider ones save a few percent at
+        /// best by the model below, and whether they do at all depends on the
+        /// machine: w=4 beat the w=5 and w=6 the model picked for 2048 and 4096-bit
+        /// exponents on some, lost by 3 to 7% on others. Sixteen entries keep the
+        /// scanned table within 8 KiB up to 4096 bits.
+        constexpr unsigned max_chosen_window = 4;
+
+        namespace details {
+            /// Relative cost of a window size, in units of 1/(420*4N) products: the
+            /// table takes 2^w products, each of the E/w windows one product plus a
+            /// full table scan of 2^w*N limbs, about 2^w/4N products
+            /// @param w window size
+            /// @param exponent_bits exponent length E
+            /// @param limbs modulus length N in limbs
+            constexpr unsigned long long window_cost(const unsigned w,const ::std::size_t exponent_bits,const ::std::size_t limbs) {
+                return (1ULL << w)*4*limbs*420 + exponent_bits*420/w*(4*limbs+(1ULL << w));
+            }
+
+            /// Cheapest window from w up to max_chosen_window
+            constexpr unsigned cheapest_window(const unsigned w,const unsigned best,const ::std::size_t exponent_bits,const ::std::size_t limbs) {
+                return w > max_chosen_window ? best
+                       : cheapest_window(w+1,window_cost(w,exponent_bits,limbs) < window_cost(best,exponent_bits,limbs) ? w : best,
+                                         exponent_bits,limbs);
+            }
+        }
+
+        /// Window size with the fewest products and table reads
+        /// @param exponent_bits exponent length
+        /// @param modulus_bits modulus length
+        /// @return window size, from 1 to max_chosen_window
+        constexpr unsigned window_size(const ::std::size_t exponent_bits,const ::std::size_t modulus_bits) {
+            return details::cheapest_window(1,1,exponent_bits,(modulus_bits+63)/64);
+        }
+
+        /// Exponentiation by fixed windows. The time and the memory access pattern
+        /// depend on the widths and the window size only: every window costs w
+        /// squares and one product, and every table lookup reads the whole table
+        /// and keeps the wanted entry by masking. The table lives in zeroizing
+        /// storage.
+        /// @param context modular arithmetic: value_type, one(), multiply(a,b), square(a)
+        /// @param base value in the domain of the context
+        /// @param exponent exponent, secret
+        /// @param window window size, 0 to choose it from the widths
+        /// @return base^exponent in the domain of the context
+        template <typename Context, ::std::size_t EBits>
+        typename Context::value_type fixed_window_power(const Context& context,const typename Context::value_type& base,
+                const uint<EBits>& exponent,unsigned window = 0) {
+            typedef typename Context::value_type value_type;
+            typedef details::limb limb;
+            constexpr ::std::size_t N = value_type::limb_count;
+            if (0 == window || window > max_window) {
+                window = window_size(EBits,64*N);
+            }
+            const ::std::size_t entries = ::std::size_t {1} << window;
+
+            // base^0... base^(2^w-1), flat so that scans run through memory in order
+            ::std::vector<limb,core::allocator<limb>> table(entries*N);
+            {
+                value_type power = context.one();
+                for (::std::size_t e = 0; e != entries; ++e) {
+                    for (::std::size_t j = 0; j != N; ++j) {
+                        table[e*N+j] = power.limb(j);
+                    }
+                    power = context.multiply(power,base);
+                }
+            }
+
+            const auto lookup = [&](const limb digit) {
+                value_type entry;
+                for (::std::size_t e = 0; e != entries; ++e) {
+                    // all ones when e equals digit, as (e^digit)-1 only borrows from 0
+                    const limb mask = limb {0}-(((e ^ digit)-1) >> 63);
+                    for (::std::size_t j = 0; j != N; ++j) {
+                        entry.limb(j) |= table[e*N+j] & mask;
+                    }
+                }
+                return entry;
+            };
+            const auto digit_at = [&](const ::std::size_t low) {
+                limb digit = 0;
+                for (unsigned b = window; b-- != 0;) {
+                    digit = 2*digit + (low+b < EBits ? static_cast<limb>(exponent.bit(low+b)) : 0);
+                }
+                return digit;
+            };
+
+            // most significant window first, possibly partial
+            ::std::size_t low = (EBits-1)/window*window;
+            value_type result = lookup(digit_at(low));
+            while (0 != low) {
+                low -= window;
+                for (unsigned s = 0; s != window; ++s) {
+                    result = context.square(result);
+                }
+                result = context.multiply(result,lookup(digit_at(low)));
+            }
+            return result;
+        }
+
+        /// Modular exponentiation for private key operations, see
+        /// @ref fixed_window_power
+        /// @param context Montgomery context of the modulus
+        /// @param base base, below the modulus
+        /// @param exponent exponent, secret
+        /// @return base^exponent mod n
+        template <::std::size_t Bits, ::std::size_t EBits>
+        uint<Bits> modexp(const montgomery_context<Bits>& context,const uint<Bits>& base,const uint<EBits>& exponent) {
+            return context.from_montgomery(fixed_window_power(context,context.to_montgomery(base),exponent));
+        }
+
+    }
+}
+
+#endif // CPP11CRYPTO_ARITH_MODEXP_HPP
@@ -0,0 +1,193 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// arith/montgomery.hpp - Modular arithmetic without divisions, in the
+//                    Montgomery domain of an odd modulus
+
+#ifndef CPP11CRYPTO_ARITH_MONTGOMERY_HPP
+#define CPP11CRYPTO_ARITH_MONTGOMERY_HPP
+
+#include <cstddef>
+#include <stdexcept>
+#include "arith/algorithms/safegcd.hpp"
+#include "arith/uint.hpp"
+#include "core/secure_array.hpp"
+
+namespace cpp11crypto {
+    namespace arith {
+
+        /// Precomputed data for modular arithmetic in the Montgomery domain of an odd
+        /// modulus n, with R = 2^Bits. Values are kept as x*R mod n; products need no
+        /// division and take a time that only depends on Bits. Contexts never change
+        /// after construction, so a single one may be shared by any number of threads.
+        /// @tparam Bits width of the modulus
+        template <::std::size_t Bits>
+        class montgomery_context {
+        public:
+            /// Type of values and of the modulus
+            typedef uint<Bits> value_type;
+
+            /// Constructor, does all the divisions once
+            /// @param modulus odd modulus, greater than one
+            /// @throw std::invalid_argument if modulus is even or one
+            explicit montgomery_context(const value_type& modulus)
+                : n {modulus}, n_prime {inverse_negated(modulus.limb(0))},
+                  r_mod_n {checked(modulus)}, r2_mod_n {value_type(wide_multiply(r_mod_n,r_mod_n) % uint<2*Bits>(modulus))} {}
+
+            /// @return modulus
+            const value_type& modulus() const noexcept {
+                return n;
+            }
+            /// @return -n^-1 modulo 2^64
+            typename value_type::limb_type inverse() const noexcept {
+                return n_prime;
+            }
+            /// @return R^2 mod n, which takes values into the domain
+            const value_type& r_squared() const noexcept {
+                return r2_mod_n;
+            }
+            /// @return one in the Montgomery domain, R mod n
+            const value_type& one() const noexcept {
+                return r_mod_n;
+            }
+
+            /// Into the domain
+            /// @param x value below the modulus
+            /// @return x*R mod n
+            value_type to_montgomery(const value_type& x) const noexcept {
+                return multiply(x,r2_mod_n);
+            }
+            /// Out of the domain
+            /// @param x value in the domain
+            /// @return x*R^-1 mod n
+            value_type from_montgomery(const value_type& x) const noexcept {
+                return multiply(x,value_type {1});
+            }
+
+            /// Montgomery product, coarsely integrated operand scanning
+            /// @param a value in the domain
+            /// @param b value in the domain
+            /// @return a*b*R^-1 mod n, the product in the domain
+            value_type multiply(const value_type& a,const value_type& b) const noexcept {
+                constexpr ::std::size_t N = value_type::limb_count;
+                typedef details::limb limb;
+                core::secure_array<limb,N+2> t;
+                for (::std::size_t i = 0; i != N; ++i) {
+                    limb carry = 0;
+                    details::for_each_limb<N>([&](const ::std::size_t j) {
+                        t[j] = details::multiply_add(a.limb(j),b.limb(i),t[j],carry);
+                    });
+                    t[N+1] = details::add_carry(0,t[N],carry,t[N]);
+                    // add the multiple of n that clears the lowest limb, then drop it
+                    const limb k = t[0]*n_prime;
+                    carry = 0;
+                    details::multiply_add(k,n.limb(0),t[0],carry);
+                    details::for_each_limb<N-1>([&](const ::std::size_t j) {
+                        t[j] = details::multiply_add(k,n.limb(j+1),t[j+1],carry);
+                    });
+                    t[N] = t[N+1]+details::add_carry(0,t[N],carry,t[N-1]);
+                }
+                // below 2n: subtract n unless that borrows past the top limb
+                value_type low;
+                details::for_each_limb<N>([&](const ::std::size_t j) {
+                    low.limb(j) = t[j];
+                });
+                return conditional_select((0 == t[N]) & (low < n),low,low-n);
+            }
+            /// Montgomery square
+            /// @param a value in the domain
+            /// @return a*a*R^-1 mod n
+            value_type square(const value_type& a) const noexcept {
+                return multiply(a,a);
+            }
+            /// Modular sum, the same in and out of the domain
+            value_type add(const value_type& a,const value_type& b) const noexcept {
+                return add_mod(a,b,n);
+            }
+            /// Modular difference, the same in and out of the domain
+            value_type subtract(const value_type& a,const value_type& b) const noexcept {
+                return subtract_mod(a,b,n);
+            }
+
+            /// Inverse by safegcd, in a time that only depends on Bits
+            /// @param a value in the domain
+            /// @return a^-1 in the domain, 0 if a is not invertible
+            value_type invert(const value_type& a) const noexcept {
+                constexpr ::std::size_t N = value_type::limb_count;
+                typedef algorithms::safegcd::inverter<N> inverter;
+                typename inverter::value_type words, modulus;
+                for (::std::size_t i = 0; i != N; ++i) {
+                    words[i] = a.limb(i);
+                    modulus[i] = n.limb(i);
+                }
+                words = inverter(modulus)(words);
+                value_type inverse;
+                for (::std::size_t i = 0; i != N; ++i) {
+                    inverse.limb(i) = words[i];
+                }
+                core::do_zeroize(words.data(),sizeof words);
+                // (a*R)^-1 is a^-1*R^-1, two products by R^2 bring it to a^-1*R
+                return multiply(multiply(inverse,r2_mod_n),r2_mod_n);
+            }
+
+            /// Exponentiation by squaring, multiplying at every bit and keeping the
+            /// product by masked selection, so that time does not depend on the exponent
+            /// @param base value in the domain
+            /// @param exponent exponent, all of its EBits bits are scanned
+            /// @return base^exponent in the domain
+            template <::std::size_t EBits>
+            value_type power(const value_type& base,const uint<EBits>& exponent) const noexcept {
+                value_type result = r_mod_n;
+                for (::std::size_t i = EBits; i-- != 0;) {
+                    result = square(result);
+                    result = conditional_select(exponent.bit(i),multiply(result,base),result);
+                }
+                return result;
+            }
+
+        private:
+            /// Hensel lifting of the inverse of the lowest limb, each step doubles the
+            /// correct low bits starting from 3 (n*n == 1 mod 8 for odd n)
+            static typename value_type::limb_type inverse_negated(const typename value_type::limb_type n0) noexcept {
+                typename value_type::limb_type inverse = n0;
+                for (int i = 0; i != 5; ++i) {
+                    inverse *= 2-n0*inverse;
+                }
+                return 0-inverse;
+            }
+
+            /// R mod n, once the modulus is known to be valid
+            static value_type checked(const value_type& modulus) {
+                if (0 == (modulus.limb(0) & 1) || modulus == value_type {1}) {
+                    throw ::std::invalid_argument("Montgomery modulus must be odd and greater than one");
+                }
+                // 2^Bits-n is R-n, congruent to R
+                return (value_type {}-modulus) % modulus;
+            }
+
+            value_type n;
+            typename value_type::limb_type n_prime;
+            value_type r_mod_n;
+            value_type r2_mod_n;
+        };
+
+    }
+}
+
+#endif // CPP11CRYPTO_ARITH_MONTGOMERY_HPP
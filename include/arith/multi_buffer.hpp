@@ -0,0 +1,586 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// arith/multi_buffer.hpp - Independent Montgomery products and exponentiations,
+//                    one per vector lane, in 52-bit (AVX-512 IFMA) or 26-bit (AVX2) radix
+
+#ifndef CPP11CRYPTO_ARITH_MULTI_BUFFER_HPP
+#define CPP11CRYPTO_ARITH_MULTI_BUFFER_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include "arith/modexp.hpp"
+#include "arith/montgomery.hpp"
+#include "arith/uint.hpp"
+#include "core/zeroizing.hpp"
+#include "utils/bits.hpp"
+#include "utils/cpu_features.hpp"
+
+namespace cpp11crypto {
+    namespace arith {
+
+        /// Kernels for independent operations in vector lanes
+        enum class lane_engine {
+            /// One operation after another with @ref montgomery_context
+            scalar,
+            /// Four lanes of 26-bit limbs, 32x32-bit products
+            avx2,
+            /// Eight lanes of 52-bit limbs, 52x52-bit multiply-add
+            avx512ifma
+        };
+
+        /// Tells whether a lane kernel can run on this processor
+        /// @param engine kernel to check
+        /// @return true if usable
+        inline bool is_supported(const lane_engine engine) noexcept {
+            switch (engine) {
+            case lane_engine::scalar:
+                return true;
+            case lane_engine::avx2:
+                return utils::cpu().avx2;
+            case lane_engine::avx512ifma:
+                return utils::cpu().avx512f && utils::cpu().avx512ifma;
+            }
+            return false;
+        }
+
+        /// Widest lane kernel usable on this processor, selected once
+        /// @return selected kernel
+        inline lane_engine best_lane_engine() noexcept {
+            static const lane_engine engine =
+                is_supported(lane_engine::avx512ifma) ? lane_engine::avx512ifma
+                : is_supported(lane_engine::avx2) ? lane_engine::avx2
+                : lane_engine::scalar;
+            return engine;
+        }
+
+        /// Operations done at once by a kernel
+        /// @param engine kernel
+        /// @return number of lanes
+        constexpr ::std::size_t lane_count(const lane_engine engine) noexcept {
+            return lane_engine::avx512ifma == engine ? 8 : lane_engine::avx2 == engine ? 4 : 1;
+        }
+
+        namespace details {
+
+            /// Vector kernels work on values split in limbs of radix bits, lane-interleaved:
+            /// limb j of lane l is at j*lanes+l. Products are almost Montgomery: with
+            /// R' = 2^(radix*m) > 4n, inputs below 2n give outputs below 2n, so that
+            /// there is no final subtraction until values leave the kernel.
+            struct lane_kernel {
+                /// Lanes per vector
+                ::std::size_t lanes;
+                /// Bits per limb
+                unsigned radix;
+                /// r = a*b/R' mod n, almost reduced, lane by lane. r may alias a or b.
+                /// Parameters: r, a, b, n, -n^-1 mod 2^radix, scratch of m vectors, m
+                void (*multiply)(limb *,const limb *,const limb *,const limb *,const limb *,limb *,::std::size_t);
+                /// r = table[digit], lane by lane, reading every entry.
+                /// Parameters: r, table, entries, digits, m
+                void (*select)(limb *,const limb *,::std::size_t,const limb *,::std::size_t);
+            };
+
+#ifdef CPP11CRYPTO_X86_INTRINSICS
+            /// Bits above the 52-bit limb. The zero-masking form keeps GCC 12 from
+            /// warning about the undefined pass-through operand of the plain one.
+            __attribute__((target("avx512f")))
+            inline __m512i carry_avx512ifma(const __m512i u) noexcept {
+                return _mm512_maskz_srli_epi64(static_cast<__mmask8>(0xff),u,52);
+            }
+
+            /// IFMA product. Every limb accumulates up to four 52-bit halves per row
+            /// and lives for at most m+1 rows, so m <= 160 never overflows 64 bits.
+            /// The row reduction is fused with the shift by one limb.
+            __attribute__((target("avx512f,avx512ifma")))
+            inline void multiply_avx512ifma(limb * const r,const limb * const a,const limb * const b,
+                                            const limb * const n,const limb * const n_prime,
+                                            limb * const t,const ::std::size_t m) noexcept {
+                const __m512i zero = _mm512_setzero_si512();
+                const __m512i mask = _mm512_set1_epi64((1LL << 52)-1);
+                const __m512i np = _mm512_loadu_si512(n_prime);
+                for (::std::size_t j = 0; j != m; ++j) {
+                    _mm512_storeu_si512(t+8*j,zero);
+                }
+                for (::std::size_t i = 0; i != m; ++i) {
+                    const __m512i bi = _mm512_loadu_si512(b+8*i);
+                    __m512i a_previous = _mm512_loadu_si512(a);
+                    __m512i n_previous = _mm512_loadu_si512(n);
+                    __m512i u = _mm512_madd52lo_epu64(_mm512_loadu_si512(t),a_previous,bi);
+                    const __m512i k = _mm512_madd52lo_epu64(zero,u,np);
+                    u = _mm512_madd52lo_epu64(u,n_previous,k);
+                    // the low 52 bits are now zero
+                    __m512i carry = carry_avx512ifma(u);
+                    for (::std::size_t j = 1; j != m; ++j) {
+                        const __m512i aj = _mm512_loadu_si512(a+8*j);
+                        const __m512i nj = _mm512_loadu_si512(n+8*j);
+                        u = _mm512_add_epi64(_mm512_loadu_si512(t+8*j),carry);
+                        u = _mm512_madd52hi_epu64(u,a_previous,bi);
+                        u = _mm512_madd52lo_epu64(u,aj,bi);
+                        u = _mm512_madd52hi_epu64(u,n_previous,k);
+                        u = _mm512_madd52lo_epu64(u,nj,k);
+                        _mm512_storeu_si512(t+8*(j-1),u);
+                        a_previous = aj;
+                        n_previous = nj;
+                        carry = zero;
+                    }
+                    u = _mm512_madd52hi_epu64(carry,a_previous,bi);
+                    _mm512_storeu_si512(t+8*(m-1),_mm512_madd52hi_epu64(u,n_previous,k));
+                }
+                __m512i carry = zero;
+                for (::std::size_t j = 0; j != m; ++j) {
+                    const __m512i u = _mm512_add_epi64(_mm512_loadu_si512(t+8*j),carry);
+                    carry = carry_avx512ifma(u);
+                    _mm512_storeu_si512(r+8*j,_mm512_and_si512(u,mask));
+                }
+            }
+
+            /// Masked table scan on eight lanes
+            __attribute__((target("avx512f")))
+            inline void select_avx512(limb * const r,const limb * const table,const ::std::size_t entries,
+                                      const limb * const digits,const ::std::size_t m) noexcept {
+                const __m512i d = _mm512_loadu_si512(digits);
+                for (::std::size_t j = 0; j != m; ++j) {
+                    _mm512_storeu_si512(r+8*j,_mm512_setzero_si512());
+                }
+                for (::std::size_t e = 0; e != entries; ++e) {
+                    const __mmask8 hit = _mm512_cmpeq_epi64_mask(d,_mm512_set1_epi64(static_cast<long long>(e)));
+                    for (::std::size_t j = 0; j != m; ++j) {
+                        _mm512_storeu_si512(r+8*j,_mm512_mask_mov_epi64(_mm512_loadu_si512(r+8*j),hit,
+                                            _mm512_loadu_si512(table+8*(e*m+j))));
+                    }
+                }
+            }
+
+            /// Unaligned load of four limbs
+            __attribute__((target("avx2")))
+            inline __m256i load_avx2(const limb * const p) noexcept {
+                return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+            }
+
+            /// AVX2 product. Limbs of 26 bits make 52-bit products that the 64-bit
+            /// accumulators take whole, two per row, so m <= 320 never overflows.
+            __attribute__((target("avx2")))
+            inline void multiply_avx2(limb * const r,const limb * const a,const limb * const b,
+                                      const limb * const n,const limb * const n_prime,
+                                      limb * const t,const ::std::size_t m) noexcept {
+                typedef __m256i vector;
+                const vector zero = _mm256_setzero_si256();
+                const vector mask = _mm256_set1_epi64x((1LL << 26)-1);
+                const vector np = load_avx2(n_prime);
+                for (::std::size_t j = 0; j != m; ++j) {
+                    _mm256_storeu_si256(reinterpret_cast<vector *>(t+4*j),zero);
+                }
+                for (::std::size_t i = 0; i != m; ++i) {
+                    const vector bi = load_avx2(b+4*i);
+                    vector u = _mm256_add_epi64(load_avx2(t),_mm256_mul_epu32(load_avx2(a),bi));
+                    const vector k = _mm256_and_si256(_mm256_mul_epu32(_mm256_and_si256(u,mask),np),mask);
+                    u = _mm256_add_epi64(u,_mm256_mul_epu32(load_avx2(n),k));
+                    vector carry = _mm256_srli_epi64(u,26);
+                    for (::std::size_t j = 1; j != m; ++j) {
+                        u = _mm256_add_epi64(load_avx2(t+4*j),carry);
+                        u = _mm256_add_epi64(u,_mm256_mul_epu32(load_avx2(a+4*j),bi));
+                        u = _mm256_add_epi64(u,_mm256_mul_epu32(load_avx2(n+4*j),k));
+                        _mm256_storeu_si256(reinterpret_cast<vector *>(t+4*(j-1)),u);
+                        carry = zero;
+                    }
+                    _mm256_storeu_si256(reinterpret_cast<vector *>(t+4*(m-1)),carry);
+                }
+                vector carry = zero;
+                for (::std::size_t j = 0; j != m; ++j) {
+                    const vector u = _mm256_add_epi64(load_avx2(t+4*j),carry);
+                    carry = _mm256_srli_epi64(u,26);
+                    _mm256_storeu_si256(reinterpret_cast<vector *>(r+4*j),_mm256_and_si256(u,mask));
+                }
+            }
+
+            /// Masked table scan on four lanes
+            __attribute__((target("avx2")))
+            inline void select_avx2(limb * const r,const limb * const table,const ::std::size_t entries,
+                                    const limb * const digits,const ::std::size_t m) noexcept {
+                typedef __m256i vector;
+                const vector d = _mm256_loadu_si256(reinterpret_cast<const vector *>(digits));
+                for (::std::size_t j = 0; j != m; ++j) {
+                    _mm256_storeu_si256(reinterpret_cast<vector *>(r+4*j),_mm256_setzero_si256());
+                }
+                for (::std::size_t e = 0; e != entries; ++e) {
+                    const vector hit = _mm256_cmpeq_epi64(d,_mm256_set1_epi64x(static_cast<long long>(e)));
+                    for (::std::size_t j = 0; j != m; ++j) {
+                        vector * const p = reinterpret_cast<vector *>(r+4*j);
+                        const vector entry = _mm256_loadu_si256(reinterpret_cast<const vector *>(table+4*(e*m+j)));
+                        _mm256_storeu_si256(p,_mm256_or_si256(_mm256_loadu_si256(p),_mm256_and_si256(hit,entry)));
+                    }
+                }
+            }
+#endif
+
+            /// Kernel of a vector engine
+            /// @param engine avx2 or avx512ifma, supported
+            /// @return kernel
+            inline lane_kernel lane_kernel_for(const lane_engine engine) noexcept {
+#ifdef CPP11CRYPTO_X86_INTRINSICS
+                if (lane_engine::avx512ifma == engine) {
+                    return lane_kernel {8,52,&multiply_avx512ifma,&select_avx512};
+                }
+                return lane_kernel {4,26,&multiply_avx2,&select_avx2};
+#else
+                return lane_kernel {1,0,nullptr,nullptr};
+#endif
+            }
+
+            /// Values of one batch of lanes in the radix of a kernel, in zeroizing storage.
+            /// Lanes past the last operation repeat the first one.
+            /// @tparam Bits width of the moduli
+            template <::std::size_t Bits>
+            class lane_batch {
+                static_assert(Bits <= 8192,"Lane accumulators would overflow");
+            public:
+                /// Constructor, the only allocation
+                /// @param kernel vector kernel
+                /// @param values number of values besides modulus, R'^2 and scratch
+                lane_batch(const lane_kernel& kernel,const ::std::size_t values)
+                    : kernel(kernel), m {(Bits+2+kernel.radix-1)/kernel.radix},
+                      storage((values+3)*m*kernel.lanes+2*kernel.lanes), loaded(kernel.lanes,nullptr) {}
+
+                /// @return limbs per value
+                ::std::size_t limbs() const noexcept {
+                    return m;
+                }
+                /// Value slot, one vector per limb
+                /// @param i index, below the values given to the constructor
+                /// @return first limb
+                limb * value(const ::std::size_t i) noexcept {
+                    return storage.data()+(i+3)*m*kernel.lanes;
+                }
+                /// @return one lane limb per lane, for digits
+                limb * digits() noexcept {
+                    return storage.data()+storage.size()-kernel.lanes;
+                }
+
+                /// Loads the moduli, R'^2 taken from R^2 by doubling. The doublings are
+                /// done once per context: a lane keeping its context keeps its values,
+                /// and a context repeated within the batch is copied from its first lane.
+                /// @param contexts contexts of the batch
+                /// @param count number of them, from 1 to lanes
+                void load_moduli(const montgomery_context<Bits> * const * const contexts,const ::std::size_t count) {
+                    const limb mask = (limb {1} << kernel.radix)-1;
+                    for (::std::size_t l = 0; l != kernel.lanes; ++l) {
+                        const montgomery_context<Bits> * const context = contexts[l < count ? l : 0];
+                        if (loaded[l] == context) {
+                            continue;
+                        }
+                        loaded[l] = context;
+                        const ::std::size_t same = ::std::find(loaded.begin(),loaded.begin()+l,context)-loaded.begin();
+                        if (same != l) {
+                            for (::std::size_t j = 0; j != m; ++j) {
+                                modulus()[j*kernel.lanes+l] = modulus()[j*kernel.lanes+same];
+                                r_squared_slot()[j*kernel.lanes+l] = r_squared_slot()[j*kernel.lanes+same];
+                            }
+                            n_prime()[l] = n_prime()[same];
+                            continue;
+                        }
+                        uint<Bits> r2 = context->r_squared();
+                        for (::std::size_t i = 0; i != 2*(kernel.radix*m-Bits); ++i) {
+                            r2 = context->add(r2,r2);
+                        }
+                        store(l,modulus(),context->modulus());
+                        store(l,r_squared_slot(),r2);
+                        n_prime()[l] = context->inverse() & mask;
+                    }
+                }
+
+                /// Splits a value into the limbs of a lane
+                /// @param l lane
+                /// @param to value slot
+                /// @param x value
+                void store(const ::std::size_t l,limb * const to,const uint<Bits>& x) const noexcept {
+                    const limb mask = (limb {1} << kernel.radix)-1;
+                    for (::std::size_t j = 0; j != m; ++j) {
+                        const ::std::size_t bit = j*kernel.radix;
+                        const ::std::size_t q = bit/64, s = bit%64;
+                        limb v = q < uint<Bits>::limb_count ? x.limb(q) >> s : 0;
+                        if (s+kernel.radix > 64 && q+1 < uint<Bits>::limb_count) {
+                            v |= x.limb(q+1) << (64-s);
+                        }
+                        to[j*kernel.lanes+l] = v & mask;
+                    }
+                }
+
+                /// Joins the limbs of a lane and reduces them
+                /// @param l lane
+                /// @param from value slot, below 2n
+                /// @return value mod n
+                uint<Bits> load(const ::std::size_t l,const limb * const from) const noexcept {
+                    typedef uint<Bits+64> wide;
+                    wide x, n;
+                    for (::std::size_t j = 0; j != m; ++j) {
+                        const limb v = from[j*kernel.lanes+l];
+                        const limb w = modulus()[j*kernel.lanes+l];
+                        const ::std::size_t bit = j*kernel.radix;
+                        const ::std::size_t q = bit/64, s = bit%64;
+                        x.limb(q) |= v << s;
+                        n.limb(q) |= w << s;
+                        if (s+kernel.radix > 64) {
+                            x.limb(q+1) |= v >> (64-s);
+                            n.limb(q+1) |= w >> (64-s);
+                        }
+                    }
+                    return uint<Bits>(conditional_select(x < n,x,x-n));
+                }
+
+                /// a*b/R' in every lane
+                void multiply(limb * const r,const limb * const a,const limb * const b) noexcept {
+                    kernel.multiply(r,a,b,modulus(),n_prime(),scratch(),m);
+                }
+                /// Entry of a table of the given size in every lane, by digits()
+                void select(limb * const r,const limb * const table,const ::std::size_t entries) noexcept {
+                    kernel.select(r,table,entries,digits(),m);
+                }
+
+                /// @return R'^2 mod n
+                const limb * r_squared() const noexcept {
+                    return storage.data()+m*kernel.lanes;
+                }
+
+            private:
+                limb * modulus() noexcept {
+                    return storage.data();
+                }
+                const limb * modulus() const noexcept {
+                    return storage.data();
+                }
+                limb * r_squared_slot() noexcept {
+                    return storage.data()+m*kernel.lanes;
+                }
+                limb * scratch() noexcept {
+                    return storage.data()+2*m*kernel.lanes;
+                }
+                limb * n_prime() noexcept {
+                    return storage.data()+storage.size()-2*kernel.lanes;
+                }
+
+                const lane_kernel kernel;
+                const ::std::size_t m;
+                ::std::vector<limb,core::allocator<limb>> storage;
+                /// Context whose modulus each lane holds
+                ::std::vector<const montgomery_context<Bits> *> loaded;
+            };
+
+        }
+
+        /// Independent modular products, one per lane of the given kernel
+        /// @param results products, count of them
+        /// @param contexts contexts of the moduli, count of them, repeats allowed
+        /// @param a first factors, below their moduli
+        /// @param b second factors, below their moduli
+        /// @param count number of products
+        /// @param engine kernel to use, the scalar one if not supported
+        template <::std::size_t Bits>
+        void multi_multiply(uint<Bits> * const results,const montgomery_context<Bits> * const * const contexts,
+                            const uint<Bits> * const a,const uint<Bits> * const b,const ::std::size_t count,
+                            const lane_engine engine) {
+            if (lane_engine::scalar == engine || !is_supported(engine)) {
+                for (::std::size_t i = 0; i != count; ++i) {
+                    // a*b/R*R^2/R
+                    results[i] = contexts[i]->multiply(contexts[i]->multiply(a[i],b[i]),contexts[i]->r_squared());
+                }
+                return;
+            }
+            typedef details::limb limb;
+            const details::lane_kernel kernel = details::lane_kernel_for(engine);
+            details::lane_batch<Bits> batch {kernel,2};
+            limb * const x = batch.value(0);
+            limb * const y = batch.value(1);
+            for (::std::size_t first = 0; first < count; first += kernel.lanes) {
+                const ::std::size_t lanes = ::std::min(kernel.lanes,count-first);
+                batch.load_moduli(contexts+first,lanes);
+                for (::std::size_t l = 0; l != kernel.lanes; ++l) {
+                    batch.store(l,x,a[first+(l < lanes ? l : 0)]);
+                    batch.store(l,y,b[first+(l < lanes ? l : 0)]);
+                }
+                // a*b/R'*R'^2/R'
+                batch.multiply(x,x,y);
+                batch.multiply(x,x,batch.r_squared());
+                for (::std::size_t l = 0; l != lanes; ++l) {
+                    results[first+l] = batch.load(l,x);
+                }
+            }
+        }
+
+        /// Independent modular products with the widest kernel available
+        template <::std::size_t Bits>
+        void multi_multiply(uint<Bits> * const results,const montgomery_context<Bits> * const * const contexts,
+                            const uint<Bits> * const a,const uint<Bits> * const b,const ::std::size_t count) {
+            multi_multiply(results,contexts,a,b,count,best_lane_engine());
+        }
+
+        /// Independent modular exponentiations, one per lane of the given kernel, by
+        /// the fixed windows of @ref fixed_window_power: every lane takes the same
+        /// squares and products and reads its whole table, so that neither time nor
+        /// memory access depends on the exponents.
+        /// @param results powers, count of them
+        /// @param contexts contexts of the moduli, count of them, repeats allowed
+        /// @param bases bases, below their moduli
+        /// @param exponents exponents, secret
+        /// @param count number of exponentiations
+        /// @param engine kernel to use, the scalar one if not supported
+        template <::std::size_t Bits, ::std::size_t EBits>
+        void multi_modexp(uint<Bits> * const results,const montgomery_context<Bits> * const * const contexts,
+                          const uint<Bits> * const bases,const uint<EBits> * const exponents,const ::std::size_t count,
+                          const lane_engine engine) {
+            if (lane_engine::scalar == engine || !is_supported(engine)) {
+                for (::std::size_t i = 0; i != count; ++i) {
+                    results[i] = modexp(*contexts[i],bases[i],exponents[i]);
+                }
+                return;
+            }
+            typedef details::limb limb;
+            const unsigned window = window_size(EBits,Bits);
+            const ::std::size_t entries = ::std::size_t {1} << window;
+            const details::lane_kernel kernel = details::lane_kernel_for(engine);
+            // accumulator, entry, one, then the table
+            details::lane_batch<Bits> batch {kernel,3+entries};
+            limb * const result = batch.value(0);
+            limb * const entry = batch.value(1);
+            limb * const one = batch.value(2);
+            const auto table = [&](const ::std::size_t e) {
+                return batch.value(3+e);
+            };
+            const auto digits_at = [&](const ::std::size_t first,const ::std::size_t lanes,const ::std::size_t low) {
+                for (::std::size_t l = 0; l != kernel.lanes; ++l) {
+                    const uint<EBits>& exponent = exponents[first+(l < lanes ? l : 0)];
+                    limb digit = 0;
+                    for (unsigned b = window; b-- != 0;) {
+                        digit = 2*digit + (low+b < EBits ? static_cast<limb>(exponent.bit(low+b)) : 0);
+                    }
+                    batch.digits()[l] = digit;
+                }
+            };
+
+            for (::std::size_t first = 0; first < count; first += kernel.lanes) {
+                const ::std::size_t lanes = ::std::min(kernel.lanes,count-first);
+                batch.load_moduli(contexts+first,lanes);
+                for (::std::size_t l = 0; l != kernel.lanes; ++l) {
+                    batch.store(l,one,uint<Bits> {1});
+                    batch.store(l,entry,bases[first+(l < lanes ? l : 0)]);
+                }
+                // base^0... base^(2^w-1) times R'
+                batch.multiply(table(0),one,batch.r_squared());
+                batch.multiply(entry,entry,batch.r_squared());
+                for (::std::size_t e = 1; e != entries; ++e) {
+                    batch.multiply(table(e),table(e-1),entry);
+                }
+
+                ::std::size_t low = (EBits-1)/window*window;
+                digits_at(first,lanes,low);
+                batch.select(result,table(0),entries);
+                while (0 != low) {
+                    low -= window;
+                    for (unsigned s = 0; s != window; ++s) {
+                        batch.multiply(result,result,result);
+                    }
+                    digits_at(first,lanes,low);
+                    batch.select(entry,table(0),entries);
+                    batch.multiply(result,result,entry);
+                }
+                batch.multiply(result,result,one);
+                for (::std::size_t l = 0; l != lanes; ++l) {
+                    results[first+l] = batch.load(l,result);
+                }
+            }
+        }
+
+        /// Independent modular exponentiations with the widest kernel available
+        template <::std::size_t Bits, ::std::size_t EBits>
+        void multi_modexp(uint<Bits> * const results,const montgomery_context<Bits> * const * const contexts,
+                          const uint<Bits> * const bases,const uint<EBits> * const exponents,const ::std::size_t count) {
+            multi_modexp(results,contexts,bases,exponents,count,best_lane_engine());
+        }
+
+        /// Independent modular exponentiations by one public exponent, one per lane
+        /// of the given kernel, by squaring and multiplying: the time depends on the
+        /// exponent, not on the bases. Meant for signature verification.
+        /// @param results powers, count of them
+        /// @param contexts contexts of the moduli, count of them, repeats allowed
+        /// @param bases bases, below their moduli
+        /// @param exponent exponent shared by all, public
+        /// @param count number of exponentiations
+        /// @param engine kernel to use, the scalar one if not supported
+        template <::std::size_t Bits>
+        void multi_modexp_public(uint<Bits> * const results,const montgomery_context<Bits> * const * const contexts,
+                                 const uint<Bits> * const bases,const unsigned long long exponent,const ::std::size_t count,
+                                 const lane_engine engine) {
+            if (0 == exponent) {
+                ::std::fill(results,results+count,uint<Bits> {1});
+                return;
+            }
+            const unsigned top = utils::bit_length(exponent)-1;
+            if (lane_engine::scalar == engine || !is_supported(engine)) {
+                for (::std::size_t i = 0; i != count; ++i) {
+                    const montgomery_context<Bits>& context = *contexts[i];
+                    const uint<Bits> x = context.to_montgomery(bases[i]);
+                    uint<Bits> power = x;
+                    for (unsigned b = top; b-- != 0;) {
+                        power = context.square(power);
+                        if (0 != ((exponent >> b) & 1)) {
+                            power = context.multiply(power,x);
+                        }
+                    }
+                    results[i] = context.from_montgomery(power);
+                }
+                return;
+            }
+            const details::lane_kernel kernel = details::lane_kernel_for(engine);
+            details::lane_batch<Bits> batch {kernel,3};
+            details::limb * const power = batch.value(0);
+            details::limb * const x = batch.value(1);
+            details::limb * const one = batch.value(2);
+            for (::std::size_t first = 0; first < count; first += kernel.lanes) {
+                const ::std::size_t lanes = ::std::min(kernel.lanes,count-first);
+                batch.load_moduli(contexts+first,lanes);
+                for (::std::size_t l = 0; l != kernel.lanes; ++l) {
+                    batch.store(l,one,uint<Bits> {1});
+                    batch.store(l,x,bases[first+(l < lanes ? l : 0)]);
+                }
+                batch.multiply(x,x,batch.r_squared());
+                ::std::copy(x,x+batch.limbs()*kernel.lanes,power);
+                for (unsigned b = top; b-- != 0;) {
+                    batch.multiply(power,power,power);
+                    if (0 != ((exponent >> b) & 1)) {
+                        batch.multiply(power,power,x);
+                    }
+                }
+                batch.multiply(power,power,one);
+                for (::std::size_t l = 0; l != lanes; ++l) {
+                    results[first+l] = batch.load(l,power);
+                }
+            }
+        }
+
+        /// Independent exponentiations by a public exponent with the widest kernel available
+        template <::std::size_t Bits>
+        void multi_modexp_public(uint<Bits> * const results,const montgomery_context<Bits> * const * const contexts,
+                                 const uint<Bits> * const bases,const unsigned long long exponent,const ::std::size_t count) {
+            multi_modexp_public(results,contexts,bases,exponent,count,best_lane_engine());
+        }
+
+    }
+}
+
+#endif // CPP11CRYPTO_ARITH_MULTI_BUFFER_HPP
@@ -0,0 +1,183 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// arith/natural.hpp - Variable length unsigned integers, in zeroizing
+//                    storage, with subquadratic multiplication
+
+#ifndef CPP11CRYPTO_ARITH_NATURAL_HPP
+#define CPP11CRYPTO_ARITH_NATURAL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+#include "arith/algorithms/multiplication.hpp"
+#include "arith/uint.hpp"
+#include "core/zeroizing.hpp"
+
+namespace cpp11crypto {
+    namespace arith {
+
+        /// Unsigned integer of any length. Limbs live in zeroizing storage, least
+        /// significant first, without leading zero limbs. Lengths, and so times,
+        /// depend on the values: this type is meant for public values or for
+        /// products whose length is known anyway.
+        class natural {
+        public:
+            /// Limb type
+            typedef details::limb limb_type;
+
+            /// Constructor, zero
+            natural() = default;
+
+            /// Constructor from a built-in integer, also implicit conversion
+            /// @param value initial value
+            natural(const unsigned long long value) : limbs(0 == value ? 0 : 1,value) {}
+
+            /// Constructor from limbs
+            /// @param first least significant limb
+            /// @param count number of limbs
+            natural(const limb_type * const first,const ::std::size_t count) : limbs(first,first+count) {
+                normalize();
+            }
+
+            /// Conversion from a fixed width integer
+            /// @param x value
+            template <::std::size_t Bits>
+            explicit natural(const uint<Bits>& x) : natural(x.data(),uint<Bits>::limb_count) {}
+
+            /// Conversion to a fixed width integer, truncating
+            /// @return value modulo 2^Bits
+            template <::std::size_t Bits>
+            explicit operator uint<Bits>() const {
+                uint<Bits> x;
+                for (::std::size_t i = 0; i != ::std::min(size(),uint<Bits>::limb_count); ++i) {
+                    x.limb(i) = limbs[i];
+                }
+                return x;
+            }
+
+            /// @return number of limbs, 0 for 0
+            ::std::size_t size() const noexcept {
+                return limbs.size();
+            }
+            /// Limb access
+            /// @param i index, 0 for the least significant
+            /// @return limb, 0 past the most significant
+            limb_type limb(const ::std::size_t i) const noexcept {
+                return i < size() ? limbs[i] : 0;
+            }
+            /// @return pointer to the least significant limb
+            const limb_type * data() const noexcept {
+                return limbs.data();
+            }
+
+            friend natural operator+(const natural& a,const natural& b) {
+                const natural& longer = a.size() >= b.size() ? a : b;
+                const natural& shorter = a.size() >= b.size() ? b : a;
+                natural sum;
+                sum.limbs.assign(longer.limbs.begin(),longer.limbs.end());
+                sum.limbs.push_back(0);
+                algorithms::multiplication::details::add_to(sum.limbs.data(),sum.size(),shorter.data(),shorter.size());
+                sum.normalize();
+                return sum;
+            }
+            /// Difference
+            /// @throw std::domain_error if b is greater than a
+            friend natural operator-(const natural& a,const natural& b) {
+                if (a < b) {
+                    throw ::std::domain_error("natural subtraction below zero");
+                }
+                natural difference {a};
+                algorithms::multiplication::details::sub_from(difference.limbs.data(),difference.size(),b.data(),b.size());
+                difference.normalize();
+                return difference;
+            }
+            /// Product, Karatsuba or Toom-3 for long operands
+            friend natural operator*(const natural& a,const natural& b) {
+                return multiply(a,b,algorithms::multiplication::thresholds());
+            }
+            /// Product with given algorithm thresholds
+            /// @param a first factor
+            /// @param b second factor
+            /// @param limits algorithm thresholds
+            /// @return a*b
+            friend natural multiply(const natural& a,const natural& b,const algorithms::multiplication::thresholds& limits) {
+                natural product;
+                if (0 != a.size() && 0 != b.size()) {
+                    product.limbs.resize(a.size()+b.size());
+                    algorithms::multiplication::multiply(product.limbs.data(),a.data(),a.size(),b.data(),b.size(),limits);
+                    product.normalize();
+                }
+                return product;
+            }
+            natural& operator+=(const natural& other) {
+                return *this = *this+other;
+            }
+            natural& operator-=(const natural& other) {
+                return *this = *this-other;
+            }
+            natural& operator*=(const natural& other) {
+                return *this = *this*other;
+            }
+
+            friend bool operator==(const natural& a,const natural& b) noexcept {
+                return a.limbs == b.limbs;
+            }
+            friend bool operator!=(const natural& a,const natural& b) noexcept {
+                return !(a == b);
+            }
+            friend bool operator<(const natural& a,const natural& b) noexcept {
+                if (a.size() != b.size()) {
+                    return a.size() < b.size();
+                }
+                return ::std::lexicographical_compare(a.limbs.rbegin(),a.limbs.rend(),b.limbs.rbegin(),b.limbs.rend());
+            }
+            friend bool operator>(const natural& a,const natural& b) noexcept {
+                return b < a;
+            }
+            friend bool operator<=(const natural& a,const natural& b) noexcept {
+                return !(b < a);
+            }
+            friend bool operator>=(const natural& a,const natural& b) noexcept {
+                return !(a < b);
+            }
+
+            /// Number of significant bits
+            /// @param x value
+            /// @return index of the highest bit set plus one, 0 for 0
+            friend ::std::size_t bit_length(const natural& x) noexcept {
+                return 0 == x.size() ? 0 : 64*(x.size()-1)+utils::bit_length(x.limbs.back());
+            }
+
+        private:
+            /// Drops leading zero limbs
+            void normalize() {
+                while (!limbs.empty() && 0 == limbs.back()) {
+                    limbs.pop_back();
+                }
+            }
+
+            ::std::vector<limb_type,core::allocator<limb_type>> limbs;
+        };
+
+    }
+}
+
+#endif // CPP11CRYPTO_ARITH_NATURAL_HPP
@@ -0,0 +1,701 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// arith/p256.hpp - The NIST P-256 curve: group law with complete formulas,
+//                    constant time and fixed-base scalar multiplication, ECDSA and ECDH
+
+#ifndef CPP11CRYPTO_ARITH_P256_HPP
+#define CPP11CRYPTO_ARITH_P256_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include "arith/montgomery.hpp"
+#include "arith/prime.hpp"
+#include "arith/uint.hpp"
+#include "core/zeroizing.hpp"
+#include "utils/bits.hpp"
+#include "utils/span.hpp"
+
+namespace cpp11crypto {
+    namespace arith {
+        namespace p256 {
+
+            /// Type of coordinates and scalars
+            typedef uint<256> value_type;
+
+            /// Teeth of the fixed-base comb, whose table holds 2^comb_teeth points
+            constexpr unsigned comb_teeth = 6;
+            /// Distance between the bits of a comb digit
+            constexpr unsigned comb_spacing = (256+comb_teeth-1)/comb_teeth;
+            /// Width of the signed digits of the generator in @ref multiply_public
+            constexpr unsigned base_window = 7;
+            /// Width of the signed digits of the other point in @ref multiply_public
+            constexpr unsigned point_window = 5;
+
+            namespace details {
+                /// Value from its limbs, most significant first
+                inline value_type from_limbs(const ::std::uint64_t l3,const ::std::uint64_t l2,
+                                             const ::std::uint64_t l1,const ::std::uint64_t l0) noexcept {
+                    value_type x;
+                    x.limb(0) = l0;
+                    x.limb(1) = l1;
+                    x.limb(2) = l2;
+                    x.limb(3) = l3;
+                    return x;
+                }
+
+                /// Limbs of p = 2^256-2^224+2^192+2^96-1, lowest first
+                constexpr arith::details::limb p_limb(const ::std::size_t i) noexcept {
+                    return 0 == i ? 0xffffffffffffffffULL : 1 == i ? 0x00000000ffffffffULL : 2 == i ? 0 : 0xffffffff00000001ULL;
+                }
+
+                /// Parameters of y^2 = x^3-3x+b over the field of p and of the scalars modulo n
+                struct curve {
+                    curve()
+                        : field {from_limbs(p_limb(3),p_limb(2),p_limb(1),p_limb(0))},
+                          scalars {from_limbs(0xffffffff00000000ULL,0xffffffffffffffffULL,0xbce6faada7179e84ULL,0xf3b9cac2fc632551ULL)} {}
+                    /// Field of the coordinates, for conversions and inversions
+                    montgomery_context<256> field;
+                    /// Field of the scalars, modulo the order of the generator
+                    montgomery_context<256> scalars;
+                };
+
+                /// @return parameters, set up on first use
+                inline const curve& parameters() {
+                    static const curve c;
+                    return c;
+                }
+            }
+
+            /// @return Montgomery context of the field of the coordinates
+            inline const montgomery_context<256>& field() {
+                return details::parameters().field;
+            }
+            /// @return Montgomery context modulo the group order n
+            inline const montgomery_context<256>& scalars() {
+                return details::parameters().scalars;
+            }
+            /// @return group order n
+            inline const value_type& order() {
+                return scalars().modulus();
+            }
+
+            /// Element of the field of p in the Montgomery domain, R = 2^256. Products use
+            /// -p^-1 == 1 mod 2^64 and the zero limb of p, and every operation takes a time
+            /// independent of the values. Elements are plain limbs, not zeroized on
+            /// destruction: scalar multiplications wipe their own tables.
+            class field_element {
+            public:
+                typedef arith::details::limb limb;
+
+                /// Zero
+                field_element() noexcept : limbs() {}
+
+                /// Into the domain
+                /// @param x value below p
+                /// @return x*R mod p
+                static field_element from_value(const value_type& x) noexcept {
+                    field_element e;
+                    for (::std::size_t i = 0; i != 4; ++i) {
+                        e.limbs[i] = x.limb(i);
+                    }
+                    return e*from_uint(field().r_squared());
+                }
+                /// Out of the domain
+                /// @return value below p
+                value_type value() const noexcept {
+                    field_element one;
+                    one.limbs[0] = 1;
+                    return (*this*one).to_uint();
+                }
+                /// @return one in the domain
+                static field_element one() noexcept {
+                    return from_uint(field().one());
+                }
+
+                /// @return true if zero
+                bool is_zero() const noexcept {
+                    return (limbs[0] | limbs[1] | limbs[2] | limbs[3]) == 0;
+                }
+                /// Inverse by safegcd, in a time that does not depend on the value
+                /// @return inverse, zero for zero
+                field_element inverse() const noexcept {
+                    return from_uint(field().invert(to_uint()));
+                }
+
+                friend field_element operator+(const field_element& a,const field_element& b) noexcept {
+                    field_element sum, reduced;
+                    unsigned char carry = 0, borrow = 0;
+                    arith::details::for_each_limb<4>([&](const ::std::size_t i) {
+                        carry = arith::details::add_carry(carry,a.limbs[i],b.limbs[i],sum.limbs[i]);
+                    });
+                    arith::details::for_each_limb<4>([&](const ::std::size_t i) {
+                        borrow = arith::details::sub_borrow(borrow,sum.limbs[i],details::p_limb(i),reduced.limbs[i]);
+                    });
+                    // the sum is kept only if it did not overflow and is below p
+                    return conditional_select(carry < borrow,sum,reduced);
+                }
+                friend field_element operator-(const field_element& a,const field_element& b) noexcept {
+                    field_element difference;
+                    unsigned char borrow = 0, carry = 0;
+                    arith::details::for_each_limb<4>([&](const ::std::size_t i) {
+                        borrow = arith::details::sub_borrow(borrow,a.limbs[i],b.limbs[i],difference.limbs[i]);
+                    });
+                    // p is added back under a mask when the difference borrowed
+                    const limb mask = limb {0}-borrow;
+                    arith::details::for_each_limb<4>([&](const ::std::size_t i) {
+                        carry = arith::details::add_carry(carry,difference.limbs[i],details::p_limb(i) & mask,difference.limbs[i]);
+                    });
+                    return difference;
+                }
+                friend field_element operator-(const field_element& a) noexcept {
+                    return field_element {}-a;
+                }
+
+                /// Montgomery product, coarsely integrated operand scanning as in
+                /// @ref montgomery_context::multiply with the constants of p
+                friend field_element operator*(const field_element& a,const field_element& b) noexcept {
+                    limb t[6] = {};
+                    arith::details::for_each_limb<4>([&](const ::std::size_t i) {
+                        limb carry = 0;
+                        arith::details::for_each_limb<4>([&](const ::std::size_t j) {
+                            t[j] = arith::details::multiply_add(a.limbs[j],b.limbs[i],t[j],carry);
+                        });
+                        t[5] = arith::details::add_carry(0,t[4],carry,t[4]);
+                        // -p^-1 == 1, the multiple of p that clears the lowest limb is t[0]*p
+                        const limb k = t[0];
+                        carry = 0;
+                        arith::details::multiply_add(k,details::p_limb(0),t[0],carry);
+                        arith::details::for_each_limb<3>([&](const ::std::size_t j) {
+                            t[j] = arith::details::multiply_add(k,details::p_limb(j+1),t[j+1],carry);
+                        });
+                        t[4] = t[5]+arith::details::add_carry(0,t[4],carry,t[3]);
+                    });
+                    // below 2p: subtract p unless that borrows past the top limb
+                    field_element low, reduced;
+                    unsigned char borrow = 0;
+                    arith::details::for_each_limb<4>([&](const ::std::size_t j) {
+                        low.limbs[j] = t[j];
+                        borrow = arith::details::sub_borrow(borrow,t[j],details::p_limb(j),reduced.limbs[j]);
+                    });
+                    return conditional_select(t[4] < borrow,low,reduced);
+                }
+                /// @return a*a in the domain
+                friend field_element square(const field_element& a) noexcept {
+                    return a*a;
+                }
+
+                /// Comparison in a time independent of the values
+                friend bool operator==(const field_element& a,const field_element& b) noexcept {
+                    return ((a.limbs[0] ^ b.limbs[0]) | (a.limbs[1] ^ b.limbs[1]) | (a.limbs[2] ^ b.limbs[2]) | (a.limbs[3] ^ b.limbs[3])) == 0;
+                }
+                friend bool operator!=(const field_element& a,const field_element& b) noexcept {
+                    return !(a == b);
+                }
+
+                /// Selection without branches nor memory access depending on the condition
+                friend field_element conditional_select(const bool condition,const field_element& if_true,
+                                                        const field_element& if_false) noexcept {
+                    const limb mask = limb {0}-static_cast<limb>(condition);
+                    field_element result;
+                    for (::std::size_t i = 0; i != 4; ++i) {
+                        result.limbs[i] = (if_true.limbs[i] & mask) | (if_false.limbs[i] & ~mask);
+                    }
+                    return result;
+                }
+                /// Masked accumulation, this |= other if condition holds, for table scans
+                void accumulate_if(const bool condition,const field_element& other) noexcept {
+                    const limb mask = limb {0}-static_cast<limb>(condition);
+                    for (::std::size_t i = 0; i != 4; ++i) {
+                        limbs[i] |= other.limbs[i] & mask;
+                    }
+                }
+
+            private:
+                static field_element from_uint(const value_type& x) noexcept {
+                    field_element e;
+                    for (::std::size_t i = 0; i != 4; ++i) {
+                        e.limbs[i] = x.limb(i);
+                    }
+                    return e;
+                }
+                value_type to_uint() const noexcept {
+                    value_type x;
+                    for (::std::size_t i = 0; i != 4; ++i) {
+                        x.limb(i) = limbs[i];
+                    }
+                    return x;
+                }
+
+                limb limbs[4];
+            };
+
+            /// Affine coordinates, outside of the Montgomery domain
+            struct affine_point {
+                value_type x, y;
+            };
+
+            namespace details {
+                /// Constants of the group law in the domain of the field
+                struct curve_constants {
+                    curve_constants()
+                        : b {field_element::from_value(from_limbs(0x5ac635d8aa3a93e7ULL,0xb3ebbd55769886bcULL,0x651d06b0cc53b0f6ULL,0x3bce3c3e27d2604bULL))},
+                          gx {field_element::from_value(from_limbs(0x6b17d1f2e12c4247ULL,0xf8bce6e563a440f2ULL,0x77037d812deb33a0ULL,0xf4a13945d898c296ULL))},
+                          gy {field_element::from_value(from_limbs(0x4fe342e2fe1a7f9bULL,0x8ee7eb4a7c0f9e16ULL,0x2bce33576b315eceULL,0xcbb6406837bf51f5ULL))},
+                          one {field_element::one()} {}
+                    field_element b, gx, gy, one;
+                };
+
+                /// @return constants, set up on first use
+                inline const curve_constants& constants() {
+                    static const curve_constants c;
+                    return c;
+                }
+            }
+
+            /// Point in homogeneous projective coordinates (X:Y:Z), the identity being
+            /// (0:1:0). Sums and doublings use the complete formulas of Renes, Costello and
+            /// Batina for a = -3: they hold for every pair of points, identity and equal
+            /// points included, so there is no branch on values.
+            class point {
+            public:
+                /// Identity
+                point() noexcept : x {}, y {details::constants().one}, z {} {}
+
+                /// Point from its affine coordinates
+                /// @param a coordinates, below p
+                /// @return point
+                /// @throw std::invalid_argument if the coordinates are not a point of the curve
+                static point from_affine(const affine_point& a) {
+                    if (!(a.x < field().modulus()) || !(a.y < field().modulus())) {
+                        throw ::std::invalid_argument("P-256 coordinates must be below p");
+                    }
+                    const point p {field_element::from_value(a.x),field_element::from_value(a.y),details::constants().one};
+                    if (!p.on_curve()) {
+                        throw ::std::invalid_argument("P-256 coordinates are not a point of the curve");
+                    }
+                    return p;
+                }
+                /// @return generator G
+                static point generator() noexcept {
+                    const details::curve_constants& c = details::constants();
+                    return point {c.gx,c.gy,c.one};
+                }
+
+                /// Affine coordinates, through one inversion in constant time
+                /// @return coordinates
+                /// @throw std::domain_error for the identity
+                affine_point to_affine() const {
+                    if (is_identity()) {
+                        throw ::std::domain_error("The P-256 identity has no affine coordinates");
+                    }
+                    const field_element z_inverse = z.inverse();
+                    return affine_point {(x*z_inverse).value(),(y*z_inverse).value()};
+                }
+                /// @return true for the identity
+                bool is_identity() const noexcept {
+                    return z.is_zero();
+                }
+
+                /// Doubling, algorithm 6 of Renes, Costello and Batina
+                /// @return 2*this
+                point doubled() const noexcept {
+                    const field_element& b = details::constants().b;
+                    field_element t0 = square(x), t1 = square(y), t2 = square(z);
+                    field_element t3 = x*y;
+                    t3 = t3+t3;
+                    field_element z3 = x*z;
+                    z3 = z3+z3;
+                    field_element y3 = b*t2-z3;
+                    field_element x3 = y3+y3;
+                    y3 = x3+y3;
+                    x3 = t1-y3;
+                    y3 = x3*(t1+y3);
+                    x3 = x3*t3;
+                    t3 = t2+t2;
+                    t2 = t2+t3;
+                    z3 = b*z3-t2-t0;
+                    z3 = z3+(z3+z3);
+                    t3 = t0+t0;
+                    t0 = t3+t0-t2;
+                    y3 = y3+t0*z3;
+                    t0 = y*z;
+                    t0 = t0+t0;
+                    x3 = x3-t0*z3;
+                    z3 = t0*t1;
+                    z3 = z3+z3;
+                    return point {x3,y3,z3+z3};
+                }
+
+                /// Sum, algorithm 4 of Renes, Costello and Batina
+                /// @return a+b
+                friend point operator+(const point& a,const point& b) noexcept {
+                    const field_element& curve_b = details::constants().b;
+                    field_element t0 = a.x*b.x, t1 = a.y*b.y, t2 = a.z*b.z;
+                    field_element t3 = (a.x+a.y)*(b.x+b.y)-(t0+t1);
+                    field_element t4 = (a.y+a.z)*(b.y+b.z)-(t1+t2);
+                    field_element x3 = (a.x+a.z)*(b.x+b.z);
+                    field_element y3 = x3-(t0+t2);
+                    field_element z3 = curve_b*t2;
+                    x3 = y3-z3;
+                    x3 = x3+(x3+x3);
+                    z3 = t1-x3;
+                    x3 = t1+x3;
+                    y3 = curve_b*y3;
+                    t1 = t2+t2;
+                    t2 = t1+t2;
+                    y3 = y3-t2-t0;
+                    y3 = y3+(y3+y3);
+                    t1 = t0+t0;
+                    t0 = t1+t0-t2;
+                    t1 = t4*y3;
+                    t2 = t0*y3;
+                    y3 = x3*z3+t2;
+                    x3 = t3*x3-t1;
+                    z3 = t4*z3+t3*t0;
+                    return point {x3,y3,z3};
+                }
+                /// @return -a
+                friend point operator-(const point& a) noexcept {
+                    return point {a.x,-a.y,a.z};
+                }
+                /// @return a-b
+                friend point operator-(const point& a,const point& b) noexcept {
+                    return a+(-b);
+                }
+                /// Comparison of the projective classes, X1*Z2 == X2*Z1 and Y1*Z2 == Y2*Z1
+                friend bool operator==(const point& a,const point& b) noexcept {
+                    return (a.x*b.z == b.x*a.z) & (a.y*b.z == b.y*a.z);
+                }
+                friend bool operator!=(const point& a,const point& b) noexcept {
+                    return !(a == b);
+                }
+
+                /// Selection without branches nor memory access depending on the condition
+                friend point conditional_select(const bool condition,const point& if_true,const point& if_false) noexcept {
+                    return point {conditional_select(condition,if_true.x,if_false.x),
+                                  conditional_select(condition,if_true.y,if_false.y),
+                                  conditional_select(condition,if_true.z,if_false.z)};
+                }
+                /// Table entry read by scanning the whole table with masks, so that neither
+                /// time nor memory accesses depend on the index
+                /// @param table entries
+                /// @param count number of entries
+                /// @param index entry wanted, below count
+                /// @return table[index]
+                static point select(const point * const table,const ::std::size_t count,const ::std::size_t index) noexcept {
+                    point r {field_element {},field_element {},field_element {}};
+                    for (::std::size_t i = 0; i != count; ++i) {
+                        const bool match = i == index;
+                        r.x.accumulate_if(match,table[i].x);
+                        r.y.accumulate_if(match,table[i].y);
+                        r.z.accumulate_if(match,table[i].z);
+                    }
+                    return r;
+                }
+
+            private:
+                point(const field_element& x,const field_element& y,const field_element& z) noexcept : x {x}, y {y}, z {z} {}
+
+                /// @return true if Y^2*Z == X^3-3*X*Z^2+b*Z^3
+                bool on_curve() const noexcept {
+                    const field_element z2 = square(z);
+                    return square(y)*z == x*(square(x)-(z2+z2+z2))+details::constants().b*z2*z;
+                }
+
+                field_element x, y, z;
+            };
+
+            namespace details {
+                /// Tables of multiples of the generator, built once on first use: the comb
+                /// entries sum(bit i of j * 2^(i*comb_spacing)*G), and the odd multiples
+                /// (2i+1)*G for signed digits of base_window bits
+                struct base_tables {
+                    base_tables() {
+                        point teeth[comb_teeth];
+                        teeth[0] = point::generator();
+                        for (unsigned t = 1; t != comb_teeth; ++t) {
+                            teeth[t] = teeth[t-1];
+                            for (unsigned i = 0; i != comb_spacing; ++i) {
+                                teeth[t] = teeth[t].doubled();
+                            }
+                        }
+                        for (unsigned j = 1; j != 1u << comb_teeth; ++j) {
+                            const unsigned top = utils::bit_length(static_cast<unsigned long long>(j))-1;
+                            comb[j] = comb[j ^ (1u << top)]+teeth[top];
+                        }
+                        odd[0] = point::generator();
+                        const point twice = odd[0].doubled();
+                        for (unsigned i = 1; i != 1u << (base_window-2); ++i) {
+                            odd[i] = odd[i-1]+twice;
+                        }
+                    }
+                    point comb[1u << comb_teeth];
+                    point odd[1u << (base_window-2)];
+                };
+
+                /// @return tables of the generator
+                inline const base_tables& generator_tables() {
+                    static const base_tables tables;
+                    return tables;
+                }
+
+                /// Signed digits of width w: odd in (-2^(w-1),2^(w-1)) or zero, with at
+                /// least w-1 zeros after each nonzero one. Time depends on the value.
+                /// @param k scalar
+                /// @param w digit width, between 2 and 8
+                /// @param digits receives the digits, least significant first
+                /// @return number of digits
+                inline unsigned wnaf(const value_type& k,const unsigned w,signed char (&digits)[257]) noexcept {
+                    typedef uint<320> wide;
+                    wide r {k};
+                    const unsigned long long mask = (1ULL << w)-1;
+                    unsigned length = 0;
+                    while (r != wide {}) {
+                        long long d = 0;
+                        if (r.bit(0)) {
+                            d = static_cast<long long>(static_cast<unsigned long long>(r) & mask);
+                            if (d >= 1LL << (w-1)) {
+                                d -= 1LL << w;
+                            }
+                            r = d > 0 ? r-wide {static_cast<unsigned long long>(d)} : r+wide {static_cast<unsigned long long>(-d)};
+                        }
+                        digits[length++] = static_cast<signed char>(d);
+                        r >>= 1;
+                    }
+                    return length;
+                }
+            }
+
+            /// Scalar multiplication for secret scalars, in a time that does not depend on
+            /// them: fixed windows of 4 bits, 4 doublings and one sum each, the multiple of
+            /// p added being read from a table of 16 by @ref point::select, wiped on return
+            /// @param k scalar
+            /// @param p point
+            /// @return k*p
+            inline point multiply(const value_type& k,const point& p) noexcept {
+                point table[16];
+                table[1] = p;
+                for (unsigned i = 2; i != 16; ++i) {
+                    table[i] = 0 == (i & 1) ? table[i/2].doubled() : table[i-1]+p;
+                }
+                point r;
+                for (unsigned window = 64; window-- != 0;) {
+                    for (unsigned i = 0; i != 4; ++i) {
+                        r = r.doubled();
+                    }
+                    const unsigned digit = static_cast<unsigned>(static_cast<unsigned long long>(k >> (4*window)) & 0xf);
+                    r = r+point::select(table,16,digit);
+                }
+                core::do_zeroize(table,sizeof table);
+                return r;
+            }
+
+            /// Scalar multiplication of the generator for secret scalars, by the comb of
+            /// Lim and Lee over the lazily built table of @ref details::base_tables:
+            /// comb_spacing doublings and sums, in a time that does not depend on the scalar
+            /// @param k scalar
+            /// @return k*G
+            inline point multiply_base(const value_type& k) {
+                const details::base_tables& tables = details::generator_tables();
+                point r;
+                for (unsigned column = comb_spacing; column-- != 0;) {
+                    r = r.doubled();
+                    unsigned digit = 0;
+                    for (unsigned t = 0; t != comb_teeth; ++t) {
+                        const unsigned bit = column+t*comb_spacing;
+                        digit |= (bit < 256 && k.bit(bit) ? 1u : 0u) << t;
+                    }
+                    r = r+point::select(tables.comb,1u << comb_teeth,digit);
+                }
+                return r;
+            }
+
+            /// Double scalar multiplication for public scalars, as in signature checks,
+            /// by interleaved signed sliding windows. Time depends on the scalars.
+            /// @param u1 scalar of the generator
+            /// @param u2 scalar of q
+            /// @param q point
+            /// @return u1*G+u2*q
+            inline point multiply_public(const value_type& u1,const value_type& u2,const point& q) {
+                const details::base_tables& tables = details::generator_tables();
+                point odd[1u << (point_window-2)];
+                odd[0] = q;
+                const point twice = q.doubled();
+                for (unsigned i = 1; i != 1u << (point_window-2); ++i) {
+                    odd[i] = odd[i-1]+twice;
+                }
+                signed char d1[257], d2[257];
+                const unsigned n1 = details::wnaf(u1,base_window,d1);
+                const unsigned n2 = details::wnaf(u2,point_window,d2);
+                point r;
+                for (unsigned i = ::std::max(n1,n2); i-- != 0;) {
+                    r = r.doubled();
+                    if (i < n1 && 0 != d1[i]) {
+                        r = d1[i] > 0 ? r+tables.odd[d1[i]/2] : r-tables.odd[-d1[i]/2];
+                    }
+                    if (i < n2 && 0 != d2[i]) {
+                        r = d2[i] > 0 ? r+odd[d2[i]/2] : r-odd[-d2[i]/2];
+                    }
+                }
+                return r;
+            }
+
+            /// ECDSA signature
+            struct signature {
+                value_type r, s;
+            };
+
+            namespace details {
+                /// Leftmost 256 bits of a digest reduced modulo n, as in FIPS 186-4
+                inline value_type digest_scalar(const utils::span<::std::uint8_t> digest) {
+                    value_type e;
+                    const ::std::size_t length = ::std::min<::std::size_t>(digest.size(),32);
+                    for (::std::size_t i = 0; i != length; ++i) {
+                        e = (e << 8) | value_type {digest[i]};
+                    }
+                    return conditional_select(e < order(),e,e-order());
+                }
+
+                /// Affine x coordinate reduced modulo n
+                inline value_type x_scalar(const point& p) {
+                    const value_type x = p.to_affine().x;
+                    return conditional_select(x < order(),x,x-order());
+                }
+            }
+
+            /// Public key: a point of the curve other than the identity
+            class public_key {
+            public:
+                /// Constructor
+                /// @param q coordinates of the point
+                /// @throw std::invalid_argument if the coordinates are not a point of the curve
+                explicit public_key(const affine_point& q) : q {q}, p {point::from_affine(q)} {}
+
+                /// @return affine coordinates
+                const affine_point& coordinates() const noexcept {
+                    return q;
+                }
+                /// @return point
+                const point& value() const noexcept {
+                    return p;
+                }
+
+                /// ECDSA signature check, in variable time
+                /// @param digest message digest, its leftmost 256 bits are taken
+                /// @param sig signature
+                /// @return true if the signature is valid
+                bool verify(const utils::span<::std::uint8_t> digest,const signature& sig) const {
+                    const value_type zero {};
+                    if (sig.r == zero || sig.s == zero || !(sig.r < order()) || !(sig.s < order())) {
+                        return false;
+                    }
+                    const montgomery_context<256>& n = scalars();
+                    // s^-1 in the domain times a value outside it is outside it
+                    const value_type w = n.invert(n.to_montgomery(sig.s));
+                    const point r = multiply_public(n.multiply(w,details::digest_scalar(digest)),n.multiply(w,sig.r),p);
+                    return !r.is_identity() && details::x_scalar(r) == sig.r;
+                }
+
+            private:
+                affine_point q;
+                point p;
+            };
+
+            /// Private key d, with 0 < d < n, and its public key d*G. Private operations
+            /// take a time that does not depend on d nor on the nonces. Objects wipe their
+            /// memory when destroyed, heap ones included.
+            class private_key : public core::ZeroizingBase<> {
+            public:
+                /// Constructor
+                /// @param d private scalar
+                /// @throw std::invalid_argument unless 0 < d < n
+                explicit private_key(const value_type& d)
+                    : d {checked(d)}, d_montgomery {scalars().to_montgomery(d)},
+                      key {multiply_base(d).to_affine()} {}
+
+                /// @return public key
+                const p256::public_key& public_key() const noexcept {
+                    return key;
+                }
+
+                /// ECDSA signature with a nonce drawn from a generator
+                /// @param digest message digest, its leftmost 256 bits are taken
+                /// @param generator uniform random bit generator of 64-bit words
+                /// @return signature
+                template <typename Generator>
+                signature sign(const utils::span<::std::uint8_t> digest,Generator& generator) const {
+                    const montgomery_context<256>& n = scalars();
+                    const value_type e = details::digest_scalar(digest);
+                    const value_type zero {};
+                    for (;;) {
+                        const value_type k = arith::details::random_below(generator,order());
+                        if (k == zero) {
+                            continue;
+                        }
+                        const value_type r = details::x_scalar(multiply_base(k));
+                        // s = k^-1*(e+r*d): products of a value in the domain by one outside it are outside it
+                        const value_type k_inverse = n.invert(n.to_montgomery(k));
+                        const value_type s = n.multiply(k_inverse,n.add(e,n.multiply(r,d_montgomery)));
+                        if (r != zero && s != zero) {
+                            return signature {r,s};
+                        }
+                    }
+                }
+
+                /// ECDH key agreement
+                /// @param peer public key of the other party, already checked to be on the curve
+                /// @return affine x coordinate of d*peer
+                value_type agree(const p256::public_key& peer) const {
+                    return multiply(d,peer.value()).to_affine().x;
+                }
+
+            private:
+                static const value_type& checked(const value_type& d) {
+                    if (d == value_type {} || !(d < order())) {
+                        throw ::std::invalid_argument("P-256 private scalar must be in [1,n)");
+                    }
+                    return d;
+                }
+
+                value_type d;
+                /// d in the Montgomery domain of n
+                value_type d_montgomery;
+                p256::public_key key;
+            };
+
+            /// Generates a key with a uniform private scalar
+            /// @param generator uniform random bit generator of 64-bit words
+            /// @return private key
+            template <typename Generator>
+            private_key generate_key(Generator& generator) {
+                value_type d;
+                do {
+                    d = arith::details::random_below(generator,order());
+                } while (d == value_type {});
+                return private_key {d};
+            }
+
+        }
+    }
+}
+
+#endif // CPP11CRYPTO_ARITH_P256_HPP
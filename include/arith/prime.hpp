@@ -0,0 +1,331 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// arith/prime.hpp - Miller-Rabin testing and random prime generation, sieving
+//                    by incremental residues and testing on several threads
+
+#ifndef CPP11CRYPTO_ARITH_PRIME_HPP
+#define CPP11CRYPTO_ARITH_PRIME_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "arith/algorithms/euclid.hpp"
+#include "arith/modexp.hpp"
+#include "arith/montgomery.hpp"
+#include "arith/uint.hpp"
+#include "core/zeroizing.hpp"
+
+namespace cpp11crypto {
+    namespace arith {
+
+        /// Candidates are sieved by the odd primes below this bound
+        constexpr ::std::uint32_t small_prime_bound = 8192;
+
+        /// Miller-Rabin rounds that bring the error probability on random candidates
+        /// below 2^-80 (Damgard, Landrock and Pomerance bounds, as in OpenSSL)
+        /// @param bits candidate length
+        /// @return number of rounds
+        constexpr unsigned miller_rabin_rounds(const ::std::size_t bits) noexcept {
+            return bits >= 3747 ? 3 : bits >= 1345 ? 4 : bits >= 476 ? 5 : bits >= 400 ? 6
+                   : bits >= 347 ? 7 : bits >= 308 ? 8 : bits >= 55 ? 27 : 34;
+        }
+
+        namespace details {
+
+            /// Odd primes below small_prime_bound, sieved once
+            /// @return primes in increasing order
+            inline const ::std::vector<::std::uint32_t>& small_primes() {
+                static const ::std::vector<::std::uint32_t> primes = []() {
+                    ::std::vector<bool> composite(small_prime_bound);
+                    ::std::vector<::std::uint32_t> found;
+                    for (::std::uint32_t p = 3; p < small_prime_bound; p += 2) {
+                        if (!composite[p]) {
+                            found.push_back(p);
+                            for (::std::uint32_t q = p*p; q < small_prime_bound; q += 2*p) {
+                                composite[q] = true;
+                            }
+                        }
+                    }
+                    return found;
+                }();
+                return primes;
+            }
+
+            /// Remainder by a word, one division per limb
+            /// @param x dividend
+            /// @param d divisor, not zero
+            /// @return x mod d
+            template <::std::size_t Bits>
+            limb remainder(const uint<Bits>& x,const limb d) noexcept {
+                limb r = 0;
+                for (::std::size_t i = uint<Bits>::limb_count; i-- != 0;) {
+                    r = static_cast<limb>(((static_cast<utils::uint128_t>(r) << 64) | x.limb(i)) % d);
+                }
+                return r;
+            }
+
+            /// Uniform value below a bound, by rejection
+            /// @param generator uniform random bit generator of 64-bit words
+            /// @param bound upper bound, not zero
+            /// @return value in [0,bound)
+            template <::std::size_t Bits, typename Generator>
+            uint<Bits> random_below(Generator& generator,const uint<Bits>& bound) {
+                const unsigned length = bit_length(bound);
+                uint<Bits> x;
+                do {
+                    for (::std::size_t i = 0; i != uint<Bits>::limb_count; ++i) {
+                        x.limb(i) = 64*i < length ? static_cast<limb>(generator()) : 0;
+                    }
+                    if (0 != length%64) {
+                        x.limb((length-1)/64) &= (limb {1} << (length%64))-1;
+                    }
+                } while (!(x < bound));
+                return x;
+            }
+
+            /// Miller-Rabin rounds with random bases. Every round does the same
+            /// exponentiation and the same squarings whatever the outcome.
+            /// @param context Montgomery context of the candidate, odd and above 3
+            /// @param rounds number of rounds
+            /// @param draw functor giving a uniform value below its argument
+            /// @param stop rounds are abandoned, returning false, once it is set
+            /// @return false if the candidate is composite or the test was stopped
+            template <::std::size_t Bits, typename Draw>
+            bool miller_rabin(const montgomery_context<Bits>& context,const unsigned rounds,
+                              const Draw& draw,const ::std::atomic<bool>& stop) {
+                const uint<Bits>& n = context.modulus();
+                const uint<Bits> n_minus_one = n-uint<Bits> {1};
+                const unsigned s = trailing_zeros(n_minus_one);
+                const uint<Bits> d = n_minus_one >> s;
+                const uint<Bits> minus_one = context.subtract(uint<Bits> {},context.one());
+                for (unsigned round = 0; round != rounds; ++round) {
+                    if (stop.load(::std::memory_order_relaxed)) {
+                        return false;
+                    }
+                    // base in [2,n-2]
+                    const uint<Bits> a = draw(n-uint<Bits> {3})+uint<Bits> {2};
+                    uint<Bits> x = fixed_window_power(context,context.to_montgomery(a),d);
+                    bool passed = x == context.one() || x == minus_one;
+                    for (unsigned j = 1; j < s; ++j) {
+                        x = context.square(x);
+                        passed |= x == minus_one;
+                    }
+                    if (!passed) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+        }
+
+        /// Probabilistic primality test: division by the small primes, then
+        /// Miller-Rabin with random bases
+        /// @param n candidate
+        /// @param generator uniform random bit generator of 64-bit words
+        /// @param rounds number of Miller-Rabin rounds, 0 to take @ref miller_rabin_rounds
+        /// @return false if n is composite, true if n is prime with high probability
+        template <::std::size_t Bits, typename Generator>
+        bool is_probable_prime(const uint<Bits>& n,Generator& generator,unsigned rounds = 0) {
+            if (n < uint<Bits> {4}) {
+                return n == uint<Bits> {2} || n == uint<Bits> {3};
+            }
+            if (!n.bit(0)) {
+                return false;
+            }
+            for (const ::std::uint32_t p : details::small_primes()) {
+                if (0 == details::remainder(n,p)) {
+                    return n == uint<Bits> {p};
+                }
+            }
+            if (0 == rounds) {
+                rounds = miller_rabin_rounds(bit_length(n));
+            }
+            const ::std::atomic<bool> never {false};
+            return details::miller_rabin(montgomery_context<Bits> {n},rounds,[&](const uint<Bits>& bound) {
+                return details::random_below(generator,bound);
+            },never);
+        }
+
+        /// Parameters of @ref generate_prime
+        struct prime_options {
+            /// Constructor
+            /// @param threads number of threads testing candidates, 0 for one per core
+            /// @param rounds number of Miller-Rabin rounds, 0 to take @ref miller_rabin_rounds
+            /// @param public_exponent primes p are kept only if gcd(p-1,e) == 1, 0 for any;
+            ///                        below 2^63
+            explicit prime_options(const unsigned threads = 0,const unsigned rounds = 0,
+                                   const unsigned long long public_exponent = 65537) noexcept
+                : threads {threads}, rounds {rounds}, public_exponent {public_exponent} {}
+            /// Number of threads testing candidates, 0 for one per core
+            unsigned threads;
+            /// Number of Miller-Rabin rounds, 0 to take @ref miller_rabin_rounds
+            unsigned rounds;
+            /// Primes p are kept only if gcd(p-1,e) == 1, 0 for any
+            unsigned long long public_exponent;
+        };
+
+        /// Work done by @ref generate_prime, summed over threads
+        struct prime_statistics {
+            /// Candidates considered, sieved out or not
+            unsigned long long candidates {0};
+            /// Candidates that reached Miller-Rabin
+            unsigned long long tested {0};
+        };
+
+        /// Number of successive odd candidates tried from a random start
+        constexpr ::std::size_t prime_search_span = 1 << 14;
+
+        /// Random prime of exactly Bits bits with the two top bits set, so that the
+        /// product of two of them has 2*Bits bits. Each thread draws a random odd start,
+        /// computes its residues by the small primes once and then walks the following
+        /// odd numbers keeping them up to date by additions; candidates with no zero
+        /// residue and with gcd(p-1,e) == 1 go through Miller-Rabin. Threads stop as
+        /// soon as one of them finds a prime. Rejected candidates, their residues and
+        /// their contexts live in zeroizing storage and are wiped as they are dropped.
+        /// @param generator uniform random bit generator of 64-bit words, shared by the
+        ///                  threads under a lock
+        /// @param options threads, rounds and public exponent
+        /// @param statistics work done, added to
+        /// @return prime
+        /// @throw whatever the generator throws, once every thread has stopped
+        template <::std::size_t Bits, typename Generator>
+        uint<Bits> generate_prime(Generator& generator,const prime_options& options,prime_statistics& statistics) {
+            static_assert(Bits >= 64,"Primes must fill at least one limb");
+            unsigned threads = 0 != options.threads ? options.threads : ::std::thread::hardware_concurrency();
+            threads = ::std::max(1u,threads);
+            const unsigned rounds = 0 != options.rounds ? options.rounds : miller_rabin_rounds(Bits);
+            const unsigned long long e = options.public_exponent;
+            const ::std::vector<::std::uint32_t>& primes = details::small_primes();
+
+            ::std::mutex lock;
+            ::std::atomic<bool> stop {false};
+            ::std::atomic<unsigned long long> candidates {0}, tested {0};
+            uint<Bits> prime;
+            ::std::exception_ptr failure;
+            const auto draw = [&](const uint<Bits>& bound) {
+                ::std::lock_guard<::std::mutex> guard(lock);
+                return details::random_below(generator,bound);
+            };
+
+            const auto search = [&]() {
+                try {
+                    ::std::vector<::std::uint32_t,core::allocator<::std::uint32_t>> residues(primes.size());
+                    while (!stop.load(::std::memory_order_relaxed)) {
+                        uint<Bits> start;
+                        {
+                            ::std::lock_guard<::std::mutex> guard(lock);
+                            for (::std::size_t i = 0; i != uint<Bits>::limb_count; ++i) {
+                                start.limb(i) = static_cast<details::limb>(generator());
+                            }
+                        }
+                        start.limb(uint<Bits>::limb_count-1) |= details::limb {3} << 62;
+                        start.limb(0) |= 1;
+                        for (::std::size_t i = 0; i != primes.size(); ++i) {
+                            residues[i] = static_cast<::std::uint32_t>(details::remainder(start,primes[i]));
+                        }
+                        const details::limb e_residue = 0 != e ? details::remainder(start,e) : 0;
+
+                        for (::std::size_t step = 0; step != prime_search_span && !stop.load(::std::memory_order_relaxed); ++step) {
+                            const unsigned long long delta = 2*step;
+                            // residues of start+delta, updated for the next step as they are read
+                            bool sieved = false;
+                            for (::std::size_t i = 0; i != primes.size(); ++i) {
+                                sieved |= 0 == residues[i];
+                                residues[i] += 2;
+                                residues[i] -= residues[i] >= primes[i] ? primes[i] : 0;
+                            }
+                            ++candidates;
+                            if (sieved) {
+                                continue;
+                            }
+                            uint<Bits> candidate;
+                            if (0 != add(start,uint<Bits> {delta},candidate)) {
+                                break;
+                            }
+                            // p-1 mod e, from the residue of start
+                            if (0 != e) {
+                                const unsigned long long r = (e_residue+delta%e)%e;
+                                if (1 != algorithms::euclid::gcd<unsigned long long>(e,0 == r ? e-1 : r-1)) {
+                                    continue;
+                                }
+                            }
+                            ++tested;
+                            if (details::miller_rabin(montgomery_context<Bits> {candidate},rounds,draw,stop)) {
+                                ::std::lock_guard<::std::mutex> guard(lock);
+                                if (!stop.exchange(true)) {
+                                    prime = candidate;
+                                }
+                                return;
+                            }
+                        }
+                    }
+                } catch (...) {
+                    ::std::lock_guard<::std::mutex> guard(lock);
+                    if (!stop.exchange(true)) {
+                        failure = ::std::current_exception();
+                    }
+                }
+            };
+
+            ::std::vector<::std::thread> workers;
+            workers.reserve(threads-1);
+            try {
+                for (unsigned t = 1; t != threads; ++t) {
+                    workers.emplace_back(search);
+                }
+            } catch (...) {
+                stop = true;
+                for (auto& worker : workers) {
+                    worker.join();
+                }
+                throw;
+            }
+            search();
+            for (auto& worker : workers) {
+                worker.join();
+            }
+            statistics.candidates += candidates;
+            statistics.tested += tested;
+            if (failure) {
+                ::std::rethrow_exception(failure);
+            }
+            return prime;
+        }
+
+        /// Random prime, see @ref generate_prime(Generator&,const prime_options&,prime_statistics&)
+        /// @param generator uniform random bit generator of 64-bit words
+        /// @param options threads, rounds and public exponent
+        /// @return prime
+        template <::std::size_t Bits, typename Generator>
+        uint<Bits> generate_prime(Generator& generator,const prime_options& options = prime_options()) {
+            prime_statistics statistics;
+            return generate_prime<Bits>(generator,options,statistics);
+        }
+
+    }
+}
+
+#endif // CPP11CRYPTO_ARITH_PRIME_HPP
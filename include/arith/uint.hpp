@@ -0,0 +1,723 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// arith/uint.hpp - Fixed width unsigned integers, stored inline as 64-bit
+//                    limbs and zeroized when destroyed
+
+#ifndef CPP11CRYPTO_ARITH_UINT_HPP
+#define CPP11CRYPTO_ARITH_UINT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include "core/zeroizing.hpp"
+#include "core/secure_array.hpp"
+#include "utils/bits.hpp"
+#include "utils/cpu_features.hpp"
+
+#ifndef CPP11CRYPTO_HAS_UINT128
+#error "arith::uint needs a 128-bit integer type"
+#endif
+
+namespace cpp11crypto {
+    namespace arith {
+
+        namespace details {
+            /// Limb of all multi-precision types
+            typedef ::std::uint64_t limb;
+
+            /// Widest operands, in limbs, whose loops are fully unrolled
+            constexpr ::std::size_t unroll_limit = 8;
+
+            /// Calls f(I), f(I+1)... f(N-1), unrolled at compile time
+            /// @tparam I first index
+            /// @tparam N index past the last
+            template <::std::size_t I, ::std::size_t N>
+            struct unrolled {
+                template <typename F>
+                static CPP11CRYPTO_ALWAYS_INLINE void apply(F& f) {
+                    f(I);
+                    unrolled<I+1,N>::apply(f);
+                }
+            };
+
+            /// End of the recursion
+            /// @tparam N index past the last
+            template <::std::size_t N>
+            struct unrolled<N,N> {
+                template <typename F>
+                static CPP11CRYPTO_ALWAYS_INLINE void apply(F&) {}
+            };
+
+            /// Unrolled loop on short operands
+            template <::std::size_t N, typename F>
+            CPP11CRYPTO_ALWAYS_INLINE void for_each_limb(F& f,::std::true_type) {
+                unrolled<0,N>::apply(f);
+            }
+
+            /// Plain loop on long ones, where unrolling only bloats the code
+            template <::std::size_t N, typename F>
+            CPP11CRYPTO_ALWAYS_INLINE void for_each_limb(F& f,::std::false_type) {
+                for (::std::size_t i = 0; i != N; ++i) {
+                    f(i);
+                }
+            }
+
+            /// Calls f(0)... f(N-1), unrolled when N is small. Always inline, so that
+            /// kernels with a target attribute unroll it with their own instruction set.
+            /// @tparam N number of limbs
+            /// @param f callable taking the limb index
+            template <::std::size_t N, typename F>
+            CPP11CRYPTO_ALWAYS_INLINE void for_each_limb(F&& f) {
+                for_each_limb<N>(f,::std::integral_constant<bool,(N <= unroll_limit)> {});
+            }
+
+            /// Addition with carry in and out, adc where available
+            /// @param carry incoming carry, 0 or 1
+            /// @param a first addend
+            /// @param b second addend
+            /// @param sum receives the low limb of the sum
+            /// @return outgoing carry
+            inline unsigned char add_carry(const unsigned char carry,const limb a,const limb b,limb& sum) noexcept {
+#if defined(CPP11CRYPTO_X86_INTRINSICS) && defined(__x86_64__)
+                unsigned long long result;
+                const unsigned char carry_out = _addcarry_u64(carry,a,b,&result);
+                sum = result;
+                return carry_out;
+#else
+                const utils::uint128_t s = static_cast<utils::uint128_t>(a)+b+carry;
+                sum = static_cast<limb>(s);
+                return static_cast<unsigned char>(s >> 64);
+#endif
+            }
+
+            /// Subtraction with borrow in and out, sbb where available
+            /// @param borrow incoming borrow, 0 or 1
+            /// @param a minuend
+            /// @param b subtrahend
+            /// @param difference receives the low limb of the difference
+            /// @return outgoing borrow
+            inline unsigned char sub_borrow(const unsigned char borrow,const limb a,const limb b,limb& difference) noexcept {
+#if defined(CPP11CRYPTO_X86_INTRINSICS) && defined(__x86_64__)
+                unsigned long long result;
+                const unsigned char borrow_out = _subborrow_u64(borrow,a,b,&result);
+                difference = result;
+                return borrow_out;
+#else
+                const utils::uint128_t d = static_cast<utils::uint128_t>(a)-b-borrow;
+                difference = static_cast<limb>(d);
+                return static_cast<unsigned char>(d >> 127);
+#endif
+            }
+
+            /// Full product of two limbs; compilers emit a single mul, or mulx when
+            /// the build targets BMI2
+            /// @param a first factor
+            /// @param b second factor
+            /// @param high receives the high limb
+            /// @return low limb
+            inline limb multiply_wide(const limb a,const limb b,limb& high) noexcept {
+                const utils::uint128_t p = static_cast<utils::uint128_t>(a)*b;
+                high = static_cast<limb>(p >> 64);
+                return static_cast<limb>(p);
+            }
+
+            /// Multiply-accumulate step of schoolbook products, a*b+addend+carry
+            /// @param a first factor
+            /// @param b second factor
+            /// @param addend limb added to the product
+            /// @param carry limb added to the product, receives the high limb of the result
+            /// @return low limb of the result
+            inline limb multiply_add(const limb a,const limb b,const limb addend,limb& carry) noexcept {
+                const utils::uint128_t s = static_cast<utils::uint128_t>(a)*b+addend+carry;
+                carry = static_cast<limb>(s >> 64);
+                return static_cast<limb>(s);
+            }
+
+            /// Schoolbook product of two short numbers, rows and columns unrolled
+            /// @tparam N limbs of the factors, at most @ref unroll_limit
+            /// @tparam Full true for all 2N limbs of the product, false for the lower N
+            /// @param a first factor
+            /// @param b second factor
+            /// @param r receives the product, zero on entry
+            template <::std::size_t N, bool Full>
+            inline void schoolbook_unrolled(const limb * const a,const limb * const b,limb * const r) noexcept {
+                for_each_limb<N>([&](const ::std::size_t i) {
+                    limb carry = 0;
+                    for_each_limb<N>([&](const ::std::size_t j) {
+                        // only the lower triangle when truncated, folded away when unrolled
+                        if (Full || i+j < N) {
+                            r[i+j] = multiply_add(a[j],b[i],r[i+j],carry);
+                        }
+                    });
+                    if (Full) {
+                        r[i+N] = carry;
+                    }
+                });
+            }
+
+            /// Schoolbook product of two long numbers, plain loops
+            /// @tparam N limbs of the factors
+            /// @tparam Full true for all 2N limbs of the product, false for the lower N
+            /// @param a first factor
+            /// @param b second factor
+            /// @param r receives the product, zero on entry
+            template <::std::size_t N, bool Full>
+            inline void schoolbook_loops(const limb * const a,const limb * const b,limb * const r) noexcept {
+                for (::std::size_t i = 0; i != N; ++i) {
+                    limb carry = 0;
+                    for (::std::size_t j = 0; j != (Full ? N : N-i); ++j) {
+                        r[i+j] = multiply_add(a[j],b[i],r[i+j],carry);
+                    }
+                    if (Full) {
+                        r[i+N] = carry;
+                    }
+                }
+            }
+
+#if defined(CPP11CRYPTO_X86_INTRINSICS) && defined(__x86_64__)
+            /// Schoolbook product with mulx. The products of a row do not depend on
+            /// each other nor on the flags; their low and high limbs are then added in
+            /// two passes, each a single carry chain that compiles to a run of adc.
+            /// It pays only unrolled; in loops, every carry is saved and reloaded.
+            /// @tparam N limbs of the factors, at most @ref unroll_limit
+            /// @tparam Full true for all 2N limbs of the product, false for the lower N
+            /// @param a first factor
+            /// @param b second factor
+            /// @param r receives the product, zero on entry
+            template <::std::size_t N, bool Full>
+            __attribute__((target("bmi2,adx"),flatten))
+            void schoolbook_mulx(const limb * const a,const limb * const b,limb * const r) noexcept {
+                for_each_limb<N>([&](const ::std::size_t i) __attribute__((target("bmi2,adx"))) {
+                    unsigned long long low[N], high[N];
+                    for_each_limb<N>([&](const ::std::size_t j) __attribute__((target("bmi2,adx"))) {
+                        low[j] = _mulx_u64(a[j],b[i],&high[j]);
+                    });
+                    unsigned char carry = 0;
+                    for_each_limb<N>([&](const ::std::size_t j) __attribute__((target("bmi2,adx"))) {
+                        if (Full || i+j < N) {
+                            unsigned long long sum;
+                            carry = _addcarryx_u64(carry,r[i+j],low[j],&sum);
+                            r[i+j] = sum;
+                        }
+                    });
+                    if (Full) {
+                        // r[i+N] is still zero; the row is below 2^(64(N+1)), so the
+                        // high pass carries nothing out of it
+                        r[i+N] = carry;
+                    }
+                    carry = 0;
+                    for_each_limb<N>([&](const ::std::size_t j) __attribute__((target("bmi2,adx"))) {
+                        if (Full || i+j+1 < N) {
+                            unsigned long long sum;
+                            carry = _addcarryx_u64(carry,r[i+j+1],high[j],&sum);
+                            r[i+j+1] = sum;
+                        }
+                    });
+                });
+            }
+#endif
+
+            /// Tells whether the mulx kernel can run on this processor
+            /// @return true if usable
+            inline bool has_mulx() noexcept {
+                return utils::cpu().bmi2 && utils::cpu().adx;
+            }
+
+            /// Schoolbook product of short numbers, mulx kernel where available
+            template <::std::size_t N, bool Full>
+            inline void schoolbook(const limb * const a,const limb * const b,limb * const r,::std::true_type) noexcept {
+#if defined(CPP11CRYPTO_X86_INTRINSICS) && defined(__x86_64__)
+                if (has_mulx()) {
+                    schoolbook_mulx<N,Full>(a,b,r);
+                    return;
+                }
+#endif
+                schoolbook_unrolled<N,Full>(a,b,r);
+            }
+
+            /// Schoolbook product of long numbers
+            template <::std::size_t N, bool Full>
+            inline void schoolbook(const limb * const a,const limb * const b,limb * const r,::std::false_type) noexcept {
+                schoolbook_loops<N,Full>(a,b,r);
+            }
+
+            /// Schoolbook product, the kernel chosen once per call
+            /// @tparam N limbs of the factors
+            /// @tparam Full true for all 2N limbs of the product, false for the lower N
+            /// @param a first factor
+            /// @param b second factor
+            /// @param r receives the product, zero on entry
+            template <::std::size_t N, bool Full>
+            inline void schoolbook(const limb * const a,const limb * const b,limb * const r) noexcept {
+                schoolbook<N,Full>(a,b,r,::std::integral_constant<bool,(N <= unroll_limit)> {});
+            }
+        }
+
+        /// Unsigned integer of a width fixed at compile time, arithmetic modulo 2^Bits
+        /// as for built-in unsigned types. Limbs are stored inline, least significant
+        /// first, and zeroized on destruction. Addition, subtraction, multiplication and
+        /// comparisons take a time that only depends on the width; divisions and shifts
+        /// depend on the values and must be kept for public data.
+        /// @tparam Bits width, a multiple of 64
+        template <::std::size_t Bits>
+        class uint {
+            static_assert(Bits > 0 && 0 == Bits % 64, "Width must be a multiple of 64 bits");
+        public:
+            /// Limb type
+            typedef details::limb limb_type;
+            /// Number of limbs
+            static constexpr ::std::size_t limb_count = Bits/64;
+
+            /// Constructor, zero
+            uint() noexcept : limbs() {}
+
+            /// Constructor from a built-in integer, also implicit conversion
+            /// @param value initial value
+            uint(const unsigned long long value) noexcept : limbs() {
+                limbs[0] = value;
+            }
+
+            /// Conversion from another width, truncating or extending with zeros
+            /// @param other value to convert
+            template <::std::size_t B2>
+            explicit uint(const uint<B2>& other) noexcept : limbs() {
+                for (::std::size_t i = 0; i != (limb_count < uint<B2>::limb_count ? limb_count : uint<B2>::limb_count); ++i) {
+                    limbs[i] = other.limb(i);
+                }
+            }
+
+            /// Destructor, zeroizes the limbs
+            ~uint() {
+                core::do_zeroize(limbs,sizeof limbs);
+            }
+
+            uint(const uint&) = default;
+            uint& operator=(const uint&) = default;
+
+            /// Lowest limb, as for conversions between built-in unsigned types
+            /// @return value modulo 2^64
+            explicit operator unsigned long long() const noexcept {
+                return limbs[0];
+            }
+
+            /// Limb access
+            /// @param i index, 0 for the least significant
+            /// @return limb
+            limb_type limb(const ::std::size_t i) const noexcept {
+                return limbs[i];
+            }
+            /// Limb access
+            /// @param i index, 0 for the least significant
+            /// @return limb
+            limb_type& limb(const ::std::size_t i) noexcept {
+                return limbs[i];
+            }
+            /// Access to the limbs
+            /// @return pointer to the least significant limb
+            const limb_type * data() const noexcept {
+                return limbs;
+            }
+            /// Access to the limbs
+            /// @return pointer to the least significant limb
+            limb_type * data() noexcept {
+                return limbs;
+            }
+
+            /// Reads a bit
+            /// @param i bit index, 0 for the least significant
+            /// @return bit value
+            bool bit(const ::std::size_t i) const noexcept {
+                return 0 != ((limbs[i/64] >> (i%64)) & 1);
+            }
+
+            uint& operator+=(const uint& other) noexcept {
+                add(*this,other,*this);
+                return *this;
+            }
+            uint& operator-=(const uint& other) noexcept {
+                subtract(*this,other,*this);
+                return *this;
+            }
+            uint& operator*=(const uint& other) noexcept {
+                return *this = *this*other;
+            }
+            uint& operator/=(const uint& other) {
+                uint remainder;
+                divide(*this,other,*this,remainder);
+                return *this;
+            }
+            uint& operator%=(const uint& other) {
+                uint quotient;
+                divide(*this,other,quotient,*this);
+                return *this;
+            }
+            uint& operator&=(const uint& other) noexcept {
+                details::for_each_limb<limb_count>([&](const ::std::size_t i) {
+                    limbs[i] &= other.limbs[i];
+                });
+                return *this;
+            }
+            uint& operator|=(const uint& other) noexcept {
+                details::for_each_limb<limb_count>([&](const ::std::size_t i) {
+                    limbs[i] |= other.limbs[i];
+                });
+                return *this;
+            }
+            uint& operator^=(const uint& other) noexcept {
+                details::for_each_limb<limb_count>([&](const ::std::size_t i) {
+                    limbs[i] ^= other.limbs[i];
+                });
+                return *this;
+            }
+            uint& operator<<=(const ::std::size_t n) noexcept {
+                const ::std::size_t whole = n/64, part = n%64;
+                for (::std::size_t i = limb_count; i-- != 0;) {
+                    const limb_type low = i >= whole ? limbs[i-whole] : 0;
+                    const limb_type lower = i > whole ? limbs[i-whole-1] : 0;
+                    limbs[i] = 0 == part ? low : (low << part) | (lower >> (64-part));
+                }
+                return *this;
+            }
+            uint& operator>>=(const ::std::size_t n) noexcept {
+                const ::std::size_t whole = n/64, part = n%64;
+                for (::std::size_t i = 0; i != limb_count; ++i) {
+                    const limb_type high = i+whole < limb_count ? limbs[i+whole] : 0;
+                    const limb_type higher = i+whole+1 < limb_count ? limbs[i+whole+1] : 0;
+                    limbs[i] = 0 == part ? high : (high >> part) | (higher << (64-part));
+                }
+                return *this;
+            }
+
+            friend uint operator+(uint a,const uint& b) noexcept {
+                return a += b;
+            }
+            friend uint operator-(uint a,const uint& b) noexcept {
+                return a -= b;
+            }
+            friend uint operator-(const uint& a) noexcept {
+                return uint {}-a;
+            }
+            /// Product modulo 2^Bits, schoolbook on the lower triangle only
+            friend uint operator*(const uint& a,const uint& b) noexcept {
+                uint result;
+                details::schoolbook<limb_count,false>(a.limbs,b.limbs,result.limbs);
+                return result;
+            }
+            friend uint operator/(uint a,const uint& b) {
+                return a /= b;
+            }
+            friend uint operator%(uint a,const uint& b) {
+                return a %= b;
+            }
+            friend uint operator&(uint a,const uint& b) noexcept {
+                return a &= b;
+            }
+            friend uint operator|(uint a,const uint& b) noexcept {
+                return a |= b;
+            }
+            friend uint operator^(uint a,const uint& b) noexcept {
+                return a ^= b;
+            }
+            friend uint operator~(uint a) noexcept {
+                details::for_each_limb<limb_count>([&](const ::std::size_t i) {
+                    a.limbs[i] = ~a.limbs[i];
+                });
+                return a;
+            }
+            friend uint operator<<(uint a,const ::std::size_t n) noexcept {
+                return a <<= n;
+            }
+            friend uint operator>>(uint a,const ::std::size_t n) noexcept {
+                return a >>= n;
+            }
+
+            /// Equality, in time independent of the values
+            friend bool operator==(const uint& a,const uint& b) noexcept {
+                limb_type difference = 0;
+                details::for_each_limb<limb_count>([&](const ::std::size_t i) {
+                    difference |= a.limbs[i] ^ b.limbs[i];
+                });
+                return 0 == difference;
+            }
+            friend bool operator!=(const uint& a,const uint& b) noexcept {
+                return !(a == b);
+            }
+            /// Ordering, from the borrow of a-b, in time independent of the values
+            friend bool operator<(const uint& a,const uint& b) noexcept {
+                uint difference;
+                return 0 != subtract(a,b,difference);
+            }
+            friend bool operator>(const uint& a,const uint& b) noexcept {
+                return b < a;
+            }
+            friend bool operator<=(const uint& a,const uint& b) noexcept {
+                return !(b < a);
+            }
+            friend bool operator>=(const uint& a,const uint& b) noexcept {
+                return !(a < b);
+            }
+
+            /// Sum with carry out
+            /// @param a first addend
+            /// @param b second addend
+            /// @param sum receives a+b modulo 2^Bits, may alias a or b
+            /// @return carry, 0 or 1
+            friend limb_type add(const uint& a,const uint& b,uint& sum) noexcept {
+                unsigned char carry = 0;
+                details::for_each_limb<limb_count>([&](const ::std::size_t i) {
+                    carry = details::add_carry(carry,a.limbs[i],b.limbs[i],sum.limbs[i]);
+                });
+                return carry;
+            }
+
+            /// Difference with borrow out
+            /// @param a minuend
+            /// @param b subtrahend
+            /// @param difference receives a-b modulo 2^Bits, may alias a or b
+            /// @return borrow, 0 or 1
+            friend limb_type subtract(const uint& a,const uint& b,uint& difference) noexcept {
+                unsigned char borrow = 0;
+                details::for_each_limb<limb_count>([&](const ::std::size_t i) {
+                    borrow = details::sub_borrow(borrow,a.limbs[i],b.limbs[i],difference.limbs[i]);
+                });
+                return borrow;
+            }
+
+            /// Selection without branches nor memory access depending on the condition
+            /// @param condition selector
+            /// @param if_true value returned when condition holds
+            /// @param if_false value returned otherwise
+            /// @return if_true or if_false
+            friend uint conditional_select(const bool condition,const uint& if_true,const uint& if_false) noexcept {
+                const limb_type mask = limb_type {0}-static_cast<limb_type>(condition);
+                uint result;
+                details::for_each_limb<limb_count>([&](const ::std::size_t i) {
+                    result.limbs[i] = (if_true.limbs[i] & mask) | (if_false.limbs[i] & ~mask);
+                });
+                return result;
+            }
+
+            /// Modular sum, in time independent of the values
+            /// @param a first addend, below modulus
+            /// @param b second addend, below modulus
+            /// @param modulus modulus
+            /// @return a+b modulo modulus
+            friend uint add_mod(const uint& a,const uint& b,const uint& modulus) noexcept {
+                uint sum, reduced;
+                const limb_type carry = add(a,b,sum);
+                const limb_type borrow = subtract(sum,modulus,reduced);
+                // the sum is kept only if it did not overflow and is below the modulus
+                return conditional_select(carry < borrow,sum,reduced);
+            }
+
+            /// Modular difference, in time independent of the values
+            /// @param a minuend, below modulus
+            /// @param b subtrahend, below modulus
+            /// @param modulus modulus
+            /// @return a-b modulo modulus
+            friend uint subtract_mod(const uint& a,const uint& b,const uint& modulus) noexcept {
+                uint difference, corrected;
+                const limb_type borrow = subtract(a,b,difference);
+                add(difference,modulus,corrected);
+                return conditional_select(0 != borrow,corrected,difference);
+            }
+
+            /// Number of significant bits, found by the Euclid algorithms
+            /// @param x value
+            /// @return index of the highest bit set plus one, 0 for 0
+            friend unsigned bit_length(const uint& x) noexcept {
+                for (::std::size_t i = limb_count; i-- != 0;) {
+                    if (0 != x.limbs[i]) {
+                        return static_cast<unsigned>(64*i)+utils::bit_length(x.limbs[i]);
+                    }
+                }
+                return 0;
+            }
+
+            /// Number of trailing zero bits, found by the Euclid algorithms
+            /// @param x value, not zero
+            /// @return index of the lowest bit set
+            friend unsigned trailing_zeros(const uint& x) noexcept {
+                for (::std::size_t i = 0; i != limb_count; ++i) {
+                    if (0 != x.limbs[i]) {
+                        return static_cast<unsigned>(64*i)+utils::trailing_zeros(x.limbs[i]);
+                    }
+                }
+                return Bits;
+            }
+
+            /// Division, Knuth's algorithm D
+            /// @param dividend value to divide
+            /// @param divisor value to divide by
+            /// @param quotient receives dividend/divisor
+            /// @param remainder receives dividend%divisor
+            /// @throw std::domain_error on division by zero
+            friend void divide(const uint& dividend,const uint& divisor,uint& quotient,uint& remainder) {
+                ::std::size_t n = limb_count, m = limb_count;
+                while (0 != n && 0 == divisor.limbs[n-1]) {
+                    --n;
+                }
+                while (0 != m && 0 == dividend.limbs[m-1]) {
+                    --m;
+                }
+                if (0 == n) {
+                    throw ::std::domain_error("uint division by zero");
+                }
+                if (m < n) {
+                    remainder = dividend;
+                    quotient = uint {};
+                    return;
+                }
+                uint q;
+                if (1 == n) {
+                    // short division
+                    limb_type rest = 0;
+                    for (::std::size_t j = m; j-- != 0;) {
+                        const utils::uint128_t part = (static_cast<utils::uint128_t>(rest) << 64) | dividend.limbs[j];
+                        q.limbs[j] = static_cast<limb_type>(part/divisor.limbs[0]);
+                        rest = static_cast<limb_type>(part%divisor.limbs[0]);
+                    }
+                    quotient = q;
+                    remainder = uint {rest};
+                    return;
+                }
+
+                // normalize, so that the top limb of the divisor has its top bit set
+                const unsigned shift = 64-utils::bit_length(divisor.limbs[n-1]);
+                core::secure_array<limb_type,limb_count> vn;
+                core::secure_array<limb_type,limb_count+1> un;
+                for (::std::size_t i = n; i-- != 1;) {
+                    vn[i] = 0 == shift ? divisor.limbs[i] : (divisor.limbs[i] << shift) | (divisor.limbs[i-1] >> (64-shift));
+                }
+                vn[0] = divisor.limbs[0] << shift;
+                un[m] = 0 == shift ? 0 : dividend.limbs[m-1] >> (64-shift);
+                for (::std::size_t i = m; i-- != 1;) {
+                    un[i] = 0 == shift ? dividend.limbs[i] : (dividend.limbs[i] << shift) | (dividend.limbs[i-1] >> (64-shift));
+                }
+                un[0] = dividend.limbs[0] << shift;
+
+                constexpr utils::uint128_t base = static_cast<utils::uint128_t>(1) << 64;
+                for (::std::size_t j = m-n+1; j-- != 0;) {
+                    // estimate the quotient limb from the top two limbs, at most two too large
+                    const utils::uint128_t top = (static_cast<utils::uint128_t>(un[j+n]) << 64) | un[j+n-1];
+                    utils::uint128_t qhat = top/vn[n-1];
+                    utils::uint128_t rhat = top%vn[n-1];
+                    while (qhat >= base || qhat*vn[n-2] > ((rhat << 64) | un[j+n-2])) {
+                        --qhat;
+                        rhat += vn[n-1];
+                        if (rhat >= base) {
+                            break;
+                        }
+                    }
+                    // multiply and subtract
+                    utils::int128_t borrow = 0;
+                    for (::std::size_t i = 0; i != n; ++i) {
+                        const utils::uint128_t p = qhat*vn[i];
+                        const utils::int128_t t = static_cast<utils::int128_t>(un[i+j]) - borrow
+                                                  - static_cast<utils::int128_t>(static_cast<limb_type>(p));
+                        un[i+j] = static_cast<limb_type>(t);
+                        borrow = static_cast<utils::int128_t>(p >> 64) - (t >> 64);
+                    }
+                    const utils::int128_t t = static_cast<utils::int128_t>(un[j+n]) - borrow;
+                    un[j+n] = static_cast<limb_type>(t);
+                    q.limbs[j] = static_cast<limb_type>(qhat);
+                    if (t < 0) {
+                        // estimate one too large, add back
+                        --q.limbs[j];
+                        unsigned char carry = 0;
+                        for (::std::size_t i = 0; i != n; ++i) {
+                            carry = details::add_carry(carry,un[i+j],vn[i],un[i+j]);
+                        }
+                        un[j+n] += carry;
+                    }
+                }
+
+                uint r;
+                for (::std::size_t i = 0; i != n; ++i) {
+                    r.limbs[i] = 0 == shift ? un[i] : (un[i] >> shift) | (un[i+1] << (64-shift));
+                }
+                quotient = q;
+                remainder = r;
+            }
+
+        private:
+            limb_type limbs[limb_count];
+        };
+
+        template <::std::size_t Bits>
+        constexpr ::std::size_t uint<Bits>::limb_count;
+
+        /// Full product, twice as wide as the factors
+        /// @param a first factor
+        /// @param b second factor
+        /// @return a*b
+        template <::std::size_t Bits>
+        uint<2*Bits> wide_multiply(const uint<Bits>& a,const uint<Bits>& b) noexcept {
+            uint<2*Bits> result;
+            details::schoolbook<uint<Bits>::limb_count,true>(a.data(),b.data(),result.data());
+            return result;
+        }
+
+    }
+}
+
+namespace std {
+    /// Limits of fixed width integers, as those of built-in unsigned types
+    /// @tparam Bits width
+    template <::std::size_t Bits>
+    struct numeric_limits<::cpp11crypto::arith::uint<Bits>> {
+    public:
+        static constexpr bool is_specialized = true;
+        static constexpr bool is_signed = false;
+        static constexpr bool is_integer = true;
+        static constexpr bool is_exact = true;
+        static constexpr bool is_bounded = true;
+        static constexpr bool is_modulo = true;
+        static constexpr int radix = 2;
+        static constexpr int digits = static_cast<int>(Bits);
+        static ::cpp11crypto::arith::uint<Bits> min() noexcept {
+            return ::cpp11crypto::arith::uint<Bits> {};
+        }
+        static ::cpp11crypto::arith::uint<Bits> max() noexcept {
+            return ~::cpp11crypto::arith::uint<Bits> {};
+        }
+    };
+
+    template <::std::size_t Bits>
+    constexpr bool numeric_limits<::cpp11crypto::arith::uint<Bits>>::is_specialized;
+    template <::std::size_t Bits>
+    constexpr bool numeric_limits<::cpp11crypto::arith::uint<Bits>>::is_signed;
+    template <::std::size_t Bits>
+    constexpr bool numeric_limits<::cpp11crypto::arith::uint<Bits>>::is_integer;
+    template <::std::size_t Bits>
+    constexpr bool numeric_limits<::cpp11crypto::arith::uint<Bits>>::is_exact;
+    template <::std::size_t Bits>
+    constexpr bool numeric_limits<::cpp11crypto::arith::uint<Bits>>::is_bounded;
+    template <::std::size_t Bits>
+    constexpr bool numeric_limits<::cpp11crypto::arith::uint<Bits>>::is_modulo;
+    template <::std::size_t Bits>
+    constexpr int numeric_limits<::cpp11crypto::arith::uint<Bits>>::radix;
+    template <::std::size_t Bits>
+    constexpr int numeric_limits<::cpp11crypto::arith::uint<Bits>>::digits;
+}
+
+#endif // CPP11CRYPTO_ARITH_UINT_HPP
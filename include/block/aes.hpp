@@ -0,0 +1,979 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// block/aes.hpp - AES-128/192/256 block cipher: constant time bitsliced code on
+//                    words or SSE2/AVX2 vectors, AES-NI and VAES kernels, chosen
+//                    once at run time
+
+#ifndef CPP11CRYPTO_BLOCK_AES_HPP
+#define CPP11CRYPTO_BLOCK_AES_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include "core/secure_array.hpp"
+#include "core/zeroizing.hpp"
+#include "utils/cpu_features.hpp"
+#include "utils/endian.hpp"
+#include "utils/span.hpp"
+
+namespace cpp11crypto {
+    namespace block {
+
+        /// AES implementations
+        enum class aes_engine {
+            /// Portable bitsliced code on 64-bit words, four blocks at a time, in
+            /// constant time: no table nor memory access depends on keys or data
+            bitsliced,
+            /// The same bitsliced code on two 64-bit lanes of SSE2 registers, eight
+            /// blocks at a time, for processors without AES-NI
+            bitsliced_sse2,
+            /// The same bitsliced code on four 64-bit lanes of AVX2 registers, sixteen
+            /// blocks at a time, for processors without AES-NI
+            bitsliced_avx2,
+            /// AES-NI, one round per instruction, eight blocks interleaved
+            aesni,
+            /// VAES on 512-bit vectors, four blocks per instruction, sixteen interleaved
+            vaes
+        };
+
+        /// Tells whether an AES implementation can run on this processor
+        /// @param engine implementation to check
+        /// @return true if usable
+        inline bool is_supported(const aes_engine engine) noexcept {
+            switch (engine) {
+            case aes_engine::bitsliced:
+                return true;
+            case aes_engine::bitsliced_sse2:
+                return utils::cpu().sse2;
+            case aes_engine::bitsliced_avx2:
+                return utils::cpu().avx2;
+            case aes_engine::aesni:
+                return utils::cpu().aes;
+            case aes_engine::vaes:
+                return utils::cpu().aes && utils::cpu().vaes && utils::cpu().avx512f;
+            }
+            return false;
+        }
+
+        /// Fastest AES implementation usable on this processor, selected once; without
+        /// AES-NI, the widest bitsliced one
+        /// @return selected implementation
+        inline aes_engine best_aes_engine() noexcept {
+            static const aes_engine engine =
+                is_supported(aes_engine::vaes) ? aes_engine::vaes
+                : is_supported(aes_engine::aesni) ? aes_engine::aesni
+                : is_supported(aes_engine::bitsliced_avx2) ? aes_engine::bitsliced_avx2
+                : is_supported(aes_engine::bitsliced_sse2) ? aes_engine::bitsliced_sse2
+                : aes_engine::bitsliced;
+            return engine;
+        }
+
+        namespace details {
+
+            // Bitsliced AES after Pornin's ct64 layout: eight words q[0..7] hold bit i of
+            // every state byte in q[i], four blocks per 64-bit word. The S-box is the
+            // 113 gate circuit of Boyar and Peralta. Words are 64-bit integers or vectors
+            // of them, each lane being an independent state.
+
+            /// Forward S-box on every byte of the state
+            template <typename W>
+            CPP11CRYPTO_ALWAYS_INLINE void sbox(W * const q) noexcept {
+                const W x0 = q[7], x1 = q[6], x2 = q[5], x3 = q[4], x4 = q[3], x5 = q[2], x6 = q[1], x7 = q[0];
+                // top linear transformation
+                const W y14 = x3 ^ x5, y13 = x0 ^ x6, y9 = x0 ^ x3, y8 = x0 ^ x5, t0 = x1 ^ x2;
+                const W y1 = t0 ^ x7, y4 = y1 ^ x3, y12 = y13 ^ y14, y2 = y1 ^ x0, y5 = y1 ^ x6;
+                const W y3 = y5 ^ y8, t1 = x4 ^ y12, y15 = t1 ^ x5, y20 = t1 ^ x1, y6 = y15 ^ x7;
+                const W y10 = y15 ^ t0, y11 = y20 ^ y9, y7 = x7 ^ y11, y17 = y10 ^ y11, y19 = y10 ^ y8;
+                const W y16 = t0 ^ y11, y21 = y13 ^ y16, y18 = x0 ^ y16;
+                // non-linear section, inversion in GF(2^8)
+                const W t2 = y12 & y15, t3 = y3 & y6, t4 = t3 ^ t2, t5 = y4 & x7, t6 = t5 ^ t2;
+                const W t7 = y13 & y16, t8 = y5 & y1, t9 = t8 ^ t7, t10 = y2 & y7, t11 = t10 ^ t7;
+                const W t12 = y9 & y11, t13 = y14 & y17, t14 = t13 ^ t12, t15 = y8 & y10, t16 = t15 ^ t12;
+                const W t17 = t4 ^ t14, t18 = t6 ^ t16, t19 = t9 ^ t14, t20 = t11 ^ t16;
+                const W t21 = t17 ^ y20, t22 = t18 ^ y19, t23 = t19 ^ y21, t24 = t20 ^ y18;
+                const W t25 = t21 ^ t22, t26 = t21 & t23, t27 = t24 ^ t26, t28 = t25 & t27, t29 = t28 ^ t22;
+                const W t30 = t23 ^ t24, t31 = t22 ^ t26, t32 = t31 & t30, t33 = t32 ^ t24, t34 = t23 ^ t33;
+                const W t35 = t27 ^ t33, t36 = t24 & t35, t37 = t36 ^ t34, t38 = t27 ^ t36, t39 = t29 & t38;
+                const W t40 = t25 ^ t39, t41 = t40 ^ t37, t42 = t29 ^ t33, t43 = t29 ^ t40, t44 = t33 ^ t37;
+                const W t45 = t42 ^ t41;
+                const W z0 = t44 & y15, z1 = t37 & y6, z2 = t33 & x7, z3 = t43 & y16, z4 = t40 & y1;
+                const W z5 = t29 & y7, z6 = t42 & y11, z7 = t45 & y17, z8 = t41 & y10, z9 = t44 & y12;
+                const W z10 = t37 & y3, z11 = t33 & y4, z12 = t43 & y13, z13 = t40 & y5, z14 = t29 & y2;
+                const W z15 = t42 & y9, z16 = t45 & y14, z17 = t41 & y8;
+                // bottom linear transformation
+                const W t46 = z15 ^ z16, t47 = z10 ^ z11, t48 = z5 ^ z13, t49 = z9 ^ z10, t50 = z2 ^ z12;
+                const W t51 = z2 ^ z5, t52 = z7 ^ z8, t53 = z0 ^ z3, t54 = z6 ^ z7, t55 = z16 ^ z17;
+                const W t56 = z12 ^ t48, t57 = t50 ^ t53, t58 = z4 ^ t46, t59 = z3 ^ t54, t60 = t46 ^ t57;
+                const W t61 = z14 ^ t57, t62 = t52 ^ t58, t63 = t49 ^ t58, t64 = z4 ^ t59, t65 = t61 ^ t62;
+                const W t66 = z1 ^ t63, t67 = t64 ^ t65;
+                const W s3 = t53 ^ t66;
+                q[7] = t59 ^ t63;
+                q[6] = t64 ^ ~s3;
+                q[5] = t55 ^ ~t67;
+                q[4] = s3;
+                q[3] = t51 ^ t66;
+                q[2] = t47 ^ t65;
+                q[1] = t56 ^ ~t62;
+                q[0] = t48 ^ ~t60;
+            }
+
+            /// Inverse of the affine map of the S-box, which turns it into its inverse
+            template <typename W>
+            CPP11CRYPTO_ALWAYS_INLINE void inverse_affine(W * const q) noexcept {
+                const W q0 = ~q[0], q1 = ~q[1], q2 = q[2], q3 = q[3], q4 = q[4], q5 = ~q[5], q6 = ~q[6], q7 = q[7];
+                q[7] = q1 ^ q4 ^ q6;
+                q[6] = q0 ^ q3 ^ q5;
+                q[5] = q7 ^ q2 ^ q4;
+                q[4] = q6 ^ q1 ^ q3;
+                q[3] = q5 ^ q0 ^ q2;
+                q[2] = q4 ^ q7 ^ q1;
+                q[1] = q3 ^ q6 ^ q0;
+                q[0] = q2 ^ q5 ^ q7;
+            }
+
+            /// Inverse S-box: inverse affine map, inversion and affine map of the
+            /// forward S-box, inverse affine map again
+            template <typename W>
+            CPP11CRYPTO_ALWAYS_INLINE void inverse_sbox(W * const q) noexcept {
+                inverse_affine(q);
+                sbox(q);
+                inverse_affine(q);
+            }
+
+            /// Exchanges bit groups between two words
+            template <typename W>
+            CPP11CRYPTO_ALWAYS_INLINE void swap_bits(W& x,W& y,const ::std::uint64_t low,const ::std::uint64_t high,const unsigned shift) noexcept {
+                const W a = x, b = y;
+                x = (a & low) | ((b & low) << shift);
+                y = ((a & high) >> shift) | (b & high);
+            }
+
+            /// Transposition between the interleaved bytes of four blocks and the bit
+            /// planes, its own inverse
+            template <typename W>
+            CPP11CRYPTO_ALWAYS_INLINE void orthogonalize(W * const q) noexcept {
+                for (unsigned i = 0; i != 8; i += 2) {
+                    swap_bits(q[i],q[i+1],0x5555555555555555ULL,0xaaaaaaaaaaaaaaaaULL,1);
+                }
+                for (unsigned i = 0; i != 8; i += 4) {
+                    swap_bits(q[i],q[i+2],0x3333333333333333ULL,0xccccccccccccccccULL,2);
+                    swap_bits(q[i+1],q[i+3],0x3333333333333333ULL,0xccccccccccccccccULL,2);
+                }
+                for (unsigned i = 0; i != 4; ++i) {
+                    swap_bits(q[i],q[i+4],0x0f0f0f0f0f0f0f0fULL,0xf0f0f0f0f0f0f0f0ULL,4);
+                }
+            }
+
+            /// Spreads the four words of a block over two 64-bit words, byte by byte
+            inline void interleave_in(::std::uint64_t& q0,::std::uint64_t& q1,const ::std::uint32_t * const w) noexcept {
+                ::std::uint64_t x[4];
+                for (unsigned i = 0; i != 4; ++i) {
+                    x[i] = w[i];
+                    x[i] = (x[i] | (x[i] << 16)) & 0x0000ffff0000ffffULL;
+                    x[i] = (x[i] | (x[i] << 8)) & 0x00ff00ff00ff00ffULL;
+                }
+                q0 = x[0] | (x[2] << 8);
+                q1 = x[1] | (x[3] << 8);
+            }
+            /// Inverse of @ref interleave_in
+            inline void interleave_out(::std::uint32_t * const w,const ::std::uint64_t q0,const ::std::uint64_t q1) noexcept {
+                ::std::uint64_t x[4] = {q0 & 0x00ff00ff00ff00ffULL,q1 & 0x00ff00ff00ff00ffULL,
+                                        (q0 >> 8) & 0x00ff00ff00ff00ffULL,(q1 >> 8) & 0x00ff00ff00ff00ffULL};
+                for (unsigned i = 0; i != 4; ++i) {
+                    x[i] = (x[i] | (x[i] >> 8)) & 0x0000ffff0000ffffULL;
+                    w[i] = static_cast<::std::uint32_t>(x[i]) | static_cast<::std::uint32_t>(x[i] >> 16);
+                }
+            }
+
+            template <typename W>
+            CPP11CRYPTO_ALWAYS_INLINE void shift_rows(W * const q) noexcept {
+                for (unsigned i = 0; i != 8; ++i) {
+                    const W x = q[i];
+                    q[i] = (x & 0x000000000000ffffULL) | ((x & 0x00000000fff00000ULL) >> 4)
+                           | ((x & 0x00000000000f0000ULL) << 12) | ((x & 0x0000ff0000000000ULL) >> 8)
+                           | ((x & 0x000000ff00000000ULL) << 8) | ((x & 0xf000000000000000ULL) >> 12)
+                           | ((x & 0x0fff000000000000ULL) << 4);
+                }
+            }
+            template <typename W>
+            CPP11CRYPTO_ALWAYS_INLINE void inverse_shift_rows(W * const q) noexcept {
+                for (unsigned i = 0; i != 8; ++i) {
+                    const W x = q[i];
+                    q[i] = (x & 0x000000000000ffffULL) | ((x & 0x000000000fff0000ULL) << 4)
+                           | ((x & 0x00000000f0000000ULL) >> 12) | ((x & 0x000000ff00000000ULL) << 8)
+                           | ((x & 0x0000ff0000000000ULL) >> 8) | ((x & 0x000f000000000000ULL) << 12)
+                           | ((x & 0xfff0000000000000ULL) >> 4);
+                }
+            }
+
+            /// Rotations of each 64-bit lane, by one row and by two, in place: vector
+            /// words never go by value through a call, whose ABI would depend on the
+            /// instruction set
+            template <typename W>
+            CPP11CRYPTO_ALWAYS_INLINE void rotate16(W& x) noexcept {
+                x = (x >> 16) | (x << 48);
+            }
+            template <typename W>
+            CPP11CRYPTO_ALWAYS_INLINE void rotate32(W& x) noexcept {
+                x = (x >> 32) | (x << 32);
+            }
+
+            template <typename W>
+            CPP11CRYPTO_ALWAYS_INLINE void mix_columns(W * const q) noexcept {
+                W x[8], r[8], t[8];
+                for (unsigned i = 0; i != 8; ++i) {
+                    x[i] = r[i] = q[i];
+                    rotate16(r[i]);
+                    t[i] = x[i] ^ r[i];
+                    rotate32(t[i]);
+                }
+                q[0] = x[7] ^ r[7] ^ r[0] ^ t[0];
+                q[1] = x[0] ^ r[0] ^ x[7] ^ r[7] ^ r[1] ^ t[1];
+                q[2] = x[1] ^ r[1] ^ r[2] ^ t[2];
+                q[3] = x[2] ^ r[2] ^ x[7] ^ r[7] ^ r[3] ^ t[3];
+                q[4] = x[3] ^ r[3] ^ x[7] ^ r[7] ^ r[4] ^ t[4];
+                q[5] = x[4] ^ r[4] ^ r[5] ^ t[5];
+                q[6] = x[5] ^ r[5] ^ r[6] ^ t[6];
+                q[7] = x[6] ^ r[6] ^ r[7] ^ t[7];
+            }
+            template <typename W>
+            CPP11CRYPTO_ALWAYS_INLINE void inverse_mix_columns(W * const q) noexcept {
+                W x[8], r[8];
+                for (unsigned i = 0; i != 8; ++i) {
+                    x[i] = r[i] = q[i];
+                    rotate16(r[i]);
+                }
+                W t[8] = {x[0] ^ x[5] ^ x[6] ^ r[0] ^ r[5],
+                          x[1] ^ x[5] ^ x[7] ^ r[1] ^ r[5] ^ r[6],
+                          x[0] ^ x[2] ^ x[6] ^ r[2] ^ r[6] ^ r[7],
+                          x[0] ^ x[1] ^ x[3] ^ x[5] ^ x[6] ^ x[7] ^ r[0] ^ r[3] ^ r[5] ^ r[7],
+                          x[1] ^ x[2] ^ x[4] ^ x[5] ^ x[7] ^ r[1] ^ r[4] ^ r[5] ^ r[6],
+                          x[2] ^ x[3] ^ x[5] ^ x[6] ^ r[2] ^ r[5] ^ r[6] ^ r[7],
+                          x[3] ^ x[4] ^ x[6] ^ x[7] ^ r[3] ^ r[6] ^ r[7],
+                          x[4] ^ x[5] ^ x[7] ^ r[4] ^ r[7]};
+                for (unsigned i = 0; i != 8; ++i) {
+                    rotate32(t[i]);
+                }
+                q[0] = x[5] ^ x[6] ^ x[7] ^ r[0] ^ r[5] ^ r[7] ^ t[0];
+                q[1] = x[0] ^ x[5] ^ r[0] ^ r[1] ^ r[5] ^ r[6] ^ r[7] ^ t[1];
+                q[2] = x[0] ^ x[1] ^ x[6] ^ r[1] ^ r[2] ^ r[6] ^ r[7] ^ t[2];
+                q[3] = x[0] ^ x[1] ^ x[2] ^ x[5] ^ x[6] ^ r[0] ^ r[2] ^ r[3] ^ r[5] ^ t[3];
+                q[4] = x[1] ^ x[2] ^ x[3] ^ x[5] ^ r[1] ^ r[3] ^ r[4] ^ r[5] ^ r[6] ^ r[7] ^ t[4];
+                q[5] = x[2] ^ x[3] ^ x[4] ^ x[6] ^ r[2] ^ r[4] ^ r[5] ^ r[6] ^ r[7] ^ t[5];
+                q[6] = x[3] ^ x[4] ^ x[5] ^ x[7] ^ r[3] ^ r[5] ^ r[6] ^ r[7] ^ t[6];
+                q[7] = x[4] ^ x[5] ^ x[6] ^ r[4] ^ r[6] ^ r[7] ^ t[7];
+            }
+
+            template <typename W>
+            CPP11CRYPTO_ALWAYS_INLINE void add_round_key(W * const q,const ::std::uint64_t * const key) noexcept {
+                for (unsigned i = 0; i != 8; ++i) {
+                    q[i] ^= key[i];
+                }
+            }
+
+            /// Bitsliced encryption of the states in q
+            /// @param q states, as bit planes
+            /// @param keys rounds+1 bitsliced round keys of 8 words
+            /// @param rounds number of rounds
+            template <typename W>
+            CPP11CRYPTO_ALWAYS_INLINE void encrypt_bitsliced(W * const q,const ::std::uint64_t * const keys,const unsigned rounds) noexcept {
+                add_round_key(q,keys);
+                for (unsigned round = 1; round != rounds; ++round) {
+                    sbox(q);
+                    shift_rows(q);
+                    mix_columns(q);
+                    add_round_key(q,keys+8*round);
+                }
+                sbox(q);
+                shift_rows(q);
+                add_round_key(q,keys+8*rounds);
+            }
+            /// Bitsliced decryption of the states in q, with the encryption round keys
+            template <typename W>
+            CPP11CRYPTO_ALWAYS_INLINE void decrypt_bitsliced(W * const q,const ::std::uint64_t * const keys,const unsigned rounds) noexcept {
+                add_round_key(q,keys+8*rounds);
+                for (unsigned round = rounds-1; round != 0; --round) {
+                    inverse_shift_rows(q);
+                    inverse_sbox(q);
+                    add_round_key(q,keys+8*round);
+                    inverse_mix_columns(q);
+                }
+                inverse_shift_rows(q);
+                inverse_sbox(q);
+                add_round_key(q,keys);
+            }
+
+            /// Up to four blocks interleaved into eight words, missing blocks being zero
+            inline void interleave_blocks(::std::uint64_t * const q,const ::std::uint8_t * const in,const ::std::size_t blocks) noexcept {
+                for (unsigned i = 0; i != 4; ++i) {
+                    ::std::uint32_t w[4] = {};
+                    for (unsigned j = 0; i < blocks && j != 4; ++j) {
+                        w[j] = utils::load32le(in+16*i+4*j);
+                    }
+                    interleave_in(q[i],q[i+4],w);
+                }
+            }
+            /// Inverse of @ref interleave_blocks, for the first blocks only
+            inline void deinterleave_blocks(::std::uint8_t * const out,const ::std::uint64_t * const q,const ::std::size_t blocks) noexcept {
+                for (unsigned i = 0; i < blocks && i != 4; ++i) {
+                    ::std::uint32_t w[4];
+                    interleave_out(w,q[i],q[i+4]);
+                    for (unsigned j = 0; j != 4; ++j) {
+                        utils::store32le(out+16*i+4*j,w[j]);
+                    }
+                }
+            }
+
+            /// Up to four blocks into bit planes, missing blocks being zero
+            inline void load_bitsliced(::std::uint64_t * const q,const ::std::uint8_t * const in,const ::std::size_t blocks) noexcept {
+                interleave_blocks(q,in,blocks);
+                orthogonalize(q);
+            }
+            /// Bit planes back into up to four blocks
+            inline void store_bitsliced(::std::uint8_t * const out,::std::uint64_t * const q,const ::std::size_t blocks) noexcept {
+                orthogonalize(q);
+                deinterleave_blocks(out,q,blocks);
+            }
+
+            /// S-box on the four bytes of a word, in constant time, for key schedules
+            inline ::std::uint32_t sub_word(const ::std::uint32_t x) noexcept {
+                ::std::uint64_t q[8] = {x};
+                orthogonalize(q);
+                sbox(q);
+                orthogonalize(q);
+                return static_cast<::std::uint32_t>(q[0]);
+            }
+
+            /// Key expansion of FIPS 197
+            /// @param key key bytes
+            /// @param nk key words, 4, 6 or 8
+            /// @param w receives the 4*(nk+7) words of the round keys
+            inline void expand_key(const ::std::uint8_t * const key,const unsigned nk,::std::uint32_t * const w) noexcept {
+                static const ::std::uint8_t rcon[10] = {0x01,0x02,0x04,0x08,0x10,0x20,0x40,0x80,0x1b,0x36};
+                for (unsigned i = 0; i != nk; ++i) {
+                    w[i] = utils::load32le(key+4*i);
+                }
+                ::std::uint32_t t = w[nk-1];
+                for (unsigned i = nk; i != 4*(nk+7); ++i) {
+                    if (0 == i%nk) {
+                        t = sub_word((t << 24) | (t >> 8)) ^ rcon[i/nk-1];
+                    } else if (nk > 6 && 4 == i%nk) {
+                        t = sub_word(t);
+                    }
+                    t ^= w[i-nk];
+                    w[i] = t;
+                }
+            }
+
+            /// Round keys as bit planes, the same key in all four blocks of a word
+            /// @param w round key words
+            /// @param rounds number of rounds
+            /// @param keys receives 8*(rounds+1) words
+            inline void slice_keys(const ::std::uint32_t * const w,const unsigned rounds,::std::uint64_t * const keys) noexcept {
+                for (unsigned round = 0; round <= rounds; ++round) {
+                    ::std::uint64_t * const q = keys+8*round;
+                    interleave_in(q[0],q[4],w+4*round);
+                    q[1] = q[2] = q[3] = q[0];
+                    q[5] = q[6] = q[7] = q[4];
+                    orthogonalize(q);
+                }
+            }
+
+            /// Portable bitsliced encryption, four blocks at a time
+            inline void encrypt_portable(const ::std::uint64_t * const keys,const unsigned rounds,
+                                         const ::std::uint8_t * in,::std::uint8_t * out,::std::size_t blocks) noexcept {
+                for (; 0 != blocks; in += 64, out += 64) {
+                    const ::std::size_t n = ::std::min<::std::size_t>(blocks,4);
+                    ::std::uint64_t q[8];
+                    load_bitsliced(q,in,n);
+                    encrypt_bitsliced(q,keys,rounds);
+                    store_bitsliced(out,q,n);
+                    blocks -= n;
+                }
+            }
+            /// Portable bitsliced decryption, four blocks at a time
+            inline void decrypt_portable(const ::std::uint64_t * const keys,const unsigned rounds,
+                                         const ::std::uint8_t * in,::std::uint8_t * out,::std::size_t blocks) noexcept {
+                for (; 0 != blocks; in += 64, out += 64) {
+                    const ::std::size_t n = ::std::min<::std::size_t>(blocks,4);
+                    ::std::uint64_t q[8];
+                    load_bitsliced(q,in,n);
+                    decrypt_bitsliced(q,keys,rounds);
+                    store_bitsliced(out,q,n);
+                    blocks -= n;
+                }
+            }
+
+#ifdef CPP11CRYPTO_X86_INTRINSICS
+            /// Two and four 64-bit lanes, each holding the bit planes of four blocks
+            typedef ::std::uint64_t sliced_x2 __attribute__((vector_size(16)));
+            typedef ::std::uint64_t sliced_x4 __attribute__((vector_size(32)));
+
+            /// Bitsliced encryption or decryption on vector words, 4*lanes blocks at a
+            /// time. Blocks are interleaved one lane at a time, then every lane is
+            /// transposed at once; round keys are the scalar ones, broadcast.
+            template <bool Decrypt,typename W>
+            CPP11CRYPTO_ALWAYS_INLINE void crypt_lanes(const ::std::uint64_t * const keys,const unsigned rounds,
+                                                       const ::std::uint8_t * in,::std::uint8_t * out,::std::size_t blocks) noexcept {
+                constexpr unsigned lanes = sizeof(W)/8;
+                for (; 0 != blocks; in += 64*lanes, out += 64*lanes) {
+                    const ::std::size_t n = ::std::min<::std::size_t>(blocks,4*lanes);
+                    W q[8];
+                    for (unsigned lane = 0; lane != lanes; ++lane) {
+                        ::std::uint64_t x[8];
+                        interleave_blocks(x,in+64*lane,n > 4*lane ? n-4*lane : 0);
+                        for (unsigned i = 0; i != 8; ++i) {
+                            q[i][lane] = x[i];
+                        }
+                    }
+                    orthogonalize(q);
+                    if (Decrypt) {
+                        decrypt_bitsliced(q,keys,rounds);
+                    } else {
+                        encrypt_bitsliced(q,keys,rounds);
+                    }
+                    orthogonalize(q);
+                    for (unsigned lane = 0; lane != lanes && n > 4*lane; ++lane) {
+                        ::std::uint64_t x[8];
+                        for (unsigned i = 0; i != 8; ++i) {
+                            x[i] = q[i][lane];
+                        }
+                        deinterleave_blocks(out+64*lane,x,n-4*lane);
+                    }
+                    blocks -= n;
+                }
+            }
+
+            /// Bitsliced code on SSE2 registers, eight blocks at a time
+            template <bool Decrypt>
+            __attribute__((target("sse2")))
+            inline void crypt_bitsliced_sse2(const ::std::uint64_t * const keys,const unsigned rounds,
+                                             const ::std::uint8_t * const in,::std::uint8_t * const out,
+                                             const ::std::size_t blocks) noexcept {
+                crypt_lanes<Decrypt,sliced_x2>(keys,rounds,in,out,blocks);
+            }
+            /// Bitsliced code on AVX2 registers, sixteen blocks at a time
+            template <bool Decrypt>
+            __attribute__((target("avx2")))
+            inline void crypt_bitsliced_avx2(const ::std::uint64_t * const keys,const unsigned rounds,
+                                             const ::std::uint8_t * const in,::std::uint8_t * const out,
+                                             const ::std::size_t blocks) noexcept {
+                crypt_lanes<Decrypt,sliced_x4>(keys,rounds,in,out,blocks);
+            }
+
+            /// Decryption round keys of the equivalent inverse cipher: reversed order,
+            /// InvMixColumns on the inner ones
+            __attribute__((target("aes")))
+            inline void inverse_keys_aesni(const ::std::uint8_t * const encryption,::std::uint8_t * const decryption,
+                                           const unsigned rounds) noexcept {
+                const __m128i * const e = reinterpret_cast<const __m128i *>(encryption);
+                __m128i * const d = reinterpret_cast<__m128i *>(decryption);
+                _mm_store_si128(d,_mm_load_si128(e+rounds));
+                for (unsigned i = 1; i != rounds; ++i) {
+                    _mm_store_si128(d+i,_mm_aesimc_si128(_mm_load_si128(e+rounds-i)));
+                }
+                _mm_store_si128(d+rounds,_mm_load_si128(e));
+            }
+
+            /// AES-NI encryption or decryption, eight independent blocks in flight to
+            /// cover the latency of the rounds, then one at a time
+            /// @param keys rounds+1 round keys, 16-byte aligned, decryption ones to decrypt
+            template <bool Decrypt>
+            __attribute__((target("aes")))
+            inline void crypt_aesni(const ::std::uint8_t * const keys,const unsigned rounds,
+                                    const ::std::uint8_t * in,::std::uint8_t * out,::std::size_t blocks) noexcept {
+                const __m128i * const k = reinterpret_cast<const __m128i *>(keys);
+                for (; blocks >= 8; blocks -= 8, in += 128, out += 128) {
+                    __m128i x[8];
+                    const __m128i k0 = _mm_load_si128(k);
+                    for (unsigned i = 0; i != 8; ++i) {
+                        x[i] = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in)+i),k0);
+                    }
+                    for (unsigned round = 1; round != rounds; ++round) {
+                        const __m128i kr = _mm_load_si128(k+round);
+                        for (unsigned i = 0; i != 8; ++i) {
+                            x[i] = Decrypt ? _mm_aesdec_si128(x[i],kr) : _mm_aesenc_si128(x[i],kr);
+                        }
+                    }
+                    const __m128i kl = _mm_load_si128(k+rounds);
+                    for (unsigned i = 0; i != 8; ++i) {
+                        x[i] = Decrypt ? _mm_aesdeclast_si128(x[i],kl) : _mm_aesenclast_si128(x[i],kl);
+                        _mm_storeu_si128(reinterpret_cast<__m128i *>(out)+i,x[i]);
+                    }
+                }
+                for (; 0 != blocks; --blocks, in += 16, out += 16) {
+                    __m128i x = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in)),_mm_load_si128(k));
+                    for (unsigned round = 1; round != rounds; ++round) {
+                        x = Decrypt ? _mm_aesdec_si128(x,_mm_load_si128(k+round)) : _mm_aesenc_si128(x,_mm_load_si128(k+round));
+                    }
+                    x = Decrypt ? _mm_aesdeclast_si128(x,_mm_load_si128(k+rounds)) : _mm_aesenclast_si128(x,_mm_load_si128(k+rounds));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(out),x);
+                }
+            }
+
+            /// VAES encryption or decryption: four 512-bit vectors of four blocks each in
+            /// flight, then single vectors, the last blocks going through AES-NI
+            template <bool Decrypt>
+            __attribute__((target("aes,vaes,avx512f")))
+            inline void crypt_vaes(const ::std::uint8_t * const keys,const unsigned rounds,
+                                   const ::std::uint8_t * in,::std::uint8_t * out,::std::size_t blocks) noexcept {
+                __m512i k[15];
+                for (unsigned round = 0; round <= rounds; ++round) {
+                    // the zero-masking form keeps GCC 12 from warning about the undefined pass-through operand
+                    k[round] = _mm512_maskz_broadcast_i32x4(static_cast<__mmask16>(0xffff),
+                                                            _mm_load_si128(reinterpret_cast<const __m128i *>(keys)+round));
+                }
+                for (; blocks >= 16; blocks -= 16, in += 256, out += 256) {
+                    __m512i x[4];
+                    for (unsigned i = 0; i != 4; ++i) {
+                        x[i] = _mm512_xor_si512(_mm512_loadu_si512(in+64*i),k[0]);
+                    }
+                    for (unsigned round = 1; round != rounds; ++round) {
+                        for (unsigned i = 0; i != 4; ++i) {
+                            x[i] = Decrypt ? _mm512_aesdec_epi128(x[i],k[round]) : _mm512_aesenc_epi128(x[i],k[round]);
+                        }
+                    }
+                    for (unsigned i = 0; i != 4; ++i) {
+                        x[i] = Decrypt ? _mm512_aesdeclast_epi128(x[i],k[rounds]) : _mm512_aesenclast_epi128(x[i],k[rounds]);
+                        _mm512_storeu_si512(out+64*i,x[i]);
+                    }
+                }
+                for (; blocks >= 4; blocks -= 4, in += 64, out += 64) {
+                    __m512i x = _mm512_xor_si512(_mm512_loadu_si512(in),k[0]);
+                    for (unsigned round = 1; round != rounds; ++round) {
+                        x = Decrypt ? _mm512_aesdec_epi128(x,k[round]) : _mm512_aesenc_epi128(x,k[round]);
+                    }
+                    x = Decrypt ? _mm512_aesdeclast_epi128(x,k[rounds]) : _mm512_aesenclast_epi128(x,k[rounds]);
+                    _mm512_storeu_si512(out,x);
+                }
+                core::do_zeroize(k,sizeof k);
+                crypt_aesni<Decrypt>(keys,rounds,in,out,blocks);
+            }
+
+            /// Next XTS tweak in a register, multiplication by x in GF(2^128), little
+            /// endian: every 32-bit lane doubles and takes the bit shifted out of the
+            /// lane below, the one out of the top lane coming back as 0x87
+            __attribute__((target("sse2")))
+            inline __m128i xts_double(const __m128i t) noexcept {
+                const __m128i carries = _mm_shuffle_epi32(_mm_srai_epi32(t,31),0x93);
+                return _mm_xor_si128(_mm_add_epi32(t,t),_mm_and_si128(carries,_mm_set_epi32(1,1,1,0x87)));
+            }
+
+            /// Multiplication by x^4 of the tweaks in the four 128-bit lanes of a vector:
+            /// each 64-bit half shifts by four, the bits leaving the low half go to the
+            /// high one, those leaving the block come back multiplied by 0x87. Zero-masking
+            /// forms throughout, as in crypt_vaes.
+            __attribute__((target("avx512f")))
+            inline __m512i xts_times_x4(const __m512i t) noexcept {
+                const __mmask8 all = 0xff;
+                const __m512i carries = _mm512_maskz_shuffle_epi32(static_cast<__mmask16>(0xffff),
+                                                                   _mm512_maskz_srli_epi64(all,t,60),_MM_PERM_BADC);
+                const __m512i reduced = _mm512_xor_si512(_mm512_ternarylogic_epi64(carries,_mm512_maskz_slli_epi64(all,carries,1),
+                                                                                   _mm512_maskz_slli_epi64(all,carries,2),0x96),
+                                                         _mm512_maskz_slli_epi64(all,carries,7));
+                return _mm512_xor_si512(_mm512_maskz_slli_epi64(all,t,4),_mm512_mask_mov_epi64(carries,0x55,reduced));
+            }
+
+            /// AES-NI XTS on whole blocks, eight in flight: the tweaks are doubled in a
+            /// register and folded into the first and last round keys, so that masking
+            /// a block costs no pass over memory
+            /// @param keys rounds+1 round keys, 16-byte aligned, decryption ones to decrypt
+            /// @param tweak tweak of the first block, little endian; receives the next one
+            template <bool Decrypt>
+            __attribute__((target("aes")))
+            inline void xts_aesni(const ::std::uint8_t * const keys,const unsigned rounds,::std::uint8_t * const tweak,
+                                  const ::std::uint8_t * in,::std::uint8_t * out,::std::size_t blocks) noexcept {
+                const __m128i * const k = reinterpret_cast<const __m128i *>(keys);
+                const __m128i k0 = _mm_load_si128(k), kl = _mm_load_si128(k+rounds);
+                __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i *>(tweak));
+                for (; blocks >= 8; blocks -= 8, in += 128, out += 128) {
+                    __m128i x[8], m[8];
+                    for (unsigned i = 0; i != 8; ++i) {
+                        m[i] = t;
+                        t = xts_double(t);
+                        x[i] = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in)+i),_mm_xor_si128(m[i],k0));
+                    }
+                    for (unsigned round = 1; round != rounds; ++round) {
+                        const __m128i kr = _mm_load_si128(k+round);
+                        for (unsigned i = 0; i != 8; ++i) {
+                            x[i] = Decrypt ? _mm_aesdec_si128(x[i],kr) : _mm_aesenc_si128(x[i],kr);
+                        }
+                    }
+                    for (unsigned i = 0; i != 8; ++i) {
+                        const __m128i last = _mm_xor_si128(kl,m[i]);
+                        x[i] = Decrypt ? _mm_aesdeclast_si128(x[i],last) : _mm_aesenclast_si128(x[i],last);
+                        _mm_storeu_si128(reinterpret_cast<__m128i *>(out)+i,x[i]);
+                    }
+                }
+                for (; 0 != blocks; --blocks, in += 16, out += 16) {
+                    __m128i x = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in)),_mm_xor_si128(t,k0));
+                    for (unsigned round = 1; round != rounds; ++round) {
+                        x = Decrypt ? _mm_aesdec_si128(x,_mm_load_si128(k+round)) : _mm_aesenc_si128(x,_mm_load_si128(k+round));
+                    }
+                    const __m128i last = _mm_xor_si128(kl,t);
+                    x = Decrypt ? _mm_aesdeclast_si128(x,last) : _mm_aesenclast_si128(x,last);
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(out),x);
+                    t = xts_double(t);
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(tweak),t);
+            }
+
+            /// VAES XTS on whole blocks: four vectors of four consecutive tweaks, each
+            /// vector moving on by x^4 per lane, the last blocks going through AES-NI
+            template <bool Decrypt>
+            __attribute__((target("aes,vaes,avx512f")))
+            inline void xts_vaes(const ::std::uint8_t * const keys,const unsigned rounds,::std::uint8_t * const tweak,
+                                 const ::std::uint8_t * in,::std::uint8_t * out,::std::size_t blocks) noexcept {
+                if (blocks >= 4) {
+                    __m512i k[15];
+                    for (unsigned round = 0; round <= rounds; ++round) {
+                        k[round] = _mm512_maskz_broadcast_i32x4(static_cast<__mmask16>(0xffff),
+                                                                _mm_load_si128(reinterpret_cast<const __m128i *>(keys)+round));
+                    }
+                    const __m128i t0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(tweak));
+                    const __m128i t1 = xts_double(t0), t2 = xts_double(t1);
+                    __m512i t = _mm512_inserti32x4(_mm512_inserti32x4(_mm512_inserti32x4(_mm512_castsi128_si512(t0),t1,1),t2,2),
+                                                   xts_double(t2),3);
+                    for (; blocks >= 16; blocks -= 16, in += 256, out += 256) {
+                        __m512i x[4], m[4];
+                        for (unsigned i = 0; i != 4; ++i) {
+                            m[i] = t;
+                            t = xts_times_x4(t);
+                            x[i] = _mm512_ternarylogic_epi64(_mm512_loadu_si512(in+64*i),m[i],k[0],0x96);
+                        }
+                        for (unsigned round = 1; round != rounds; ++round) {
+                            for (unsigned i = 0; i != 4; ++i) {
+                                x[i] = Decrypt ? _mm512_aesdec_epi128(x[i],k[round]) : _mm512_aesenc_epi128(x[i],k[round]);
+                            }
+                        }
+                        for (unsigned i = 0; i != 4; ++i) {
+                            const __m512i last = _mm512_xor_si512(k[rounds],m[i]);
+                            x[i] = Decrypt ? _mm512_aesdeclast_epi128(x[i],last) : _mm512_aesenclast_epi128(x[i],last);
+                            _mm512_storeu_si512(out+64*i,x[i]);
+                        }
+                    }
+                    for (; blocks >= 4; blocks -= 4, in += 64, out += 64) {
+                        __m512i x = _mm512_ternarylogic_epi64(_mm512_loadu_si512(in),t,k[0],0x96);
+                        for (unsigned round = 1; round != rounds; ++round) {
+                            x = Decrypt ? _mm512_aesdec_epi128(x,k[round]) : _mm512_aesenc_epi128(x,k[round]);
+                        }
+                        const __m512i last = _mm512_xor_si512(k[rounds],t);
+                        x = Decrypt ? _mm512_aesdeclast_epi128(x,last) : _mm512_aesenclast_epi128(x,last);
+                        _mm512_storeu_si512(out,x);
+                        t = xts_times_x4(t);
+                    }
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(tweak),_mm512_maskz_extracti32x4_epi32(0xf,t,0));
+                    core::do_zeroize(k,sizeof k);
+                }
+                xts_aesni<Decrypt>(keys,rounds,tweak,in,out,blocks);
+            }
+
+            /// AES-NI counter mode on whole blocks, eight in flight: counter blocks are
+            /// built in registers as in stream::details::counter_blocks_ssse3 and the
+            /// input is folded into the last round key
+            /// @param keys encryption round keys, 16-byte aligned
+            /// @param counter first counter block; a 128-bit counter must not carry
+            ///                between its halves during the call
+            template <unsigned CounterBits>
+            __attribute__((target("aes,ssse3")))
+            inline void ctr_aesni(const ::std::uint8_t * const keys,const unsigned rounds,const ::std::uint8_t * const counter,
+                                  const ::std::uint8_t * in,::std::uint8_t * out,::std::size_t blocks) noexcept {
+                const __m128i * const k = reinterpret_cast<const __m128i *>(keys);
+                const __m128i k0 = _mm_load_si128(k), kl = _mm_load_si128(k+rounds);
+                const __m128i reverse = _mm_set_epi8(0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15);
+                const __m128i one = _mm_set_epi64x(0,1);
+                __m128i c = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(counter)),reverse);
+                for (; blocks >= 8; blocks -= 8, in += 128, out += 128) {
+                    __m128i x[8];
+                    for (unsigned i = 0; i != 8; ++i) {
+                        x[i] = _mm_xor_si128(_mm_shuffle_epi8(c,reverse),k0);
+                        c = 32 == CounterBits ? _mm_add_epi32(c,one) : _mm_add_epi64(c,one);
+                    }
+                    for (unsigned round = 1; round != rounds; ++round) {
+                        const __m128i kr = _mm_load_si128(k+round);
+                        for (unsigned i = 0; i != 8; ++i) {
+                            x[i] = _mm_aesenc_si128(x[i],kr);
+                        }
+                    }
+                    for (unsigned i = 0; i != 8; ++i) {
+                        x[i] = _mm_aesenclast_si128(x[i],_mm_xor_si128(kl,_mm_loadu_si128(reinterpret_cast<const __m128i *>(in)+i)));
+                        _mm_storeu_si128(reinterpret_cast<__m128i *>(out)+i,x[i]);
+                    }
+                }
+                for (; 0 != blocks; --blocks, in += 16, out += 16) {
+                    __m128i x = _mm_xor_si128(_mm_shuffle_epi8(c,reverse),k0);
+                    c = 32 == CounterBits ? _mm_add_epi32(c,one) : _mm_add_epi64(c,one);
+                    for (unsigned round = 1; round != rounds; ++round) {
+                        x = _mm_aesenc_si128(x,_mm_load_si128(k+round));
+                    }
+                    x = _mm_aesenclast_si128(x,_mm_xor_si128(kl,_mm_loadu_si128(reinterpret_cast<const __m128i *>(in))));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(out),x);
+                }
+            }
+
+            /// VAES counter mode on whole blocks: four vectors of four counters, the
+            /// last blocks going through AES-NI
+            template <unsigned CounterBits>
+            __attribute__((target("aes,ssse3,vaes,avx512f,avx512bw")))
+            inline void ctr_vaes(const ::std::uint8_t * const keys,const unsigned rounds,const ::std::uint8_t * const counter,
+                                 const ::std::uint8_t * in,::std::uint8_t * out,::std::size_t blocks) noexcept {
+                core::secure_array<::std::uint8_t,16> next;
+                ::std::memcpy(next.data(),counter,16);
+                if (blocks >= 4) {
+                    __m512i k[15];
+                    for (unsigned round = 0; round <= rounds; ++round) {
+                        k[round] = _mm512_maskz_broadcast_i32x4(static_cast<__mmask16>(0xffff),
+                                                                _mm_load_si128(reinterpret_cast<const __m128i *>(keys)+round));
+                    }
+                    const __m512i reverse = _mm512_maskz_broadcast_i32x4(static_cast<__mmask16>(0xffff),
+                                                                         _mm_set_epi8(0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15));
+                    // the same steps serve both widths: the upper half of each 64-bit lane is zero
+                    const __m512i four = _mm512_set_epi64(0,4,0,4,0,4,0,4);
+                    __m512i c = _mm512_shuffle_epi8(_mm512_maskz_broadcast_i32x4(static_cast<__mmask16>(0xffff),
+                                                                                 _mm_loadu_si128(reinterpret_cast<const __m128i *>(counter))),
+                                                    reverse);
+                    c = 32 == CounterBits ? _mm512_add_epi32(c,_mm512_set_epi64(0,3,0,2,0,1,0,0))
+                                          : _mm512_add_epi64(c,_mm512_set_epi64(0,3,0,2,0,1,0,0));
+                    for (; blocks >= 16; blocks -= 16, in += 256, out += 256) {
+                        __m512i x[4];
+                        for (unsigned i = 0; i != 4; ++i) {
+                            x[i] = _mm512_xor_si512(_mm512_shuffle_epi8(c,reverse),k[0]);
+                            c = 32 == CounterBits ? _mm512_add_epi32(c,four) : _mm512_add_epi64(c,four);
+                        }
+                        for (unsigned round = 1; round != rounds; ++round) {
+                            for (unsigned i = 0; i != 4; ++i) {
+                                x[i] = _mm512_aesenc_epi128(x[i],k[round]);
+                            }
+                        }
+                        for (unsigned i = 0; i != 4; ++i) {
+                            x[i] = _mm512_aesenclast_epi128(x[i],_mm512_xor_si512(k[rounds],_mm512_loadu_si512(in+64*i)));
+                            _mm512_storeu_si512(out+64*i,x[i]);
+                        }
+                    }
+                    for (; blocks >= 4; blocks -= 4, in += 64, out += 64) {
+                        __m512i x = _mm512_xor_si512(_mm512_shuffle_epi8(c,reverse),k[0]);
+                        c = 32 == CounterBits ? _mm512_add_epi32(c,four) : _mm512_add_epi64(c,four);
+                        for (unsigned round = 1; round != rounds; ++round) {
+                            x = _mm512_aesenc_epi128(x,k[round]);
+                        }
+                        x = _mm512_aesenclast_epi128(x,_mm512_xor_si512(k[rounds],_mm512_loadu_si512(in)));
+                        _mm512_storeu_si512(out,x);
+                    }
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(next.data()),
+                                     _mm512_maskz_extracti32x4_epi32(0xf,_mm512_shuffle_epi8(c,reverse),0));
+                    core::do_zeroize(k,sizeof k);
+                }
+                ctr_aesni<CounterBits>(keys,rounds,next.data(),in,out,blocks);
+            }
+#endif
+
+        }
+
+        /// AES block cipher. The key is expanded once, in constant time; the
+        /// implementation is chosen when the object is built, the fastest usable one by
+        /// default. Round keys live in the object and are wiped with it, heap objects
+        /// included. Objects never change after construction and may be shared by
+        /// any number of threads.
+        /// @tparam KeyBits key length, 128, 192 or 256
+        template <::std::size_t KeyBits>
+        class aes : public core::ZeroizingBase<> {
+            static_assert(128 == KeyBits || 192 == KeyBits || 256 == KeyBits,"AES keys are 128, 192 or 256 bits");
+        public:
+            /// Bytes per block
+            static constexpr ::std::size_t block_size = 16;
+            /// Bytes per key
+            static constexpr ::std::size_t key_size = KeyBits/8;
+            /// Number of rounds
+            static constexpr unsigned rounds = KeyBits/32+6;
+
+            /// Constructor, expands the key
+            /// @param key key_size bytes
+            /// @param engine implementation to use
+            /// @throw std::invalid_argument if the key length is wrong or the implementation unsupported
+            explicit aes(const utils::span<::std::uint8_t> key,const aes_engine engine = best_aes_engine())
+                : selected {checked(engine)} {
+                if (key_size != key.size()) {
+                    throw ::std::invalid_argument("Wrong AES key length");
+                }
+                core::secure_array<::std::uint32_t,4*(rounds+1)> w;
+                details::expand_key(key.data(),KeyBits/32,w.data());
+                if (aes_engine::aesni != selected && aes_engine::vaes != selected) {
+                    details::slice_keys(w.data(),rounds,sliced_keys.data());
+                    return;
+                }
+                for (unsigned i = 0; i != 4*(rounds+1); ++i) {
+                    utils::store32le(encryption_keys.data()+4*i,w[i]);
+                }
+#ifdef CPP11CRYPTO_X86_INTRINSICS
+                details::inverse_keys_aesni(encryption_keys.data(),decryption_keys.data(),rounds);
+#endif
+            }
+
+            /// @return implementation in use
+            aes_engine engine() const noexcept {
+                return selected;
+            }
+
+            /// Encryption round keys in byte order, for kernels that run the AES
+            /// instructions themselves, stitched with other work
+            /// @return rounds+1 keys of 16 bytes, 16-byte aligned; unset for the
+            ///         bitsliced implementations
+            const ::std::uint8_t * round_keys() const noexcept {
+                return encryption_keys.data();
+            }
+
+            /// Encrypts independent blocks, as in ECB mode
+            /// @param in blocks to encrypt
+            /// @param out receives the encrypted blocks, may be in
+            /// @param blocks number of blocks
+            void encrypt(const ::std::uint8_t * const in,::std::uint8_t * const out,const ::std::size_t blocks) const noexcept {
+                switch (selected) {
+#ifdef CPP11CRYPTO_X86_INTRINSICS
+                case aes_engine::vaes:
+                    details::crypt_vaes<false>(encryption_keys.data(),rounds,in,out,blocks);
+                    return;
+                case aes_engine::aesni:
+                    details::crypt_aesni<false>(encryption_keys.data(),rounds,in,out,blocks);
+                    return;
+                case aes_engine::bitsliced_avx2:
+                    details::crypt_bitsliced_avx2<false>(sliced_keys.data(),rounds,in,out,blocks);
+                    return;
+                case aes_engine::bitsliced_sse2:
+                    details::crypt_bitsliced_sse2<false>(sliced_keys.data(),rounds,in,out,blocks);
+                    return;
+#endif
+                default:
+                    details::encrypt_portable(sliced_keys.data(),rounds,in,out,blocks);
+                }
+            }
+            /// Decrypts independent blocks, as in ECB mode
+            /// @param in blocks to decrypt
+            /// @param out receives the decrypted blocks, may be in
+            /// @param blocks number of blocks
+            void decrypt(const ::std::uint8_t * const in,::std::uint8_t * const out,const ::std::size_t blocks) const noexcept {
+                switch (selected) {
+#ifdef CPP11CRYPTO_X86_INTRINSICS
+                case aes_engine::vaes:
+                    details::crypt_vaes<true>(decryption_keys.data(),rounds,in,out,blocks);
+                    return;
+                case aes_engine::aesni:
+                    details::crypt_aesni<true>(decryption_keys.data(),rounds,in,out,blocks);
+                    return;
+                case aes_engine::bitsliced_avx2:
+                    details::crypt_bitsliced_avx2<true>(sliced_keys.data(),rounds,in,out,blocks);
+                    return;
+                case aes_engine::bitsliced_sse2:
+                    details::crypt_bitsliced_sse2<true>(sliced_keys.data(),rounds,in,out,blocks);
+                    return;
+#endif
+                default:
+                    details::decrypt_portable(sliced_keys.data(),rounds,in,out,blocks);
+                }
+            }
+
+            /// XTS on whole blocks, for block::xts: each block masked by its tweak before
+            /// and after the cipher, the tweaks built and the masks applied in registers
+            /// @param tweak tweak of the first block, 16 bytes little endian; receives
+            ///              the tweak of the block after the last
+            /// @param in blocks to process
+            /// @param out receives the processed blocks, may be in
+            /// @param blocks number of blocks
+            /// @return false, having done nothing, for the bitsliced implementations
+            template <bool Decrypt>
+            bool xts_blocks(::std::uint8_t * const tweak,const ::std::uint8_t * const in,::std::uint8_t * const out,
+                            const ::std::size_t blocks) const noexcept {
+                const ::std::uint8_t * const keys = Decrypt ? decryption_keys.data() : encryption_keys.data();
+                switch (selected) {
+#ifdef CPP11CRYPTO_X86_INTRINSICS
+                case aes_engine::vaes:
+                    details::xts_vaes<Decrypt>(keys,rounds,tweak,in,out,blocks);
+                    return true;
+                case aes_engine::aesni:
+                    details::xts_aesni<Decrypt>(keys,rounds,tweak,in,out,blocks);
+                    return true;
+#endif
+                default:
+                    return false;
+                }
+            }
+            /// Counter mode on whole blocks, for stream::ctr: counter blocks built in
+            /// registers, the keystream XORed into the data as the rounds end
+            /// @tparam CounterBits width of the counter at the end of the counter block
+            /// @param counter first counter block; a 128-bit counter must not carry
+            ///                between its halves over the blocks
+            /// @param in data to process
+            /// @param out receives the processed data, may be in
+            /// @param blocks number of blocks
+            /// @return false, having done nothing, for the bitsliced implementations
+            template <unsigned CounterBits>
+            bool ctr_blocks(const ::std::uint8_t * const counter,const ::std::uint8_t * const in,::std::uint8_t * const out,
+                            const ::std::size_t blocks) const noexcept {
+#ifdef CPP11CRYPTO_X86_INTRINSICS
+                if (!utils::cpu().ssse3) {
+                    return false;
+                }
+                if (aes_engine::vaes == selected && utils::cpu().avx512bw) {
+                    details::ctr_vaes<CounterBits>(encryption_keys.data(),rounds,counter,in,out,blocks);
+                    return true;
+                }
+                if (aes_engine::aesni == selected || aes_engine::vaes == selected) {
+                    details::ctr_aesni<CounterBits>(encryption_keys.data(),rounds,counter,in,out,blocks);
+                    return true;
+                }
+#endif
+                return false;
+            }
+
+        private:
+            static aes_engine checked(const aes_engine engine) {
+                if (!is_supported(engine)) {
+                    throw ::std::invalid_argument("AES implementation not supported by this processor");
+                }
+                return engine;
+            }
+
+            aes_engine selected;
+            /// Round keys in byte order for the AES instructions, the decryption ones
+            /// those of the equivalent inverse cipher
+            core::secure_array<::std::uint8_t,16*(rounds+1),16> encryption_keys, decryption_keys;
+            /// Round keys as bit planes for the bitsliced code
+            core::secure_array<::std::uint64_t,8*(rounds+1)> sliced_keys;
+        };
+
+        template <::std::size_t KeyBits>
+        constexpr ::std::size_t aes<KeyBits>::block_size;
+        template <::std::size_t KeyBits>
+        constexpr ::std::size_t aes<KeyBits>::key_size;
+        template <::std::size_t KeyBits>
+        constexpr unsigned aes<KeyBits>::rounds;
+
+        /// AES with 128-bit keys
+        typedef aes<128> aes128;
+        /// AES with 192-bit keys
+        typedef aes<192> aes192;
+        /// AES with 256-bit keys
+        typedef aes<256> aes256;
+
+    }
+}
+
+#endif // CPP11CRYPTO_BLOCK_AES_HPP
@@ -0,0 +1,333 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// block/modes.hpp - ECB, CBC and XTS modes of operation over any block
+//                    cipher, the parallel ones feeding it batches of blocks
+
+#ifndef CPP11CRYPTO_BLOCK_MODES_HPP
+#define CPP11CRYPTO_BLOCK_MODES_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include "core/secure_array.hpp"
+#include "core/zeroizing.hpp"
+#include "utils/endian.hpp"
+#include "utils/span.hpp"
+
+namespace cpp11crypto {
+    namespace block {
+
+        // A block cipher, as used by the modes, provides block_size and the const
+        // members encrypt(in,out,blocks) and decrypt(in,out,blocks) working on
+        // independent blocks, in place or not, like @ref aes. Modes keep a reference
+        // to the cipher, which must outlive them.
+
+        /// Blocks handed to the cipher at once by the parallel modes: a full pass of
+        /// the VAES and AVX2 bitsliced kernels, two of the eight-way AES-NI one, so
+        /// that the pipeline does not drain between batches
+        constexpr ::std::size_t parallel_blocks = 16;
+
+        namespace details {
+
+            /// out = a ^ b, a word at a time; out may be a or b
+            inline void xor_bytes(const ::std::uint8_t * const a,const ::std::uint8_t * const b,
+                                  ::std::uint8_t * const out,const ::std::size_t bytes) noexcept {
+                ::std::size_t i = 0;
+                for (; i+8 <= bytes; i += 8) {
+                    ::std::uint64_t x, y;
+                    ::std::memcpy(&x,a+i,8);
+                    ::std::memcpy(&y,b+i,8);
+                    x ^= y;
+                    ::std::memcpy(out+i,&x,8);
+                }
+                for (; i != bytes; ++i) {
+                    out[i] = a[i] ^ b[i];
+                }
+            }
+
+            /// Number of blocks in a length
+            /// @throw std::invalid_argument if the length is not a whole number of blocks
+            template <typename Cipher>
+            ::std::size_t whole_blocks(const ::std::size_t bytes) {
+                if (0 != bytes%Cipher::block_size) {
+                    throw ::std::invalid_argument("Length is not a multiple of the block size");
+                }
+                return bytes/Cipher::block_size;
+            }
+
+            /// Whole XTS blocks through the cipher's own kernel, when it has one, like
+            /// @ref aes::xts_blocks
+            /// @return false when the cipher has no such kernel or did not run it
+            template <bool Decrypt,typename Cipher>
+            auto xts_kernel(const Cipher& cipher,::std::uint8_t * const tweak,const ::std::uint8_t * const in,
+                            ::std::uint8_t * const out,const ::std::size_t blocks,int) noexcept
+                -> decltype(cipher.template xts_blocks<Decrypt>(tweak,in,out,blocks)) {
+                return cipher.template xts_blocks<Decrypt>(tweak,in,out,blocks);
+            }
+            template <bool Decrypt,typename Cipher>
+            bool xts_kernel(const Cipher&,::std::uint8_t *,const ::std::uint8_t *,::std::uint8_t *,::std::size_t,long) noexcept {
+                return false;
+            }
+
+        }
+
+        /// Electronic codebook mode: every block on its own. The whole buffer goes to
+        /// the cipher in one call, its kernels interleaving as many blocks as they can.
+        /// @tparam Cipher block cipher
+        template <typename Cipher>
+        class ecb {
+        public:
+            /// Cipher type
+            typedef Cipher cipher_type;
+            /// Bytes per block
+            static constexpr ::std::size_t block_size = Cipher::block_size;
+
+            /// Constructor
+            /// @param cipher keyed cipher, referenced
+            explicit ecb(const Cipher& cipher) noexcept : cipher(cipher) {}
+
+            /// Encrypts whole blocks
+            /// @param in data to encrypt
+            /// @param out receives the encrypted data, may be in
+            /// @param bytes length, a multiple of the block size
+            /// @throw std::invalid_argument if the length is not a multiple of the block size
+            void encrypt(const ::std::uint8_t * const in,::std::uint8_t * const out,const ::std::size_t bytes) const {
+                cipher.encrypt(in,out,details::whole_blocks<Cipher>(bytes));
+            }
+            /// Decrypts whole blocks
+            /// @param in data to decrypt
+            /// @param out receives the decrypted data, may be in
+            /// @param bytes length, a multiple of the block size
+            /// @throw std::invalid_argument if the length is not a multiple of the block size
+            void decrypt(const ::std::uint8_t * const in,::std::uint8_t * const out,const ::std::size_t bytes) const {
+                cipher.decrypt(in,out,details::whole_blocks<Cipher>(bytes));
+            }
+
+        private:
+            const Cipher& cipher;
+        };
+
+        /// Cipher block chaining mode. Encryption is serial by nature, one block per
+        /// cipher call; decryption is not, and goes by batches of @ref parallel_blocks.
+        /// The chaining value carries over from one call to the next, so a message may
+        /// be processed in pieces of whole blocks.
+        /// @tparam Cipher block cipher
+        template <typename Cipher>
+        class cbc : public core::ZeroizingBase<> {
+        public:
+            /// Cipher type
+            typedef Cipher cipher_type;
+            /// Bytes per block
+            static constexpr ::std::size_t block_size = Cipher::block_size;
+
+            /// Constructor
+            /// @param cipher keyed cipher, referenced
+            /// @param iv initialization vector, block_size bytes
+            /// @throw std::invalid_argument if the initialization vector length is wrong
+            cbc(const Cipher& cipher,const utils::span<::std::uint8_t> iv) : cipher(cipher) {
+                if (block_size != iv.size()) {
+                    throw ::std::invalid_argument("Wrong CBC initialization vector length");
+                }
+                ::std::memcpy(chain.data(),iv.data(),block_size);
+            }
+
+            /// Encrypts whole blocks, continuing the chain
+            /// @param in data to encrypt
+            /// @param out receives the encrypted data, may be in
+            /// @param bytes length, a multiple of the block size
+            /// @throw std::invalid_argument if the length is not a multiple of the block size
+            void encrypt(const ::std::uint8_t * in,::std::uint8_t * out,const ::std::size_t bytes) {
+                for (::std::size_t blocks = details::whole_blocks<Cipher>(bytes); 0 != blocks; --blocks) {
+                    details::xor_bytes(chain.data(),in,chain.data(),block_size);
+                    cipher.encrypt(chain.data(),chain.data(),1);
+                    ::std::memcpy(out,chain.data(),block_size);
+                    in += block_size;
+                    out += block_size;
+                }
+            }
+            /// Decrypts whole blocks, continuing the chain
+            /// @param in data to decrypt
+            /// @param out receives the decrypted data, may be in
+            /// @param bytes length, a multiple of the block size
+            /// @throw std::invalid_argument if the length is not a multiple of the block size
+            void decrypt(const ::std::uint8_t * in,::std::uint8_t * out,const ::std::size_t bytes) {
+                ::std::uint8_t saved[parallel_blocks*block_size];
+                for (::std::size_t blocks = details::whole_blocks<Cipher>(bytes); 0 != blocks;) {
+                    const ::std::size_t n = ::std::min(blocks,parallel_blocks);
+                    // the ciphertext is kept aside, out may overwrite it
+                    ::std::memcpy(saved,in,n*block_size);
+                    cipher.decrypt(in,out,n);
+                    details::xor_bytes(out,chain.data(),out,block_size);
+                    details::xor_bytes(out+block_size,saved,out+block_size,(n-1)*block_size);
+                    ::std::memcpy(chain.data(),saved+(n-1)*block_size,block_size);
+                    in += n*block_size;
+                    out += n*block_size;
+                    blocks -= n;
+                }
+            }
+
+        private:
+            const Cipher& cipher;
+            /// Last ciphertext block, or the initialization vector
+            core::secure_array<::std::uint8_t,block_size> chain;
+        };
+
+        /// XEX-based tweaked codebook mode with ciphertext stealing (XTS, IEEE 1619 and
+        /// SP 800-38E), for storage: each data unit, a disk sector for instance, is
+        /// encrypted on its own under the tweak given by its number. Blocks of a unit
+        /// go to the cipher's own XTS kernel when it has one, as @ref aes does, or by
+        /// batches of @ref parallel_blocks with their tweaks.
+        /// @tparam Cipher block cipher of 16-byte blocks
+        template <typename Cipher>
+        class xts {
+            static_assert(16 == Cipher::block_size,"XTS works on 128-bit blocks");
+        public:
+            /// Cipher type
+            typedef Cipher cipher_type;
+            /// Bytes per block
+            static constexpr ::std::size_t block_size = 16;
+
+            /// Constructor. The two keys must be different.
+            /// @param data cipher keyed with the first half of the XTS key, referenced
+            /// @param tweak cipher keyed with the second half of the XTS key, referenced
+            xts(const Cipher& data,const Cipher& tweak) noexcept : data(data), tweak(tweak) {}
+
+            /// Encrypts a data unit
+            /// @param unit data unit number
+            /// @param in data to encrypt
+            /// @param out receives the encrypted data, may be in
+            /// @param bytes length, at least one block
+            /// @throw std::invalid_argument if the data unit is shorter than a block
+            void encrypt(const ::std::uint64_t unit,const ::std::uint8_t * const in,::std::uint8_t * const out,
+                         const ::std::size_t bytes) const {
+                crypt<false>(unit,in,out,bytes);
+            }
+            /// Decrypts a data unit
+            /// @param unit data unit number
+            /// @param in data to decrypt
+            /// @param out receives the decrypted data, may be in
+            /// @param bytes length, at least one block
+            /// @throw std::invalid_argument if the data unit is shorter than a block
+            void decrypt(const ::std::uint64_t unit,const ::std::uint8_t * const in,::std::uint8_t * const out,
+                         const ::std::size_t bytes) const {
+                crypt<true>(unit,in,out,bytes);
+            }
+
+        private:
+            /// Tweak of the next block: multiplication by x in GF(2^128), little endian
+            static void next_tweak(::std::uint64_t * const t) noexcept {
+                const ::std::uint64_t carry = t[1] >> 63;
+                t[1] = (t[1] << 1) | (t[0] >> 63);
+                t[0] = (t[0] << 1) ^ (0x87 & (0-carry));
+            }
+            static void store_tweak(::std::uint8_t * const out,const ::std::uint64_t * const t) noexcept {
+                utils::store64le(out,t[0]);
+                utils::store64le(out+8,t[1]);
+            }
+            static void load_tweak(::std::uint64_t * const t,const ::std::uint8_t * const in) noexcept {
+                t[0] = utils::load_le<::std::uint64_t>(in);
+                t[1] = utils::load_le<::std::uint64_t>(in+8);
+            }
+
+            /// One block under a tweak, in place
+            template <bool Decrypt>
+            void one_block(::std::uint8_t * const x,const ::std::uint64_t * const t) const noexcept {
+                core::secure_array<::std::uint8_t,16> mask;
+                store_tweak(mask.data(),t);
+                details::xor_bytes(x,mask.data(),x,16);
+                if (Decrypt) {
+                    data.decrypt(x,x,1);
+                } else {
+                    data.encrypt(x,x,1);
+                }
+                details::xor_bytes(x,mask.data(),x,16);
+            }
+
+            template <bool Decrypt>
+            void crypt(const ::std::uint64_t unit,const ::std::uint8_t * in,::std::uint8_t * out,const ::std::size_t bytes) const {
+                if (bytes < block_size) {
+                    throw ::std::invalid_argument("XTS data units are at least one block long");
+                }
+                core::secure_array<::std::uint8_t,parallel_blocks*block_size,16> masks;
+                core::secure_array<::std::uint64_t,2> t {unit,0};
+                store_tweak(masks.data(),t.data());
+                tweak.encrypt(masks.data(),masks.data(),1);
+
+                // the last full block joins the stolen tail when there is one
+                const ::std::size_t tail = bytes%block_size;
+                ::std::size_t blocks = bytes/block_size-(0 != tail ? 1 : 0);
+                if (details::xts_kernel<Decrypt>(data,masks.data(),in,out,blocks,0)) {
+                    in += 16*blocks;
+                    out += 16*blocks;
+                    blocks = 0;
+                }
+                load_tweak(t.data(),masks.data());
+                while (0 != blocks) {
+                    const ::std::size_t n = ::std::min(blocks,parallel_blocks);
+                    for (::std::size_t i = 0; i != n; ++i) {
+                        store_tweak(masks.data()+16*i,t.data());
+                        next_tweak(t.data());
+                    }
+                    details::xor_bytes(in,masks.data(),out,16*n);
+                    if (Decrypt) {
+                        data.decrypt(out,out,n);
+                    } else {
+                        data.encrypt(out,out,n);
+                    }
+                    details::xor_bytes(out,masks.data(),out,16*n);
+                    in += 16*n;
+                    out += 16*n;
+                    blocks -= n;
+                }
+                if (0 == tail) {
+                    return;
+                }
+
+                // ciphertext stealing: the last full block is processed under the
+                // last tweak when decrypting, the tail being read before it is written
+                core::secure_array<::std::uint64_t,2> last(t);
+                next_tweak(last.data());
+                core::secure_array<::std::uint8_t,16> x, y;
+                ::std::memcpy(x.data(),in,16);
+                one_block<Decrypt>(x.data(),Decrypt ? last.data() : t.data());
+                ::std::memcpy(y.data(),in+16,tail);
+                ::std::memcpy(y.data()+tail,x.data()+tail,16-tail);
+                ::std::memcpy(out+16,x.data(),tail);
+                one_block<Decrypt>(y.data(),Decrypt ? t.data() : last.data());
+                ::std::memcpy(out,y.data(),16);
+            }
+
+            const Cipher& data;
+            const Cipher& tweak;
+        };
+
+        template <typename Cipher>
+        constexpr ::std::size_t ecb<Cipher>::block_size;
+        template <typename Cipher>
+        constexpr ::std::size_t cbc<Cipher>::block_size;
+        template <typename Cipher>
+        constexpr ::std::size_t xts<Cipher>::block_size;
+
+    }
+}
+
+#endif // CPP11CRYPTO_BLOCK_MODES_HPP
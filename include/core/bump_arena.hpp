@@ -0,0 +1,102 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// core/bump_arena.hpp - Scratch space carved in stack order from a single
+//                    zeroizing allocation
+
+#ifndef CPP11CRYPTO_CORE_BUMP_ARENA_HPP
+#define CPP11CRYPTO_CORE_BUMP_ARENA_HPP
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <vector>
+#include "core/zeroizing.hpp"
+
+namespace cpp11crypto {
+    namespace core {
+
+        /// Fixed capacity scratch space for recursive algorithms. Blocks are taken by
+        /// bumping an offset and given back in reverse order through scopes, so that
+        /// no allocation happens after construction. The storage comes from
+        /// core::allocator and is zeroized when the arena is destroyed.
+        /// @tparam T element type, trivially destructible
+        template <typename T>
+        class bump_arena {
+            static_assert(::std::is_trivially_destructible<T>::value,
+                          "Scratch elements are never destroyed, only wiped");
+        public:
+            /// Element type
+            typedef T value_type;
+
+            /// Constructor, the only allocation
+            /// @param capacity number of elements available
+            explicit bump_arena(const ::std::size_t capacity) : storage(capacity), used {0} {}
+
+            bump_arena(const bump_arena&) = delete;
+            bump_arena& operator=(const bump_arena&) = delete;
+
+            /// Takes a block, with whatever contents earlier blocks left
+            /// @param n number of elements
+            /// @return first element of the block
+            /// @throw std::bad_alloc if the capacity is exhausted
+            T * allocate(const ::std::size_t n) {
+                if (n > storage.size()-used) {
+                    throw ::std::bad_alloc();
+                }
+                T * const block = storage.data()+used;
+                used += n;
+                return block;
+            }
+
+            /// @return number of elements in use
+            ::std::size_t size() const noexcept {
+                return used;
+            }
+            /// @return number of elements available in total
+            ::std::size_t capacity() const noexcept {
+                return storage.size();
+            }
+
+            /// Gives back every block taken during its lifetime
+            class scope {
+            public:
+                /// Constructor, remembers the current offset
+                /// @param arena arena
+                explicit scope(bump_arena& arena) noexcept : arena(arena), mark {arena.used} {}
+                scope(const scope&) = delete;
+                scope& operator=(const scope&) = delete;
+                /// Destructor, restores the offset
+                ~scope() {
+                    arena.used = mark;
+                }
+            private:
+                bump_arena& arena;
+                const ::std::size_t mark;
+            };
+
+        private:
+            ::std::vector<T,allocator<T>> storage;
+            ::std::size_t used;
+        };
+
+    }
+}
+
+#endif // CPP11CRYPTO_CORE_BUMP_ARENA_HPP
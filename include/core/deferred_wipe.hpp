@@ -0,0 +1,427 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// core/deferred_wipe.hpp - Quarantine of freed secure blocks, wiped in
+//                    batches by a background reclaimer
+
+#ifndef CPP11CRYPTO_CORE_DEFERRED_WIPE_HPP
+#define CPP11CRYPTO_CORE_DEFERRED_WIPE_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "core/secure_arena.hpp"
+#include "core/zeroizing.hpp"
+
+namespace cpp11crypto {
+    namespace core {
+
+        /// Snapshot of the counters kept by @ref wipe_quarantine
+        struct quarantine_statistics {
+            /// Blocks waiting to be wiped
+            ::std::uint64_t depth_blocks {0};
+            /// Bytes waiting to be wiped
+            ::std::uint64_t depth_bytes {0};
+            /// Largest number of bytes ever waiting
+            ::std::uint64_t max_depth_bytes {0};
+            /// Bytes of waiting blocks made unreadable
+            ::std::uint64_t protected_bytes {0};
+            /// Bytes wiped by the reclaimer or by a flush
+            ::std::uint64_t wiped_bytes {0};
+            /// Time spent wiping those bytes, in seconds
+            double wipe_seconds {0};
+            /// Batches wiped
+            ::std::uint64_t batches {0};
+            /// Blocks wiped by the freeing thread because the quarantine was full
+            ::std::uint64_t synchronous_wipes {0};
+
+            /// Wiping throughput of the reclaimer
+            /// @return bytes per second, 0 if nothing was wiped yet
+            double wipe_throughput() const noexcept {
+                return 0 == wipe_seconds ? 0.0 : wiped_bytes/wipe_seconds;
+            }
+        };
+
+        /// Process wide quarantine for freed secure blocks.
+        /// Whole pages inside a block are made unreadable as soon as it enters; a
+        /// background reclaimer wipes blocks in batches and only then releases them,
+        /// so no block can be reused before it is wiped. When the quarantine is full
+        /// the freeing thread wipes and releases its block itself.
+        class wipe_quarantine {
+        public:
+            /// Function releasing a wiped block to its owner
+            using release_function = void (*)(void *,::std::size_t);
+
+            /// The only quarantine, started on first use. It is never destroyed,
+            /// call @ref flush at shutdown to wipe whatever is still waiting.
+            /// @return reference to the quarantine
+            static wipe_quarantine& instance() {
+                static wipe_quarantine * const quarantine = new wipe_quarantine;
+                return *quarantine;
+            }
+
+            /// Quarantines a freed block. Never allocates: when the quarantine is
+            /// full, in bytes or in blocks, the block is wiped and released at once.
+            /// @param p block address
+            /// @param size block size in bytes
+            /// @param release function to call once the block is wiped
+            void push(void * const p,const ::std::size_t size,const release_function release) noexcept {
+                if (nullptr == p) {
+                    return;
+                }
+                {
+                    ::std::lock_guard<::std::mutex> lock {mutex};
+                    if (stats.depth_bytes + size <= limit && pending.size() < capacity) {
+                        // within the reserved capacity, no reallocation; the pages are
+                        // protected under the lock, so the reclaimer cannot see the entry
+                        // before its protection is recorded
+                        pending.push_back(entry {p,size,release,0});
+                        pending.back().protected_size = protect(p,size);
+                        stats.depth_blocks += 1;
+                        stats.depth_bytes += size;
+                        stats.protected_bytes += pending.back().protected_size;
+                        if (stats.depth_bytes > stats.max_depth_bytes) {
+                            stats.max_depth_bytes = stats.depth_bytes;
+                        }
+                        if (stats.depth_bytes >= batch && !pending_notified) {
+                            pending_notified = true;
+                            wake.notify_one();
+                        }
+                        return;
+                    }
+                    ++stats.synchronous_wipes;
+                }
+                secure_wipe(p,size);
+                release(p,size);
+            }
+
+            /// Wipes and releases every quarantined block before returning
+            void flush() {
+                // reserved before the reclaimer is held off, so that a bad_alloc
+                // leaves it running
+                ::std::vector<entry> work;
+                work.reserve(capacity);
+                ::std::unique_lock<::std::mutex> lock {mutex};
+                idle.wait(lock,[this]() {
+                    return !reclaiming;
+                });
+                reclaiming = true;
+                work.swap(pending);
+                lock.unlock();
+                reclaim(work);
+                lock.lock();
+                reclaiming = false;
+                idle.notify_all();
+            }
+
+            /// Sets the largest number of bytes waiting to be wiped
+            /// @param bytes new bound
+            void set_limit(const ::std::size_t bytes) {
+                ::std::lock_guard<::std::mutex> lock {mutex};
+                limit = bytes;
+            }
+
+            /// Sets the number of waiting bytes that wakes the reclaimer before its period
+            /// @param bytes new batch size
+            void set_batch(const ::std::size_t bytes) {
+                ::std::lock_guard<::std::mutex> lock {mutex};
+                batch = bytes;
+            }
+
+            /// Reads the counters
+            /// @return snapshot of the counters
+            quarantine_statistics statistics() const {
+                ::std::lock_guard<::std::mutex> lock {mutex};
+                return stats;
+            }
+
+        private:
+            /// Largest number of blocks waiting, all of them in storage reserved up front
+            static constexpr ::std::size_t capacity = 4096;
+
+            /// A quarantined block
+            struct entry {
+                void *p;
+                ::std::size_t size;
+                release_function release;
+                ::std::size_t protected_size;
+            };
+
+            /// Period of the reclaimer when batches fill slowly
+            /// @return period
+            static ::std::chrono::milliseconds period() noexcept {
+                return ::std::chrono::milliseconds {20};
+            }
+
+            wipe_quarantine() {
+                pending.reserve(capacity);
+                ::std::thread(&wipe_quarantine::run,this).detach();
+            }
+            wipe_quarantine(const wipe_quarantine&) = delete;
+            wipe_quarantine& operator=(const wipe_quarantine&) = delete;
+
+            /// Whole pages inside a block
+            /// @param p block address
+            /// @param size block size
+            /// @return first page and size of the page range, possibly empty
+            static ::std::pair<unsigned char *,::std::size_t> inner_pages(void * const p,const ::std::size_t size) noexcept {
+                const ::std::uintptr_t page = details::page_size();
+                const ::std::uintptr_t first = (reinterpret_cast<::std::uintptr_t>(p) + page - 1) & ~(page - 1);
+                const ::std::uintptr_t last = (reinterpret_cast<::std::uintptr_t>(p) + size) & ~(page - 1);
+                return last > first ? ::std::make_pair(reinterpret_cast<unsigned char *>(first),last - first)
+                       : ::std::make_pair(static_cast<unsigned char *>(nullptr),::std::size_t {0});
+            }
+
+            /// Makes the whole pages of a block unreadable. Pages shared with other
+            /// blocks cannot be protected, so small blocks stay readable until wiped.
+            /// @param p block address
+            /// @param size block size
+            /// @return bytes protected
+            static ::std::size_t protect(void * const p,const ::std::size_t size) noexcept {
+#ifdef CPP11CRYPTO_SECURE_MMAP
+                const auto pages = inner_pages(p,size);
+                if (0 != pages.second && 0 == ::mprotect(pages.first,pages.second,PROT_NONE)) {
+                    return pages.second;
+                }
+#else
+                (void) p;
+                (void) size;
+#endif
+                return 0;
+            }
+
+            /// Makes the protected pages of a block accessible again
+            /// @param e quarantined block
+            static void unprotect(const entry& e) noexcept {
+#ifdef CPP11CRYPTO_SECURE_MMAP
+                if (0 != e.protected_size) {
+                    const auto pages = inner_pages(e.p,e.size);
+                    ::mprotect(pages.first,pages.second,PROT_READ|PROT_WRITE);
+                }
+#else
+                (void) e;
+#endif
+            }
+
+            /// Wipes and releases a batch, then accounts for it
+            /// @param work blocks to process
+            void reclaim(::std::vector<entry>& work) {
+                const auto start = ::std::chrono::steady_clock::now();
+                ::std::uint64_t bytes = 0, protected_bytes = 0;
+                for (const entry& e : work) {
+                    unprotect(e);
+                    secure_wipe(e.p,e.size);
+                    e.release(e.p,e.size);
+                    bytes += e.size;
+                    protected_bytes += e.protected_size;
+                }
+                const ::std::chrono::duration<double> elapsed = ::std::chrono::steady_clock::now() - start;
+                ::std::lock_guard<::std::mutex> lock {mutex};
+                stats.depth_blocks -= work.size();
+                stats.depth_bytes -= bytes;
+                stats.protected_bytes -= protected_bytes;
+                stats.wiped_bytes += bytes;
+                stats.wipe_seconds += elapsed.count();
+                stats.batches += work.empty() ? 0 : 1;
+                work.clear();
+            }
+
+            /// Reclaimer loop
+            void run() {
+                ::std::vector<entry> work;
+                work.reserve(capacity);
+                ::std::unique_lock<::std::mutex> lock {mutex};
+                for (;;) {
+                    wake.wait_for(lock,period(),[this]() {
+                        return pending_notified;
+                    });
+                    pending_notified = false;
+                    if (pending.empty() || reclaiming) {
+                        continue;
+                    }
+                    reclaiming = true;
+                    work.swap(pending);
+                    lock.unlock();
+                    reclaim(work);
+                    lock.lock();
+                    reclaiming = false;
+                    idle.notify_all();
+                }
+            }
+
+            mutable ::std::mutex mutex;
+            ::std::condition_variable wake;
+            ::std::condition_variable idle;
+            ::std::vector<entry> pending;
+            bool pending_notified {false};
+            bool reclaiming {false};
+            ::std::size_t limit {::std::size_t {64} << 20};
+            ::std::size_t batch {::std::size_t {1} << 20};
+            quarantine_statistics stats;
+        };
+
+        /// Base operator for @ref ZeroizingBase that defers wiping to @ref wipe_quarantine.
+        /// Memory comes from another base operator, and goes back to it once wiped.
+        /// @tparam base_operator operator allocating and freeing the memory
+        template <typename base_operator = standard>
+        struct deferred {
+            /// Tells @ref ZeroizingBase not to wipe on delete
+            static constexpr bool deferred_wipe = true;
+
+            /// Allocates required space from the base operator
+            /// @param size number of bytes required
+            /// @return pointer to allocated space
+            static void *get_new(const ::std::size_t size) {
+                return base_operator::get_new(size);
+            }
+            /// Quarantines space until it is wiped and freed by the base operator
+            /// @param p pointer to space to free
+            /// @param size of memory block to free
+            static void do_delete(void * const p,const ::std::size_t size) noexcept {
+                wipe_quarantine::instance().push(p,size,&base_operator::do_delete);
+            }
+
+            /// Allocates required space from the base operator
+            /// @param size number of bytes required
+            /// @return pointer to allocated space
+            static void *get_new_array(const ::std::size_t size) {
+                return base_operator::get_new_array(size);
+            }
+            /// Quarantines space until it is wiped and freed by the base operator
+            /// @param p pointer to space to free
+            /// @param size of memory block to free
+            static void do_delete_array(void * const p,const ::std::size_t size) noexcept {
+                wipe_quarantine::instance().push(p,size,&base_operator::do_delete_array);
+            }
+        };
+
+        template <typename base_operator>
+        constexpr bool deferred<base_operator>::deferred_wipe;
+
+        template <typename T, template <class> class underlying_allocator = ::std::allocator> class deferred_allocator;
+
+        /// Root specialization of the deferred allocator
+        /// @tparam underlying_allocator allocator providing and taking back the memory
+        template <template <class> class underlying_allocator>
+        class deferred_allocator<void, underlying_allocator> {
+        public:
+            /// pointer trait required by STL
+            typedef void* pointer;
+            /// const pointer trait required by STL
+            typedef const void* const_pointer;
+            /// value type trait required by STL
+            typedef void value_type;
+            /// Auxiliary structure required by STL to reuse allocators
+            /// @tparam U class of the object(s) to be allocated by STL container
+            template <class U> struct rebind {
+                typedef deferred_allocator<U, underlying_allocator> other;
+            };
+        };
+
+        /// Allocator, STL compatible, that hands freed space to @ref wipe_quarantine.
+        /// Memory comes from another allocator, and goes back to it once wiped, so
+        /// that deferred wiping can be stacked on locked memory. Meant as the
+        /// underlying allocator of the zeroizing @ref allocator, through
+        /// @ref deferred_over. Objects are still wiped as they are destroyed; the
+        /// quarantine wipes whole blocks, spare capacity included, before they are freed.
+        /// @tparam T class of the object type for the STL container
+        /// @tparam underlying_allocator allocator providing and taking back the memory
+        template <typename T, template <class> class underlying_allocator>
+        class deferred_allocator : public underlying_allocator<T> {
+            // All members inherited, save for constructors, allocator and deallocator
+        private:
+            typedef underlying_allocator<T> base_allocator;
+        public:
+            /// Constructor does nothing special, defaulted
+            deferred_allocator() noexcept = default;
+            /// Copy constructor from compatible object does nothing special
+            /// @param other compatible allocator to be copied, it is ignored
+            template <class U>
+            deferred_allocator(const deferred_allocator<U, underlying_allocator>& other) noexcept {}
+
+            /// Auxiliary structure required by STL to reuse allocators
+            /// @tparam U class of the object(s) to be allocated by STL container
+            template <class U> struct rebind {
+                typedef deferred_allocator<U, underlying_allocator> other;
+            };
+
+            /// Allocates space for n objects from the underlying allocator.
+            /// @param n number of objects to allocate space for
+            /// @param hint pointer, if valid, that may be reallocated.
+            /// @return address allocated
+            typename base_allocator::pointer
+            allocate(typename base_allocator::size_type const n,
+                     typename deferred_allocator<void, underlying_allocator>::const_pointer const hint = 0) {
+                return base_allocator::allocate(n,hint);
+            }
+
+            /// Quarantines space from n objects until it is wiped and given back to
+            /// the underlying allocator.
+            /// @param p pointer to first address
+            /// @param n number of objects space was allocated for
+            void deallocate(typename base_allocator::pointer const p,
+                            typename base_allocator::size_type const n) noexcept {
+                wipe_quarantine::instance().push(p,n*sizeof(T),&release);
+            }
+
+        private:
+            static void release(void * const p,const ::std::size_t size) noexcept {
+                base_allocator().deallocate(static_cast<T *>(p),size/sizeof(T));
+            }
+        };
+
+        /// Deferred allocators are stateless, all of them compare equal
+        /// @return true
+        template <class T, class U, template <class> class underlying_allocator>
+        bool operator==(const deferred_allocator<T, underlying_allocator>&,
+                        const deferred_allocator<U, underlying_allocator>&) noexcept {
+            return true;
+        }
+
+        /// Deferred allocators are stateless, all of them compare equal
+        /// @return false
+        template <class T, class U, template <class> class underlying_allocator>
+        bool operator!=(const deferred_allocator<T, underlying_allocator>&,
+                        const deferred_allocator<U, underlying_allocator>&) noexcept {
+            return false;
+        }
+
+        /// Binds the underlying allocator of @ref deferred_allocator, so that it can
+        /// be the underlying allocator of the zeroizing @ref allocator:
+        /// `core::allocator<T,core::deferred_over<core::secure_arena_allocator>::allocator>`
+        /// @tparam underlying_allocator allocator providing and taking back the memory
+        template <template <class> class underlying_allocator = ::std::allocator>
+        struct deferred_over {
+            /// Deferred allocator on top of underlying_allocator
+            /// @tparam T class of the object type for the STL container
+            template <class T> using allocator = deferred_allocator<T, underlying_allocator>;
+        };
+
+    }
+
+}
+
+#endif // CPP11CRYPTO_CORE_DEFERRED_WIPE_HPP
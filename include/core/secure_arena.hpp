@@ -0,0 +1,419 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// core/secure_arena.hpp - Pool of locked, non-dumpable memory carved in
+//                    size classes, to be used under zeroizing allocators
+
+#ifndef CPP11CRYPTO_CORE_SECURE_ARENA_HPP
+#define CPP11CRYPTO_CORE_SECURE_ARENA_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <utility>
+#include "core/secure_wipe.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+/// Defined when secure memory is obtained from mmap and can be locked
+#define CPP11CRYPTO_SECURE_MMAP 1
+#endif
+
+namespace cpp11crypto {
+    namespace core {
+
+        /// Snapshot of the counters kept by @ref secure_arena
+        struct arena_statistics {
+            /// Allocations served from a free list, without system calls
+            ::std::uint64_t hits {0};
+            /// Allocations that needed a new region or a direct mapping
+            ::std::uint64_t misses {0};
+            /// Bytes of secure memory currently mapped
+            ::std::uint64_t resident_bytes {0};
+            /// Bytes currently handed out to callers, rounded to their size class
+            ::std::uint64_t in_use_bytes {0};
+            /// Mappings whose pages could not be locked in memory
+            ::std::uint64_t unlocked_mappings {0};
+
+            /// Fraction of allocations served without system calls
+            /// @return hit rate in [0,1], 0 if nothing was allocated yet
+            double hit_rate() const noexcept {
+                return 0 == hits+misses ? 0.0 : static_cast<double>(hits)/(hits+misses);
+            }
+        };
+
+        namespace details {
+
+            /// Size of a memory page
+            /// @return page size in bytes
+            inline ::std::size_t page_size() noexcept {
+#ifdef CPP11CRYPTO_SECURE_MMAP
+                static const ::std::size_t size = static_cast<::std::size_t>(::sysconf(_SC_PAGESIZE));
+                return size;
+#else
+                return 4096;
+#endif
+            }
+
+            /// Rounds a size up to a multiple of a power of two
+            /// @param size size to round
+            /// @param granule power of two
+            /// @return rounded size
+            constexpr ::std::size_t round_up(const ::std::size_t size,const ::std::size_t granule) noexcept {
+                return (size + granule - 1) & ~(granule - 1);
+            }
+
+            /// Maps memory locked in RAM and excluded from core dumps
+            /// @param bytes size of the mapping, multiple of the page size
+            /// @param locked set to true if the pages could be locked
+            /// @return address of the mapping
+            /// @throw std::bad_alloc if no memory could be mapped
+            inline void *map_secure(const ::std::size_t bytes,bool& locked) {
+#ifdef CPP11CRYPTO_SECURE_MMAP
+#ifdef MAP_ANONYMOUS
+                void * const p = ::mmap(nullptr,bytes,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS,-1,0);
+#else
+                void * const p = ::mmap(nullptr,bytes,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANON,-1,0);
+#endif
+                if (MAP_FAILED == p) {
+                    throw ::std::bad_alloc();
+                }
+#ifdef MADV_DONTDUMP
+                ::madvise(p,bytes,MADV_DONTDUMP);
+#endif
+                // A failure is tolerated, RLIMIT_MEMLOCK may be low; it is reported by the counters
+                locked = 0 == ::mlock(p,bytes);
+                return p;
+#else
+                locked = false;
+                return ::operator new(bytes);
+#endif
+            }
+
+            /// Releases a mapping obtained from @ref map_secure. It must be already wiped.
+            /// @param p address of the mapping
+            /// @param bytes size of the mapping
+            /// @param locked whether the pages were locked
+            inline void unmap_secure(void * const p,const ::std::size_t bytes,const bool locked) noexcept {
+#ifdef CPP11CRYPTO_SECURE_MMAP
+                if (locked) {
+                    ::munlock(p,bytes);
+                }
+                ::munmap(p,bytes);
+#else
+                (void) bytes;
+                (void) locked;
+                ::operator delete(p);
+#endif
+            }
+
+        }
+
+        /// Process wide pool of secure memory.
+        /// Small blocks are carved, by size class, from large locked regions that are never
+        /// returned to the system; freed blocks are wiped and kept in per class free lists,
+        /// as are the rests of regions too short for the block that needed a new one.
+        /// Blocks over the largest class get a mapping of their own.
+        class secure_arena {
+        public:
+            /// Smallest block handed out, also the alignment of every block
+            static constexpr ::std::size_t min_block = 16;
+            /// Number of size classes, powers of two from @ref min_block
+            static constexpr ::std::size_t class_count = 9;
+            /// Largest block carved from regions
+            static constexpr ::std::size_t max_block = min_block << (class_count-1);
+            /// Size of each region mapped for small blocks
+            static constexpr ::std::size_t region_bytes = ::std::size_t {1} << 20;
+
+            /// The only arena. It is never destroyed, so that containers with static
+            /// storage duration can still free their memory during program exit.
+            /// @return reference to the arena
+            static secure_arena& instance() {
+                static secure_arena * const arena = new secure_arena;
+                return *arena;
+            }
+
+            /// Size class serving a request
+            /// @param bytes size requested
+            /// @return class index, @ref class_count for blocks served by direct mappings
+            static ::std::size_t size_class(const ::std::size_t bytes) noexcept {
+                ::std::size_t index = 0;
+                for (::std::size_t block = min_block; block < bytes && index != class_count; block <<= 1) {
+                    ++index;
+                }
+                return index;
+            }
+
+            /// Block size of a size class
+            /// @param index class index
+            /// @return block size in bytes
+            static constexpr ::std::size_t class_size(const ::std::size_t index) noexcept {
+                return min_block << index;
+            }
+
+            /// Allocates a block
+            /// @param bytes size required
+            /// @return block address, aligned to @ref min_block
+            /// @throw std::bad_alloc if no memory could be mapped
+            void *allocate(const ::std::size_t bytes) {
+                const ::std::size_t index = size_class(bytes);
+                if (class_count == index) {
+                    return allocate_mapping(bytes);
+                }
+                ::std::lock_guard<::std::mutex> lock {mutex};
+                if (nullptr != free_lists[index]) {
+                    ++stats.hits;
+                    stats.in_use_bytes += class_size(index);
+                    free_block * const block = free_lists[index];
+                    free_lists[index] = block->next;
+                    block->next = nullptr;
+                    return block;
+                }
+                if (region_left < class_size(index)) {
+                    ++stats.misses;
+                    carve_rest();
+                    bool locked;
+                    region_next = static_cast<unsigned char *>(details::map_secure(region_bytes,locked));
+                    region_left = region_bytes;
+                    stats.resident_bytes += region_bytes;
+                    stats.unlocked_mappings += locked ? 0 : 1;
+                } else {
+                    ++stats.hits;
+                }
+                stats.in_use_bytes += class_size(index);
+                void * const block = region_next;
+                region_next += class_size(index);
+                region_left -= class_size(index);
+                return block;
+            }
+
+            /// Wipes and frees a block
+            /// @param p block address, as returned by @ref allocate
+            /// @param bytes size requested when allocated
+            void deallocate(void * const p,const ::std::size_t bytes) noexcept {
+                if (nullptr == p) {
+                    return;
+                }
+                const ::std::size_t index = size_class(bytes);
+                if (class_count == index) {
+                    deallocate_mapping(p,bytes);
+                    return;
+                }
+                secure_wipe(p,class_size(index));
+                ::std::lock_guard<::std::mutex> lock {mutex};
+                stats.in_use_bytes -= class_size(index);
+                free_block * const block = static_cast<free_block *>(p);
+                block->next = free_lists[index];
+                free_lists[index] = block;
+            }
+
+            /// Reads the counters
+            /// @return snapshot of the counters
+            arena_statistics statistics() const {
+                ::std::lock_guard<::std::mutex> lock {mutex};
+                return stats;
+            }
+
+        private:
+            /// Link stored in the first bytes of a free block
+            struct free_block {
+                free_block *next;
+            };
+
+            secure_arena() = default;
+            secure_arena(const secure_arena&) = delete;
+            secure_arena& operator=(const secure_arena&) = delete;
+
+            /// Size of the direct mapping of a large block
+            /// @param bytes size requested
+            /// @return mapping size
+            static ::std::size_t mapping_size(const ::std::size_t bytes) noexcept {
+                return details::round_up(bytes,details::page_size());
+            }
+
+            /// Hands what is left of the current region to the free lists of the
+            /// smaller classes, largest first, so that no locked memory is lost when a
+            /// new region replaces it. Every block size divides the region size, so the
+            /// rest is a multiple of the smallest one.
+            void carve_rest() noexcept {
+                for (::std::size_t index = class_count; 0 != index--;) {
+                    while (region_left >= class_size(index)) {
+                        free_block * const block = reinterpret_cast<free_block *>(region_next);
+                        block->next = free_lists[index];
+                        free_lists[index] = block;
+                        region_next += class_size(index);
+                        region_left -= class_size(index);
+                    }
+                }
+            }
+
+            void *allocate_mapping(const ::std::size_t bytes) {
+                const ::std::size_t size = mapping_size(bytes);
+                bool locked;
+                void * const p = details::map_secure(size,locked);
+                ::std::lock_guard<::std::mutex> lock {mutex};
+                ++stats.misses;
+                stats.resident_bytes += size;
+                stats.in_use_bytes += size;
+                stats.unlocked_mappings += locked ? 0 : 1;
+                return p;
+            }
+
+            void deallocate_mapping(void * const p,const ::std::size_t bytes) noexcept {
+                const ::std::size_t size = mapping_size(bytes);
+                secure_wipe(p,size);
+                // munlock on pages that were never locked is harmless
+                details::unmap_secure(p,size,true);
+                ::std::lock_guard<::std::mutex> lock {mutex};
+                stats.resident_bytes -= size;
+                stats.in_use_bytes -= size;
+            }
+
+            mutable ::std::mutex mutex;
+            ::std::array<free_block *,class_count> free_lists {{}};
+            unsigned char *region_next {nullptr};
+            ::std::size_t region_left {0};
+            arena_statistics stats;
+        };
+
+        template <typename T> class secure_arena_allocator;
+
+        /// Root specialization of the arena allocator
+        template <>
+        class secure_arena_allocator<void> {
+        public:
+            /// pointer trait required by STL
+            typedef void* pointer;
+            /// const pointer trait required by STL
+            typedef const void* const_pointer;
+            /// value type trait required by STL
+            typedef void value_type;
+            /// Auxiliary structure required by STL to reuse allocators
+            /// @tparam U class of the object(s) to be allocated by STL container
+            template <class U> struct rebind {
+                typedef secure_arena_allocator<U> other;
+            };
+        };
+
+        /// Allocator, STL compatible, drawing from @ref secure_arena.
+        /// Meant as the underlying allocator of the zeroizing @ref allocator:
+        /// `core::allocator<T,core::secure_arena_allocator>`. Memory is then wiped
+        /// twice, on purpose: each object as it is destroyed, then the whole block
+        /// by the arena. Neither pass covers the other. The arena also wipes the
+        /// class slack and the capacity no object ever used. It also serves raw
+        /// users with no destroy step, such as the large blocks of secure_pool.
+        /// The object wipe in turn holds with any underlying allocator. The second
+        /// pass runs over lines the first one has just written, still in cache.
+        /// @tparam T class of the object type for the STL container, aligned to at
+        ///           most @ref secure_arena::min_block bytes
+        template <typename T>
+        class secure_arena_allocator {
+            static_assert(alignof(T) <= secure_arena::min_block,
+                          "Secure arena blocks are not aligned enough for this type");
+        public:
+            /// size type trait required by STL
+            typedef ::std::size_t size_type;
+            /// difference type trait required by STL
+            typedef ::std::ptrdiff_t difference_type;
+            /// pointer trait required by STL
+            typedef T* pointer;
+            /// const pointer trait required by STL
+            typedef const T* const_pointer;
+            /// reference trait required by STL
+            typedef T& reference;
+            /// const reference trait required by STL
+            typedef const T& const_reference;
+            /// value type trait required by STL
+            typedef T value_type;
+
+            /// Auxiliary structure required by STL to reuse allocators
+            /// @tparam U class of the object(s) to be allocated by STL container
+            template <class U> struct rebind {
+                typedef secure_arena_allocator<U> other;
+            };
+
+            /// Constructor does nothing special, defaulted
+            secure_arena_allocator() noexcept = default;
+            /// Copy constructor from compatible object does nothing special
+            /// @param other compatible allocator to be copied, it is ignored
+            template <class U>
+            secure_arena_allocator(const secure_arena_allocator<U>& other) noexcept {}
+
+            /// Allocates space for n objects.
+            /// @param n number of objects to allocate space for
+            /// @param hint ignored
+            /// @return address allocated
+            pointer allocate(const size_type n,secure_arena_allocator<void>::const_pointer const hint = 0) {
+                if (n > max_size()) {
+                    throw ::std::bad_alloc();
+                }
+                return static_cast<pointer>(secure_arena::instance().allocate(n*sizeof(T)));
+            }
+
+            /// Wipes and deallocates space from n objects. The arena wipes the whole
+            /// block, whether or not destroy wiped the objects in it.
+            /// @param p pointer to first address
+            /// @param n number of objects space was allocated for
+            void deallocate(const pointer p,const size_type n) noexcept {
+                secure_arena::instance().deallocate(p,n*sizeof(T));
+            }
+
+            /// Largest number of objects that could be allocated
+            /// @return maximum count
+            size_type max_size() const noexcept {
+                return ::std::numeric_limits<size_type>::max()/sizeof(T);
+            }
+
+            /// Constructs an object in allocated space
+            /// @param p address of the object
+            /// @param args arguments for the constructor
+            template <class U, class... Args> void construct(U * const p, Args&&... args) {
+                ::new(static_cast<void *>(p)) U(::std::forward<Args>(args)...);
+            }
+
+            /// Destroys an object
+            /// @param p address of the object
+            template <class U> void destroy(U * const p) noexcept {
+                p->~U();
+            }
+        };
+
+        /// Arena allocators are stateless, all of them compare equal
+        /// @return true
+        template <class T, class U>
+        bool operator==(const secure_arena_allocator<T>&,const secure_arena_allocator<U>&) noexcept {
+            return true;
+        }
+
+        /// Arena allocators are stateless, all of them compare equal
+        /// @return false
+        template <class T, class U>
+        bool operator!=(const secure_arena_allocator<T>&,const secure_arena_allocator<U>&) noexcept {
+            return false;
+        }
+
+    }
+
+}
+
+#endif // CPP11CRYPTO_CORE_SECURE_ARENA_HPP
@@ -0,0 +1,243 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// core/secure_array.hpp - Fixed capacity arrays stored inline, zeroized
+//                    when destroyed or moved from
+
+#ifndef CPP11CRYPTO_CORE_SECURE_ARRAY_HPP
+#define CPP11CRYPTO_CORE_SECURE_ARRAY_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include "core/zeroizing.hpp"
+
+namespace cpp11crypto {
+    namespace core {
+
+        /// Array of N objects of type T stored inline, on the stack or inside another
+        /// object, never on the heap by itself. Its storage is zeroized when it is
+        /// destroyed and when it is moved from.
+        /// @tparam T element type, trivially destructible as its bytes are wiped in place
+        /// @tparam N number of elements
+        /// @tparam Align alignment of the storage, at least that of T
+        template <typename T, ::std::size_t N, ::std::size_t Align = alignof(T)>
+        class secure_array {
+            static_assert(N > 0, "A secure array must hold some element");
+            static_assert(::std::is_trivially_destructible<T>::value,
+                          "Elements are wiped in place, they cannot have destructors");
+            static_assert(Align >= alignof(T) && 0 == (Align & (Align-1)),
+                          "Alignment must be a power of two no weaker than that of T");
+        public:
+            /// value type trait, as in std::array
+            typedef T value_type;
+            /// size type trait, as in std::array
+            typedef ::std::size_t size_type;
+            /// difference type trait, as in std::array
+            typedef ::std::ptrdiff_t difference_type;
+            /// reference trait, as in std::array
+            typedef T& reference;
+            /// const reference trait, as in std::array
+            typedef const T& const_reference;
+            /// pointer trait, as in std::array
+            typedef T* pointer;
+            /// const pointer trait, as in std::array
+            typedef const T* const_pointer;
+            /// iterator trait, as in std::array
+            typedef T* iterator;
+            /// const iterator trait, as in std::array
+            typedef const T* const_iterator;
+
+            /// Constructor, value-initializes all elements
+            secure_array() noexcept : elements() {}
+
+            /// Constructor from a list of values, remaining elements are value-initialized
+            /// @param values initial values, no more than N
+            secure_array(const ::std::initializer_list<T> values) : elements() {
+                assert(values.size() <= N);
+                ::std::copy_n(values.begin(),::std::min(values.size(),N),elements);
+            }
+
+            /// Copy constructor
+            /// @param other array to be copied
+            secure_array(const secure_array& other) noexcept {
+                ::std::copy_n(other.elements,N,elements);
+            }
+
+            /// Move constructor, the source is zeroized
+            /// @param other array to be moved
+            secure_array(secure_array&& other) noexcept {
+                ::std::copy_n(other.elements,N,elements);
+                other.wipe();
+            }
+
+            /// Copy operator
+            /// @param other array to be copied
+            /// @return *this
+            secure_array& operator=(const secure_array& other) noexcept {
+                ::std::copy_n(other.elements,N,elements);
+                return *this;
+            }
+
+            /// Move operator, the source is zeroized
+            /// @param other array to be moved
+            /// @return *this
+            secure_array& operator=(secure_array&& other) noexcept {
+                if (this != &other) {
+                    ::std::copy_n(other.elements,N,elements);
+                    other.wipe();
+                }
+                return *this;
+            }
+
+            /// Destructor, zeroizes the storage
+            ~secure_array() {
+                wipe();
+            }
+
+            /// Zeroizes the storage, leaving all elements with an all-zero representation
+            void wipe() noexcept {
+                do_zeroize(elements,sizeof elements);
+            }
+
+            /// Number of elements, known at compile time
+            /// @return N
+            static constexpr size_type size() noexcept {
+                return N;
+            }
+            /// Size of the storage, known at compile time
+            /// @return bytes used by the elements
+            static constexpr size_type bytes() noexcept {
+                return N*sizeof(T);
+            }
+
+            /// Access to the storage
+            /// @return pointer to the first element
+            pointer data() noexcept {
+                return elements;
+            }
+            /// Access to the storage
+            /// @return pointer to the first element
+            const_pointer data() const noexcept {
+                return elements;
+            }
+
+            /// Unchecked element access
+            /// @param i index of the element
+            /// @return reference to the element
+            reference operator[](const size_type i) noexcept {
+                return elements[i];
+            }
+            /// Unchecked element access
+            /// @param i index of the element
+            /// @return reference to the element
+            const_reference operator[](const size_type i) const noexcept {
+                return elements[i];
+            }
+
+            /// Checked element access
+            /// @param i index of the element
+            /// @return reference to the element
+            /// @throw std::out_of_range if i is not below N
+            reference at(const size_type i) {
+                if (i >= N) {
+                    throw ::std::out_of_range("secure_array::at");
+                }
+                return elements[i];
+            }
+            /// Checked element access
+            /// @param i index of the element
+            /// @return reference to the element
+            /// @throw std::out_of_range if i is not below N
+            const_reference at(const size_type i) const {
+                if (i >= N) {
+                    throw ::std::out_of_range("secure_array::at");
+                }
+                return elements[i];
+            }
+
+            /// @return iterator to the first element
+            iterator begin() noexcept {
+                return elements;
+            }
+            /// @return iterator past the last element
+            iterator end() noexcept {
+                return elements+N;
+            }
+            /// @return iterator to the first element
+            const_iterator begin() const noexcept {
+                return elements;
+            }
+            /// @return iterator past the last element
+            const_iterator end() const noexcept {
+                return elements+N;
+            }
+
+            /// Assigns a value to all elements
+            /// @param value value to assign
+            void fill(const T& value) noexcept {
+                ::std::fill_n(elements,N,value);
+            }
+
+            /// Compares the storage of two arrays in time independent of their contents
+            /// @param other array to compare with
+            /// @return true if both hold the same bytes
+            bool equals(const secure_array& other) const noexcept {
+                const unsigned char * const a = reinterpret_cast<const unsigned char *>(elements);
+                const unsigned char * const b = reinterpret_cast<const unsigned char *>(other.elements);
+                unsigned char difference = 0;
+                for (size_type i = 0; i != sizeof elements; ++i) {
+                    difference |= a[i] ^ b[i];
+                }
+                return 0 == difference;
+            }
+
+        private:
+            alignas(Align) T elements[N];
+        };
+
+        /// Compares two arrays in constant time, see @ref secure_array::equals
+        /// @return true if both hold the same bytes
+        template <typename T, ::std::size_t N, ::std::size_t Align>
+        bool operator==(const secure_array<T,N,Align>& a,const secure_array<T,N,Align>& b) noexcept {
+            return a.equals(b);
+        }
+
+        /// Compares two arrays in constant time, see @ref secure_array::equals
+        /// @return true if they hold different bytes
+        template <typename T, ::std::size_t N, ::std::size_t Align>
+        bool operator!=(const secure_array<T,N,Align>& a,const secure_array<T,N,Align>& b) noexcept {
+            return !a.equals(b);
+        }
+
+        /// Inline byte buffer for keys, nonces and cipher state, aligned as a 16-byte vector
+        /// @tparam N number of bytes
+        template <::std::size_t N>
+        using secure_buffer = secure_array<::std::uint8_t,N,16>;
+
+    }
+
+}
+
+#endif // CPP11CRYPTO_CORE_SECURE_ARRAY_HPP
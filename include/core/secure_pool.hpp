@@ -0,0 +1,331 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// core/secure_pool.hpp - Shared pool of secure blocks with per-thread
+//                    magazines, as a base operator for ZeroizingBase
+
+#ifndef CPP11CRYPTO_CORE_SECURE_POOL_HPP
+#define CPP11CRYPTO_CORE_SECURE_POOL_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include "core/secure_arena.hpp"
+#include "utils/aligned_as_vector.hpp"
+
+namespace cpp11crypto {
+    namespace core {
+
+        /// Snapshot of the counters kept by @ref secure_pool
+        struct pool_statistics {
+            /// Blocks carved from the arena since start
+            ::std::uint64_t carved_blocks {0};
+            /// Batches handed from the shared pool to a thread
+            ::std::uint64_t batches_taken {0};
+            /// Batches returned by threads to the shared pool
+            ::std::uint64_t batches_given {0};
+        };
+
+        /// Shared pool of secure blocks, one stack of batches per size class of
+        /// @ref secure_arena. Blocks are carved from the arena a batch at a time and
+        /// never given back to it. Batches are returned with a lock-free push; taking
+        /// one is serialized per class, which keeps the pop free from ABA.
+        class secure_pool {
+        public:
+            /// Blocks moved at once between a thread and the shared pool
+            static constexpr ::std::size_t batch_blocks = 32;
+
+            /// Header kept in every free block, which is at least 16 bytes long
+            struct block {
+                /// Next block in the same batch or magazine
+                block *next;
+                /// First block of the next batch in the shared stack
+                block *next_batch;
+            };
+
+            /// The only pool. It is never destroyed, see @ref secure_arena::instance.
+            /// @return reference to the pool
+            static secure_pool& instance() {
+                // placement into static storage, plain new would not honour the alignment
+                static utils::aligned_storage<sizeof(secure_pool),alignof(secure_pool)>::type storage;
+                static secure_pool * const pool = new(&storage) secure_pool;
+                return *pool;
+            }
+
+            /// Takes a batch of free blocks, carving a new one if the class is empty
+            /// @param index size class
+            /// @return first block of a list linked by @ref block::next
+            block *take_batch(const ::std::size_t index) {
+                shelf& s = shelves[index];
+                block *top;
+                {
+                    ::std::lock_guard<::std::mutex> lock {s.pop_mutex};
+                    top = s.batches.load(::std::memory_order_acquire);
+                    while (nullptr != top &&
+                            !s.batches.compare_exchange_weak(top,top->next_batch,
+                                    ::std::memory_order_acquire,::std::memory_order_acquire)) {
+                    }
+                }
+                if (nullptr != top) {
+                    batches_taken.fetch_add(1,::std::memory_order_relaxed);
+                    return top;
+                }
+                return carve(index);
+            }
+
+            /// Returns a batch of wiped blocks, without locking
+            /// @param index size class
+            /// @param first first block of a list linked by @ref block::next
+            void give_batch(const ::std::size_t index,block * const first) noexcept {
+                shelf& s = shelves[index];
+                first->next_batch = s.batches.load(::std::memory_order_relaxed);
+                while (!s.batches.compare_exchange_weak(first->next_batch,first,
+                                                        ::std::memory_order_release,::std::memory_order_relaxed)) {
+                }
+                batches_given.fetch_add(1,::std::memory_order_relaxed);
+            }
+
+            /// Reads the counters
+            /// @return snapshot of the counters
+            pool_statistics statistics() const noexcept {
+                pool_statistics result;
+                result.carved_blocks = carved_blocks.load(::std::memory_order_relaxed);
+                result.batches_taken = batches_taken.load(::std::memory_order_relaxed);
+                result.batches_given = batches_given.load(::std::memory_order_relaxed);
+                return result;
+            }
+
+        private:
+            /// Stack of batches of a size class, on its own cache line
+            struct alignas(utils::cache_line_size) shelf {
+                ::std::atomic<block *> batches {nullptr};
+                ::std::mutex pop_mutex;
+            };
+
+            secure_pool() = default;
+            secure_pool(const secure_pool&) = delete;
+            secure_pool& operator=(const secure_pool&) = delete;
+
+            block *carve(const ::std::size_t index) {
+                const ::std::size_t size = secure_arena::class_size(index);
+                unsigned char * const chunk =
+                    static_cast<unsigned char *>(secure_arena::instance().allocate(size*batch_blocks));
+                block *first = nullptr;
+                for (::std::size_t i = batch_blocks; 0 != i--;) {
+                    block * const b = reinterpret_cast<block *>(chunk + i*size);
+                    b->next = first;
+                    b->next_batch = nullptr;
+                    first = b;
+                }
+                carved_blocks.fetch_add(batch_blocks,::std::memory_order_relaxed);
+                return first;
+            }
+
+            ::std::array<shelf,secure_arena::class_count> shelves;
+            ::std::atomic<::std::uint64_t> carved_blocks {0};
+            ::std::atomic<::std::uint64_t> batches_taken {0};
+            ::std::atomic<::std::uint64_t> batches_given {0};
+        };
+
+        namespace details {
+
+            /// Per-thread cache of free blocks for every size class.
+            /// It never holds more than two batches per class; the rest goes back to the
+            /// shared pool, as does everything when the thread ends.
+            class magazine {
+            public:
+                /// Blocks kept per class before a batch is returned
+                static constexpr ::std::size_t capacity = 2*secure_pool::batch_blocks;
+
+                /// Magazine of the calling thread. Objects freed by the destructors of
+                /// other thread_local or static objects may outlive it.
+                /// @return pointer to the magazine, nullptr once it has been destroyed
+                static magazine *local() {
+                    if (lifetime::ended == state()) {
+                        return nullptr;
+                    }
+                    static thread_local magazine m;
+                    return &m;
+                }
+
+                magazine() noexcept {
+                    state() = lifetime::alive;
+                }
+                magazine(const magazine&) = delete;
+                magazine& operator=(const magazine&) = delete;
+
+                /// Returns every cached block to the shared pool
+                ~magazine() {
+                    state() = lifetime::ended;
+                    for (::std::size_t index = 0; index != heads.size(); ++index) {
+                        while (0 != counts[index]) {
+                            give_batch(index);
+                        }
+                    }
+                }
+
+                /// Takes a block
+                /// @param index size class
+                /// @return block, its header cleared
+                void *pop(const ::std::size_t index) {
+                    if (0 == counts[index]) {
+                        heads[index] = secure_pool::instance().take_batch(index);
+                        for (const secure_pool::block *b = heads[index]; nullptr != b; b = b->next) {
+                            ++counts[index];
+                        }
+                    }
+                    secure_pool::block * const b = heads[index];
+                    heads[index] = b->next;
+                    --counts[index];
+                    b->next = nullptr;
+                    b->next_batch = nullptr;
+                    return b;
+                }
+
+                /// Keeps a wiped block
+                /// @param index size class
+                /// @param p block
+                void push(const ::std::size_t index,void * const p) noexcept {
+                    secure_pool::block * const b = static_cast<secure_pool::block *>(p);
+                    b->next = heads[index];
+                    heads[index] = b;
+                    if (++counts[index] > capacity) {
+                        give_batch(index);
+                    }
+                }
+
+                /// Takes a block straight from the shared pool, for threads whose
+                /// magazine is gone. The rest of the batch goes back at once.
+                /// @param index size class
+                /// @return block, its header cleared
+                static void *pop_shared(const ::std::size_t index) {
+                    secure_pool::block * const b = secure_pool::instance().take_batch(index);
+                    if (nullptr != b->next) {
+                        secure_pool::instance().give_batch(index,b->next);
+                    }
+                    b->next = nullptr;
+                    b->next_batch = nullptr;
+                    return b;
+                }
+
+                /// Returns a wiped block straight to the shared pool, as a batch of one
+                /// @param index size class
+                /// @param p block
+                static void push_shared(const ::std::size_t index,void * const p) noexcept {
+                    secure_pool::block * const b = static_cast<secure_pool::block *>(p);
+                    b->next = nullptr;
+                    secure_pool::instance().give_batch(index,b);
+                }
+
+            private:
+                /// Lifetime of the magazine of a thread
+                enum class lifetime : unsigned char {
+                    unborn,
+                    alive,
+                    ended
+                };
+
+                /// Lifetime of the magazine of the calling thread. A trivially
+                /// destructible thread_local, so it outlives every other one.
+                /// @return reference to the state
+                static lifetime& state() noexcept {
+                    static thread_local lifetime s {lifetime::unborn};
+                    return s;
+                }
+
+                /// Detaches up to a batch from the head of a class and returns it
+                /// @param index size class
+                void give_batch(const ::std::size_t index) noexcept {
+                    secure_pool::block * const first = heads[index];
+                    secure_pool::block *last = first;
+                    ::std::size_t n = 1;
+                    for (; n != secure_pool::batch_blocks && nullptr != last->next; ++n) {
+                        last = last->next;
+                    }
+                    heads[index] = last->next;
+                    counts[index] -= n;
+                    last->next = nullptr;
+                    secure_pool::instance().give_batch(index,first);
+                }
+
+                ::std::array<secure_pool::block *,secure_arena::class_count> heads {{}};
+                ::std::array<::std::size_t,secure_arena::class_count> counts {{}};
+            };
+
+        }
+
+        /// Base operator for @ref ZeroizingBase drawing from @ref secure_pool through
+        /// per-thread magazines. Blocks are wiped by ZeroizingBase before they are
+        /// deleted, so they are cached as they come. Objects over the largest size
+        /// class go straight to @ref secure_arena. Once the magazine of a thread has
+        /// been destroyed, its blocks are taken from and given to @ref secure_pool.
+        struct thread_cached {
+            /// Allocates a secure block
+            /// @param size number of bytes required
+            /// @return pointer to allocated space
+            static void *get_new(const ::std::size_t size) {
+                const ::std::size_t index = secure_arena::size_class(size);
+                if (secure_arena::class_count == index) {
+                    return secure_arena::instance().allocate(size);
+                }
+                details::magazine * const m = details::magazine::local();
+                return nullptr != m ? m->pop(index) : details::magazine::pop_shared(index);
+            }
+            /// Caches a wiped block in the thread magazine
+            /// @param p pointer to space to free
+            /// @param size of memory block to free
+            static void do_delete(void * const p,const ::std::size_t size) {
+                if (nullptr == p) {
+                    return;
+                }
+                const ::std::size_t index = secure_arena::size_class(size);
+                if (secure_arena::class_count == index) {
+                    secure_arena::instance().deallocate(p,size);
+                    return;
+                }
+                details::magazine * const m = details::magazine::local();
+                if (nullptr != m) {
+                    m->push(index,p);
+                } else {
+                    details::magazine::push_shared(index,p);
+                }
+            }
+
+            /// Allocates a secure block for an array
+            /// @param size number of bytes required
+            /// @return pointer to allocated space
+            static void *get_new_array(const ::std::size_t size) {
+                return get_new(size);
+            }
+            /// Caches a wiped block of an array in the thread magazine
+            /// @param p pointer to space to free
+            /// @param size of memory block to free
+            static void do_delete_array(void * const p,const ::std::size_t size) {
+                do_delete(p,size);
+            }
+        };
+
+    }
+
+}
+
+#endif // CPP11CRYPTO_CORE_SECURE_POOL_HPP
@@ -0,0 +1,224 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// core/secure_wipe.hpp - Wiping of memory blocks that cannot be optimized
+//                    away, using the widest vector stores available on short ones
+
+#ifndef CPP11CRYPTO_CORE_SECURE_WIPE_HPP
+#define CPP11CRYPTO_CORE_SECURE_WIPE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "utils/cpu_features.hpp"
+
+namespace cpp11crypto {
+    namespace core {
+
+        /// Available wiping kernels, one per vector level: memset, then 16, 32
+        /// and 64-byte vector stores
+        using wipe_engine = utils::simd_level;
+
+        namespace details {
+
+            /// Compiler barrier. The compiler must assume the memory behind the pointer
+            /// is read afterwards, so the preceding stores cannot be removed as dead.
+            /// @param p pointer to the wiped block
+            inline void wipe_barrier(const void * const p) noexcept {
+#if defined(__GNUC__)
+                __asm__ __volatile__("" : : "r"(p) : "memory");
+#else
+                static_cast<const volatile unsigned char *>(p)[0];
+#endif
+            }
+
+            /// Portable kernel
+            /// @param start pointer to first byte of the memory block
+            /// @param len length in bytes of the memory block
+            inline void wipe_scalar(void * const start,const ::std::size_t len) noexcept {
+                if (0 != len) {
+                    ::std::memset(start,0,len);
+                    wipe_barrier(start);
+                }
+            }
+
+#ifdef CPP11CRYPTO_X86_INTRINSICS
+            /// Rounds a pointer up to the next multiple of an alignment
+            /// @tparam A alignment, power of two
+            /// @param p pointer to round
+            /// @return rounded pointer
+            template <::std::size_t A>
+            unsigned char *align_up(unsigned char * const p) noexcept {
+                return reinterpret_cast<unsigned char *>(
+                           (reinterpret_cast<::std::uintptr_t>(p) + (A-1)) & ~::std::uintptr_t {A-1});
+            }
+
+            /// SSE2 kernel. The unaligned head and tail are covered by two overlapping
+            /// unaligned stores, the body by aligned stores, four per iteration.
+            /// @param start pointer to first byte of the memory block
+            /// @param len length in bytes of the memory block
+            __attribute__((target("sse2")))
+            inline void wipe_sse2(void * const start,const ::std::size_t len) noexcept {
+                if (len < 16) {
+                    wipe_scalar(start,len);
+                    return;
+                }
+                unsigned char * const first = static_cast<unsigned char *>(start);
+                unsigned char * const last = first + len;
+                const __m128i zero = _mm_setzero_si128();
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(first),zero);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(last-16),zero);
+                unsigned char *p = align_up<16>(first);
+                for (; p+64 <= last; p+=64) {
+                    _mm_store_si128(reinterpret_cast<__m128i *>(p),zero);
+                    _mm_store_si128(reinterpret_cast<__m128i *>(p+16),zero);
+                    _mm_store_si128(reinterpret_cast<__m128i *>(p+32),zero);
+                    _mm_store_si128(reinterpret_cast<__m128i *>(p+48),zero);
+                }
+                for (; p+16 <= last; p+=16) {
+                    _mm_store_si128(reinterpret_cast<__m128i *>(p),zero);
+                }
+                wipe_barrier(start);
+            }
+
+            /// AVX2 kernel, same structure as @ref wipe_sse2 with 32-byte stores
+            /// @param start pointer to first byte of the memory block
+            /// @param len length in bytes of the memory block
+            __attribute__((target("avx2")))
+            inline void wipe_avx2(void * const start,const ::std::size_t len) noexcept {
+                if (len < 32) {
+                    wipe_sse2(start,len);
+                    return;
+                }
+                unsigned char * const first = static_cast<unsigned char *>(start);
+                unsigned char * const last = first + len;
+                const __m256i zero = _mm256_setzero_si256();
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(first),zero);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(last-32),zero);
+                unsigned char *p = align_up<32>(first);
+                for (; p+128 <= last; p+=128) {
+                    _mm256_store_si256(reinterpret_cast<__m256i *>(p),zero);
+                    _mm256_store_si256(reinterpret_cast<__m256i *>(p+32),zero);
+                    _mm256_store_si256(reinterpret_cast<__m256i *>(p+64),zero);
+                    _mm256_store_si256(reinterpret_cast<__m256i *>(p+96),zero);
+                }
+                for (; p+32 <= last; p+=32) {
+                    _mm256_store_si256(reinterpret_cast<__m256i *>(p),zero);
+                }
+                wipe_barrier(start);
+            }
+
+            /// AVX-512 kernel, same structure as @ref wipe_sse2 with 64-byte stores
+            /// @param start pointer to first byte of the memory block
+            /// @param len length in bytes of the memory block
+            __attribute__((target("avx512f")))
+            inline void wipe_avx512(void * const start,const ::std::size_t len) noexcept {
+                if (len < 64) {
+                    wipe_avx2(start,len);
+                    return;
+                }
+                unsigned char * const first = static_cast<unsigned char *>(start);
+                unsigned char * const last = first + len;
+                const __m512i zero = _mm512_setzero_si512();
+                _mm512_storeu_si512(first,zero);
+                _mm512_storeu_si512(last-64,zero);
+                unsigned char *p = align_up<64>(first);
+                for (; p+256 <= last; p+=256) {
+                    _mm512_store_si512(p,zero);
+                    _mm512_store_si512(p+64,zero);
+                    _mm512_store_si512(p+128,zero);
+                    _mm512_store_si512(p+192,zero);
+                }
+                for (; p+64 <= last; p+=64) {
+                    _mm512_store_si512(p,zero);
+                }
+                wipe_barrier(start);
+            }
+#endif
+
+            /// Signature shared by all wiping kernels
+            using wipe_function = void (*)(void *,::std::size_t);
+
+        }
+
+        /// Tells whether a wiping kernel can run on this processor
+        using utils::is_supported;
+
+        /// Length from which the portable kernel wipes: the C library's memset,
+        /// tuned for large blocks, keeps up with the vector kernels at 4 KiB and
+        /// beats them past it, per benchmarks/core/secure_wipe
+        constexpr ::std::size_t vector_wipe_limit = 4096;
+
+        /// Fastest wiping kernel usable on this processor for a block length: the
+        /// widest vector one below @ref vector_wipe_limit, memset from there
+        /// @param len length in bytes of the block, short by default
+        /// @return selected kernel
+        inline wipe_engine best_wipe_engine(const ::std::size_t len = 0) noexcept {
+            return len < vector_wipe_limit ? utils::simd() : wipe_engine::scalar;
+        }
+
+        namespace details {
+            /// Maps a kernel to its function. Unsupported kernels map to the portable one.
+            /// @param engine kernel to map
+            /// @return kernel function
+            inline wipe_function wipe_function_for(const wipe_engine engine) noexcept {
+#ifdef CPP11CRYPTO_X86_INTRINSICS
+                if (is_supported(engine)) {
+                    switch (engine) {
+                    case wipe_engine::sse2:
+                        return &wipe_sse2;
+                    case wipe_engine::avx2:
+                        return &wipe_avx2;
+                    case wipe_engine::avx512:
+                        return &wipe_avx512;
+                    case wipe_engine::scalar:
+                        break;
+                    }
+                }
+#endif
+                return &wipe_scalar;
+            }
+        }
+
+        /// Wipes a memory block with a given kernel
+        /// @param start pointer to first byte of the memory block
+        /// @param len length in bytes of the memory block
+        /// @param engine kernel to use, the portable one if not supported
+        inline void secure_wipe(void * const start,const ::std::size_t len,const wipe_engine engine) noexcept {
+            details::wipe_function_for(engine)(start,len);
+        }
+
+        /// Wipes a memory block with the fastest kernel for its length, the vector
+        /// one being selected once
+        /// @param start pointer to first byte of the memory block
+        /// @param len length in bytes of the memory block
+        inline void secure_wipe(void * const start,const ::std::size_t len) noexcept {
+            static const details::wipe_function kernel = details::wipe_function_for(best_wipe_engine());
+            if (len >= vector_wipe_limit) {
+                details::wipe_scalar(start,len);
+                return;
+            }
+            kernel(start,len);
+        }
+
+    }
+
+}
+
+#endif // CPP11CRYPTO_CORE_SECURE_WIPE_HPP
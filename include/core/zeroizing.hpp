@@ -27,14 +27,17 @@
 #include <cstring>
 #include <memory>
 #include <algorithm>
+#include <type_traits>
 #include <utility>
 #include "utils/aligned_as_integral.hpp"
+#include "core/secure_wipe.hpp"
 
 namespace cpp11crypto {
     namespace core {
         namespace details  {
 
-            /// Helper struct meant to zeroize the memory used previously by one or more objects of type U
+            /// Helper struct meant to zeroize the memory used previously by one or more objects of type U.
+            /// The block is wiped as a whole by @ref secure_wipe, whatever the type.
             /// @tparam U type of the objects that resided originally
             template <typename U>
             struct zeroizer {
@@ -49,15 +52,7 @@ namespace cpp11crypto {
             template <typename U>
             void zeroizer<U>::operator()(void * const start,const size_t len) const {
                 assert(0 == len % sizeof(casted_to));
-                do {
-                    ::std::uninitialized_fill_n(static_cast<casted_to *>(start),len/sizeof(casted_to),casted_to {});
-                } while (
-                    start == ::std::find_if(static_cast<const casted_to *>(start),
-                                            static_cast<const casted_to *>(start)+len,
-                [](const casted_to c) {
-                return casted_to {} !=c;
-            })
-            );
+                secure_wipe(start,len);
             }
 
         }
@@ -67,6 +62,20 @@ namespace cpp11crypto {
             details::zeroizer<T>()(start,len);
         }
 
+        /// Trait telling whether a base operator wipes memory itself when it is released,
+        /// so that @ref ZeroizingBase must not wipe it beforehand. It is declared by a
+        /// `static constexpr bool deferred_wipe = true;` member. Zeroizing allocators
+        /// wipe every object they destroy regardless, as destroyed objects may stay in
+        /// the spare capacity of a container long before it is deallocated.
+        /// @tparam X base operator
+        template <typename X, typename = void>
+        struct defers_wipe : ::std::false_type {};
+
+        /// Specialization for types declaring the member
+        /// @tparam X base operator
+        template <typename X>
+        struct defers_wipe<X, typename ::std::enable_if<X::deferred_wipe>::type> : ::std::true_type {};
+
         // Zeroizing class templates
 
         // To be used by STL templates instead of default (or any other) allocator
@@ -108,6 +117,12 @@ namespace cpp11crypto {
             /// Move constructor does nothing special, defaulted
             /// @param other allocator to be moved
             allocator(allocator&& other) noexcept = default;
+            /// Copy assignment does nothing special, defaulted
+            /// @param other allocator to be copied
+            allocator& operator=(const allocator& other) noexcept = default;
+            /// Move assignment does nothing special, defaulted
+            /// @param other allocator to be moved
+            allocator& operator=(allocator&& other) noexcept = default;
             /// Copy constructor from compatible object does nothing special
             /// @param other compatible allocator to be copied, it is ignored
             template <class U>
@@ -154,6 +169,22 @@ namespace cpp11crypto {
 
         };
 
+        /// Zeroizing allocators keep no state of their own, all of them compare equal
+        /// @return true
+        template <class T, class U, template <class> class underlying_allocator>
+        bool operator==(const allocator<T, underlying_allocator>&,
+                        const allocator<U, underlying_allocator>&) noexcept {
+            return true;
+        }
+
+        /// Zeroizing allocators keep no state of their own, all of them compare equal
+        /// @return false
+        template <class T, class U, template <class> class underlying_allocator>
+        bool operator!=(const allocator<T, underlying_allocator>&,
+                        const allocator<U, underlying_allocator>&) noexcept {
+            return false;
+        }
+
         /// Proxy structure to allow using of global operator new... by @ref ZeroizingBase
         struct standard {
             /// Allocates required space by calling global operator new
@@ -208,11 +239,14 @@ namespace cpp11crypto {
             static void *operator new(const ::std::size_t size) {
                 return base_operator::get_new(size);
             }
-            /// Zeroizes and frees space by calling global base_operator do_delete
+            /// Zeroizes and frees space by calling global base_operator do_delete.
+            /// Zeroizing is left to base_operator if it defers wiping.
             /// @param p pointer to space to free
             /// @param size of memory block to free
             static void operator delete(void * const p,const ::std::size_t size) {
-                do_zeroize(p,size);
+                if (!defers_wipe<base_operator>::value) {
+                    do_zeroize(p,size);
+                }
                 base_operator::do_delete(p,size);
             }
 
@@ -222,11 +256,14 @@ namespace cpp11crypto {
             static void *operator new[](const ::std::size_t size) {
                 return base_operator::get_new_array(size);
             }
-            /// Zeroizes and frees space by calling global base_operator do_delete_array
+            /// Zeroizes and frees space by calling global base_operator do_delete_array.
+            /// Zeroizing is left to base_operator if it defers wiping.
             /// @param p pointer to space to free
             /// @param size of memory block to free
             static void operator delete[](void * const p,const ::std::size_t size) {
-                do_zeroize(p,size);
+                if (!defers_wipe<base_operator>::value) {
+                    do_zeroize(p,size);
+                }
                 base_operator::do_delete_array(p,size);
             }
         };
@@ -0,0 +1,709 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// hash/sha2.hpp - SHA-256 and SHA-512 (FIPS 180-4): one message at a time,
+//                    with SHA-NI for SHA-256, or many independent messages at
+//                    once across the lanes of SSE2, AVX2 or AVX-512 vectors
+
+#ifndef CPP11CRYPTO_HASH_SHA2_HPP
+#define CPP11CRYPTO_HASH_SHA2_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include "core/secure_array.hpp"
+#include "core/zeroizing.hpp"
+#include "utils/cpu_features.hpp"
+#include "utils/endian.hpp"
+#include "utils/span.hpp"
+
+namespace cpp11crypto {
+    namespace hash {
+
+        /// Implementations of the hash of a single message
+        enum class sha_engine {
+            /// Portable code
+            scalar,
+            /// SHA-NI instructions, SHA-256 only
+            shani
+        };
+
+        /// Tells whether an implementation can run on this processor
+        /// @param engine implementation to check
+        /// @return true if usable
+        inline bool is_supported(const sha_engine engine) noexcept {
+            switch (engine) {
+            case sha_engine::scalar:
+                return true;
+            case sha_engine::shani:
+                return utils::cpu().sha && utils::cpu().ssse3 && utils::cpu().sse41;
+            }
+            return false;
+        }
+
+        /// Fastest SHA-256 implementation usable on this processor, selected once
+        /// @return selected implementation
+        inline sha_engine best_sha_engine() noexcept {
+            static const sha_engine engine =
+                is_supported(sha_engine::shani) ? sha_engine::shani : sha_engine::scalar;
+            return engine;
+        }
+
+        /// Kernels hashing independent messages, one per vector level: one message
+        /// at a time, then one message per 32-bit (SHA-256) or 64-bit (SHA-512) lane
+        /// of 16, 32 and 64-byte vectors
+        using multi_engine = utils::simd_level;
+
+        /// Tells whether a multi-buffer kernel can run on this processor
+        using utils::is_supported;
+
+        /// Widest multi-buffer kernel usable on this processor
+        /// @return selected kernel
+        inline multi_engine best_multi_engine() noexcept {
+            return utils::simd();
+        }
+
+        /// Fastest way to hash many SHA-256 messages on this processor, selected
+        /// once: 16 lanes of AVX-512 if usable, else one message at a time when
+        /// SHA-NI is there, as it outruns the narrower lanes, else the widest lanes
+        /// @return selected kernel
+        inline multi_engine best_multi_sha256_engine() noexcept {
+            static const multi_engine engine =
+                is_supported(multi_engine::avx512) ? multi_engine::avx512 :
+                is_supported(sha_engine::shani) ? multi_engine::scalar : best_multi_engine();
+            return engine;
+        }
+
+        namespace details {
+
+            /// Rounds, rotations and constants of SHA-256 and SHA-512, by word type:
+            /// s0*, s1* rotate for Σ0, Σ1; r0*, r1* rotate and shift for σ0, σ1
+            template <typename Word> struct sha2_parameters;
+
+            template <> struct sha2_parameters<::std::uint32_t> {
+                enum : unsigned {
+                    rounds = 64,
+                    s0a = 2, s0b = 13, s0c = 22, s1a = 6, s1b = 11, s1c = 25,
+                    r0a = 7, r0b = 18, r0s = 3, r1a = 17, r1b = 19, r1s = 10
+                };
+                static const ::std::uint32_t * constants() noexcept {
+                    alignas(16) static const ::std::uint32_t k[64] = {
+                        0x428a2f98,0x71374491,0xb5c0fbcf,0xe9b5dba5,0x3956c25b,0x59f111f1,0x923f82a4,0xab1c5ed5,
+                        0xd807aa98,0x12835b01,0x243185be,0x550c7dc3,0x72be5d74,0x80deb1fe,0x9bdc06a7,0xc19bf174,
+                        0xe49b69c1,0xefbe4786,0x0fc19dc6,0x240ca1cc,0x2de92c6f,0x4a7484aa,0x5cb0a9dc,0x76f988da,
+                        0x983e5152,0xa831c66d,0xb00327c8,0xbf597fc7,0xc6e00bf3,0xd5a79147,0x06ca6351,0x14292967,
+                        0x27b70a85,0x2e1b2138,0x4d2c6dfc,0x53380d13,0x650a7354,0x766a0abb,0x81c2c92e,0x92722c85,
+                        0xa2bfe8a1,0xa81a664b,0xc24b8b70,0xc76c51a3,0xd192e819,0xd6990624,0xf40e3585,0x106aa070,
+                        0x19a4c116,0x1e376c08,0x2748774c,0x34b0bcb5,0x391c0cb3,0x4ed8aa4a,0x5b9cca4f,0x682e6ff3,
+                        0x748f82ee,0x78a5636f,0x84c87814,0x8cc70208,0x90befffa,0xa4506ceb,0xbef9a3f7,0xc67178f2
+                    };
+                    return k;
+                }
+                static const ::std::uint32_t * initial() noexcept {
+                    static const ::std::uint32_t h[8] = {
+                        0x6a09e667,0xbb67ae85,0x3c6ef372,0xa54ff53a,0x510e527f,0x9b05688c,0x1f83d9ab,0x5be0cd19
+                    };
+                    return h;
+                }
+            };
+
+            template <> struct sha2_parameters<::std::uint64_t> {
+                enum : unsigned {
+                    rounds = 80,
+                    s0a = 28, s0b = 34, s0c = 39, s1a = 14, s1b = 18, s1c = 41,
+                    r0a = 1, r0b = 8, r0s = 7, r1a = 19, r1b = 61, r1s = 6
+                };
+                static const ::std::uint64_t * constants() noexcept {
+                    static const ::std::uint64_t k[80] = {
+                        0x428a2f98d728ae22ULL,0x7137449123ef65cdULL,0xb5c0fbcfec4d3b2fULL,0xe9b5dba58189dbbcULL,
+                        0x3956c25bf348b538ULL,0x59f111f1b605d019ULL,0x923f82a4af194f9bULL,0xab1c5ed5da6d8118ULL,
+                        0xd807aa98a3030242ULL,0x12835b0145706fbeULL,0x243185be4ee4b28cULL,0x550c7dc3d5ffb4e2ULL,
+                        0x72be5d74f27b896fULL,0x80deb1fe3b1696b1ULL,0x9bdc06a725c71235ULL,0xc19bf174cf692694ULL,
+                        0xe49b69c19ef14ad2ULL,0xefbe4786384f25e3ULL,0x0fc19dc68b8cd5b5ULL,0x240ca1cc77ac9c65ULL,
+                        0x2de92c6f592b0275ULL,0x4a7484aa6ea6e483ULL,0x5cb0a9dcbd41fbd4ULL,0x76f988da831153b5ULL,
+                        0x983e5152ee66dfabULL,0xa831c66d2db43210ULL,0xb00327c898fb213fULL,0xbf597fc7beef0ee4ULL,
+                        0xc6e00bf33da88fc2ULL,0xd5a79147930aa725ULL,0x06ca6351e003826fULL,0x142929670a0e6e70ULL,
+                        0x27b70a8546d22ffcULL,0x2e1b21385c26c926ULL,0x4d2c6dfc5ac42aedULL,0x53380d139d95b3dfULL,
+                        0x650a73548baf63deULL,0x766a0abb3c77b2a8ULL,0x81c2c92e47edaee6ULL,0x92722c851482353bULL,
+                        0xa2bfe8a14cf10364ULL,0xa81a664bbc423001ULL,0xc24b8b70d0f89791ULL,0xc76c51a30654be30ULL,
+                        0xd192e819d6ef5218ULL,0xd69906245565a910ULL,0xf40e35855771202aULL,0x106aa07032bbd1b8ULL,
+                        0x19a4c116b8d2d0c8ULL,0x1e376c085141ab53ULL,0x2748774cdf8eeb99ULL,0x34b0bcb5e19b48a8ULL,
+                        0x391c0cb3c5c95a63ULL,0x4ed8aa4ae3418acbULL,0x5b9cca4f7763e373ULL,0x682e6ff3d6b2b8a3ULL,
+                        0x748f82ee5defb2fcULL,0x78a5636f43172f60ULL,0x84c87814a1f0ab72ULL,0x8cc702081a6439ecULL,
+                        0x90befffa23631e28ULL,0xa4506cebde82bde9ULL,0xbef9a3f7b2c67915ULL,0xc67178f2e372532bULL,
+                        0xca273eceea26619cULL,0xd186b8c721c0c207ULL,0xeada7dd6cde0eb1eULL,0xf57d4f7fee6ed178ULL,
+                        0x06f067aa72176fbaULL,0x0a637dc5a2c898a6ULL,0x113f9804bef90daeULL,0x1b710b35131c471bULL,
+                        0x28db77f523047d84ULL,0x32caab7b40c72493ULL,0x3c9ebe0a15c9bebcULL,0x431d67c49c100d4cULL,
+                        0x4cc5d4becb3e42b6ULL,0x597f299cfc657e2aULL,0x5fcb6fab3ad6faecULL,0x6c44198c4a475817ULL
+                    };
+                    return k;
+                }
+                static const ::std::uint64_t * initial() noexcept {
+                    static const ::std::uint64_t h[8] = {
+                        0x6a09e667f3bcc908ULL,0xbb67ae8584caa73bULL,0x3c6ef372fe94f82bULL,0xa54ff53a5f1d36f1ULL,
+                        0x510e527fade682d1ULL,0x9b05688c2b3e6c1fULL,0x1f83d9abfb41bd6bULL,0x5be0cd19137e2179ULL
+                    };
+                    return h;
+                }
+            };
+
+            /// Rotation to the right of a Word, or of each of the Word lanes of a vector
+            template <typename Word,unsigned N,typename W>
+            CPP11CRYPTO_ALWAYS_INLINE void rotate_right(W& x,const W& y) noexcept {
+                x = (y >> N) | (y << (8*sizeof(Word)-N));
+            }
+            template <unsigned N,typename W>
+            CPP11CRYPTO_ALWAYS_INLINE void shift_right(W& x,const W& y) noexcept {
+                x = y >> N;
+            }
+
+            /// One round: d and h receive the new e and a; the caller renames the rest
+            template <typename Word,typename W>
+            CPP11CRYPTO_ALWAYS_INLINE void sha2_round(const W& a,const W& b,const W& c,W& d,
+                                                      const W& e,const W& f,const W& g,W& h,const W& kw) noexcept {
+                typedef sha2_parameters<Word> P;
+                W r1, r2, r3;
+                rotate_right<Word,P::s1a>(r1,e);
+                rotate_right<Word,P::s1b>(r2,e);
+                rotate_right<Word,P::s1c>(r3,e);
+                const W t1 = h+(r1^r2^r3)+(g^(e&(f^g)))+kw;
+                rotate_right<Word,P::s0a>(r1,a);
+                rotate_right<Word,P::s0b>(r2,a);
+                rotate_right<Word,P::s0c>(r3,a);
+                d += t1;
+                h = t1+(r1^r2^r3)+((a&b)|(c&(a|b)));
+            }
+
+            /// Word t of the schedule over word t-16 in the rolling window w
+            template <typename Word,typename W>
+            CPP11CRYPTO_ALWAYS_INLINE void sha2_schedule(W * const w,const unsigned t) noexcept {
+                typedef sha2_parameters<Word> P;
+                const W& w15 = w[(t-15)%16];
+                const W& w2 = w[(t-2)%16];
+                W r1, r2, r3;
+                rotate_right<Word,P::r0a>(r1,w15);
+                rotate_right<Word,P::r0b>(r2,w15);
+                shift_right<P::r0s>(r3,w15);
+                w[t%16] += r1^r2^r3;
+                rotate_right<Word,P::r1a>(r1,w2);
+                rotate_right<Word,P::r1b>(r2,w2);
+                shift_right<P::r1s>(r3,w2);
+                w[t%16] += (r1^r2^r3)+w[(t-7)%16];
+            }
+
+            /// The compression function, on Words or on vectors of them, one message per lane
+            /// @param state chaining value, updated
+            /// @param w the sixteen words of the block, overwritten by the schedule
+            template <typename Word,typename W>
+            CPP11CRYPTO_ALWAYS_INLINE void sha2_compress(W * const state,W * const w) noexcept {
+                typedef sha2_parameters<Word> P;
+                const Word * const k = P::constants();
+                W a = state[0], b = state[1], c = state[2], d = state[3];
+                W e = state[4], f = state[5], g = state[6], h = state[7];
+                for (unsigned t = 0; t != P::rounds; t += 8) {
+                    if (t >= 16) {
+                        for (unsigned i = 0; i != 8; ++i) {
+                            sha2_schedule<Word>(w,t+i);
+                        }
+                    }
+                    const unsigned j = t%16;
+                    sha2_round<Word>(a,b,c,d,e,f,g,h,W {}+k[t]+w[j]);
+                    sha2_round<Word>(h,a,b,c,d,e,f,g,W {}+k[t+1]+w[j+1]);
+                    sha2_round<Word>(g,h,a,b,c,d,e,f,W {}+k[t+2]+w[j+2]);
+                    sha2_round<Word>(f,g,h,a,b,c,d,e,W {}+k[t+3]+w[j+3]);
+                    sha2_round<Word>(e,f,g,h,a,b,c,d,W {}+k[t+4]+w[j+4]);
+                    sha2_round<Word>(d,e,f,g,h,a,b,c,W {}+k[t+5]+w[j+5]);
+                    sha2_round<Word>(c,d,e,f,g,h,a,b,W {}+k[t+6]+w[j+6]);
+                    sha2_round<Word>(b,c,d,e,f,g,h,a,W {}+k[t+7]+w[j+7]);
+                }
+                state[0] += a;
+                state[1] += b;
+                state[2] += c;
+                state[3] += d;
+                state[4] += e;
+                state[5] += f;
+                state[6] += g;
+                state[7] += h;
+            }
+
+            /// Portable compression of whole blocks, the reference for the other kernels
+            template <typename Word>
+            inline void sha2_portable(Word * const state,const ::std::uint8_t * data,::std::size_t blocks) noexcept {
+                Word w[16];
+                for (; 0 != blocks; --blocks, data += sizeof w) {
+                    for (unsigned i = 0; i != 16; ++i) {
+                        w[i] = utils::load_be<Word>(data+sizeof(Word)*i);
+                    }
+                    sha2_compress<Word>(state,w);
+                }
+                core::do_zeroize(w,sizeof w);
+            }
+
+            /// Pads the last bytes of a message: the 0x80 byte, zeros and the length
+            /// in bits, on 64 bits for SHA-256 and 128 bits for SHA-512
+            /// @param tail receives two blocks, the second one possibly unused
+            /// @param rest bytes of the message after its last whole block
+            /// @param rest_bytes their number, below one block
+            /// @param total bytes of the whole message
+            /// @return blocks of tail to compress, one or two
+            template <typename Word>
+            inline ::std::size_t sha2_pad(::std::uint8_t * const tail,const ::std::uint8_t * const rest,
+                                          const ::std::size_t rest_bytes,const ::std::uint64_t total) noexcept {
+                constexpr ::std::size_t block = 16*sizeof(Word);
+                ::std::memset(tail,0,2*block);
+                if (0 != rest_bytes) {
+                    ::std::memcpy(tail,rest,rest_bytes);
+                }
+                tail[rest_bytes] = 0x80;
+                const ::std::size_t blocks = rest_bytes+1+2*sizeof(Word) <= block ? 1 : 2;
+                ::std::uint8_t * const end = tail+blocks*block;
+                utils::store_be<::std::uint64_t>(end-8,total << 3);
+                if (8 == sizeof(Word)) {
+                    utils::store_be<::std::uint64_t>(end-16,total >> 61);
+                }
+                return blocks;
+            }
+
+#ifdef CPP11CRYPTO_X86_INTRINSICS
+            /// Four rounds of SHA-NI, with the message schedule of later rounds
+            /// @tparam I index in m of the four words of these rounds
+            /// @param abef state words a, b, e and f, from the high lane down
+            /// @param cdgh state words c, d, g and h
+            /// @param m rolling window of sixteen message words
+            /// @param group rounds 4*group to 4*group+3
+            /// @param k round constants
+            template <unsigned I>
+            __attribute__((target("sha,sse4.1,ssse3"),always_inline))
+            inline void sha256_shani_rounds(__m128i& abef,__m128i& cdgh,__m128i * const m,const unsigned group,
+                                            const ::std::uint32_t * const k) noexcept {
+                __m128i words = _mm_add_epi32(m[I],_mm_load_si128(reinterpret_cast<const __m128i *>(k+4*group)));
+                cdgh = _mm_sha256rnds2_epu32(cdgh,abef,words);
+                if (group >= 3 && group <= 14) {
+                    const __m128i previous = _mm_alignr_epi8(m[I],m[(I+3)%4],4);
+                    m[(I+1)%4] = _mm_sha256msg2_epu32(_mm_add_epi32(m[(I+1)%4],previous),m[I]);
+                }
+                words = _mm_shuffle_epi32(words,0x0e);
+                abef = _mm_sha256rnds2_epu32(abef,cdgh,words);
+                if (group >= 1 && group <= 12) {
+                    m[(I+3)%4] = _mm_sha256msg1_epu32(m[(I+3)%4],m[I]);
+                }
+            }
+
+            /// SHA-NI compression of whole blocks
+            __attribute__((target("sha,sse4.1,ssse3")))
+            inline void sha256_shani(::std::uint32_t * const state,const ::std::uint8_t * data,::std::size_t blocks) noexcept {
+                const ::std::uint32_t * const k = sha2_parameters<::std::uint32_t>::constants();
+                const __m128i byte_swap = _mm_set_epi64x(0x0c0d0e0f08090a0bLL,0x0405060700010203LL);
+                // the instructions keep the state as a, b, e, f and c, d, g, h
+                const __m128i dcba = _mm_loadu_si128(reinterpret_cast<const __m128i *>(state));
+                const __m128i hgfe = _mm_loadu_si128(reinterpret_cast<const __m128i *>(state+4));
+                const __m128i cdab = _mm_shuffle_epi32(dcba,0xb1);
+                const __m128i efgh = _mm_shuffle_epi32(hgfe,0x1b);
+                __m128i abef = _mm_alignr_epi8(cdab,efgh,8);
+                __m128i cdgh = _mm_blend_epi16(efgh,cdab,0xf0);
+                __m128i m[4];
+                for (; 0 != blocks; --blocks, data += 64) {
+                    const __m128i abef_in = abef, cdgh_in = cdgh;
+                    for (unsigned i = 0; i != 4; ++i) {
+                        m[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data+16*i)),byte_swap);
+                    }
+                    for (unsigned group = 0; group != 16; group += 4) {
+                        sha256_shani_rounds<0>(abef,cdgh,m,group,k);
+                        sha256_shani_rounds<1>(abef,cdgh,m,group+1,k);
+                        sha256_shani_rounds<2>(abef,cdgh,m,group+2,k);
+                        sha256_shani_rounds<3>(abef,cdgh,m,group+3,k);
+                    }
+                    abef = _mm_add_epi32(abef,abef_in);
+                    cdgh = _mm_add_epi32(cdgh,cdgh_in);
+                }
+                const __m128i feba = _mm_shuffle_epi32(abef,0x1b);
+                const __m128i dchg = _mm_shuffle_epi32(cdgh,0xb1);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(state),_mm_blend_epi16(feba,dchg,0xf0));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(state+4),_mm_alignr_epi8(dchg,feba,8));
+                for (unsigned i = 0; i != 4; ++i) {
+                    m[i] = _mm_setzero_si128();
+                }
+            }
+#endif
+
+            /// Compresses whole blocks with an implementation
+            inline void sha2_blocks(::std::uint32_t * const state,const ::std::uint8_t * const data,
+                                    const ::std::size_t blocks,const sha_engine engine) noexcept {
+#ifdef CPP11CRYPTO_X86_INTRINSICS
+                if (sha_engine::shani == engine) {
+                    sha256_shani(state,data,blocks);
+                    return;
+                }
+#endif
+                (void)engine;
+                sha2_portable(state,data,blocks);
+            }
+            inline void sha2_blocks(::std::uint64_t * const state,const ::std::uint8_t * const data,
+                                    const ::std::size_t blocks,sha_engine) noexcept {
+                sha2_portable(state,data,blocks);
+            }
+
+        }
+
+        /// SHA-256 or SHA-512 (FIPS 180-4) of messages given in pieces of any
+        /// length. @ref finalize ends a message and starts the next one.
+        /// @tparam Word 32-bit words for SHA-256, 64-bit ones for SHA-512
+        template <typename Word>
+        class sha2 : public core::ZeroizingBase<> {
+        public:
+            /// Bytes per block
+            static constexpr ::std::size_t block_size = 16*sizeof(Word);
+            /// Bytes per digest
+            static constexpr ::std::size_t digest_size = 8*sizeof(Word);
+
+            /// Fastest implementation of this hash usable on this processor
+            /// @return SHA-NI if usable for SHA-256, the portable code otherwise
+            static sha_engine best_engine() noexcept {
+                return 4 == sizeof(Word) ? best_sha_engine() : sha_engine::scalar;
+            }
+
+            /// Constructor
+            /// @param engine implementation to use
+            /// @throw std::invalid_argument if the implementation is unsupported, by the
+            ///        processor or, for SHA-NI, by SHA-512
+            explicit sha2(const sha_engine engine = best_engine())
+                : kernel {engine} {
+                if (!is_supported(engine) || (sha_engine::shani == engine && 4 != sizeof(Word))) {
+                    throw ::std::invalid_argument("SHA-2 implementation not supported");
+                }
+                restart();
+            }
+
+            /// @return implementation in use
+            sha_engine engine() const noexcept {
+                return kernel;
+            }
+
+            /// Hashes the next piece of the message
+            /// @param data bytes to hash
+            /// @param bytes length
+            void update(const ::std::uint8_t * data,::std::size_t bytes) noexcept {
+                length += bytes;
+                if (0 != buffered) {
+                    const ::std::size_t n = ::std::min(bytes,block_size-buffered);
+                    ::std::memcpy(buffer.data()+buffered,data,n);
+                    buffered += n;
+                    data += n;
+                    bytes -= n;
+                    if (block_size != buffered) {
+                        return;
+                    }
+                    details::sha2_blocks(state.data(),buffer.data(),1,kernel);
+                    buffered = 0;
+                }
+                const ::std::size_t blocks = bytes/block_size;
+                if (0 != blocks) {
+                    details::sha2_blocks(state.data(),data,blocks,kernel);
+                }
+                buffered = bytes%block_size;
+                if (0 != buffered) {
+                    ::std::memcpy(buffer.data(),data+blocks*block_size,buffered);
+                }
+            }
+
+            /// Ends the message and starts a new one
+            /// @param digest receives digest_size bytes
+            void finalize(::std::uint8_t * const digest) noexcept {
+                core::secure_array<::std::uint8_t,2*block_size> tail;
+                const ::std::size_t blocks = details::sha2_pad<Word>(tail.data(),buffer.data(),buffered,length);
+                details::sha2_blocks(state.data(),tail.data(),blocks,kernel);
+                for (unsigned i = 0; i != 8; ++i) {
+                    utils::store_be(digest+sizeof(Word)*i,state[i]);
+                }
+                restart();
+            }
+
+            /// Hashes a whole message
+            /// @param data bytes to hash
+            /// @param bytes length
+            /// @param digest receives digest_size bytes
+            /// @param engine implementation to use
+            /// @throw std::invalid_argument if the implementation is unsupported
+            static void digest(const ::std::uint8_t * const data,const ::std::size_t bytes,::std::uint8_t * const digest,
+                               const sha_engine engine = best_engine()) {
+                sha2 hash {engine};
+                hash.update(data,bytes);
+                hash.finalize(digest);
+            }
+
+        private:
+            void restart() noexcept {
+                const Word * const initial = details::sha2_parameters<Word>::initial();
+                ::std::copy(initial,initial+8,state.data());
+                buffered = 0;
+                length = 0;
+            }
+
+            core::secure_array<Word,8> state;
+            core::secure_array<::std::uint8_t,block_size> buffer;
+            ::std::size_t buffered;
+            ::std::uint64_t length;
+            sha_engine kernel;
+        };
+
+        template <typename Word> constexpr ::std::size_t sha2<Word>::block_size;
+        template <typename Word> constexpr ::std::size_t sha2<Word>::digest_size;
+
+        typedef sha2<::std::uint32_t> sha256;
+        typedef sha2<::std::uint64_t> sha512;
+
+        /// Messages hashed at once by a multi-buffer kernel
+        /// @tparam Hash sha256 or sha512
+        /// @param engine kernel
+        /// @return number of lanes
+        template <typename Hash>
+        constexpr ::std::size_t multi_lanes(const multi_engine engine) noexcept {
+            return multi_engine::scalar == engine ? 1 : 8*utils::lane_bytes(engine)/Hash::digest_size;
+        }
+
+        namespace details {
+
+            /// Message in progress in a lane
+            struct sha2_lane {
+                const ::std::uint8_t * data;
+                ::std::size_t whole_blocks;
+                ::std::size_t blocks;
+                ::std::size_t done;
+                ::std::size_t message;
+                bool busy;
+            };
+
+            /// Starts a message in a lane: its state set to the initial value and
+            /// its padded tail prepared
+            template <typename Word,typename V>
+            CPP11CRYPTO_ALWAYS_INLINE void sha2_start(sha2_lane& lane,::std::uint8_t * const tail,V * const state,
+                                                      const unsigned l,const utils::span<::std::uint8_t>& message,
+                                                      const ::std::size_t index) noexcept {
+                constexpr ::std::size_t block = 16*sizeof(Word);
+                const Word * const initial = sha2_parameters<Word>::initial();
+                lane.data = message.data();
+                lane.whole_blocks = message.size()/block;
+                lane.blocks = lane.whole_blocks+sha2_pad<Word>(tail,message.data()+lane.whole_blocks*block,
+                                                               message.size()%block,message.size());
+                lane.done = 0;
+                lane.message = index;
+                lane.busy = true;
+                for (unsigned i = 0; i != 8; ++i) {
+                    state[i][l] = initial[i];
+                }
+            }
+
+            /// Message words of one block per lane, word i of every block in w[i]: each
+            /// block is read as whole vectors, every square of lanes x lanes words is
+            /// transposed by log2(lanes) rounds of two-vector shuffles, then the bytes of
+            /// each word are swapped
+            /// @param w receives the sixteen word vectors
+            /// @param blocks block of each lane
+            template <typename Word,typename V>
+            CPP11CRYPTO_ALWAYS_INLINE void sha2_gather(V * const w,const ::std::uint8_t * const * const blocks) noexcept {
+                constexpr unsigned lanes = sizeof(V)/sizeof(Word);
+                for (unsigned g = 0; g != 16/lanes; ++g) {
+                    V * const rows = w+g*lanes;
+                    for (unsigned l = 0; l != lanes; ++l) {
+                        ::std::memcpy(&rows[l],blocks[l]+g*sizeof(V),sizeof(V));
+                    }
+                    // swapping bit h of the row and column numbers, for each bit
+                    for (unsigned h = 1; h != lanes; h *= 2) {
+                        V low, high;
+                        for (unsigned c = 0; c != lanes; ++c) {
+                            low[c] = 0 == (c & h) ? c : lanes+c-h;
+                            high[c] = 0 == (c & h) ? c+h : lanes+c;
+                        }
+                        for (unsigned r = 0; r != lanes; ++r) {
+                            if (0 == (r & h)) {
+                                const V a = rows[r], b = rows[r+h];
+                                rows[r] = __builtin_shuffle(a,b,low);
+                                rows[r+h] = __builtin_shuffle(a,b,high);
+                            }
+                        }
+                    }
+                }
+                // byte order by shifts, which SSE2 has, unlike byte shuffles
+                for (unsigned i = 0; i != 16; ++i) {
+                    V x = w[i];
+                    x = (x << 8 & (V {}+static_cast<Word>(0xff00ff00ff00ff00ULL))) | (x >> 8 & (V {}+static_cast<Word>(0x00ff00ff00ff00ffULL)));
+                    x = (x << 16 & (V {}+static_cast<Word>(0xffff0000ffff0000ULL))) | (x >> 16 & (V {}+static_cast<Word>(0x0000ffff0000ffffULL)));
+                    if (8 == sizeof(Word)) {
+                        x = x << (4*sizeof(Word)) | x >> (4*sizeof(Word));
+                    }
+                    w[i] = x;
+                }
+            }
+
+            /// Hashes messages in the lanes of V, one block of each per compression;
+            /// a lane whose message ends takes the next one, so that lengths may differ
+            template <typename Word,typename V>
+            CPP11CRYPTO_ALWAYS_INLINE void sha2_lanes(const utils::span<::std::uint8_t> * const messages,
+                                                      ::std::uint8_t * const digests,const ::std::size_t count) noexcept {
+                constexpr unsigned lanes = sizeof(V)/sizeof(Word);
+                constexpr ::std::size_t block = 16*sizeof(Word);
+                V state[8] = {}, w[16];
+                sha2_lane lane[lanes];
+                ::std::uint8_t tails[lanes][2*block] = {};
+                ::std::size_t next = 0;
+                unsigned busy = 0;
+                for (unsigned l = 0; l != lanes; ++l) {
+                    lane[l].busy = false;
+                    if (next != count) {
+                        sha2_start<Word>(lane[l],tails[l],state,l,messages[next],next);
+                        ++next;
+                        ++busy;
+                    }
+                }
+                while (0 != busy) {
+                    const ::std::uint8_t * blocks[lanes];
+                    for (unsigned l = 0; l != lanes; ++l) {
+                        const sha2_lane& job = lane[l];
+                        // idle lanes hash their zeroed tail
+                        blocks[l] = !job.busy ? tails[l]
+                                    : job.done < job.whole_blocks ? job.data+job.done*block
+                                    : tails[l]+(job.done-job.whole_blocks)*block;
+                    }
+                    sha2_gather<Word>(w,blocks);
+                    sha2_compress<Word>(state,w);
+                    for (unsigned l = 0; l != lanes; ++l) {
+                        sha2_lane& job = lane[l];
+                        if (!job.busy || ++job.done != job.blocks) {
+                            continue;
+                        }
+                        for (unsigned i = 0; i != 8; ++i) {
+                            utils::store_be<Word>(digests+8*sizeof(Word)*job.message+sizeof(Word)*i,state[i][l]);
+                        }
+                        if (next != count) {
+                            sha2_start<Word>(job,tails[l],state,l,messages[next],next);
+                            ++next;
+                        } else {
+                            job.busy = false;
+                            --busy;
+                        }
+                    }
+                }
+                core::do_zeroize(state,sizeof state);
+                core::do_zeroize(w,sizeof w);
+                core::do_zeroize(tails,sizeof tails);
+            }
+
+#ifdef CPP11CRYPTO_X86_INTRINSICS
+            /// Vectors of the multi-buffer kernels, by word type
+            template <typename Word> struct sha2_vectors;
+            template <> struct sha2_vectors<::std::uint32_t> {
+                typedef ::std::uint32_t x16 __attribute__((vector_size(16)));
+                typedef ::std::uint32_t x32 __attribute__((vector_size(32)));
+                typedef ::std::uint32_t x64 __attribute__((vector_size(64)));
+            };
+            template <> struct sha2_vectors<::std::uint64_t> {
+                typedef ::std::uint64_t x16 __attribute__((vector_size(16)));
+                typedef ::std::uint64_t x32 __attribute__((vector_size(32)));
+                typedef ::std::uint64_t x64 __attribute__((vector_size(64)));
+            };
+
+            template <typename Word>
+            __attribute__((target("sse2")))
+            inline void sha2_sse2(const utils::span<::std::uint8_t> * const messages,::std::uint8_t * const digests,
+                                  const ::std::size_t count) noexcept {
+                sha2_lanes<Word,typename sha2_vectors<Word>::x16>(messages,digests,count);
+            }
+
+            template <typename Word>
+            __attribute__((target("avx2")))
+            inline void sha2_avx2(const utils::span<::std::uint8_t> * const messages,::std::uint8_t * const digests,
+                                  const ::std::size_t count) noexcept {
+                sha2_lanes<Word,typename sha2_vectors<Word>::x32>(messages,digests,count);
+            }
+
+            template <typename Word>
+            __attribute__((target("avx512f,avx512bw,avx512vl")))
+            inline void sha2_avx512(const utils::span<::std::uint8_t> * const messages,::std::uint8_t * const digests,
+                                    const ::std::size_t count) noexcept {
+                sha2_lanes<Word,typename sha2_vectors<Word>::x64>(messages,digests,count);
+            }
+#endif
+
+            template <typename Word>
+            inline void multi_sha2(const utils::span<::std::uint8_t> * const messages,::std::uint8_t * const digests,
+                                   const ::std::size_t count,const multi_engine engine) noexcept {
+                switch (is_supported(engine) ? engine : multi_engine::scalar) {
+#ifdef CPP11CRYPTO_X86_INTRINSICS
+                case multi_engine::avx512:
+                    sha2_avx512<Word>(messages,digests,count);
+                    return;
+                case multi_engine::avx2:
+                    sha2_avx2<Word>(messages,digests,count);
+                    return;
+                case multi_engine::sse2:
+                    sha2_sse2<Word>(messages,digests,count);
+                    return;
+#endif
+                default:
+                    for (::std::size_t i = 0; i != count; ++i) {
+                        sha2<Word>::digest(messages[i].data(),messages[i].size(),digests+i*sha2<Word>::digest_size);
+                    }
+                }
+            }
+
+        }
+
+        /// Hashes independent messages with SHA-256, as many at once as the kernel
+        /// has lanes. Lengths may differ freely: a lane whose message ends takes the
+        /// next one, so a few long messages among many short ones cost little more
+        /// than their own blocks.
+        /// @param messages messages to hash, count of them
+        /// @param digests receives the digests, sha256::digest_size bytes each, in order
+        /// @param count number of messages
+        /// @param engine kernel to use, the scalar one if not supported
+        inline void multi_sha256(const utils::span<::std::uint8_t> * const messages,::std::uint8_t * const digests,
+                                 const ::std::size_t count,const multi_engine engine) noexcept {
+            details::multi_sha2<::std::uint32_t>(messages,digests,count,engine);
+        }
+
+        /// Hashes independent messages with SHA-256 and the fastest kernel available,
+        /// see @ref best_multi_sha256_engine
+        inline void multi_sha256(const utils::span<::std::uint8_t> * const messages,::std::uint8_t * const digests,
+                                 const ::std::size_t count) noexcept {
+            multi_sha256(messages,digests,count,best_multi_sha256_engine());
+        }
+
+        /// Hashes independent messages with SHA-512, as many at once as the kernel
+        /// has lanes, as @ref multi_sha256 does
+        /// @param messages messages to hash, count of them
+        /// @param digests receives the digests, sha512::digest_size bytes each, in order
+        /// @param count number of messages
+        /// @param engine kernel to use, the scalar one if not supported
+        inline void multi_sha512(const utils::span<::std::uint8_t> * const messages,::std::uint8_t * const digests,
+                                 const ::std::size_t count,const multi_engine engine) noexcept {
+            details::multi_sha2<::std::uint64_t>(messages,digests,count,engine);
+        }
+
+        /// Hashes independent messages with SHA-512 and the widest kernel available
+        inline void multi_sha512(const utils::span<::std::uint8_t> * const messages,::std::uint8_t * const digests,
+                                 const ::std::size_t count) noexcept {
+            multi_sha512(messages,digests,count,best_multi_engine());
+        }
+
+    }
+}
+
+#endif // CPP11CRYPTO_HASH_SHA2_HPP
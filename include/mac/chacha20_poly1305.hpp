@@ -0,0 +1,164 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// mac/chacha20_poly1305.hpp - ChaCha20-Poly1305 authenticated encryption
+//                    (RFC 8439), for processors without AES instructions
+
+#ifndef CPP11CRYPTO_MAC_CHACHA20_POLY1305_HPP
+#define CPP11CRYPTO_MAC_CHACHA20_POLY1305_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include "block/modes.hpp"
+#include "core/secure_array.hpp"
+#include "core/zeroizing.hpp"
+#include "mac/poly1305.hpp"
+#include "stream/chacha20.hpp"
+#include "utils/endian.hpp"
+#include "utils/span.hpp"
+
+namespace cpp11crypto {
+    namespace mac {
+
+        /// ChaCha20-Poly1305 authenticated encryption with associated data
+        /// (RFC 8439). The Poly1305 key of each message is the start of the
+        /// keystream of block 0; the message is encrypted from block 1. Objects
+        /// never change after construction and may be shared by any number of threads.
+        class chacha20_poly1305 : public core::ZeroizingBase<> {
+        public:
+            /// Bytes per key
+            static constexpr ::std::size_t key_size = stream::chacha20::key_size;
+            /// Bytes per nonce
+            static constexpr ::std::size_t nonce_size = stream::chacha20::nonce_size;
+            /// Bytes per tag
+            static constexpr ::std::size_t tag_size = poly1305::tag_size;
+            /// Longest plaintext, 2^32-1 blocks of 64 bytes
+            static constexpr ::std::uint64_t max_bytes = 0x3fffffffc0ULL;
+
+            /// Constructor
+            /// @param key key_size bytes
+            /// @param engine ChaCha20 kernel
+            /// @param hash Poly1305 implementation
+            /// @throw std::invalid_argument if the key length is wrong or an implementation unsupported
+            explicit chacha20_poly1305(const utils::span<::std::uint8_t> key,
+                                       const stream::chacha_engine engine = stream::best_chacha_engine(),
+                                       const poly1305_engine hash = best_poly1305_engine())
+                : kernel {engine}, hashing {hash} {
+                if (key_size != key.size()) {
+                    throw ::std::invalid_argument("Wrong ChaCha20-Poly1305 key length");
+                }
+                if (!stream::is_supported(engine) || !is_supported(hash)) {
+                    throw ::std::invalid_argument("ChaCha20-Poly1305 implementation not supported by this processor");
+                }
+                ::std::memcpy(key_bytes.data(),key.data(),key_size);
+            }
+
+            /// Encrypts and authenticates
+            /// @param nonce nonce_size bytes, never reused with the same key
+            /// @param aad associated data, authenticated only
+            /// @param in data to encrypt
+            /// @param out receives the encrypted data, may be in
+            /// @param bytes length, at most max_bytes
+            /// @param tag receives tag_size bytes
+            /// @throw std::invalid_argument if the nonce length is wrong or the data too long
+            void encrypt(const utils::span<::std::uint8_t> nonce,const utils::span<::std::uint8_t> aad,
+                         const ::std::uint8_t * const in,::std::uint8_t * const out,const ::std::size_t bytes,
+                         ::std::uint8_t * const tag) const {
+                stream::chacha20 cipher {key_bytes,nonce,0,kernel};
+                check(bytes);
+                poly1305 mac = start(cipher,aad);
+                cipher.process(in,out,bytes);
+                finish(mac,out,aad.size(),bytes,tag);
+            }
+
+            /// Checks and decrypts
+            /// @param nonce nonce used to encrypt
+            /// @param aad associated data
+            /// @param in data to decrypt
+            /// @param out receives the decrypted data, may be in; left untouched if the tag is wrong
+            /// @param bytes length, at most max_bytes
+            /// @param tag tag_size bytes of tag
+            /// @return true if the tag is right, compared in constant time
+            /// @throw std::invalid_argument if the nonce length is wrong or the data too long
+            bool decrypt(const utils::span<::std::uint8_t> nonce,const utils::span<::std::uint8_t> aad,
+                         const ::std::uint8_t * const in,::std::uint8_t * const out,const ::std::size_t bytes,
+                         const ::std::uint8_t * const tag) const {
+                stream::chacha20 cipher {key_bytes,nonce,0,kernel};
+                check(bytes);
+                poly1305 mac = start(cipher,aad);
+                core::secure_array<::std::uint8_t,tag_size> expected;
+                finish(mac,in,aad.size(),bytes,expected.data());
+                ::std::uint8_t difference = 0;
+                for (::std::size_t i = 0; i != tag_size; ++i) {
+                    difference |= expected[i] ^ tag[i];
+                }
+                if (0 != difference) {
+                    return false;
+                }
+                cipher.process(in,out,bytes);
+                return true;
+            }
+
+        private:
+            static void check(const ::std::size_t bytes) {
+                if (bytes > max_bytes) {
+                    throw ::std::invalid_argument("Too much data for one ChaCha20-Poly1305 nonce");
+                }
+            }
+
+            /// Poly1305 keyed with the first block, the associated data added;
+            /// leaves the cipher at block 1
+            poly1305 start(stream::chacha20& cipher,const utils::span<::std::uint8_t> aad) const {
+                core::secure_array<::std::uint8_t,stream::chacha20::block_size> first;
+                cipher.process(first.data(),first.data(),first.size());
+                poly1305 mac {utils::make_span(first.data(),poly1305::key_size),hashing};
+                mac.update(aad.data(),aad.size());
+                pad(mac,aad.size());
+                return mac;
+            }
+
+            static void pad(poly1305& mac,const ::std::size_t bytes) noexcept {
+                static const ::std::uint8_t zeros[16] = {};
+                if (0 != bytes%16) {
+                    mac.update(zeros,16-bytes%16);
+                }
+            }
+
+            void finish(poly1305& mac,const ::std::uint8_t * const ciphertext,const ::std::size_t aad_bytes,
+                        const ::std::size_t bytes,::std::uint8_t * const tag) const noexcept {
+                mac.update(ciphertext,bytes);
+                pad(mac,bytes);
+                ::std::uint8_t lengths[16];
+                utils::store64le(lengths,aad_bytes);
+                utils::store64le(lengths+8,bytes);
+                mac.update(lengths,sizeof lengths);
+                mac.finalize(tag);
+            }
+
+            core::secure_array<::std::uint8_t,key_size> key_bytes;
+            stream::chacha_engine kernel;
+            poly1305_engine hashing;
+        };
+
+    }
+}
+
+#endif // CPP11CRYPTO_MAC_CHACHA20_POLY1305_HPP
@@ -0,0 +1,516 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// mac/gcm.hpp - AES-GCM authenticated encryption: GHASH with PCLMULQDQ and
+//                    aggregated reduction, stitched with AES-NI counter mode,
+//                    or with a constant time 4-bit table
+
+#ifndef CPP11CRYPTO_MAC_GCM_HPP
+#define CPP11CRYPTO_MAC_GCM_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include "block/aes.hpp"
+#include "core/secure_array.hpp"
+#include "core/zeroizing.hpp"
+#include "stream/ctr.hpp"
+#include "utils/cpu_features.hpp"
+#include "utils/endian.hpp"
+#include "utils/span.hpp"
+
+namespace cpp11crypto {
+    namespace mac {
+
+        /// GHASH implementations
+        enum class ghash_engine {
+            /// Shoup's 4-bit tables, each entry read by a masked scan of the whole
+            /// table, so that no memory access depends on the key or the data
+            table,
+            /// PCLMULQDQ carry-less products, eight blocks reduced at once
+            pclmul
+        };
+
+        /// Tells whether a GHASH implementation can run on this processor
+        /// @param engine implementation to check
+        /// @return true if usable
+        inline bool is_supported(const ghash_engine engine) noexcept {
+            switch (engine) {
+            case ghash_engine::table:
+                return true;
+            case ghash_engine::pclmul:
+                return utils::cpu().pclmulqdq && utils::cpu().ssse3;
+            }
+            return false;
+        }
+
+        /// Fastest GHASH implementation usable on this processor, selected once
+        /// @return selected implementation
+        inline ghash_engine best_ghash_engine() noexcept {
+            static const ghash_engine engine =
+                is_supported(ghash_engine::pclmul) ? ghash_engine::pclmul : ghash_engine::table;
+            return engine;
+        }
+
+        /// Blocks hashed per reduction by the PCLMULQDQ code, and powers of H kept
+        constexpr ::std::size_t ghash_aggregation = 8;
+
+        namespace details {
+
+            // GHASH works in GF(2^128) with the bits of each byte reflected: the first
+            // bit of a block, the high bit of its first byte, is the coefficient of x^0.
+            // Blocks read as two big endian words put it in the high bit of the high word,
+            // so multiplying by x is a right shift.
+
+            /// Multiplies by x a block held as two big endian words
+            inline void multiply_x(::std::uint64_t& high,::std::uint64_t& low) noexcept {
+                const ::std::uint64_t carry = low & 1;
+                low = (low >> 1) | (high << 63);
+                high = (high >> 1) ^ (0xe100000000000000ULL & (0-carry));
+            }
+
+            /// Shoup's table: entry n is H times the 4-bit polynomial whose x^0
+            /// coefficient is the high bit of n, as two big endian words
+            /// @param table receives 32 words
+            inline void ghash_table_init(::std::uint64_t * const table,::std::uint64_t high,::std::uint64_t low) noexcept {
+                ::std::uint64_t powers[8];
+                for (unsigned j = 0; j != 4; ++j) {
+                    powers[2*j] = high;
+                    powers[2*j+1] = low;
+                    multiply_x(high,low);
+                }
+                for (unsigned n = 0; n != 16; ++n) {
+                    table[2*n] = table[2*n+1] = 0;
+                    for (unsigned j = 0; j != 4; ++j) {
+                        if (0 != ((n >> (3-j)) & 1)) {
+                            table[2*n] ^= powers[2*j];
+                            table[2*n+1] ^= powers[2*j+1];
+                        }
+                    }
+                }
+                core::do_zeroize(powers,sizeof powers);
+            }
+
+            /// X times H, nibble by nibble from the highest degree, Horner style; each
+            /// table entry is read by a scan of the whole table
+            inline void ghash_table_multiply(const ::std::uint64_t * const table,::std::uint64_t& high,::std::uint64_t& low) noexcept {
+                ::std::uint64_t zh = 0, zl = 0;
+                for (unsigned i = 0; i != 32; ++i) {
+                    // low nibble before the high one, last byte first
+                    const unsigned position = 31-i;
+                    const ::std::uint64_t word = position < 16 ? high : low;
+                    const unsigned nibble = static_cast<unsigned>(word >> (60-4*(position%16))) & 0xf;
+                    for (unsigned j = 0; j != 4; ++j) {
+                        multiply_x(zh,zl);
+                    }
+                    for (unsigned n = 0; n != 16; ++n) {
+                        const ::std::uint64_t mask = 0-(((n ^ nibble)-1ULL) >> 63);
+                        zh ^= table[2*n] & mask;
+                        zl ^= table[2*n+1] & mask;
+                    }
+                }
+                high = zh;
+                low = zl;
+            }
+
+            /// GHASH of whole blocks with the table
+            inline void ghash_table(const ::std::uint64_t * const table,::std::uint8_t * const state,
+                                    const ::std::uint8_t * data,::std::size_t blocks) noexcept {
+                ::std::uint64_t high = utils::load64be(state), low = utils::load64be(state+8);
+                for (; 0 != blocks; --blocks, data += 16) {
+                    high ^= utils::load64be(data);
+                    low ^= utils::load64be(data+8);
+                    ghash_table_multiply(table,high,low);
+                }
+                utils::store64be(state,high);
+                utils::store64be(state+8,low);
+                high = low = 0;
+            }
+
+#ifdef CPP11CRYPTO_X86_INTRINSICS
+            // The PCLMULQDQ code follows Gueron and Kounavis: blocks are byte reversed,
+            // so that they are 128-bit integers with reflected bits, multiplied into
+            // 256 bits, shifted left by one and reduced. Shift and reduction being
+            // linear, they are applied once to the sum of eight products by H^8..H^1.
+
+            __attribute__((target("ssse3")))
+            inline __m128i byte_reverse(const __m128i x) noexcept {
+                return _mm_shuffle_epi8(x,_mm_set_epi8(0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15));
+            }
+
+            /// Adds the 256-bit product a*b to lo, middle and hi
+            __attribute__((target("pclmul")))
+            inline void clmul_accumulate(const __m128i a,const __m128i b,__m128i& lo,__m128i& middle,__m128i& hi) noexcept {
+                lo = _mm_xor_si128(lo,_mm_clmulepi64_si128(a,b,0x00));
+                hi = _mm_xor_si128(hi,_mm_clmulepi64_si128(a,b,0x11));
+                middle = _mm_xor_si128(middle,_mm_xor_si128(_mm_clmulepi64_si128(a,b,0x10),_mm_clmulepi64_si128(a,b,0x01)));
+            }
+
+            /// Reduction of a sum of products to a field element
+            __attribute__((target("pclmul,ssse3")))
+            inline __m128i clmul_reduce(__m128i lo,const __m128i middle,__m128i hi) noexcept {
+                lo = _mm_xor_si128(lo,_mm_slli_si128(middle,8));
+                hi = _mm_xor_si128(hi,_mm_srli_si128(middle,8));
+                // shift left by one
+                __m128i carry_lo = _mm_srli_epi32(lo,31), carry_hi = _mm_srli_epi32(hi,31);
+                lo = _mm_slli_epi32(lo,1);
+                hi = _mm_slli_epi32(hi,1);
+                const __m128i across = _mm_srli_si128(carry_lo,12);
+                carry_hi = _mm_slli_si128(carry_hi,4);
+                carry_lo = _mm_slli_si128(carry_lo,4);
+                lo = _mm_or_si128(lo,carry_lo);
+                hi = _mm_or_si128(_mm_or_si128(hi,carry_hi),across);
+                // reduction by x^128+x^7+x^2+x+1
+                __m128i a = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(lo,31),_mm_slli_epi32(lo,30)),_mm_slli_epi32(lo,25));
+                const __m128i b = _mm_srli_si128(a,4);
+                a = _mm_slli_si128(a,12);
+                lo = _mm_xor_si128(lo,a);
+                __m128i c = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(lo,1),_mm_srli_epi32(lo,2)),_mm_srli_epi32(lo,7));
+                c = _mm_xor_si128(c,b);
+                lo = _mm_xor_si128(lo,c);
+                return _mm_xor_si128(hi,lo);
+            }
+
+            __attribute__((target("pclmul,ssse3")))
+            inline __m128i clmul_multiply(const __m128i a,const __m128i b) noexcept {
+                __m128i lo = _mm_setzero_si128(), middle = lo, hi = lo;
+                clmul_accumulate(a,b,lo,middle,hi);
+                return clmul_reduce(lo,middle,hi);
+            }
+
+            /// Byte reversed H^1..H^8
+            /// @param h H, in block order
+            /// @param powers receives 16*ghash_aggregation bytes
+            __attribute__((target("pclmul,ssse3")))
+            inline void ghash_powers(const ::std::uint8_t * const h,::std::uint8_t * const powers) noexcept {
+                const __m128i h1 = byte_reverse(_mm_loadu_si128(reinterpret_cast<const __m128i *>(h)));
+                __m128i p = h1;
+                for (::std::size_t i = 0; i != ghash_aggregation; ++i) {
+                    _mm_store_si128(reinterpret_cast<__m128i *>(powers)+i,p);
+                    p = clmul_multiply(p,h1);
+                }
+            }
+
+            /// Eight blocks, already byte reversed, the state added to the first
+            /// one, hashed with a single reduction
+            __attribute__((target("pclmul,ssse3")))
+            inline __m128i ghash_eight(const __m128i * const powers,const __m128i * const x) noexcept {
+                __m128i lo = _mm_setzero_si128(), middle = lo, hi = lo;
+                for (unsigned i = 0; i != 8; ++i) {
+                    clmul_accumulate(x[i],_mm_load_si128(powers+7-i),lo,middle,hi);
+                }
+                return clmul_reduce(lo,middle,hi);
+            }
+
+            /// GHASH of whole blocks with PCLMULQDQ, eight at a time
+            __attribute__((target("pclmul,ssse3")))
+            inline void ghash_pclmul(const ::std::uint8_t * const powers,::std::uint8_t * const state,
+                                     const ::std::uint8_t * data,::std::size_t blocks) noexcept {
+                const __m128i * const h = reinterpret_cast<const __m128i *>(powers);
+                __m128i s = byte_reverse(_mm_loadu_si128(reinterpret_cast<const __m128i *>(state)));
+                for (; blocks >= 8; blocks -= 8, data += 128) {
+                    __m128i x[8];
+                    for (unsigned i = 0; i != 8; ++i) {
+                        x[i] = byte_reverse(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data)+i));
+                    }
+                    x[0] = _mm_xor_si128(x[0],s);
+                    s = ghash_eight(h,x);
+                }
+                for (; 0 != blocks; --blocks, data += 16) {
+                    s = _mm_xor_si128(s,byte_reverse(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data))));
+                    s = clmul_multiply(s,_mm_load_si128(h));
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(state),byte_reverse(s));
+            }
+
+            /// AES-NI counter mode stitched with GHASH, eight blocks at a time: the
+            /// products of one batch of ciphertext are spread over the rounds of the
+            /// next batch when encrypting, of the same batch when decrypting.
+            /// @param keys encryption round keys, 16-byte aligned
+            /// @param counter counter block of the first block, J0 incremented
+            /// @param state GHASH state, updated
+            /// @param batches number of batches of eight blocks
+            template <bool Decrypt>
+            __attribute__((target("aes,pclmul,ssse3")))
+            inline void gcm_aesni(const ::std::uint8_t * const keys,const unsigned rounds,const ::std::uint8_t * const powers,
+                                  const ::std::uint8_t * const counter,::std::uint8_t * const state,
+                                  const ::std::uint8_t * in,::std::uint8_t * out,::std::size_t batches) noexcept {
+                const __m128i * const k = reinterpret_cast<const __m128i *>(keys);
+                const __m128i * const h = reinterpret_cast<const __m128i *>(powers);
+                const __m128i reverse = _mm_set_epi8(0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15);
+                // counter in little endian lanes, where a 32-bit addition is inc32
+                __m128i c = byte_reverse(_mm_loadu_si128(reinterpret_cast<const __m128i *>(counter)));
+                const __m128i one = _mm_set_epi32(0,0,0,1);
+                __m128i s = byte_reverse(_mm_loadu_si128(reinterpret_cast<const __m128i *>(state)));
+                // byte reversed ciphertext waiting to be hashed
+                __m128i pending[8];
+                bool waiting = false;
+                for (; 0 != batches; --batches, in += 128, out += 128) {
+                    __m128i x[8];
+                    const __m128i k0 = _mm_load_si128(k);
+                    for (unsigned i = 0; i != 8; ++i) {
+                        x[i] = _mm_xor_si128(_mm_shuffle_epi8(c,reverse),k0);
+                        c = _mm_add_epi32(c,one);
+                    }
+                    if (Decrypt) {
+                        for (unsigned i = 0; i != 8; ++i) {
+                            pending[i] = byte_reverse(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in)+i));
+                        }
+                        waiting = true;
+                    }
+                    __m128i lo = _mm_setzero_si128(), middle = lo, hi = lo;
+                    if (waiting) {
+                        pending[0] = _mm_xor_si128(pending[0],s);
+                    }
+                    for (unsigned round = 1; round != rounds; ++round) {
+                        const __m128i kr = _mm_load_si128(k+round);
+                        for (unsigned i = 0; i != 8; ++i) {
+                            x[i] = _mm_aesenc_si128(x[i],kr);
+                        }
+                        if (waiting && round <= 8) {
+                            clmul_accumulate(pending[round-1],_mm_load_si128(h+8-round),lo,middle,hi);
+                        }
+                    }
+                    if (waiting) {
+                        s = clmul_reduce(lo,middle,hi);
+                    }
+                    const __m128i kl = _mm_load_si128(k+rounds);
+                    for (unsigned i = 0; i != 8; ++i) {
+                        x[i] = _mm_xor_si128(_mm_aesenclast_si128(x[i],kl),
+                                             _mm_loadu_si128(reinterpret_cast<const __m128i *>(in)+i));
+                        _mm_storeu_si128(reinterpret_cast<__m128i *>(out)+i,x[i]);
+                    }
+                    if (!Decrypt) {
+                        for (unsigned i = 0; i != 8; ++i) {
+                            pending[i] = byte_reverse(x[i]);
+                        }
+                        waiting = true;
+                    }
+                }
+                if (!Decrypt && waiting) {
+                    pending[0] = _mm_xor_si128(pending[0],s);
+                    s = ghash_eight(h,pending);
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(state),byte_reverse(s));
+                core::do_zeroize(pending,sizeof pending);
+            }
+#endif
+
+        }
+
+        /// AES-GCM authenticated encryption with associated data (SP 800-38D). When
+        /// the cipher runs on AES-NI and GHASH on PCLMULQDQ, whole batches of eight
+        /// blocks go through a single loop doing both; otherwise, and for the last
+        /// blocks, counter mode and GHASH run one after the other. The hash key and its
+        /// powers or tables live in the object, and are wiped with it. Objects never
+        /// change after construction and may be shared by any number of threads.
+        /// @tparam KeyBits AES key length, 128, 192 or 256
+        template <::std::size_t KeyBits>
+        class aes_gcm : public core::ZeroizingBase<> {
+        public:
+            /// Underlying cipher
+            typedef block::aes<KeyBits> cipher_type;
+            /// Bytes per key
+            static constexpr ::std::size_t key_size = KeyBits/8;
+            /// Bytes per recommended nonce; other lengths are hashed into the counter
+            static constexpr ::std::size_t nonce_size = 12;
+            /// Bytes per tag
+            static constexpr ::std::size_t tag_size = 16;
+            /// Longest plaintext, 2^32-2 blocks
+            static constexpr ::std::uint64_t max_bytes = 0xfffffffe0ULL;
+
+            /// Constructor, expands the key and precomputes the hash key
+            /// @param key key_size bytes
+            /// @param engine AES implementation
+            /// @param hash GHASH implementation
+            /// @throw std::invalid_argument if the key length is wrong or an implementation unsupported
+            explicit aes_gcm(const utils::span<::std::uint8_t> key,const block::aes_engine engine = block::best_aes_engine(),
+                             const ghash_engine hash = best_ghash_engine())
+                : cipher {key,engine}, hashing {checked(hash)} {
+                core::secure_array<::std::uint8_t,16,16> h;
+                cipher.encrypt(h.data(),h.data(),1);
+#ifdef CPP11CRYPTO_X86_INTRINSICS
+                if (ghash_engine::pclmul == hashing) {
+                    details::ghash_powers(h.data(),powers.data());
+                    return;
+                }
+#endif
+                details::ghash_table_init(table.data(),utils::load64be(h.data()),utils::load64be(h.data()+8));
+            }
+
+            /// @return cipher in use
+            const cipher_type& cipher_in_use() const noexcept {
+                return cipher;
+            }
+            /// @return GHASH implementation in use
+            ghash_engine hash_engine() const noexcept {
+                return hashing;
+            }
+
+            /// Encrypts and authenticates
+            /// @param nonce nonce, never reused with the same key; nonce_size bytes preferably
+            /// @param aad associated data, authenticated only
+            /// @param in data to encrypt
+            /// @param out receives the encrypted data, may be in
+            /// @param bytes length, at most max_bytes
+            /// @param tag receives tag_size bytes
+            /// @throw std::invalid_argument if the nonce is empty or the data too long
+            void encrypt(const utils::span<::std::uint8_t> nonce,const utils::span<::std::uint8_t> aad,
+                         const ::std::uint8_t * const in,::std::uint8_t * const out,const ::std::size_t bytes,
+                         ::std::uint8_t * const tag) const {
+                crypt<false>(nonce,aad,in,out,bytes,tag);
+            }
+
+            /// Checks and decrypts
+            /// @param nonce nonce used to encrypt
+            /// @param aad associated data
+            /// @param in data to decrypt
+            /// @param out receives the decrypted data, may be in; wiped if the tag is wrong
+            /// @param bytes length, at most max_bytes
+            /// @param tag tag_size bytes of tag
+            /// @return true if the tag is right, compared in constant time
+            /// @throw std::invalid_argument if the nonce is empty or the data too long
+            bool decrypt(const utils::span<::std::uint8_t> nonce,const utils::span<::std::uint8_t> aad,
+                         const ::std::uint8_t * const in,::std::uint8_t * const out,const ::std::size_t bytes,
+                         const ::std::uint8_t * const tag) const {
+                core::secure_array<::std::uint8_t,tag_size> expected;
+                crypt<true>(nonce,aad,in,out,bytes,expected.data());
+                ::std::uint8_t difference = 0;
+                for (::std::size_t i = 0; i != tag_size; ++i) {
+                    difference |= expected[i] ^ tag[i];
+                }
+                if (0 != difference) {
+                    core::do_zeroize(out,bytes);
+                    return false;
+                }
+                return true;
+            }
+
+        private:
+            static ghash_engine checked(const ghash_engine engine) {
+                if (!is_supported(engine)) {
+                    throw ::std::invalid_argument("GHASH implementation not supported by this processor");
+                }
+                return engine;
+            }
+
+            /// GHASH of whole blocks
+            void hash_blocks(::std::uint8_t * const state,const ::std::uint8_t * const data,const ::std::size_t blocks) const noexcept {
+#ifdef CPP11CRYPTO_X86_INTRINSICS
+                if (ghash_engine::pclmul == hashing) {
+                    details::ghash_pclmul(powers.data(),state,data,blocks);
+                    return;
+                }
+#endif
+                details::ghash_table(table.data(),state,data,blocks);
+            }
+            /// GHASH of data padded with zeros to whole blocks
+            void hash(::std::uint8_t * const state,const ::std::uint8_t * const data,const ::std::size_t bytes) const noexcept {
+                hash_blocks(state,data,bytes/16);
+                if (0 != bytes%16) {
+                    core::secure_array<::std::uint8_t,16> last;
+                    ::std::memcpy(last.data(),data+bytes/16*16,bytes%16);
+                    hash_blocks(state,last.data(),1);
+                }
+            }
+
+            template <bool Decrypt>
+            void crypt(const utils::span<::std::uint8_t> nonce,const utils::span<::std::uint8_t> aad,
+                       const ::std::uint8_t * in,::std::uint8_t * out,const ::std::size_t bytes,
+                       ::std::uint8_t * const tag) const {
+                if (nonce.empty()) {
+                    throw ::std::invalid_argument("GCM nonces cannot be empty");
+                }
+                if (bytes > max_bytes) {
+                    throw ::std::invalid_argument("Too much data for one GCM nonce");
+                }
+                // J0, the nonce and a 32-bit counter at 1, or a hash of the nonce
+                core::secure_array<::std::uint8_t,16> j0, state;
+                if (nonce_size == nonce.size()) {
+                    ::std::memcpy(j0.data(),nonce.data(),nonce_size);
+                    j0[15] = 1;
+                } else {
+                    hash(j0.data(),nonce.data(),nonce.size());
+                    core::secure_array<::std::uint8_t,16> lengths;
+                    utils::store64be(lengths.data()+8,8*static_cast<::std::uint64_t>(nonce.size()));
+                    hash_blocks(j0.data(),lengths.data(),1);
+                }
+                hash(state.data(),aad.data(),aad.size());
+
+                ::std::size_t done = 0;
+#ifdef CPP11CRYPTO_X86_INTRINSICS
+                if (ghash_engine::pclmul == hashing && (block::aes_engine::aesni == cipher.engine()
+                                                         || block::aes_engine::vaes == cipher.engine())) {
+                    const ::std::size_t batches = bytes/128;
+                    core::secure_array<::std::uint8_t,16> first;
+                    stream::details::counter_blocks<32>(j0.data(),1,first.data(),1);
+                    details::gcm_aesni<Decrypt>(cipher.round_keys(),cipher_type::rounds,powers.data(),first.data(),
+                                                state.data(),in,out,batches);
+                    done = 128*batches;
+                }
+#endif
+                // the rest: counter mode from block 1+done/16, then GHASH
+                stream::ctr<cipher_type,32> ctr {cipher,j0};
+                ctr.seek(16+done);
+                if (Decrypt) {
+                    hash(state.data(),in+done,bytes-done);
+                }
+                ctr.process(in+done,out+done,bytes-done);
+                if (!Decrypt) {
+                    hash(state.data(),out+done,bytes-done);
+                }
+
+                core::secure_array<::std::uint8_t,16> lengths;
+                utils::store64be(lengths.data(),8*static_cast<::std::uint64_t>(aad.size()));
+                utils::store64be(lengths.data()+8,8*static_cast<::std::uint64_t>(bytes));
+                hash_blocks(state.data(),lengths.data(),1);
+                cipher.encrypt(j0.data(),j0.data(),1);
+                block::details::xor_bytes(state.data(),j0.data(),tag,tag_size);
+            }
+
+            cipher_type cipher;
+            ghash_engine hashing;
+            /// Byte reversed H^1..H^8, for PCLMULQDQ
+            core::secure_array<::std::uint8_t,16*ghash_aggregation,16> powers;
+            /// Shoup's table of H, for the portable code
+            core::secure_array<::std::uint64_t,32> table;
+        };
+
+        template <::std::size_t KeyBits>
+        constexpr ::std::size_t aes_gcm<KeyBits>::key_size;
+        template <::std::size_t KeyBits>
+        constexpr ::std::size_t aes_gcm<KeyBits>::nonce_size;
+        template <::std::size_t KeyBits>
+        constexpr ::std::size_t aes_gcm<KeyBits>::tag_size;
+        template <::std::size_t KeyBits>
+        constexpr ::std::uint64_t aes_gcm<KeyBits>::max_bytes;
+
+        /// AES-GCM with 128-bit keys
+        typedef aes_gcm<128> aes128_gcm;
+        /// AES-GCM with 192-bit keys
+        typedef aes_gcm<192> aes192_gcm;
+        /// AES-GCM with 256-bit keys
+        typedef aes_gcm<256> aes256_gcm;
+
+    }
+}
+
+#endif // CPP11CRYPTO_MAC_GCM_HPP
@@ -0,0 +1,368 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// mac/poly1305.hpp - Poly1305 one-time authenticator (RFC 8439) on 26-bit
+//                    limbs, four blocks per iteration in AVX2 lanes
+
+#ifndef CPP11CRYPTO_MAC_POLY1305_HPP
+#define CPP11CRYPTO_MAC_POLY1305_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include "core/secure_array.hpp"
+#include "core/zeroizing.hpp"
+#include "utils/cpu_features.hpp"
+#include "utils/endian.hpp"
+#include "utils/span.hpp"
+
+namespace cpp11crypto {
+    namespace mac {
+
+        /// Poly1305 implementations
+        enum class poly1305_engine {
+            /// One block at a time on five 26-bit limbs, the reference
+            scalar,
+            /// Four blocks at a time, one per 64-bit lane, multiplied by r^4
+            avx2
+        };
+
+        /// Tells whether a Poly1305 implementation can run on this processor
+        /// @param engine implementation to check
+        /// @return true if usable
+        inline bool is_supported(const poly1305_engine engine) noexcept {
+            switch (engine) {
+            case poly1305_engine::scalar:
+                return true;
+            case poly1305_engine::avx2:
+                return utils::cpu().avx2;
+            }
+            return false;
+        }
+
+        /// Fastest Poly1305 implementation usable on this processor, selected once
+        /// @return selected implementation
+        inline poly1305_engine best_poly1305_engine() noexcept {
+            static const poly1305_engine engine =
+                is_supported(poly1305_engine::avx2) ? poly1305_engine::avx2 : poly1305_engine::scalar;
+            return engine;
+        }
+
+        namespace details {
+
+            // Numbers modulo 2^130-5 are five limbs of 26 bits, left partially
+            // carried between blocks: below 2^26, but for the second one, slightly
+            // above. Products reach 2^59 and fit in 64 bits, 2^130 = 5 folding the
+            // upper half onto the lower one as multiples of five.
+
+            constexpr ::std::uint32_t poly1305_mask = 0x3ffffff;
+
+            /// Limbs of a 16-byte block
+            /// @param high 1 << 24 for the 2^128 bit of a whole block, 0 for a padded one
+            inline void poly1305_limbs(const ::std::uint8_t * const m,const ::std::uint32_t high,::std::uint32_t * const limbs) noexcept {
+                limbs[0] = utils::load32le(m) & poly1305_mask;
+                limbs[1] = (utils::load32le(m+3) >> 2) & poly1305_mask;
+                limbs[2] = (utils::load32le(m+6) >> 4) & poly1305_mask;
+                limbs[3] = (utils::load32le(m+9) >> 6) & poly1305_mask;
+                limbs[4] = (utils::load32le(m+12) >> 8) | high;
+            }
+
+            /// h times r, partially carried
+            inline void poly1305_multiply(::std::uint32_t * const h,const ::std::uint32_t * const r) noexcept {
+                const ::std::uint64_t r0 = r[0], r1 = r[1], r2 = r[2], r3 = r[3], r4 = r[4];
+                const ::std::uint64_t s1 = 5*r1, s2 = 5*r2, s3 = 5*r3, s4 = 5*r4;
+                const ::std::uint64_t h0 = h[0], h1 = h[1], h2 = h[2], h3 = h[3], h4 = h[4];
+                ::std::uint64_t d0 = h0*r0+h1*s4+h2*s3+h3*s2+h4*s1;
+                ::std::uint64_t d1 = h0*r1+h1*r0+h2*s4+h3*s3+h4*s2;
+                ::std::uint64_t d2 = h0*r2+h1*r1+h2*r0+h3*s4+h4*s3;
+                ::std::uint64_t d3 = h0*r3+h1*r2+h2*r1+h3*r0+h4*s4;
+                ::std::uint64_t d4 = h0*r4+h1*r3+h2*r2+h3*r1+h4*r0;
+                d1 += d0 >> 26;
+                d2 += d1 >> 26;
+                d3 += d2 >> 26;
+                d4 += d3 >> 26;
+                ::std::uint64_t c = d4 >> 26;
+                ::std::uint64_t l0 = (d0 & poly1305_mask)+5*c;
+                h[1] = static_cast<::std::uint32_t>((d1 & poly1305_mask)+(l0 >> 26));
+                h[0] = static_cast<::std::uint32_t>(l0 & poly1305_mask);
+                h[2] = static_cast<::std::uint32_t>(d2 & poly1305_mask);
+                h[3] = static_cast<::std::uint32_t>(d3 & poly1305_mask);
+                h[4] = static_cast<::std::uint32_t>(d4 & poly1305_mask);
+            }
+
+            /// Portable code on whole blocks, the reference for the vector one
+            inline void poly1305_scalar(const ::std::uint32_t * const r,::std::uint32_t * const h,
+                                        const ::std::uint8_t * m,::std::size_t blocks) noexcept {
+                for (; 0 != blocks; --blocks, m += 16) {
+                    ::std::uint32_t limbs[5];
+                    poly1305_limbs(m,1u << 24,limbs);
+                    for (unsigned i = 0; i != 5; ++i) {
+                        h[i] += limbs[i];
+                    }
+                    poly1305_multiply(h,r);
+                }
+            }
+
+#ifdef CPP11CRYPTO_X86_INTRINSICS
+            /// Limbs of four blocks, block j in lane j
+            __attribute__((target("avx2")))
+            inline void poly1305_load_avx2(const ::std::uint8_t * const m,__m256i * const limbs) noexcept {
+                const __m256i mask = _mm256_set1_epi64x(poly1305_mask);
+                const __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(m));
+                const __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(m+32));
+                // unpacks pair blocks 0 and 2, 1 and 3; the permutation restores the order
+                const __m256i low = _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(v0,v1),0xd8);
+                const __m256i high = _mm256_permute4x64_epi64(_mm256_unpackhi_epi64(v0,v1),0xd8);
+                limbs[0] = _mm256_and_si256(low,mask);
+                limbs[1] = _mm256_and_si256(_mm256_srli_epi64(low,26),mask);
+                limbs[2] = _mm256_and_si256(_mm256_or_si256(_mm256_srli_epi64(low,52),_mm256_slli_epi64(high,12)),mask);
+                limbs[3] = _mm256_and_si256(_mm256_srli_epi64(high,14),mask);
+                limbs[4] = _mm256_or_si256(_mm256_srli_epi64(high,40),_mm256_set1_epi64x(1 << 24));
+            }
+
+            /// h times r lane by lane, partially carried; s holds 5*r
+            __attribute__((target("avx2")))
+            inline void poly1305_multiply_avx2(__m256i * const h,const __m256i * const r,const __m256i * const s) noexcept {
+                const __m256i mask = _mm256_set1_epi64x(poly1305_mask);
+                __m256i d[5];
+                for (unsigned k = 0; k != 5; ++k) {
+                    // d[k] is the sum of h[i]*r[k-i], with 5*r[k-i+5] where k-i wraps
+                    d[k] = _mm256_mul_epu32(h[0],r[k]);
+                    for (unsigned i = 1; i != 5; ++i) {
+                        d[k] = _mm256_add_epi64(d[k],_mm256_mul_epu32(h[i],i <= k ? r[k-i] : s[k+5-i]));
+                    }
+                }
+                for (unsigned k = 0; k != 4; ++k) {
+                    d[k+1] = _mm256_add_epi64(d[k+1],_mm256_srli_epi64(d[k],26));
+                    d[k] = _mm256_and_si256(d[k],mask);
+                }
+                const __m256i c = _mm256_srli_epi64(d[4],26);
+                d[4] = _mm256_and_si256(d[4],mask);
+                d[0] = _mm256_add_epi64(d[0],_mm256_add_epi64(c,_mm256_slli_epi64(c,2)));
+                h[1] = _mm256_add_epi64(d[1],_mm256_srli_epi64(d[0],26));
+                h[0] = _mm256_and_si256(d[0],mask);
+                h[2] = d[2];
+                h[3] = d[3];
+                h[4] = d[4];
+            }
+
+            /// Whole blocks, four at a time: lane j accumulates blocks j, j+4, j+8...,
+            /// multiplied by r^4 each time, and is finally multiplied by r^(4-j)
+            /// @param powers limbs of r, r^2, r^3 and r^4
+            /// @param blocks a non zero multiple of four
+            __attribute__((target("avx2")))
+            inline void poly1305_avx2(const ::std::uint32_t * const powers,::std::uint32_t * const h,
+                                      const ::std::uint8_t * m,::std::size_t blocks) noexcept {
+                __m256i r[5], s[5], a[5], x[5];
+                for (unsigned i = 0; i != 5; ++i) {
+                    r[i] = _mm256_set1_epi64x(powers[15+i]);
+                    s[i] = _mm256_set1_epi64x(5*powers[15+i]);
+                }
+                poly1305_load_avx2(m,a);
+                for (unsigned i = 0; i != 5; ++i) {
+                    a[i] = _mm256_add_epi64(a[i],_mm256_set_epi64x(0,0,0,h[i]));
+                }
+                for (blocks -= 4, m += 64; 0 != blocks; blocks -= 4, m += 64) {
+                    poly1305_multiply_avx2(a,r,s);
+                    poly1305_load_avx2(m,x);
+                    for (unsigned i = 0; i != 5; ++i) {
+                        a[i] = _mm256_add_epi64(a[i],x[i]);
+                    }
+                }
+                for (unsigned i = 0; i != 5; ++i) {
+                    r[i] = _mm256_set_epi64x(powers[i],powers[5+i],powers[10+i],powers[15+i]);
+                    s[i] = _mm256_add_epi64(r[i],_mm256_slli_epi64(r[i],2));
+                }
+                poly1305_multiply_avx2(a,r,s);
+                // sum of the lanes, below 2^29 per limb
+                ::std::uint64_t sum[5];
+                for (unsigned i = 0; i != 5; ++i) {
+                    const __m128i half = _mm_add_epi64(_mm256_castsi256_si128(a[i]),_mm256_extracti128_si256(a[i],1));
+                    sum[i] = static_cast<::std::uint64_t>(_mm_cvtsi128_si64(_mm_add_epi64(half,_mm_unpackhi_epi64(half,half))));
+                }
+                for (unsigned i = 0; i != 4; ++i) {
+                    sum[i+1] += sum[i] >> 26;
+                    sum[i] &= poly1305_mask;
+                }
+                const ::std::uint64_t c = sum[4] >> 26;
+                sum[4] &= poly1305_mask;
+                sum[0] += 5*c;
+                sum[1] += sum[0] >> 26;
+                sum[0] &= poly1305_mask;
+                for (unsigned i = 0; i != 5; ++i) {
+                    h[i] = static_cast<::std::uint32_t>(sum[i]);
+                }
+                core::do_zeroize(a,sizeof a);
+                core::do_zeroize(x,sizeof x);
+                core::do_zeroize(sum,sizeof sum);
+            }
+#endif
+
+        }
+
+        /// Poly1305 (RFC 8439), a one-time authenticator: a key must never
+        /// authenticate two messages. Messages may be added in pieces of any length.
+        class poly1305 : public core::ZeroizingBase<> {
+        public:
+            /// Bytes per key, r then s
+            static constexpr ::std::size_t key_size = 32;
+            /// Bytes per tag
+            static constexpr ::std::size_t tag_size = 16;
+            /// Bytes per block
+            static constexpr ::std::size_t block_size = 16;
+            /// Whole blocks from which the vector code is used
+            static constexpr ::std::size_t vector_blocks = 8;
+
+            /// Constructor, clamps r
+            /// @param key key_size bytes, used once
+            /// @param engine implementation
+            /// @throw std::invalid_argument if the key length is wrong or the implementation unsupported
+            explicit poly1305(const utils::span<::std::uint8_t> key,const poly1305_engine engine = best_poly1305_engine())
+                : kernel {engine} {
+                if (key_size != key.size()) {
+                    throw ::std::invalid_argument("Wrong Poly1305 key length");
+                }
+                if (!is_supported(engine)) {
+                    throw ::std::invalid_argument("Poly1305 implementation not supported by this processor");
+                }
+                details::poly1305_limbs(key.data(),0,powers.data());
+                powers[1] &= 0x3ffff03;
+                powers[2] &= 0x3ffc0ff;
+                powers[3] &= 0x3f03fff;
+                powers[4] &= 0x00fffff;
+                for (unsigned i = 0; i != 4; ++i) {
+                    pad[i] = utils::load32le(key.data()+16+4*i);
+                }
+            }
+
+            /// @return implementation in use
+            poly1305_engine engine() const noexcept {
+                return kernel;
+            }
+
+            /// Adds data to the message
+            /// @param data bytes to add
+            /// @param bytes length
+            void update(const ::std::uint8_t * data,::std::size_t bytes) noexcept {
+                if (0 != buffered) {
+                    const ::std::size_t n = ::std::min(bytes,block_size-buffered);
+                    ::std::memcpy(buffer.data()+buffered,data,n);
+                    buffered += n;
+                    data += n;
+                    bytes -= n;
+                    if (block_size != buffered) {
+                        return;
+                    }
+                    details::poly1305_scalar(powers.data(),h.data(),buffer.data(),1);
+                    buffered = 0;
+                }
+                ::std::size_t blocks = bytes/block_size;
+#ifdef CPP11CRYPTO_X86_INTRINSICS
+                if (poly1305_engine::avx2 == kernel && blocks >= vector_blocks) {
+                    if (!powered) {
+                        for (unsigned k = 1; k != 4; ++k) {
+                            ::std::copy(powers.data()+5*(k-1),powers.data()+5*k,powers.data()+5*k);
+                            details::poly1305_multiply(powers.data()+5*k,powers.data());
+                        }
+                        powered = true;
+                    }
+                    const ::std::size_t n = blocks/4*4;
+                    details::poly1305_avx2(powers.data(),h.data(),data,n);
+                    data += n*block_size;
+                    blocks -= n;
+                    bytes -= n*block_size;
+                }
+#endif
+                details::poly1305_scalar(powers.data(),h.data(),data,blocks);
+                data += blocks*block_size;
+                bytes -= blocks*block_size;
+                ::std::memcpy(buffer.data(),data,bytes);
+                buffered = bytes;
+            }
+
+            /// Computes the tag; the object is not to be used afterwards
+            /// @param tag receives tag_size bytes
+            void finalize(::std::uint8_t * const tag) noexcept {
+                if (0 != buffered) {
+                    // a partial block is padded with a one byte, no 2^128 bit
+                    buffer[buffered] = 1;
+                    ::std::fill(buffer.data()+buffered+1,buffer.data()+block_size,0);
+                    ::std::uint32_t limbs[5];
+                    details::poly1305_limbs(buffer.data(),0,limbs);
+                    for (unsigned i = 0; i != 5; ++i) {
+                        h[i] += limbs[i];
+                    }
+                    details::poly1305_multiply(h.data(),powers.data());
+                    buffered = 0;
+                }
+                // full carry, then h-p if it is not negative, in constant time
+                ::std::uint32_t c = 0;
+                for (unsigned i = 1; i != 5; ++i) {
+                    h[i] += c;
+                    c = h[i] >> 26;
+                    h[i] &= details::poly1305_mask;
+                }
+                h[0] += 5*c;
+                c = h[0] >> 26;
+                h[0] &= details::poly1305_mask;
+                h[1] += c;
+                ::std::uint32_t g[5];
+                c = 5;
+                for (unsigned i = 0; i != 5; ++i) {
+                    g[i] = h[i]+c;
+                    c = g[i] >> 26;
+                    g[i] &= details::poly1305_mask;
+                }
+                // c is the 2^130 bit of h+5, set exactly when h >= p
+                const ::std::uint32_t keep = c-1;
+                for (unsigned i = 0; i != 5; ++i) {
+                    h[i] = (h[i] & keep) | (g[i] & ~keep);
+                }
+                const ::std::uint32_t words[4] = {h[0] | h[1] << 26,h[1] >> 6 | h[2] << 20,h[2] >> 12 | h[3] << 14,
+                                                  h[3] >> 18 | h[4] << 8};
+                ::std::uint64_t f = 0;
+                for (unsigned i = 0; i != 4; ++i) {
+                    f = static_cast<::std::uint64_t>(words[i])+pad[i]+(f >> 32);
+                    utils::store32le(tag+4*i,static_cast<::std::uint32_t>(f));
+                }
+                core::do_zeroize(g,sizeof g);
+                core::do_zeroize(h.data(),h.size()*sizeof h[0]);
+            }
+
+        private:
+            poly1305_engine kernel;
+            /// Limbs of r, then of r^2, r^3 and r^4 for the vector code, computed on
+            /// its first use so that short messages do not pay for them
+            core::secure_array<::std::uint32_t,20> powers;
+            bool powered {false};
+            /// s, added to the tag
+            core::secure_array<::std::uint32_t,4> pad;
+            /// Accumulator
+            core::secure_array<::std::uint32_t,5> h;
+            /// Partial block
+            core::secure_array<::std::uint8_t,block_size> buffer;
+            ::std::size_t buffered {0};
+        };
+
+    }
+}
+
+#endif // CPP11CRYPTO_MAC_POLY1305_HPP
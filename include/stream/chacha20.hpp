@@ -0,0 +1,417 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// stream/chacha20.hpp - ChaCha20 stream cipher (RFC 8439), 4, 8 or 16 blocks
+//                    at a time across the lanes of SSE2, AVX2 or AVX-512 vectors
+
+#ifndef CPP11CRYPTO_STREAM_CHACHA20_HPP
+#define CPP11CRYPTO_STREAM_CHACHA20_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include "block/modes.hpp"
+#include "core/secure_array.hpp"
+#include "core/zeroizing.hpp"
+#include "utils/cpu_features.hpp"
+#include "utils/endian.hpp"
+#include "utils/span.hpp"
+
+namespace cpp11crypto {
+    namespace stream {
+
+        /// ChaCha20 kernels, one per vector level: one block at a time, then 4, 8
+        /// and 16 blocks in the lanes of 16, 32 and 64-byte vectors
+        using chacha_engine = utils::simd_level;
+
+        /// Tells whether a ChaCha20 kernel can run on this processor
+        using utils::is_supported;
+
+        /// Widest ChaCha20 kernel usable on this processor
+        /// @return selected kernel
+        inline chacha_engine best_chacha_engine() noexcept {
+            return utils::simd();
+        }
+
+        namespace details {
+
+            template <unsigned N,typename W>
+            CPP11CRYPTO_ALWAYS_INLINE void rotate_left(W& x) noexcept {
+                x = (x << N) | (x >> (32-N));
+            }
+
+            template <typename W>
+            CPP11CRYPTO_ALWAYS_INLINE void quarter_round(W& a,W& b,W& c,W& d) noexcept {
+                a += b; d ^= a; rotate_left<16>(d);
+                c += d; b ^= c; rotate_left<12>(b);
+                a += b; d ^= a; rotate_left<8>(d);
+                c += d; b ^= c; rotate_left<7>(b);
+            }
+
+            /// The twenty rounds, on 32-bit words or on vectors of them
+            template <typename W>
+            CPP11CRYPTO_ALWAYS_INLINE void chacha_rounds(W * const x) noexcept {
+                for (unsigned i = 0; i != 10; ++i) {
+                    quarter_round(x[0],x[4],x[8],x[12]);
+                    quarter_round(x[1],x[5],x[9],x[13]);
+                    quarter_round(x[2],x[6],x[10],x[14]);
+                    quarter_round(x[3],x[7],x[11],x[15]);
+                    quarter_round(x[0],x[5],x[10],x[15]);
+                    quarter_round(x[1],x[6],x[11],x[12]);
+                    quarter_round(x[2],x[7],x[8],x[13]);
+                    quarter_round(x[3],x[4],x[9],x[14]);
+                }
+            }
+
+            /// Portable kernel, the reference for the others
+            /// @param state initial state, its block counter unused
+            /// @param counter block counter of the first block
+            /// @param in data to process
+            /// @param out receives the processed data, may be in
+            /// @param bytes length; a last partial block is cut
+            inline void chacha_portable(const ::std::uint32_t * const state,::std::uint32_t counter,
+                                        const ::std::uint8_t * in,::std::uint8_t * out,::std::size_t bytes) noexcept {
+                ::std::uint32_t x[16];
+                ::std::uint8_t keystream[64];
+                for (; 0 != bytes; ++counter) {
+                    ::std::copy(state,state+16,x);
+                    x[12] = counter;
+                    chacha_rounds(x);
+                    for (unsigned i = 0; i != 16; ++i) {
+                        utils::store32le(keystream+4*i,x[i]+(12 == i ? counter : state[i]));
+                    }
+                    const ::std::size_t n = ::std::min<::std::size_t>(bytes,64);
+                    block::details::xor_bytes(in,keystream,out,n);
+                    in += n;
+                    out += n;
+                    bytes -= n;
+                }
+                core::do_zeroize(x,sizeof x);
+                core::do_zeroize(keystream,sizeof keystream);
+            }
+
+#ifdef CPP11CRYPTO_X86_INTRINSICS
+            /// Four, eight and sixteen 32-bit lanes, word i of block j in lane j of x[i]
+            typedef ::std::uint32_t chacha_x4 __attribute__((vector_size(16)));
+            typedef ::std::uint32_t chacha_x8 __attribute__((vector_size(32)));
+            typedef ::std::uint32_t chacha_x16 __attribute__((vector_size(64)));
+
+            /// Keystream of as many consecutive blocks as V has lanes, word by word
+            template <typename V>
+            CPP11CRYPTO_ALWAYS_INLINE void chacha_lanes(const ::std::uint32_t * const state,const ::std::uint32_t counter,
+                                                        V * const x) noexcept {
+                constexpr unsigned lanes = sizeof(V)/4;
+                V counters;
+                for (unsigned j = 0; j != lanes; ++j) {
+                    counters[j] = counter+j;
+                }
+                for (unsigned i = 0; i != 16; ++i) {
+                    x[i] = V {}+state[i];
+                }
+                x[12] = counters;
+                chacha_rounds(x);
+                for (unsigned i = 0; i != 16; ++i) {
+                    x[i] += V {}+state[i];
+                }
+                x[12] += counters-state[12];
+            }
+
+            // Kernels: the lanes are transposed four words at a time, with 32 and
+            // 64-bit unpacks inside each 128-bit lane, then, on the wider vectors,
+            // 128-bit lanes are gathered so that each store covers one block. Full
+            // groups of blocks are processed in place; the last one goes through
+            // a keystream buffer.
+
+            __attribute__((target("sse2")))
+            inline void chacha_sse2(const ::std::uint32_t * const state,::std::uint32_t counter,
+                                    const ::std::uint8_t * in,::std::uint8_t * out,::std::size_t bytes) noexcept {
+                alignas(16) ::std::uint8_t keystream[256];
+                chacha_x4 x[16];
+                for (; 0 != bytes; counter += 4) {
+                    const ::std::size_t n = ::std::min<::std::size_t>(bytes,sizeof keystream);
+                    const bool whole = sizeof keystream == n;
+                    const ::std::uint8_t * const source = whole ? in : keystream;
+                    ::std::uint8_t * const target = whole ? out : keystream;
+                    if (!whole) {
+                        ::std::memset(keystream,0,sizeof keystream);
+                    }
+                    chacha_lanes(state,counter,x);
+                    for (unsigned q = 0; q != 4; ++q) {
+                        const __m128i a = (__m128i)x[4*q], b = (__m128i)x[4*q+1], c = (__m128i)x[4*q+2], d = (__m128i)x[4*q+3];
+                        const __m128i t0 = _mm_unpacklo_epi32(a,b), t1 = _mm_unpacklo_epi32(c,d);
+                        const __m128i t2 = _mm_unpackhi_epi32(a,b), t3 = _mm_unpackhi_epi32(c,d);
+                        const __m128i rows[4] = {_mm_unpacklo_epi64(t0,t1),_mm_unpackhi_epi64(t0,t1),
+                                                 _mm_unpacklo_epi64(t2,t3),_mm_unpackhi_epi64(t2,t3)};
+                        for (unsigned j = 0; j != 4; ++j) {
+                            const __m128i * const p = reinterpret_cast<const __m128i *>(source+64*j+16*q);
+                            _mm_storeu_si128(reinterpret_cast<__m128i *>(target+64*j+16*q),
+                                             _mm_xor_si128(_mm_loadu_si128(p),rows[j]));
+                        }
+                    }
+                    if (!whole) {
+                        block::details::xor_bytes(in,keystream,out,n);
+                    }
+                    in += n;
+                    out += n;
+                    bytes -= n;
+                }
+                core::do_zeroize(x,sizeof x);
+                core::do_zeroize(keystream,sizeof keystream);
+            }
+
+            __attribute__((target("avx2")))
+            inline void chacha_avx2(const ::std::uint32_t * const state,::std::uint32_t counter,
+                                    const ::std::uint8_t * in,::std::uint8_t * out,::std::size_t bytes) noexcept {
+                alignas(32) ::std::uint8_t keystream[512];
+                chacha_x8 x[16];
+                for (; 0 != bytes; counter += 8) {
+                    const ::std::size_t n = ::std::min<::std::size_t>(bytes,sizeof keystream);
+                    const bool whole = sizeof keystream == n;
+                    const ::std::uint8_t * const source = whole ? in : keystream;
+                    ::std::uint8_t * const target = whole ? out : keystream;
+                    if (!whole) {
+                        ::std::memset(keystream,0,sizeof keystream);
+                    }
+                    chacha_lanes(state,counter,x);
+                    // rows[q][j]: words 4q..4q+3 of block j in the low half, of block j+4 in the high one
+                    __m256i rows[4][4];
+                    for (unsigned q = 0; q != 4; ++q) {
+                        const __m256i a = (__m256i)x[4*q], b = (__m256i)x[4*q+1], c = (__m256i)x[4*q+2], d = (__m256i)x[4*q+3];
+                        const __m256i t0 = _mm256_unpacklo_epi32(a,b), t1 = _mm256_unpacklo_epi32(c,d);
+                        const __m256i t2 = _mm256_unpackhi_epi32(a,b), t3 = _mm256_unpackhi_epi32(c,d);
+                        rows[q][0] = _mm256_unpacklo_epi64(t0,t1);
+                        rows[q][1] = _mm256_unpackhi_epi64(t0,t1);
+                        rows[q][2] = _mm256_unpacklo_epi64(t2,t3);
+                        rows[q][3] = _mm256_unpackhi_epi64(t2,t3);
+                    }
+                    for (unsigned j = 0; j != 4; ++j) {
+                        for (unsigned h = 0; h != 2; ++h) {
+                            const __m256i low = _mm256_permute2x128_si256(rows[2*h][j],rows[2*h+1][j],0x20);
+                            const __m256i high = _mm256_permute2x128_si256(rows[2*h][j],rows[2*h+1][j],0x31);
+                            const ::std::size_t first = 64*j+32*h, second = first+256;
+                            _mm256_storeu_si256(reinterpret_cast<__m256i *>(target+first),
+                                                _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(source+first)),low));
+                            _mm256_storeu_si256(reinterpret_cast<__m256i *>(target+second),
+                                                _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(source+second)),high));
+                        }
+                    }
+                    if (!whole) {
+                        block::details::xor_bytes(in,keystream,out,n);
+                    }
+                    in += n;
+                    out += n;
+                    bytes -= n;
+                }
+                core::do_zeroize(x,sizeof x);
+                core::do_zeroize(keystream,sizeof keystream);
+            }
+
+            __attribute__((target("avx512f")))
+            inline void chacha_avx512(const ::std::uint32_t * const state,::std::uint32_t counter,
+                                      const ::std::uint8_t * in,::std::uint8_t * out,::std::size_t bytes) noexcept {
+                alignas(64) ::std::uint8_t keystream[1024];
+                chacha_x16 x[16];
+                // unpacks within 128-bit lanes and moves of whole 128-bit lanes, all as
+                // two-source permutations
+                const __m512i low32 = _mm512_set_epi32(29,13,28,12,25,9,24,8,21,5,20,4,17,1,16,0);
+                const __m512i high32 = _mm512_set_epi32(31,15,30,14,27,11,26,10,23,7,22,6,19,3,18,2);
+                const __m512i low64 = _mm512_set_epi64(14,6,12,4,10,2,8,0);
+                const __m512i high64 = _mm512_set_epi64(15,7,13,5,11,3,9,1);
+                const __m512i low_lanes = _mm512_set_epi64(11,10,9,8,3,2,1,0);
+                const __m512i high_lanes = _mm512_set_epi64(15,14,13,12,7,6,5,4);
+                const __m512i even_lanes = _mm512_set_epi64(13,12,9,8,5,4,1,0);
+                const __m512i odd_lanes = _mm512_set_epi64(15,14,11,10,7,6,3,2);
+                for (; 0 != bytes; counter += 16) {
+                    const ::std::size_t n = ::std::min<::std::size_t>(bytes,sizeof keystream);
+                    const bool whole = sizeof keystream == n;
+                    const ::std::uint8_t * const source = whole ? in : keystream;
+                    ::std::uint8_t * const target = whole ? out : keystream;
+                    if (!whole) {
+                        ::std::memset(keystream,0,sizeof keystream);
+                    }
+                    chacha_lanes(state,counter,x);
+                    // rows[q][j]: words 4q..4q+3 of block 4L+j in 128-bit lane L
+                    __m512i rows[4][4];
+                    for (unsigned q = 0; q != 4; ++q) {
+                        const __m512i a = (__m512i)x[4*q], b = (__m512i)x[4*q+1], c = (__m512i)x[4*q+2], d = (__m512i)x[4*q+3];
+                        const __m512i t0 = _mm512_permutex2var_epi32(a,low32,b), t1 = _mm512_permutex2var_epi32(c,low32,d);
+                        const __m512i t2 = _mm512_permutex2var_epi32(a,high32,b), t3 = _mm512_permutex2var_epi32(c,high32,d);
+                        rows[q][0] = _mm512_permutex2var_epi64(t0,low64,t1);
+                        rows[q][1] = _mm512_permutex2var_epi64(t0,high64,t1);
+                        rows[q][2] = _mm512_permutex2var_epi64(t2,low64,t3);
+                        rows[q][3] = _mm512_permutex2var_epi64(t2,high64,t3);
+                    }
+                    for (unsigned j = 0; j != 4; ++j) {
+                        // 4x4 transposition of 128-bit lanes
+                        const __m512i a = _mm512_permutex2var_epi64(rows[0][j],low_lanes,rows[1][j]);
+                        const __m512i b = _mm512_permutex2var_epi64(rows[0][j],high_lanes,rows[1][j]);
+                        const __m512i c = _mm512_permutex2var_epi64(rows[2][j],low_lanes,rows[3][j]);
+                        const __m512i d = _mm512_permutex2var_epi64(rows[2][j],high_lanes,rows[3][j]);
+                        const __m512i blocks[4] = {_mm512_permutex2var_epi64(a,even_lanes,c),_mm512_permutex2var_epi64(a,odd_lanes,c),
+                                                   _mm512_permutex2var_epi64(b,even_lanes,d),_mm512_permutex2var_epi64(b,odd_lanes,d)};
+                        for (unsigned lane = 0; lane != 4; ++lane) {
+                            const ::std::size_t offset = 64*(4*lane+j);
+                            _mm512_storeu_si512(target+offset,_mm512_xor_si512(_mm512_loadu_si512(source+offset),blocks[lane]));
+                        }
+                    }
+                    if (!whole) {
+                        block::details::xor_bytes(in,keystream,out,n);
+                    }
+                    in += n;
+                    out += n;
+                    bytes -= n;
+                }
+                core::do_zeroize(x,sizeof x);
+                core::do_zeroize(keystream,sizeof keystream);
+            }
+#endif
+
+            /// Runs a kernel, or a narrower one on inputs too short to fill half of its lanes
+            inline void chacha(chacha_engine engine,const ::std::uint32_t * const state,const ::std::uint32_t counter,
+                               const ::std::uint8_t * const in,::std::uint8_t * const out,const ::std::size_t bytes) noexcept {
+                if (chacha_engine::avx512 == engine && bytes <= 512) {
+                    engine = chacha_engine::avx2;
+                }
+                if (chacha_engine::avx2 == engine && bytes <= 256) {
+                    engine = chacha_engine::sse2;
+                }
+                if (chacha_engine::sse2 == engine && bytes <= 64) {
+                    engine = chacha_engine::scalar;
+                }
+                switch (engine) {
+#ifdef CPP11CRYPTO_X86_INTRINSICS
+                case chacha_engine::avx512:
+                    chacha_avx512(state,counter,in,out,bytes);
+                    return;
+                case chacha_engine::avx2:
+                    chacha_avx2(state,counter,in,out,bytes);
+                    return;
+                case chacha_engine::sse2:
+                    chacha_sse2(state,counter,in,out,bytes);
+                    return;
+#endif
+                default:
+                    chacha_portable(state,counter,in,out,bytes);
+                }
+            }
+
+        }
+
+        /// ChaCha20 (RFC 8439): a 256-bit key, a 96-bit nonce and a 32-bit block
+        /// counter. Messages may be processed in pieces of any length, and from any
+        /// position; at most 2^32 blocks, 256 GiB, follow the initial counter before
+        /// it wraps around.
+        class chacha20 : public core::ZeroizingBase<> {
+        public:
+            /// Bytes per key
+            static constexpr ::std::size_t key_size = 32;
+            /// Bytes per nonce
+            static constexpr ::std::size_t nonce_size = 12;
+            /// Bytes per block
+            static constexpr ::std::size_t block_size = 64;
+
+            /// Constructor
+            /// @param key key_size bytes
+            /// @param nonce nonce_size bytes, never reused with the same key
+            /// @param counter block counter at position 0
+            /// @param engine kernel to use
+            /// @throw std::invalid_argument if a length is wrong or the kernel unsupported
+            chacha20(const utils::span<::std::uint8_t> key,const utils::span<::std::uint8_t> nonce,
+                     const ::std::uint32_t counter = 0,const chacha_engine engine = best_chacha_engine())
+                : kernel {engine} {
+                if (key_size != key.size()) {
+                    throw ::std::invalid_argument("Wrong ChaCha20 key length");
+                }
+                if (nonce_size != nonce.size()) {
+                    throw ::std::invalid_argument("Wrong ChaCha20 nonce length");
+                }
+                if (!is_supported(engine)) {
+                    throw ::std::invalid_argument("ChaCha20 kernel not supported by this processor");
+                }
+                // "expand 32-byte k"
+                state[0] = 0x61707865;
+                state[1] = 0x3320646e;
+                state[2] = 0x79622d32;
+                state[3] = 0x6b206574;
+                for (unsigned i = 0; i != 8; ++i) {
+                    state[4+i] = utils::load32le(key.data()+4*i);
+                }
+                state[12] = counter;
+                for (unsigned i = 0; i != 3; ++i) {
+                    state[13+i] = utils::load32le(nonce.data()+4*i);
+                }
+            }
+
+            /// @return kernel in use
+            chacha_engine engine() const noexcept {
+                return kernel;
+            }
+
+            /// Encrypts or decrypts, continuing the keystream
+            /// @param in data to process
+            /// @param out receives the processed data, may be in
+            /// @param bytes length
+            void process(const ::std::uint8_t * in,::std::uint8_t * out,::std::size_t bytes) noexcept {
+                // the rest of a block started by the previous call
+                const ::std::size_t used = offset%block_size;
+                if (0 != used && 0 != bytes) {
+                    const ::std::size_t n = ::std::min(bytes,block_size-used);
+                    core::secure_array<::std::uint8_t,block_size> keystream;
+                    ::std::memcpy(keystream.data()+used,in,n);
+                    details::chacha(kernel,state.data(),block_counter(),keystream.data(),keystream.data(),used+n);
+                    ::std::memcpy(out,keystream.data()+used,n);
+                    in += n;
+                    out += n;
+                    bytes -= n;
+                    offset += n;
+                }
+                details::chacha(kernel,state.data(),block_counter(),in,out,bytes);
+                offset += bytes;
+            }
+
+            /// @return position in the keystream, bytes processed since construction
+            ///         unless moved by @ref seek
+            ::std::uint64_t position() const noexcept {
+                return offset;
+            }
+            /// Moves to any position of the keystream
+            /// @param position byte offset from the start of the keystream
+            void seek(const ::std::uint64_t position) noexcept {
+                offset = position;
+            }
+
+        private:
+            /// Counter of the block holding the current position
+            ::std::uint32_t block_counter() const noexcept {
+                return static_cast<::std::uint32_t>(state[12]+offset/block_size);
+            }
+
+            /// Constants, key, initial counter and nonce
+            core::secure_array<::std::uint32_t,16> state;
+            /// Position in the keystream
+            ::std::uint64_t offset {0};
+            chacha_engine kernel;
+        };
+
+    }
+}
+
+#endif // CPP11CRYPTO_STREAM_CHACHA20_HPP
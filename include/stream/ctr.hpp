@@ -0,0 +1,234 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// stream/ctr.hpp - Counter mode, a stream cipher out of any 128-bit block
+//                    cipher, with counter blocks built in vectors
+
+#ifndef CPP11CRYPTO_STREAM_CTR_HPP
+#define CPP11CRYPTO_STREAM_CTR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include "block/modes.hpp"
+#include "core/secure_array.hpp"
+#include "core/zeroizing.hpp"
+#include "utils/cpu_features.hpp"
+#include "utils/endian.hpp"
+#include "utils/span.hpp"
+
+namespace cpp11crypto {
+    namespace stream {
+
+        namespace details {
+
+            /// Adds to the counter held in the low CounterBits bits of a big endian
+            /// block, modulo 2^CounterBits, the other bits left alone
+            /// @param high first eight bytes of the block, as a number
+            /// @param low last eight bytes of the block, as a number
+            /// @param n value to add
+            template <unsigned CounterBits>
+            void add_counter(::std::uint64_t& high,::std::uint64_t& low,const ::std::uint64_t n) noexcept {
+                if (32 == CounterBits) {
+                    low = (low & 0xffffffff00000000ULL) | ((low+n) & 0xffffffffULL);
+                } else {
+                    const ::std::uint64_t sum = low+n;
+                    if (128 == CounterBits) {
+                        high += sum < low ? 1 : 0;
+                    }
+                    low = sum;
+                }
+            }
+
+            /// Portable counter blocks
+            template <unsigned CounterBits>
+            void counter_blocks_portable(::std::uint64_t high,::std::uint64_t low,::std::uint8_t * out,
+                                         ::std::size_t count) noexcept {
+                for (; 0 != count; --count, out += 16) {
+                    utils::store64be(out,high);
+                    utils::store64be(out+8,low);
+                    add_counter<CounterBits>(high,low,1);
+                }
+            }
+
+#ifdef CPP11CRYPTO_X86_INTRINSICS
+            /// Counter blocks in SSSE3 registers: the counter is kept in little endian
+            /// lanes, where a 32 or 64-bit vector addition wraps exactly as the counter
+            /// does, and one byte shuffle per block turns it big endian. A 128-bit
+            /// counter must not carry between its halves during the call.
+            template <unsigned CounterBits>
+            __attribute__((target("ssse3")))
+            inline void counter_blocks_ssse3(const ::std::uint64_t high,const ::std::uint64_t low,::std::uint8_t * out,
+                                             ::std::size_t count) noexcept {
+                const __m128i reverse = _mm_set_epi8(0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15);
+                const __m128i one = _mm_set_epi64x(0,1);
+                __m128i c = _mm_set_epi64x(static_cast<long long>(high),static_cast<long long>(low));
+                for (; 0 != count; --count, out += 16) {
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(out),_mm_shuffle_epi8(c,reverse));
+                    c = 32 == CounterBits ? _mm_add_epi32(c,one) : _mm_add_epi64(c,one);
+                }
+            }
+#endif
+
+            /// Counter blocks of a range of the keystream
+            /// @tparam CounterBits width of the counter at the end of the block
+            /// @param initial first counter block
+            /// @param index number of the first block to build, counted from initial
+            /// @param out receives count blocks
+            /// @param count number of blocks
+            template <unsigned CounterBits>
+            void counter_blocks(const ::std::uint8_t * const initial,const ::std::uint64_t index,
+                                ::std::uint8_t * const out,const ::std::size_t count) noexcept {
+                ::std::uint64_t high = utils::load64be(initial), low = utils::load64be(initial+8);
+                add_counter<CounterBits>(high,low,index);
+#ifdef CPP11CRYPTO_X86_INTRINSICS
+                if (utils::cpu().ssse3 && (128 != CounterBits || low <= ~::std::uint64_t {0}-count)) {
+                    counter_blocks_ssse3<CounterBits>(high,low,out,count);
+                    return;
+                }
+#endif
+                counter_blocks_portable<CounterBits>(high,low,out,count);
+            }
+
+            /// Whole blocks through the cipher's own counter mode kernel, when it has
+            /// one, like block::aes::ctr_blocks
+            /// @return false when the cipher has no such kernel or did not run it
+            template <unsigned CounterBits,typename Cipher>
+            auto ctr_kernel(const Cipher& cipher,const ::std::uint8_t * const counter,const ::std::uint8_t * const in,
+                            ::std::uint8_t * const out,const ::std::size_t blocks,int) noexcept
+                -> decltype(cipher.template ctr_blocks<CounterBits>(counter,in,out,blocks)) {
+                return cipher.template ctr_blocks<CounterBits>(counter,in,out,blocks);
+            }
+            template <unsigned CounterBits,typename Cipher>
+            bool ctr_kernel(const Cipher&,const ::std::uint8_t *,const ::std::uint8_t *,::std::uint8_t *,::std::size_t,long) noexcept {
+                return false;
+            }
+
+        }
+
+        /// Counter mode (SP 800-38A): the keystream is the encryption of successive
+        /// counter blocks, which go to the cipher's own counter mode kernel when it has
+        /// one, as block::aes does, or by batches of @ref block::parallel_blocks.
+        /// Encryption and decryption are the same operation; a message may be
+        /// processed in pieces of any length, and from any position.
+        /// @tparam Cipher block cipher of 16-byte blocks
+        /// @tparam CounterBits width of the counter at the end of the counter block, 32,
+        ///                     64 or 128; bits before it stay as in the initial block
+        template <typename Cipher,unsigned CounterBits = 128>
+        class ctr : public core::ZeroizingBase<> {
+            static_assert(16 == Cipher::block_size,"Counter mode is built on 128-bit blocks");
+            static_assert(32 == CounterBits || 64 == CounterBits || 128 == CounterBits,"Counters are 32, 64 or 128 bits");
+        public:
+            /// Cipher type
+            typedef Cipher cipher_type;
+            /// Bytes per block
+            static constexpr ::std::size_t block_size = 16;
+
+            /// Constructor
+            /// @param cipher keyed cipher, referenced
+            /// @param initial first counter block, 16 bytes
+            /// @throw std::invalid_argument if the counter block length is wrong
+            ctr(const Cipher& cipher,const utils::span<::std::uint8_t> initial) : cipher(cipher) {
+                if (block_size != initial.size()) {
+                    throw ::std::invalid_argument("Wrong counter block length");
+                }
+                ::std::memcpy(counter.data(),initial.data(),block_size);
+            }
+
+            /// Encrypts or decrypts, continuing the keystream
+            /// @param in data to process
+            /// @param out receives the processed data, may be in
+            /// @param bytes length
+            void process(const ::std::uint8_t * in,::std::uint8_t * out,::std::size_t bytes) noexcept {
+                core::secure_array<::std::uint8_t,block::parallel_blocks*block_size,16> keystream;
+                // the rest of a block started by the previous call
+                const ::std::size_t used = offset%block_size;
+                if (0 != used && 0 != bytes) {
+                    const ::std::size_t n = ::std::min(bytes,block_size-used);
+                    keystream_blocks(keystream.data(),offset/block_size,1);
+                    block::details::xor_bytes(in,keystream.data()+used,out,n);
+                    in += n;
+                    out += n;
+                    bytes -= n;
+                    offset += n;
+                }
+                const ::std::size_t whole = bytes/block_size;
+                if (0 != whole && kernel_blocks(in,out,whole)) {
+                    in += whole*block_size;
+                    out += whole*block_size;
+                    bytes -= whole*block_size;
+                    offset += whole*block_size;
+                }
+                while (0 != bytes) {
+                    const ::std::size_t blocks = ::std::min((bytes+block_size-1)/block_size,block::parallel_blocks);
+                    const ::std::size_t n = ::std::min(bytes,blocks*block_size);
+                    keystream_blocks(keystream.data(),offset/block_size,blocks);
+                    block::details::xor_bytes(in,keystream.data(),out,n);
+                    in += n;
+                    out += n;
+                    bytes -= n;
+                    offset += n;
+                }
+            }
+
+            /// @return position in the keystream, bytes processed since construction
+            ///         unless moved by @ref seek
+            ::std::uint64_t position() const noexcept {
+                return offset;
+            }
+            /// Moves to any position of the keystream, in constant time: counter blocks
+            /// are computed from their index, never from the previous one
+            /// @param position byte offset from the start of the keystream
+            void seek(const ::std::uint64_t position) noexcept {
+                offset = position;
+            }
+
+        private:
+            void keystream_blocks(::std::uint8_t * const out,const ::std::uint64_t index,const ::std::size_t count) const noexcept {
+                details::counter_blocks<CounterBits>(counter.data(),index,out,count);
+                cipher.encrypt(out,out,count);
+            }
+            /// Whole blocks from the current position through the cipher's own kernel
+            /// @return false if the cipher has none, or a 128-bit counter would carry
+            ///         between its halves
+            bool kernel_blocks(const ::std::uint8_t * const in,::std::uint8_t * const out,const ::std::size_t count) const noexcept {
+                core::secure_array<::std::uint8_t,block_size> first;
+                details::counter_blocks<CounterBits>(counter.data(),offset/block_size,first.data(),1);
+                if (128 == CounterBits && utils::load64be(first.data()+8) > ~::std::uint64_t {0}-count) {
+                    return false;
+                }
+                return details::ctr_kernel<CounterBits>(cipher,first.data(),in,out,count,0);
+            }
+
+            const Cipher& cipher;
+            /// First counter block
+            core::secure_array<::std::uint8_t,block_size> counter;
+            /// Position in the keystream
+            ::std::uint64_t offset {0};
+        };
+
+        template <typename Cipher,unsigned CounterBits>
+        constexpr ::std::size_t ctr<Cipher,CounterBits>::block_size;
+
+    }
+}
+
+#endif // CPP11CRYPTO_STREAM_CTR_HPP
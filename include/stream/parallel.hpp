@@ -0,0 +1,81 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// stream/parallel.hpp - Seekable stream ciphers over long buffers, in chunks
+//                    spread over a work stealing thread pool
+
+#ifndef CPP11CRYPTO_STREAM_PARALLEL_HPP
+#define CPP11CRYPTO_STREAM_PARALLEL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include "utils/work_stealing_pool.hpp"
+
+namespace cpp11crypto {
+    namespace stream {
+
+        /// Default chunk length of @ref process_parallel: well within the level 2
+        /// cache, so that each chunk is read and written while it is there, and large
+        /// enough for the cost of a chunk to hide that of taking it
+        constexpr ::std::size_t parallel_chunk_bytes = 1 << 16;
+
+        /// Encrypts or decrypts a buffer with a seekable stream cipher on a thread
+        /// pool. Chunks are processed by copies of the stream, each moved to the
+        /// position of its chunk, so the output and the final position are those of
+        /// stream.process(in,out,bytes), byte for byte. Short buffers are processed
+        /// by the calling thread alone.
+        /// @tparam Stream copyable stream cipher with position(), seek(position) and
+        ///                process(in,out,bytes), like @ref ctr; copies run concurrently
+        /// @param stream stream cipher, moved past the processed bytes
+        /// @param in data to process
+        /// @param out receives the processed data, may be in
+        /// @param bytes length
+        /// @param pool threads to use
+        /// @param chunk_bytes bytes per chunk
+        /// @throw std::invalid_argument if the chunk length is zero
+        template <typename Stream>
+        void process_parallel(Stream& stream,const ::std::uint8_t * const in,::std::uint8_t * const out,
+                              const ::std::size_t bytes,utils::work_stealing_pool& pool = utils::shared_pool(),
+                              ::std::size_t chunk_bytes = parallel_chunk_bytes) {
+            if (0 == chunk_bytes) {
+                throw ::std::invalid_argument("Chunks cannot be empty");
+            }
+            // the pool numbers chunks on 32 bits
+            chunk_bytes = ::std::max<::std::size_t>(chunk_bytes,bytes/0xffffffffULL+1);
+            const ::std::size_t chunks = bytes/chunk_bytes+(0 != bytes%chunk_bytes ? 1 : 0);
+            if (chunks <= 1 || 1 == pool.size()) {
+                stream.process(in,out,bytes);
+                return;
+            }
+            const ::std::uint64_t start = stream.position();
+            pool.run(chunks,[&](const ::std::size_t chunk) {
+                const ::std::size_t first = chunk*chunk_bytes;
+                Stream part(stream);
+                part.seek(start+first);
+                part.process(in+first,out+first,::std::min(chunk_bytes,bytes-first));
+            });
+            stream.seek(start+bytes);
+        }
+
+    }
+}
+
+#endif // CPP11CRYPTO_STREAM_PARALLEL_HPP
@@ -0,0 +1,103 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// utils/aligned_as_vector.hpp - Templates to select vector lanes and cache
+//                    line alignment, and storage aligned for them
+
+#ifndef CPP11CRYPTO_UTILS_ALIGNED_AS_VECTOR_HPP
+#define CPP11CRYPTO_UTILS_ALIGNED_AS_VECTOR_HPP
+
+#include <cstddef>
+#include <type_traits>
+#include "utils/aligned_as_integral.hpp"
+#include "utils/cpu_features.hpp"
+
+namespace cpp11crypto {
+    namespace utils {
+
+        /// Size and alignment of a cache line, the unit of false sharing
+        constexpr ::std::size_t cache_line_size = 64;
+
+        /// Widest vector lane any kernel of the library uses
+        constexpr ::std::size_t max_lane_size = lane_bytes(simd_level::avx512);
+
+        /// POD as wide and as aligned as a vector register
+        /// @tparam Bytes register width, 16, 32 or 64
+        template <::std::size_t Bytes>
+        struct alignas(Bytes) vector_lane {
+            static_assert(16 == Bytes || 32 == Bytes || 64 == Bytes,
+                          "Vector lanes are 16, 32 or 64 bytes wide");
+            /// Register contents
+            unsigned char bytes[Bytes];
+        };
+
+        /// Lane of an SSE register
+        using lane128 = vector_lane<16>;
+        /// Lane of an AVX2 register
+        using lane256 = vector_lane<32>;
+        /// Lane of an AVX-512 register
+        using lane512 = vector_lane<64>;
+
+        /// Helper struct designed to select the widest vector lane whose alignment divides
+        /// that of other type, or the greatest integral type when no lane fits
+        /// @tparam T type subject to search
+        template <typename T>
+        struct aligned_as_vector {
+            /// Selected type
+            using type = typename ::std::conditional< (alignof(T) >= alignof(lane128)),
+                  details::select_aligned_as_integral<T,lane512,lane256,lane128>,
+                  aligned_as_integral<T>
+                  >::type::type;
+        };
+
+        /// Specialization to catch the general case, arising from a (void *) pointer
+        template <>
+        struct aligned_as_vector<void> {
+            /// Selected type
+            using type = details::worst_case_type;
+        };
+
+        /// Uninitialized storage, as std::aligned_storage, without its upper bound on
+        /// the alignment
+        /// @tparam Len size in bytes
+        /// @tparam Align alignment, a power of two, a cache line by default
+        template <::std::size_t Len, ::std::size_t Align = cache_line_size>
+        struct aligned_storage {
+            static_assert(0 != Align && 0 == (Align & (Align-1)), "Alignment must be a power of two");
+            /// Storage type, a POD
+            struct type {
+                /// Raw bytes
+                alignas(Align) unsigned char data[Len];
+            };
+        };
+
+        /// Object alone on its cache lines, so that writes to it do not slow down
+        /// threads working on its neighbours
+        /// @tparam T wrapped type
+        template <typename T>
+        struct alignas(cache_line_size) cache_aligned {
+            /// Wrapped object
+            T value;
+        };
+
+    }
+
+}
+
+#endif // CPP11CRYPTO_UTILS_ALIGNED_AS_VECTOR_HPP
@@ -0,0 +1,107 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// utils/bits.hpp - Bit counting on integral types, and the compiler
+//                    128-bit integer where it exists
+
+#ifndef CPP11CRYPTO_UTILS_BITS_HPP
+#define CPP11CRYPTO_UTILS_BITS_HPP
+
+#include <climits>
+#include <type_traits>
+
+#if defined(__SIZEOF_INT128__)
+/// Defined when the compiler provides a 128-bit integer type
+#define CPP11CRYPTO_HAS_UINT128 1
+#endif
+
+namespace cpp11crypto {
+    namespace utils {
+
+#ifdef CPP11CRYPTO_HAS_UINT128
+        /// Unsigned 128-bit integer, a compiler extension
+        __extension__ typedef unsigned __int128 uint128_t;
+        /// Signed 128-bit integer, a compiler extension
+        __extension__ typedef __int128 int128_t;
+#endif
+
+        namespace details {
+#if !defined(__GNUC__)
+            /// Portable count of trailing zeros
+            constexpr unsigned portable_trailing_zeros(const unsigned long long x) {
+                return 0 != (x & 1) ? 0 : 1 + portable_trailing_zeros(x >> 1);
+            }
+
+            /// Portable count of significant bits
+            constexpr unsigned portable_bit_length(const unsigned long long x) {
+                return 0 == x ? 0 : 1 + portable_bit_length(x >> 1);
+            }
+#endif
+        }
+
+        /// Number of trailing zero bits of a word
+        /// @param x value, not zero
+        /// @return index of the lowest bit set
+        template <typename T, typename = typename ::std::enable_if<(sizeof(T) <= sizeof(unsigned long long))>::type>
+        constexpr unsigned trailing_zeros(const T x) noexcept {
+#if defined(__GNUC__)
+            return static_cast<unsigned>(__builtin_ctzll(static_cast<unsigned long long>(x)));
+#else
+            return details::portable_trailing_zeros(static_cast<unsigned long long>(x));
+#endif
+        }
+
+        /// Number of significant bits of a word
+        /// @param x value
+        /// @return index of the highest bit set plus one, 0 for 0
+        template <typename T, typename = typename ::std::enable_if<(sizeof(T) <= sizeof(unsigned long long))>::type>
+        constexpr unsigned bit_length(const T x) noexcept {
+#if defined(__GNUC__)
+            return 0 == x ? 0 : static_cast<unsigned>(sizeof(unsigned long long)*CHAR_BIT
+                    - __builtin_clzll(static_cast<unsigned long long>(x)));
+#else
+            return details::portable_bit_length(static_cast<unsigned long long>(x));
+#endif
+        }
+
+#ifdef CPP11CRYPTO_HAS_UINT128
+        /// Number of trailing zero bits of a 128-bit integer
+        /// @param x value, not zero
+        /// @return index of the lowest bit set
+        constexpr unsigned trailing_zeros(const uint128_t x) noexcept {
+            return 0 == static_cast<unsigned long long>(x)
+                   ? 64 + trailing_zeros(static_cast<unsigned long long>(x >> 64))
+                   : trailing_zeros(static_cast<unsigned long long>(x));
+        }
+
+        /// Number of significant bits of a 128-bit integer
+        /// @param x value
+        /// @return index of the highest bit set plus one, 0 for 0
+        constexpr unsigned bit_length(const uint128_t x) noexcept {
+            return 0 != (x >> 64)
+                   ? 64 + bit_length(static_cast<unsigned long long>(x >> 64))
+                   : bit_length(static_cast<unsigned long long>(x));
+        }
+#endif
+
+    }
+
+}
+
+#endif // CPP11CRYPTO_UTILS_BITS_HPP
@@ -0,0 +1,203 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// utils/cpu_features.hpp - Runtime detection of the instruction set
+//                    extensions available on the running processor
+
+#ifndef CPP11CRYPTO_UTILS_CPU_FEATURES_HPP
+#define CPP11CRYPTO_UTILS_CPU_FEATURES_HPP
+
+#include <cstddef>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+/// Defined when x86 intrinsics and per-function target attributes are usable
+#define CPP11CRYPTO_X86_INTRINSICS 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+#ifdef CPP11CRYPTO_X86_INTRINSICS
+/// For code generic over its words, called from vector kernels: forcing it
+/// inline lets each kernel compile it with its own instruction set
+#define CPP11CRYPTO_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define CPP11CRYPTO_ALWAYS_INLINE inline
+#endif
+
+namespace cpp11crypto {
+    namespace utils {
+
+        /// Instruction set extensions usable by the library on the running processor.
+        /// A flag is only set when both the processor and the operating system support it.
+        struct cpu_features {
+            /// SSE2, 128-bit integer vectors
+            bool sse2 {false};
+            /// SSSE3, byte shuffles on 128-bit vectors
+            bool ssse3 {false};
+            /// SSE4.1, blends, extractions and insertions on 128-bit vectors
+            bool sse41 {false};
+            /// AES-NI, one AES round per instruction on 128-bit vectors
+            bool aes {false};
+            /// PCLMULQDQ, carry-less 64x64-bit multiplication
+            bool pclmulqdq {false};
+            /// SHA-NI, SHA-1 and SHA-256 rounds
+            bool sha {false};
+            /// AVX2, 256-bit integer vectors
+            bool avx2 {false};
+            /// BMI2, flagless multiplication and shifts (mulx, shrx...)
+            bool bmi2 {false};
+            /// ADX, two independent carry chains (adcx, adox)
+            bool adx {false};
+            /// AES rounds on 256-bit and 512-bit vectors
+            bool vaes {false};
+            /// Carry-less multiplication on 256-bit and 512-bit vectors
+            bool vpclmulqdq {false};
+            /// AVX-512 foundation, 512-bit vectors
+            bool avx512f {false};
+            /// AVX-512 byte and word operations
+            bool avx512bw {false};
+            /// AVX-512 operations on 128-bit and 256-bit vectors
+            bool avx512vl {false};
+            /// AVX-512 52-bit integer multiply-add
+            bool avx512ifma {false};
+        };
+
+        /// Vector instruction set levels, each one implying the previous ones.
+        /// Kernels are selected by level so that detection lives in one place.
+        enum class simd_level {
+            /// Portable code, no vector extension
+            scalar,
+            /// 128-bit vectors
+            sse2,
+            /// 256-bit vectors
+            avx2,
+            /// 512-bit vectors, with byte, word and 256-bit forms (F, BW and VL)
+            avx512
+        };
+
+        namespace details {
+
+#ifdef CPP11CRYPTO_X86_INTRINSICS
+            /// Reads an extended control register
+            /// @param index register to read
+            /// @return register contents
+            inline unsigned long long read_xcr(const unsigned index) noexcept {
+                unsigned eax, edx;
+                __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(index));
+                return (static_cast<unsigned long long>(edx) << 32) | eax;
+            }
+
+            /// Queries cpuid and the operating system saved state
+            /// @return detected features
+            inline cpu_features probe_cpu_features() noexcept {
+                cpu_features result;
+                unsigned eax, ebx, ecx, edx;
+                if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+                    return result;
+                }
+                result.sse2 = 0 != (edx & (1u << 26));
+                result.ssse3 = 0 != (ecx & (1u << 9));
+                result.sse41 = 0 != (ecx & (1u << 19));
+                result.pclmulqdq = 0 != (ecx & (1u << 1));
+                result.aes = 0 != (ecx & (1u << 25));
+
+                const bool osxsave = 0 != (ecx & (1u << 27));
+                const bool avx = 0 != (ecx & (1u << 28));
+                const unsigned long long xcr0 = osxsave ? read_xcr(0) : 0;
+                // XMM and YMM state
+                const bool os_avx = avx && 0x6 == (xcr0 & 0x6);
+                // opmask, ZMM_Hi256 and Hi16_ZMM state as well
+                const bool os_avx512 = os_avx && 0xe6 == (xcr0 & 0xe6);
+
+                if (__get_cpuid_max(0, nullptr) >= 7) {
+                    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+                    result.avx2 = os_avx && 0 != (ebx & (1u << 5));
+                    result.bmi2 = 0 != (ebx & (1u << 8));
+                    result.adx = 0 != (ebx & (1u << 19));
+                    result.sha = 0 != (ebx & (1u << 29));
+                    result.vaes = os_avx && 0 != (ecx & (1u << 9));
+                    result.vpclmulqdq = os_avx && 0 != (ecx & (1u << 10));
+                    result.avx512f = os_avx512 && 0 != (ebx & (1u << 16));
+                    result.avx512ifma = os_avx512 && 0 != (ebx & (1u << 21));
+                    result.avx512bw = os_avx512 && 0 != (ebx & (1u << 30));
+                    result.avx512vl = os_avx512 && 0 != (ebx & (1u << 31));
+                }
+                return result;
+            }
+#else
+            /// No detection possible, only portable code will be selected
+            /// @return empty feature set
+            inline cpu_features probe_cpu_features() noexcept {
+                return cpu_features {};
+            }
+#endif
+
+        }
+
+        /// Features of the running processor, probed once on first use
+        /// @return detected features
+        inline const cpu_features& cpu() noexcept {
+            static const cpu_features features = details::probe_cpu_features();
+            return features;
+        }
+
+        /// Tells whether a vector level can run on this processor
+        /// @param level level to check
+        /// @return true if usable
+        inline bool is_supported(const simd_level level) noexcept {
+            switch (level) {
+            case simd_level::scalar:
+                return true;
+            case simd_level::sse2:
+                return cpu().sse2;
+            case simd_level::avx2:
+                return cpu().avx2;
+            case simd_level::avx512:
+                return cpu().avx512f && cpu().avx512bw && cpu().avx512vl;
+            }
+            return false;
+        }
+
+        /// Widest vector level usable on this processor, selected once.
+        /// Kernels dispatch on it instead of querying individual features.
+        /// @return selected level
+        inline simd_level simd() noexcept {
+            static const simd_level level =
+                is_supported(simd_level::avx512) ? simd_level::avx512
+                : is_supported(simd_level::avx2) ? simd_level::avx2
+                : is_supported(simd_level::sse2) ? simd_level::sse2
+                : simd_level::scalar;
+            return level;
+        }
+
+        /// Width of the vectors of a level
+        /// @param level vector level
+        /// @return bytes per vector register, that of the widest integral type for scalar code
+        constexpr ::std::size_t lane_bytes(const simd_level level) noexcept {
+            return simd_level::avx512 == level ? 64
+                   : simd_level::avx2 == level ? 32
+                   : simd_level::sse2 == level ? 16
+                   : sizeof(unsigned long long);
+        }
+
+    }
+
+}
+
+#endif // CPP11CRYPTO_UTILS_CPU_FEATURES_HPP
@@ -0,0 +1,101 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// utils/endian.hpp - Unsigned words read from and written to bytes in a
+//                    given order, whatever the order of the processor
+
+#ifndef CPP11CRYPTO_UTILS_ENDIAN_HPP
+#define CPP11CRYPTO_UTILS_ENDIAN_HPP
+
+#include <cstdint>
+#include <type_traits>
+
+namespace cpp11crypto {
+    namespace utils {
+
+        /// Word from its bytes, least significant first; compilers turn the loop
+        /// into a single load
+        /// @param p first byte, with no alignment required
+        /// @return word read
+        template <typename Word>
+        inline Word load_le(const ::std::uint8_t * const p) noexcept {
+            static_assert(::std::is_unsigned<Word>::value,"Only unsigned words have a byte order here");
+            Word x = 0;
+            for (unsigned i = 0; i != sizeof(Word); ++i) {
+                x = static_cast<Word>(x | static_cast<Word>(p[i]) << 8*i);
+            }
+            return x;
+        }
+
+        /// Word from its bytes, most significant first
+        /// @param p first byte, with no alignment required
+        /// @return word read
+        template <typename Word>
+        inline Word load_be(const ::std::uint8_t * const p) noexcept {
+            static_assert(::std::is_unsigned<Word>::value,"Only unsigned words have a byte order here");
+            Word x = 0;
+            for (unsigned i = 0; i != sizeof(Word); ++i) {
+                x = static_cast<Word>(static_cast<Word>(x << 8) | p[i]);
+            }
+            return x;
+        }
+
+        /// Writes the bytes of a word, least significant first
+        /// @param p first byte, with no alignment required
+        /// @param x word to write
+        template <typename Word>
+        inline void store_le(::std::uint8_t * const p,const Word x) noexcept {
+            static_assert(::std::is_unsigned<Word>::value,"Only unsigned words have a byte order here");
+            for (unsigned i = 0; i != sizeof(Word); ++i) {
+                p[i] = static_cast<::std::uint8_t>(x >> 8*i);
+            }
+        }
+
+        /// Writes the bytes of a word, most significant first
+        /// @param p first byte, with no alignment required
+        /// @param x word to write
+        template <typename Word>
+        inline void store_be(::std::uint8_t * const p,const Word x) noexcept {
+            static_assert(::std::is_unsigned<Word>::value,"Only unsigned words have a byte order here");
+            for (unsigned i = 0; i != sizeof(Word); ++i) {
+                p[i] = static_cast<::std::uint8_t>(x >> 8*(sizeof(Word)-1-i));
+            }
+        }
+
+        /// Fixed width forms of the above, for the words the formats use
+        inline ::std::uint32_t load32le(const ::std::uint8_t * const p) noexcept {
+            return load_le<::std::uint32_t>(p);
+        }
+        inline void store32le(::std::uint8_t * const p,const ::std::uint32_t x) noexcept {
+            store_le(p,x);
+        }
+        inline void store64le(::std::uint8_t * const p,const ::std::uint64_t x) noexcept {
+            store_le(p,x);
+        }
+        inline ::std::uint64_t load64be(const ::std::uint8_t * const p) noexcept {
+            return load_be<::std::uint64_t>(p);
+        }
+        inline void store64be(::std::uint8_t * const p,const ::std::uint64_t x) noexcept {
+            store_be(p,x);
+        }
+
+    }
+}
+
+#endif // CPP11CRYPTO_UTILS_ENDIAN_HPP
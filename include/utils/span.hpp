@@ -0,0 +1,284 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// utils/span.hpp - Non-owning views over contiguous objects, carrying
+//                    the alignment of their first element in their type
+
+#ifndef CPP11CRYPTO_UTILS_SPAN_HPP
+#define CPP11CRYPTO_UTILS_SPAN_HPP
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "utils/aligned_as_integral.hpp"
+
+namespace cpp11crypto {
+    namespace core {
+        template <typename T, ::std::size_t N, ::std::size_t Align> class secure_array;
+    }
+
+    namespace utils {
+        namespace details {
+            /// Empty type with a given alignment, to reuse @ref aligned_as_integral on alignments
+            /// @tparam Align alignment
+            template <::std::size_t Align>
+            struct alignas(Align) alignment_tag {};
+        }
+
+        /// Tells whether an address is a multiple of an alignment
+        /// @tparam Align alignment, power of two
+        /// @param p address to check
+        /// @return true if aligned
+        template <::std::size_t Align>
+        bool is_aligned(const void * const p) noexcept {
+            return 0 == (reinterpret_cast<::std::uintptr_t>(p) & (Align-1));
+        }
+
+        template <typename T, ::std::size_t Align = alignof(T)> class span;
+        template <typename T, ::std::size_t Align = alignof(T)> class mutable_span;
+
+        /// Members shared by both views
+        /// @tparam T element type
+        /// @tparam Align guaranteed alignment of the first element
+        /// @tparam P pointer type held, to T or to const T
+        template <typename T, ::std::size_t Align, typename P>
+        class span_base {
+            static_assert(0 == (Align & (Align-1)) && Align >= alignof(T),
+                          "Alignment must be a power of two no weaker than that of T");
+        public:
+            /// value type trait
+            typedef T value_type;
+            /// size type trait
+            typedef ::std::size_t size_type;
+            /// Alignment of the first element, known at compile time
+            static constexpr ::std::size_t alignment = Align;
+            /// Widest integral type that every view of this type may be read as, from its start
+            using word_type = typename aligned_as_integral<details::alignment_tag<Align>>::type;
+
+            /// Number of elements
+            /// @return element count
+            size_type size() const noexcept {
+                return count;
+            }
+            /// Size in bytes
+            /// @return byte count
+            size_type size_bytes() const noexcept {
+                return count*sizeof(T);
+            }
+            /// Tells whether the view is empty
+            /// @return true if there are no elements
+            bool empty() const noexcept {
+                return 0 == count;
+            }
+            /// Access to the elements
+            /// @return pointer to the first element
+            P data() const noexcept {
+                return first;
+            }
+            /// @return iterator to the first element
+            P begin() const noexcept {
+                return first;
+            }
+            /// @return iterator past the last element
+            P end() const noexcept {
+                return first+count;
+            }
+            /// Unchecked element access
+            /// @param i index of the element
+            /// @return reference to the element
+            typename ::std::remove_pointer<P>::type& operator[](const size_type i) const noexcept {
+                assert(i < count);
+                return first[i];
+            }
+
+        protected:
+            span_base() noexcept = default;
+            span_base(const P p,const size_type n) noexcept : first {p}, count {n} {
+                assert(is_aligned<Align>(p));
+            }
+
+            P first {nullptr};
+            size_type count {0};
+        };
+
+        template <typename T, ::std::size_t Align, typename P>
+        constexpr ::std::size_t span_base<T,Align,P>::alignment;
+
+        /// Read-only view over contiguous objects of type T
+        /// @tparam T element type
+        /// @tparam Align guaranteed alignment of the first element
+        template <typename T, ::std::size_t Align>
+        class span : public span_base<T,Align,const T *> {
+            typedef span_base<T,Align,const T *> base;
+        public:
+            /// Empty view
+            span() noexcept = default;
+            /// View over raw memory, whose alignment is checked in debug builds
+            /// @param p first element
+            /// @param n number of elements
+            span(const T * const p,const ::std::size_t n) noexcept : base(p,n) {}
+            /// View over a vector, whatever its allocator
+            /// @param v vector to view
+            template <typename A>
+            span(const ::std::vector<T,A>& v) noexcept : base(v.data(),v.size()) {
+                static_assert(Align <= alignof(T),"Vectors only guarantee the alignment of T");
+            }
+            /// View over a standard array
+            /// @param a array to view
+            template <::std::size_t N>
+            span(const ::std::array<T,N>& a) noexcept : base(a.data(),N) {
+                static_assert(Align <= alignof(::std::array<T,N>),"Array alignment too weak");
+            }
+            /// View over a secure array whose storage alignment is stronger or equal
+            /// @param a array to view
+            template <::std::size_t N, ::std::size_t A2, typename = typename ::std::enable_if<(A2 >= Align)>::type>
+            span(const core::secure_array<T,N,A2>& a) noexcept : base(a.data(),N) {}
+            /// Conversion from a view with stronger or equal alignment
+            /// @param other view to convert
+            template <::std::size_t A2, typename = typename ::std::enable_if<(A2 >= Align)>::type>
+            span(const span<T,A2>& other) noexcept : base(other.data(),other.size()) {}
+            /// Conversion from a writable view with stronger or equal alignment
+            /// @param other view to convert
+            template <::std::size_t A2, typename = typename ::std::enable_if<(A2 >= Align)>::type>
+            span(const mutable_span<T,A2>& other) noexcept : base(other.data(),other.size()) {}
+
+            /// Leading part, which keeps the alignment
+            /// @param n number of elements
+            /// @return view over the first n elements
+            span first_elements(const ::std::size_t n) const noexcept {
+                assert(n <= this->count);
+                return span(this->first,n);
+            }
+            /// Any part, its alignment falls back to that of T
+            /// @param offset index of the first element
+            /// @param n number of elements
+            /// @return view over [offset,offset+n)
+            span<T> subspan(const ::std::size_t offset,const ::std::size_t n) const noexcept {
+                assert(offset+n <= this->count);
+                return span<T>(this->first+offset,n);
+            }
+            /// Same memory seen as bytes
+            /// @return byte view with the same alignment
+            span<::std::uint8_t,Align> as_bytes() const noexcept {
+                return span<::std::uint8_t,Align>(reinterpret_cast<const ::std::uint8_t *>(this->first),
+                                                  this->size_bytes());
+            }
+        };
+
+        /// Writable view over contiguous objects of type T
+        /// @tparam T element type
+        /// @tparam Align guaranteed alignment of the first element
+        template <typename T, ::std::size_t Align>
+        class mutable_span : public span_base<T,Align,T *> {
+            typedef span_base<T,Align,T *> base;
+        public:
+            /// Empty view
+            mutable_span() noexcept = default;
+            /// View over raw memory, whose alignment is checked in debug builds
+            /// @param p first element
+            /// @param n number of elements
+            mutable_span(T * const p,const ::std::size_t n) noexcept : base(p,n) {}
+            /// View over a vector, whatever its allocator
+            /// @param v vector to view
+            template <typename A>
+            mutable_span(::std::vector<T,A>& v) noexcept : base(v.data(),v.size()) {
+                static_assert(Align <= alignof(T),"Vectors only guarantee the alignment of T");
+            }
+            /// View over a standard array
+            /// @param a array to view
+            template <::std::size_t N>
+            mutable_span(::std::array<T,N>& a) noexcept : base(a.data(),N) {
+                static_assert(Align <= alignof(::std::array<T,N>),"Array alignment too weak");
+            }
+            /// View over a secure array whose storage alignment is stronger or equal
+            /// @param a array to view
+            template <::std::size_t N, ::std::size_t A2, typename = typename ::std::enable_if<(A2 >= Align)>::type>
+            mutable_span(core::secure_array<T,N,A2>& a) noexcept : base(a.data(),N) {}
+            /// Conversion from a view with stronger or equal alignment
+            /// @param other view to convert
+            template <::std::size_t A2, typename = typename ::std::enable_if<(A2 >= Align)>::type>
+            mutable_span(const mutable_span<T,A2>& other) noexcept : base(other.data(),other.size()) {}
+
+            /// Leading part, which keeps the alignment
+            /// @param n number of elements
+            /// @return view over the first n elements
+            mutable_span first_elements(const ::std::size_t n) const noexcept {
+                assert(n <= this->count);
+                return mutable_span(this->first,n);
+            }
+            /// Any part, its alignment falls back to that of T
+            /// @param offset index of the first element
+            /// @param n number of elements
+            /// @return view over [offset,offset+n)
+            mutable_span<T> subspan(const ::std::size_t offset,const ::std::size_t n) const noexcept {
+                assert(offset+n <= this->count);
+                return mutable_span<T>(this->first+offset,n);
+            }
+            /// Same memory seen as bytes
+            /// @return byte view with the same alignment
+            mutable_span<::std::uint8_t,Align> as_bytes() const noexcept {
+                return mutable_span<::std::uint8_t,Align>(reinterpret_cast<::std::uint8_t *>(this->first),
+                        this->size_bytes());
+            }
+        };
+
+        /// Raises the alignment carried by a view, after checking it in debug builds
+        /// @tparam A new alignment
+        /// @param s view to convert
+        /// @return same view with alignment A
+        template <::std::size_t A, typename T, ::std::size_t Align>
+        span<T,A> assume_aligned(const span<T,Align>& s) noexcept {
+            return span<T,A>(s.data(),s.size());
+        }
+
+        /// Raises the alignment carried by a view, after checking it in debug builds
+        /// @tparam A new alignment
+        /// @param s view to convert
+        /// @return same view with alignment A
+        template <::std::size_t A, typename T, ::std::size_t Align>
+        mutable_span<T,A> assume_aligned(const mutable_span<T,Align>& s) noexcept {
+            return mutable_span<T,A>(s.data(),s.size());
+        }
+
+        /// Read-only view over raw memory
+        /// @param p first element
+        /// @param n number of elements
+        /// @return view
+        template <typename T>
+        span<T> make_span(const T * const p,const ::std::size_t n) noexcept {
+            return span<T>(p,n);
+        }
+
+        /// Writable view over raw memory
+        /// @param p first element
+        /// @param n number of elements
+        /// @return view
+        template <typename T>
+        mutable_span<T> make_mutable_span(T * const p,const ::std::size_t n) noexcept {
+            return mutable_span<T>(p,n);
+        }
+
+    }
+
+}
+
+#endif // CPP11CRYPTO_UTILS_SPAN_HPP
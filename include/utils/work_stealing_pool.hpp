@@ -0,0 +1,323 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// utils/work_stealing_pool.hpp - Persistent threads running the chunks of a
+//                    job, idle ones stealing from the busy ones
+
+#ifndef CPP11CRYPTO_UTILS_WORK_STEALING_POOL_HPP
+#define CPP11CRYPTO_UTILS_WORK_STEALING_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "utils/aligned_as_vector.hpp"
+
+namespace cpp11crypto {
+    namespace utils {
+
+        /// Pool of threads running jobs made of independent chunks, numbered from 0.
+        /// Each participant, the calling thread included, starts with a contiguous
+        /// range of chunks and takes them from its front; once it is empty it steals
+        /// the back half of the range of another participant. Ranges are single
+        /// atomic words, so taking and stealing are lock free; locks are only taken
+        /// to start and finish a job. Jobs run one at a time, whatever the number of
+        /// threads submitting them; a job submitted from one of the pool's own tasks
+        /// runs at once on the thread of that task, as the pool is busy with the
+        /// outer job.
+        class work_stealing_pool {
+        public:
+            /// Constructor, starts the threads
+            /// @param threads participants in each job, the calling thread included,
+            ///                0 for one per core
+            /// @throw std::system_error if a thread cannot be started
+            explicit work_stealing_pool(const unsigned threads = 0)
+                : participants {::std::max(1u,0 != threads ? threads : ::std::thread::hardware_concurrency())},
+                  slot_storage {new unsigned char[(participants+1)*sizeof(slot)]},
+                  slots {place_slots(slot_storage.get(),participants)} {
+                workers.reserve(participants-1);
+                try {
+                    for (unsigned i = 1; i != participants; ++i) {
+                        workers.emplace_back([this,i]() {
+                            work(i);
+                        });
+                    }
+                } catch (...) {
+                    stop();
+                    throw;
+                }
+            }
+            work_stealing_pool(const work_stealing_pool&) = delete;
+            work_stealing_pool& operator=(const work_stealing_pool&) = delete;
+
+            /// Destructor, waits for the threads to finish
+            ~work_stealing_pool() {
+                stop();
+            }
+
+            /// @return participants in each job, the calling thread included
+            unsigned size() const noexcept {
+                return participants;
+            }
+
+            /// Runs task(i) for every chunk i in [0,chunks), returning once all are done.
+            /// Called from a task of this pool, runs them in order on the calling thread.
+            /// @param chunks number of chunks, below 2^32
+            /// @param task callable on a chunk number, from any thread at once
+            /// @throw std::invalid_argument if there are too many chunks
+            /// @throw whatever a task throws, the first one, once no task runs; chunks
+            ///        not started by then are skipped
+            template <typename Task>
+            void run(const ::std::size_t chunks,const Task& task) {
+                execute(chunks,[](const void * const context,const ::std::size_t chunk) {
+                    (*static_cast<const Task *>(context))(chunk);
+                },&task);
+            }
+
+        private:
+            typedef void (*job_function)(const void *,::std::size_t);
+
+            /// Range [begin,end) of chunks, as begin in the low half and end in the high
+            /// one, alone on its cache line
+            struct alignas(cache_line_size) slot {
+                ::std::atomic<::std::uint64_t> range {0};
+            };
+
+            /// Pool whose tasks a thread is running, one per pool it runs tasks of,
+            /// innermost first
+            struct participation {
+                const work_stealing_pool * pool;
+                const participation * outer;
+            };
+
+            /// @return innermost participation of the calling thread, null if none
+            static const participation *& current() noexcept {
+                static thread_local const participation * innermost = nullptr;
+                return innermost;
+            }
+
+            /// Marks the calling thread as running tasks of a pool for its lifetime
+            class participating {
+            public:
+                explicit participating(const work_stealing_pool * const pool) noexcept
+                    : self {pool,current()} {
+                    current() = &self;
+                }
+                participating(const participating&) = delete;
+                participating& operator=(const participating&) = delete;
+                ~participating() {
+                    current() = self.outer;
+                }
+            private:
+                participation self;
+            };
+
+            /// @return whether the calling thread is running a task of this pool
+            bool inside() const noexcept {
+                for (const participation * p = current(); nullptr != p; p = p->outer) {
+                    if (this == p->pool) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            /// Slots built on cache line boundaries of storage one slot larger than
+            /// needed; operator new only aligns that far from C++17 on
+            static slot * place_slots(unsigned char * const storage,const unsigned count) noexcept {
+                void * first = storage;
+                ::std::size_t space = (count+1)*sizeof(slot);
+                ::std::align(alignof(slot),count*sizeof(slot),first,space);
+                slot * const slots = static_cast<slot *>(first);
+                for (unsigned i = 0; i != count; ++i) {
+                    new (slots+i) slot;
+                }
+                return slots;
+            }
+
+            static ::std::uint64_t pack(const ::std::uint64_t begin,const ::std::uint64_t end) noexcept {
+                return end << 32 | begin;
+            }
+            static ::std::size_t begin(const ::std::uint64_t range) noexcept {
+                return static_cast<::std::size_t>(range & 0xffffffffULL);
+            }
+            static ::std::size_t end(const ::std::uint64_t range) noexcept {
+                return static_cast<::std::size_t>(range >> 32);
+            }
+
+            void execute(const ::std::size_t chunks,const job_function function,const void * const context) {
+                if (chunks > 0xffffffffULL) {
+                    throw ::std::invalid_argument("Too many chunks for one job");
+                }
+                // the outer job holds the pool, and waits for this task
+                if (inside()) {
+                    for (::std::size_t chunk = 0; chunk != chunks; ++chunk) {
+                        function(context,chunk);
+                    }
+                    return;
+                }
+                ::std::lock_guard<::std::mutex> serial(submission);
+                if (0 == chunks) {
+                    return;
+                }
+                const ::std::size_t n = participants;
+                for (::std::size_t i = 0; i != n; ++i) {
+                    slots[i].range.store(pack(chunks*i/n,chunks*(i+1)/n),::std::memory_order_relaxed);
+                }
+                {
+                    ::std::lock_guard<::std::mutex> guard(lock);
+                    job = function;
+                    job_context = context;
+                    failed.store(false,::std::memory_order_relaxed);
+                    finished = 0;
+                    ++generation;
+                }
+                wake.notify_all();
+                drain(0);
+                ::std::exception_ptr error;
+                {
+                    ::std::unique_lock<::std::mutex> guard(lock);
+                    done.wait(guard,[this]() {
+                        return workers.size() == finished;
+                    });
+                    ::std::swap(error,failure);
+                }
+                if (error) {
+                    ::std::rethrow_exception(error);
+                }
+            }
+
+            /// Takes the first chunk of the own range
+            bool take(const ::std::size_t self,::std::size_t& chunk) noexcept {
+                ::std::atomic<::std::uint64_t>& range = slots[self].range;
+                ::std::uint64_t r = range.load(::std::memory_order_relaxed);
+                while (begin(r) < end(r)) {
+                    if (range.compare_exchange_weak(r,pack(begin(r)+1,end(r)),::std::memory_order_relaxed)) {
+                        chunk = begin(r);
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            /// Steals the back half of the range of another participant, running its
+            /// first chunk and keeping the rest as the own range, which is empty
+            bool steal(const ::std::size_t self,::std::size_t& chunk) noexcept {
+                const ::std::size_t n = participants;
+                for (::std::size_t k = 1; k != n; ++k) {
+                    ::std::atomic<::std::uint64_t>& victim = slots[(self+k)%n].range;
+                    ::std::uint64_t r = victim.load(::std::memory_order_relaxed);
+                    while (begin(r) < end(r)) {
+                        const ::std::uint64_t middle = begin(r)+(end(r)-begin(r))/2;
+                        if (victim.compare_exchange_weak(r,pack(begin(r),middle),::std::memory_order_relaxed)) {
+                            chunk = static_cast<::std::size_t>(middle);
+                            slots[self].range.store(pack(middle+1,end(r)),::std::memory_order_relaxed);
+                            return true;
+                        }
+                    }
+                }
+                return false;
+            }
+
+            void drain(const ::std::size_t self) {
+                const participating marked {this};
+                ::std::size_t chunk;
+                while (!failed.load(::std::memory_order_relaxed) && (take(self,chunk) || steal(self,chunk))) {
+                    try {
+                        job(job_context,chunk);
+                    } catch (...) {
+                        ::std::lock_guard<::std::mutex> guard(lock);
+                        if (!failed.exchange(true)) {
+                            failure = ::std::current_exception();
+                        }
+                    }
+                }
+            }
+
+            void work(const ::std::size_t self) {
+                unsigned long long seen = 0;
+                for (;;) {
+                    {
+                        ::std::unique_lock<::std::mutex> guard(lock);
+                        wake.wait(guard,[this,seen]() {
+                            return stopping || seen != generation;
+                        });
+                        if (stopping) {
+                            return;
+                        }
+                        seen = generation;
+                    }
+                    drain(self);
+                    {
+                        ::std::lock_guard<::std::mutex> guard(lock);
+                        ++finished;
+                    }
+                    done.notify_one();
+                }
+            }
+
+            void stop() noexcept {
+                {
+                    ::std::lock_guard<::std::mutex> guard(lock);
+                    stopping = true;
+                }
+                wake.notify_all();
+                for (::std::thread& worker : workers) {
+                    worker.join();
+                }
+            }
+
+            const unsigned participants;
+            ::std::unique_ptr<unsigned char[]> slot_storage;
+            slot * const slots;
+            ::std::vector<::std::thread> workers;
+            /// Serializes jobs
+            ::std::mutex submission;
+            /// Guards what follows, but for failed
+            ::std::mutex lock;
+            ::std::condition_variable wake, done;
+            job_function job {nullptr};
+            const void * job_context {nullptr};
+            unsigned long long generation {0};
+            ::std::size_t finished {0};
+            bool stopping {false};
+            ::std::atomic<bool> failed {false};
+            ::std::exception_ptr failure;
+        };
+
+        /// Pool with one thread per core, started on first use and shared by the
+        /// whole program
+        /// @return shared pool
+        inline work_stealing_pool& shared_pool() {
+            static work_stealing_pool pool;
+            return pool;
+        }
+
+    }
+}
+
+#endif // CPP11CRYPTO_UTILS_WORK_STEALING_POOL_HPP
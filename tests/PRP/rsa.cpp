@@ -0,0 +1,127 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License with Cpp11crypto.
+   If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// tests/PRP/rsa.cpp - Tests PRP/rsa.hpp
+
+#include "PRP/rsa.hpp"
+#include "../utils/test_uint.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <fastformat/fastformat.hpp>
+
+namespace cpp11crypto {
+    namespace tests {
+
+        namespace {
+            // key and signature from an independent implementation
+            const arith::uint<512> p = from_hex<512>(
+                                           "cd0722b91b6c45527317fbe916a36f56b88a8e1c16c1bcdf75edc4aeafcd4bd9"
+                                           "880662c31a19d28a802afcb1abd035b5a365c0d9a9bf57ef3fb91f8f359192a1");
+            const arith::uint<512> q = from_hex<512>(
+                                           "c180e9ce5863db20f0bfc63510ea5b8841bb5d68416b780febfeec1b0a38ba22"
+                                           "b5c8a05fbe551611f91bdb016fe02e1e59fcd32da90abf30303781ccf4f1b437");
+            const arith::uint<1024> n = from_hex<1024>(
+                                            "9af99fffab5d2e80f9a23fecca2bcdc2dee58082386b97fd6015d20b5ca3b034c305ef1491d3368062198501259c26e5"
+                                            "8f8b11534bc8d7a918d9dcfbd075278d33743f7897a0f0282a11eff344d567d36b3277e4eb0e891d361e5d889579d077"
+                                            "cbd47cf97a24edb4bac2e408de697e08a6701e1e301f47a1cb51a0875af0b497");
+            const arith::uint<1024> message = from_hex<1024>(
+                                                  "000000e70bb2c7d55bd6f42f1ed50ddd4458b3a39cba82eb09d9b3124dbd939b3966471b4c82ff0b979bbef10136f2f4"
+                                                  "8fb02deae98057ba4d6a4cde9b46da5ece498dc74f25e3e289e84499d819e7d1100c8ce13990bd4d372259d22943fa3b"
+                                                  "c4d6f946c2907314c99094d13e1a1c50507eb4d5246a2076b36bb3b5987cf119");
+            const arith::uint<1024> signature = from_hex<1024>(
+                                                    "886df77b7f37e6a6eebe739823841be9b7a726194ca99884f87e31e3496e500f273593f93ae449b790bd55f44bd8f74a"
+                                                    "7036230d9049fe456a99555d013afc617c174a02b3694c825eed62a7860991d38936089ff32fd707dcb94f7ca6fce78e"
+                                                    "280e2a19e73c1fe477c8c4c50eee1e808900d6a26a8698bb4554eac5d2b03992");
+        }
+
+        BOOST_AUTO_TEST_CASE (rsa_known_signature) {
+            fastformat::fmtln(std::cout,"{0}","RSA known signature test starts...");
+            boost::random::mt19937_64 generator {1};
+            PRP::rsa_private_key<1024> key {p,q,65537,generator};
+            BOOST_CHECK( key.public_key().modulus() == n );
+            // every operation runs with a blinding pair squared from the previous one
+            for (int i = 0; i != 10; ++i) {
+                BOOST_CHECK( key.sign(message) == signature );
+            }
+            BOOST_CHECK( key.public_key().verify(signature,message) );
+            BOOST_CHECK( key.public_key().encrypt(signature) == message );
+            BOOST_CHECK( !key.public_key().verify(signature,message+arith::uint<1024> {1}) );
+            key.reblind(generator);
+            BOOST_CHECK( key.decrypt(key.public_key().encrypt(message)) == message );
+            BOOST_CHECK_THROW( key.decrypt(n), std::domain_error );
+            // also when q is above p
+            PRP::rsa_private_key<1024> swapped {q,p,65537,generator};
+            BOOST_CHECK( swapped.sign(message) == signature );
+        }
+
+        BOOST_AUTO_TEST_CASE (rsa_invalid_keys) {
+            fastformat::fmtln(std::cout,"{0}","RSA invalid key test starts...");
+            boost::random::mt19937_64 generator {2};
+            typedef PRP::rsa_private_key<1024> key;
+            BOOST_CHECK_THROW( key(p,p,65537,generator), std::invalid_argument );
+            BOOST_CHECK_THROW( key(p,q,65536,generator), std::invalid_argument );
+            BOOST_CHECK_THROW( key(p,q,1,generator), std::invalid_argument );
+            // q-1 is a multiple of 3
+            BOOST_CHECK_THROW( key(p,q,3,generator), std::invalid_argument );
+            BOOST_CHECK_THROW( PRP::rsa_public_key<1024>(n+arith::uint<1024> {1}), std::invalid_argument );
+        }
+
+        BOOST_AUTO_TEST_CASE (rsa_batch_verification) {
+            fastformat::fmtln(std::cout,"{0}","RSA batch verification test starts...");
+            boost::random::mt19937_64 generator {3};
+            PRP::rsa_private_key<1024> key {p,q,65537,generator};
+            const std::size_t count = 150;
+            std::vector<arith::uint<1024>> messages, signatures;
+            for (std::size_t i = 0; i != count; ++i) {
+                arith::uint<1024> m;
+                for (std::size_t j = 0; j != 15; ++j) {
+                    m.limb(j) = generator();
+                }
+                messages.push_back(m);
+                signatures.push_back(key.sign(m));
+            }
+            signatures[7] = signatures[7]+arith::uint<1024> {1};
+            messages[77] = messages[78];
+            signatures[140] = signatures[140]+n;
+            std::unique_ptr<bool[]> valid {new bool[count]};
+            BOOST_CHECK( PRP::verify_batch(key.public_key(),signatures.data(),messages.data(),valid.get(),count) == count-3 );
+            for (std::size_t i = 0; i != count; ++i) {
+                BOOST_CHECK( valid[i] == (i != 7 && i != 77 && i != 140) );
+                BOOST_CHECK( valid[i] == key.public_key().verify(signatures[i],messages[i]) );
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (rsa_generated_keys) {
+            fastformat::fmtln(std::cout,"{0}","RSA key generation test starts...");
+            boost::random::mt19937_64 generator {4};
+            std::unique_ptr<PRP::rsa_private_key<512>> key {new PRP::rsa_private_key<512>(PRP::generate_rsa_key<512>(generator))};
+            BOOST_CHECK( key->public_key().modulus().bit(511) );
+            const arith::uint<512> m {0x0123456789abcdefULL};
+            BOOST_CHECK( key->public_key().encrypt(key->sign(m)) == m );
+            const PRP::rsa_private_key<512> small = PRP::generate_rsa_key<512>(generator,3,arith::prime_options {2});
+            BOOST_CHECK( small.public_key().exponent() == 3 );
+        }
+
+    }
+}
@@ -0,0 +1,81 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License with Cpp11crypto.
+   If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// tests/arith/algorithms/batch_inverse.cpp - Tests arith/algorithms/batch_inverse.hpp
+
+#include "arith/algorithms/batch_inverse.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include <fastformat/fastformat.hpp>
+
+namespace cpp11crypto {
+    namespace tests {
+
+        BOOST_AUTO_TEST_CASE (batch_inverse_test) {
+            fastformat::fmtln(std::cout,"{0}","Batch inverse test starts...");
+            using secure_vector = std::vector<std::uint64_t,core::allocator<std::uint64_t>>;
+            const std::uint64_t p = ~std::uint64_t {0}-58;
+            boost::random::mt19937_64 generator {10};
+
+            for (const std::size_t n : {
+                        std::size_t {1},std::size_t {2},std::size_t {7},std::size_t {1000}
+                    }) {
+                secure_vector values(n);
+                for (auto& x : values) {
+                    x = generator() % p;
+                }
+                values[n/2] = 0;
+                secure_vector expected(n);
+                for (std::size_t i = 0; i != n; ++i) {
+                    expected[i] = arith::algorithms::safegcd::inverse(values[i],p);
+                }
+
+                secure_vector separate(n);
+                arith::algorithms::batch_inverse(values.begin(),values.end(),p,separate.begin());
+                BOOST_CHECK( expected == separate );
+
+                for (const unsigned threads : {2u,3u,16u}) {
+                    secure_vector in_place {values};
+                    arith::algorithms::batch_inverse(in_place.begin(),in_place.end(),p,in_place.begin(),threads);
+                    BOOST_CHECK( expected == in_place );
+                }
+            }
+
+            // smaller words, through an explicit field
+            const std::uint32_t small[] = {1,2,3,0,100};
+            std::uint32_t inverses[5];
+            arith::algorithms::batch_inverse(small,small+5,inverses,arith::algorithms::word_field<std::uint32_t> {101});
+            BOOST_CHECK( 1 == inverses[0] && 51 == inverses[1] && 34 == inverses[2] && 0 == inverses[3] && 100 == inverses[4] );
+
+            // a composite modulus: 3 has no inverse modulo 15, 7 has one
+            const std::uint32_t shared[] = {7,3,0,2};
+            BOOST_CHECK_THROW(arith::algorithms::batch_inverse(shared,shared+4,std::uint32_t {15},inverses),std::invalid_argument);
+            BOOST_CHECK_THROW(arith::algorithms::batch_inverse(shared,shared+4,std::uint32_t {15},inverses,2),std::invalid_argument);
+            arith::algorithms::batch_inverse(shared,shared+1,std::uint32_t {15},inverses);
+            BOOST_CHECK( 13 == inverses[0] );
+            BOOST_CHECK_THROW(arith::algorithms::word_field<std::uint32_t> {16},std::invalid_argument);
+        }
+
+    }
+
+}
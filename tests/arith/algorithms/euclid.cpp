@@ -31,6 +31,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <string>
+#include <type_traits>
 #include <array>
 #include <memory>
 #include <numeric>
@@ -51,6 +52,7 @@ namespace cpp11crypto {
             }
 
             std::array<unsigned char,arith::algorithms::euclid::gcd(A,B)> arr_gcd;
+            std::array<unsigned char,arith::algorithms::euclid::gcd(A,B,arith::algorithms::euclid::binary_tag {})> arr_binary_gcd;
         };
 
 
@@ -77,13 +79,63 @@ namespace cpp11crypto {
             const auto ers=arith::algorithms::euclid::extended_gcd(a,b);
 
             fastformat::fmtln(std::cout,"GCD on RT gives {0}",rs);
-            BOOST_CHECK( rs == T().arr_gcd.size() );
+            typedef typename std::remove_const<decltype(rs)>::type result_type;
+            BOOST_CHECK( rs == static_cast<result_type>(T().arr_gcd.size()) );
+            BOOST_CHECK( rs == static_cast<result_type>(T().arr_binary_gcd.size()) );
+            BOOST_CHECK( rs == arith::algorithms::euclid::gcd(a,b,arith::algorithms::euclid::lehmer_tag {}) );
+            const auto lrs=arith::algorithms::euclid::extended_gcd(a,b,arith::algorithms::euclid::lehmer_tag {});
+            BOOST_CHECK( (rs == a*std::get<0>(lrs)+b*std::get<1>(lrs)) );
             fastformat::fmtln(std::cout,"(E)GCD on RT gives {0},{1}",std::get<0>(ers),std::get<1>(ers));
             BOOST_CHECK( (rs == a*std::get<0>(ers)+b*std::get<1>(ers)) );
 
             fastformat::fmtln(std::cout,"GCD test on {0} complete.", libcwd::type_info_of<T>().demangled_name());
         }
 
+
+        namespace {
+            template <typename T>
+            T random_operand(boost::random::mt19937_64& generator) {
+                return static_cast<T>(generator());
+            }
+
+#ifdef CPP11CRYPTO_HAS_UINT128
+            template <>
+            utils::uint128_t random_operand<utils::uint128_t>(boost::random::mt19937_64& generator) {
+                const utils::uint128_t high = generator();
+                return (high << 64) | generator();
+            }
+#endif
+        }
+
+        using engine_list = boost::mpl::list<
+                            std::uint32_t,std::uint64_t
+#ifdef CPP11CRYPTO_HAS_UINT128
+                            ,utils::uint128_t
+#endif
+                            >;
+
+        BOOST_AUTO_TEST_CASE_TEMPLATE (gcd_engines_test, T, engine_list ) {
+            namespace euclid = arith::algorithms::euclid;
+            fastformat::fmtln(std::cout,"GCD engines test on {0} bits starts...",8*sizeof(T));
+            boost::random::mt19937_64 generator {sizeof(T)};
+            for (int i = 0; i != 2000; ++i) {
+                // a shared factor, so that gcds are not all trivial
+                const T factor = 1+(generator() % 1000);
+                const T a = random_operand<T>(generator) / factor * factor;
+                const T b = random_operand<T>(generator) / factor * factor;
+                const T g = euclid::gcd(a,b,euclid::recursive_tag {});
+                BOOST_REQUIRE( g == euclid::gcd(a,b,euclid::binary_tag {}) );
+                BOOST_REQUIRE( g == euclid::gcd(a,b,euclid::lehmer_tag {}) );
+                const std::tuple<T,T> classic = euclid::extended_gcd(a,b);
+                const std::tuple<T,T> lehmer = euclid::extended_gcd(a,b,euclid::lehmer_tag {});
+                BOOST_REQUIRE( g == a*std::get<0>(lehmer)+b*std::get<1>(lehmer) );
+                BOOST_REQUIRE( classic == lehmer );
+            }
+            BOOST_CHECK( 5 == euclid::gcd(T {0},T {5},euclid::binary_tag {}) );
+            BOOST_CHECK( 5 == euclid::gcd(T {5},T {0},euclid::lehmer_tag {}) );
+            fastformat::fmtln(std::cout,"GCD engines test on {0} bits complete.",8*sizeof(T));
+        }
+
     }
 
 }
@@ -0,0 +1,104 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License with Cpp11crypto.
+   If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// tests/arith/algorithms/safegcd.cpp - Tests arith/algorithms/safegcd.hpp
+
+#include "arith/algorithms/safegcd.hpp"
+#include "arith/algorithms/euclid.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <array>
+#include <cstdint>
+#include <fastformat/fastformat.hpp>
+
+namespace cpp11crypto {
+    namespace tests {
+
+        namespace {
+            namespace safegcd = arith::algorithms::safegcd;
+
+            using u256 = std::array<std::uint64_t,4>;
+            using u512 = std::array<std::uint64_t,8>;
+
+            /// P-256 field prime
+            const u256 p256 {{0xffffffffffffffffULL,0x00000000ffffffffULL,0x0000000000000000ULL,0xffffffff00000001ULL}};
+            /// 2^512-569, prime
+            const u512 p512 {{0xfffffffffffffdc7ULL,0xffffffffffffffffULL,0xffffffffffffffffULL,0xffffffffffffffffULL,
+                              0xffffffffffffffffULL,0xffffffffffffffffULL,0xffffffffffffffffULL,0xffffffffffffffffULL}};
+        }
+
+        BOOST_AUTO_TEST_CASE (safegcd_word_inverse) {
+            fastformat::fmtln(std::cout,"{0}","Safegcd word inverse test starts...");
+            boost::random::mt19937_64 generator {9};
+            for (int i = 0; i != 5000; ++i) {
+                const std::uint64_t m = generator() | 1;
+                const std::uint64_t x = generator() % m;
+                const std::uint64_t inverse = safegcd::inverse(x,m);
+                if (1 == arith::algorithms::euclid::gcd(x,m,arith::algorithms::euclid::binary_tag {})) {
+                    BOOST_REQUIRE( 1 == static_cast<utils::uint128_t>(x)*inverse % m );
+                    BOOST_REQUIRE( inverse < m );
+                } else {
+                    BOOST_REQUIRE( 0 == inverse );
+                }
+            }
+            BOOST_CHECK( 0 == safegcd::inverse(std::uint32_t {0},std::uint32_t {101}) );
+            BOOST_CHECK( 1 == safegcd::inverse(std::uint32_t {1},std::uint32_t {101}) );
+            BOOST_CHECK( 51 == safegcd::inverse(std::uint32_t {2},std::uint32_t {101}) );
+            BOOST_CHECK( 0 == safegcd::inverse(std::uint16_t {21},std::uint16_t {35}) );
+            BOOST_CHECK( (~std::uint64_t {0}-59) == safegcd::inverse(~std::uint64_t {0}-59,~std::uint64_t {0}-58) );
+        }
+
+        BOOST_AUTO_TEST_CASE (safegcd_multi_word_inverse) {
+            fastformat::fmtln(std::cout,"{0}","Safegcd multi-word inverse test starts...");
+            // expected values from an independent implementation
+            const u256 x1 {{0x9cfbac6e7687a66fULL,0x4462ebfc5f915ef0ULL,0x2fa73207237751aaULL,0xad38835eddd6ff55ULL}};
+            const u256 y1 {{0x5e1604ae0186ecdcULL,0xac07c952b10bc456ULL,0x09c7fa9bdaa834a1ULL,0xb47209f4f89aae1fULL}};
+            const u256 x2 {{0x569c803601a5ba51ULL,0x76b6745180b65386ULL,0x9acd8acde5f6db1dULL,0x558298e214b044d7ULL}};
+            const u256 y2 {{0x4877bdc3302945ecULL,0x1655d9570f539605ULL,0xdb045fd11dc5c37aULL,0x4d0203d87b7cf724ULL}};
+            const safegcd::inverter<4> p256_inverter {p256};
+            BOOST_CHECK( y1 == p256_inverter(x1) );
+            BOOST_CHECK( y2 == p256_inverter(x2) );
+            BOOST_CHECK( x1 == p256_inverter(y1) );
+            BOOST_CHECK( (u256 {{1,0,0,0}}) == p256_inverter(u256 {{1,0,0,0}}) );
+            BOOST_CHECK( (u256 {{0,0,0,0}}) == p256_inverter(u256 {{0,0,0,0}}) );
+            u256 minus_one = p256;
+            minus_one[0] -= 1;
+            BOOST_CHECK( minus_one == p256_inverter(minus_one) );
+
+            const u512 x3 {{0xefb6fbfe8de4ab48ULL,0xb339a4769ddcc6f8ULL,0xba6ace6c0a78250fULL,0x2b5ebaa061076dc3ULL,
+                            0xf23b2cc4b4174a67ULL,0xf386825473b7a490ULL,0x6c2ea417b99de255ULL,0x2b1e1885283b73a6ULL}};
+            const u512 y3 {{0x2ce9cb2e8d110cb4ULL,0x961f167123ece152ULL,0x76f8279dd6e62fe1ULL,0x9410a3d246f06375ULL,
+                            0x2c5b9c182247767cULL,0xf075108564985f42ULL,0xcd8b61690bf9f78aULL,0x059c7d946dcbd2efULL}};
+            const u512 x4 {{0x0d243a163cee5e2dULL,0x21e6a46f1c670ea9ULL,0xdf2965b3819ad93bULL,0xfdb119a9ec801bdfULL,
+                            0x10363c5f972651daULL,0xb03da701c632976aULL,0xca22e4c76237dbe6ULL,0xe323bb2abf00188dULL}};
+            const u512 y4 {{0x1883477b52a79549ULL,0x1808fe44c620bceeULL,0xb00a01302e09d9f2ULL,0xbd32db06b530b0b6ULL,
+                            0x9195e7efaeea00a5ULL,0xacf94638d75c1d3dULL,0x275f01bf7771384eULL,0x1faec6a582c5f81cULL}};
+            BOOST_CHECK( y3 == safegcd::inverse(x3,p512) );
+            BOOST_CHECK( y4 == safegcd::inverse(x4,p512) );
+
+            // a composite modulus: 2^256-1 is a multiple of 3, not of 7
+            const u256 composite {{~0ULL,~0ULL,~0ULL,~0ULL}};
+            BOOST_CHECK( (u256 {{0,0,0,0}}) == safegcd::inverse(u256 {{6,0,0,0}},composite) );
+            BOOST_CHECK( (u256 {{0,0,0,0}}) != safegcd::inverse(u256 {{7,0,0,0}},composite) );
+        }
+
+    }
+
+}
@@ -0,0 +1,76 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License with Cpp11crypto.
+   If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// tests/arith/barrett.cpp - Tests arith/barrett.hpp
+
+#include "arith/barrett.hpp"
+#include "arith/context_cache.hpp"
+#include "../utils/test_uint.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <cstdint>
+#include <stdexcept>
+#include <fastformat/fastformat.hpp>
+
+namespace cpp11crypto {
+    namespace tests {
+
+        namespace {
+            template <std::size_t Bits>
+            void check_reductions(boost::random::mt19937_64& generator,const int rounds) {
+                for (int i = 0; i != rounds; ++i) {
+                    // any length, even or odd
+                    arith::uint<Bits> n = random_uint<Bits>(generator) >> (generator() % (Bits-1));
+                    n |= arith::uint<Bits> {2};
+                    const arith::barrett_context<Bits> context {n};
+                    const arith::uint<Bits> a = random_uint<Bits>(generator) % n;
+                    const arith::uint<Bits> b = (i % 4 == 0 ? n-1 : random_uint<Bits>(generator) % n);
+                    const arith::uint<2*Bits> product = wide_multiply(a,b);
+                    BOOST_REQUIRE( context.multiply(a,b) == arith::uint<Bits>(product % arith::uint<2*Bits>(n)) );
+                    BOOST_REQUIRE( context.square(b) == arith::uint<Bits>(wide_multiply(b,b) % arith::uint<2*Bits>(n)) );
+                    BOOST_REQUIRE( context.subtract(context.add(a,b),b) == a );
+                }
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (barrett_reductions) {
+            fastformat::fmtln(std::cout,"{0}","Barrett reduction test starts...");
+            boost::random::mt19937_64 generator {22};
+            check_reductions<64>(generator,2000);
+            check_reductions<384>(generator,500);
+            check_reductions<2048>(generator,20);
+            BOOST_CHECK_THROW( arith::barrett_context<256> {arith::uint<256> {1}}, std::invalid_argument );
+            BOOST_CHECK_THROW( arith::barrett_context<256> {arith::uint<256> {}}, std::invalid_argument );
+        }
+
+        BOOST_AUTO_TEST_CASE (barrett_power) {
+            fastformat::fmtln(std::cout,"{0}","Barrett exponentiation test starts...");
+            // expected values from an independent implementation, even modulus
+            const auto n = from_hex<384>("f67d52758d1bd6ba80752c150ca5b7a1c9116d90b5a774650665e0b4b052d030eca62e6fe253918da3949b89dbfbc82c");
+            const auto x = from_hex<384>("fa74969f21ff5eb6ed78f5d0960afe94bbdbb01dc14ed575e0730b3cc170c31c7eec61bbf9703c096fabb7b1ba95a54");
+            const auto e = from_hex<384>("b3de08f9ec9837044692ba035707967025f02628eb07c30d5cd5061c9c5f319e834c1b69573ac59a355f2af41757905e");
+            const auto expected = from_hex<384>("2405e233fa66a4786e7f52d31bdb29925453ca017bb4ffb1b025797192f6eb7b9051d62d92bd0c3bf57dcb6bac9e99c8");
+            const auto context = arith::shared_context<arith::barrett_context<384>>(n);
+            BOOST_CHECK( context->power(x,e) == expected );
+            BOOST_CHECK( context->power(x,arith::uint<64> {1}) == x );
+        }
+
+    }
+}
@@ -0,0 +1,92 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License with Cpp11crypto.
+   If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// tests/arith/modexp.cpp - Tests arith/modexp.hpp
+
+#include "arith/modexp.hpp"
+#include "arith/barrett.hpp"
+#include "../utils/test_uint.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <cstdint>
+#include <fastformat/fastformat.hpp>
+
+namespace cpp11crypto {
+    namespace tests {
+
+        BOOST_AUTO_TEST_CASE (modexp_window_sizes) {
+            fastformat::fmtln(std::cout,"{0}","Modular exponentiation window size test starts...");
+            static_assert(arith::window_size(1,2048) == 1,"Single bit exponents need no table");
+            BOOST_CHECK( arith::window_size(17,2048) <= 2 );
+            BOOST_CHECK( arith::window_size(256,256) == 3 );
+            BOOST_CHECK( arith::window_size(1024,1024) == 4 );
+            BOOST_CHECK( arith::window_size(2048,2048) == 4 );
+            BOOST_CHECK( arith::window_size(4096,4096) == 4 );
+            for (std::size_t bits = 64; bits <= 8192; bits *= 2) {
+                BOOST_CHECK( arith::window_size(bits,bits) <= arith::window_size(2*bits,2*bits) );
+                BOOST_CHECK( arith::window_size(bits,bits) <= arith::max_chosen_window );
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (modexp_all_windows) {
+            fastformat::fmtln(std::cout,"{0}","Modular exponentiation on all window sizes test starts...");
+            boost::random::mt19937_64 generator {31};
+            for (int i = 0; i != 20; ++i) {
+                const arith::uint<256> n = random_uint<256>(generator) | arith::uint<256> {1};
+                const arith::montgomery_context<256> montgomery {n};
+                const arith::barrett_context<256> barrett {n};
+                const arith::uint<256> x = random_uint<256>(generator) % n;
+                const arith::uint<192> e = i == 0 ? arith::uint<192> {} : random_uint<192>(generator) >> (3*i);
+                const arith::uint<256> expected = barrett.power(x,e);
+                BOOST_REQUIRE( arith::modexp(montgomery,x,e) == expected );
+                for (unsigned w = 1; w <= arith::max_window; ++w) {
+                    BOOST_REQUIRE( montgomery.from_montgomery(arith::fixed_window_power(montgomery,montgomery.to_montgomery(x),e,w)) == expected );
+                    BOOST_REQUIRE( arith::fixed_window_power(barrett,x,e,w) == expected );
+                }
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (modexp_2048) {
+            fastformat::fmtln(std::cout,"{0}","Modular exponentiation 2048 bits test starts...");
+            // expected value from an independent implementation
+            const arith::montgomery_context<2048> context {from_hex<2048>(
+                    "98f135d25f557203301850c5a38fd547923a736994e3bf911a61dbe22e44158bae97ba94d0eda82f8f6d05584ef8aa38922766581e27a1c08a6a63ec24ede6a4"
+                    "6b4cb2424a23d5962217beaddbc496cb8e81973e0becd7b03898d190f9ebdacc0cb1e29c658cda1495e60af593bd04cf0fd630f1f29d0da9953f48f1a09f76b5"
+                    "a170b33839263059f28c105d1fb17c2390c192cfd3ac94af0f21ddb66cad4a268d116ece1738f7d93d9c172411e20b8f6b0d549b6f03675a1600a35a099950d8"
+                    "36f675cc81e74ef5e8e25d940ed904759531985d5d9dc9f81818e811892f902bd23f0824128b2f330c5c7fd0a6a3a4506513270e269e0d37f2a74de452e6b439")};
+            const auto x = from_hex<2048>(
+                               "3f930a2598289fcd59a54a7bb1fee08f571242425051c1ccd17f9acae01f5057ca02135e92b1d3f28ede0d7ac3baea9e13deef86ab1031d0f646e1f40a097c97"
+                               "6bf46c697d2caf82eeeacbe226e875555790f82ec1d3fcff2a3af4d46b0a18e8830e07bc1e398f1012bd4acefaecbd389be4bcfc49b64a0872e6cc3ababced20"
+                               "57ee05cde00902c77ebff206867347214cdd2055930d6eaf14f4733f3e7d1bfbc7a2ea20b2f14c942e05319acb5c74273f98e2774cbd87ad5c90a9587403e430"
+                               "ec66a78795e761d17731af10506bf2efc6f877186d76b07e881ed162ae2eb1547f15052434b9b5df9e7769b10f4205b4907a70c31012f037b64ce4228c38fb29");
+            const auto d = from_hex<2048>(
+                               "fc891b4a6a50df4db4d66a3a47469a4d8cdb305fdd2e16096e36aab0d1bc52d9230d977ee22571594720771f8ca8181166d2287672fdf2022a96fb1a14a0f9e7"
+                               "7f1b103cdf1582b0eab477d26415479c65dc9f503f63af83bd0561e6211c70cf49952399c4aaeac137dc76fb0f17a3007e62aa0a1df9fd789c6539382b0537e6"
+                               "5affb2297631a992f0ce583505c6af0758d5563dab2cd31ee315128862c33a4fb774eb5248db40af72158370d269a9a5ae658f33fe3b890b93f448b3a5aa3c81"
+                               "4f426dcbb394fb36bb2d420f0f88080b10a3d6b2aa05e11ab2715945795e8229451abd81f1d69ed617f5e837d70820fe119a72d174c9df6acc011cdd9474031b");
+            BOOST_CHECK( arith::modexp(context,x,d) == from_hex<2048>(
+                             "0a33663e4d9944d25edfa6f7f370e99fe1081c4f33b9d90c417fdfd842bc8a397b9a3ada596d056728ea2436e1fa3f421d9ec77aa2d42d79d7f32761e02f1823"
+                             "c613aef2c5b1f16fe67d9cbfda77a27f2a55bd3fcb7383420d1bf8228f6105d475478f209ccbf5c0618524fee1fd2eb25850859ca5fd4e5bc4ac53e3b050feae"
+                             "3c95e8a7c9809e5f0df19088a55e1ce1812c1df7059de1db15ae88e606c00a6ed6b7358453fcab208f4b235a462d700ac4bb73b604627ec1cedaa8dde1f0f0c2"
+                             "b8ceab5cc5e6bdf375505174539dea2b228a91dc1a73cb0fe6bbe87665653fb08cb5ed03b873ac358cfdc26672827748014ecd8864f352151aa3492913035ad9") );
+        }
+
+    }
+}
@@ -0,0 +1,156 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License with Cpp11crypto.
+   If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// tests/arith/montgomery.cpp - Tests arith/montgomery.hpp and arith/context_cache.hpp
+
+#include "arith/montgomery.hpp"
+#include "arith/algorithms/euclid.hpp"
+#include "arith/context_cache.hpp"
+#include "../utils/test_uint.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <fastformat/fastformat.hpp>
+
+namespace cpp11crypto {
+    namespace tests {
+
+        namespace {
+            /// Reference modular product, by division
+            template <std::size_t Bits>
+            arith::uint<Bits> product_mod(const arith::uint<Bits>& a,const arith::uint<Bits>& b,const arith::uint<Bits>& n) {
+                return arith::uint<Bits>(wide_multiply(a,b) % arith::uint<2*Bits>(n));
+            }
+
+            template <std::size_t Bits>
+            void check_products(boost::random::mt19937_64& generator,const int rounds) {
+                for (int i = 0; i != rounds; ++i) {
+                    arith::uint<Bits> n = random_uint<Bits>(generator) >> (generator() % 64);
+                    n |= arith::uint<Bits> {3};
+                    const arith::montgomery_context<Bits> context {n};
+                    const arith::uint<Bits> a = random_uint<Bits>(generator) % n;
+                    const arith::uint<Bits> b = random_uint<Bits>(generator) % n;
+                    const arith::uint<Bits> am = context.to_montgomery(a), bm = context.to_montgomery(b);
+                    BOOST_REQUIRE( context.from_montgomery(am) == a );
+                    BOOST_REQUIRE( context.from_montgomery(context.multiply(am,bm)) == product_mod(a,b,n) );
+                    BOOST_REQUIRE( context.from_montgomery(context.square(am)) == product_mod(a,a,n) );
+                    BOOST_REQUIRE( context.from_montgomery(context.add(am,bm))
+                                   == arith::uint<Bits>((arith::uint<2*Bits>(a)+arith::uint<2*Bits>(b)) % arith::uint<2*Bits>(n)) );
+                    BOOST_REQUIRE( context.add(context.subtract(am,bm),bm) == am );
+                }
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (montgomery_products) {
+            fastformat::fmtln(std::cout,"{0}","Montgomery products test starts...");
+            boost::random::mt19937_64 generator {21};
+            check_products<64>(generator,2000);
+            check_products<256>(generator,500);
+            check_products<2048>(generator,20);
+            BOOST_CHECK_THROW( arith::montgomery_context<256> {arith::uint<256> {10}}, std::invalid_argument );
+            BOOST_CHECK_THROW( arith::montgomery_context<256> {arith::uint<256> {1}}, std::invalid_argument );
+        }
+
+        BOOST_AUTO_TEST_CASE (montgomery_power) {
+            fastformat::fmtln(std::cout,"{0}","Montgomery exponentiation test starts...");
+            // expected values from an independent implementation
+            const arith::montgomery_context<256> p256 {from_hex<256>("ffffffff00000001000000000000000000000000ffffffffffffffffffffffff")};
+            const auto x = from_hex<256>("6bb6a198f1446beab0c11fdecb91ce375bc8fbbcbde5c0994164d8399f767c45");
+            const auto e = from_hex<256>("c6a5387777330bdbd7210dff076ce2ef87b0b125ec1d7da0a6eb8c9ebd69fe29");
+            BOOST_CHECK( p256.from_montgomery(p256.power(p256.to_montgomery(x),e))
+                         == from_hex<256>("48416aeb74a5719f9beccf7779dc9e7dd4b364d08e83e62005fa5176e69af3c2") );
+            BOOST_CHECK( p256.from_montgomery(p256.power(p256.to_montgomery(x),arith::uint<64> {})) == arith::uint<256> {1} );
+
+            const arith::montgomery_context<2048> rsa {from_hex<2048>(
+                    "f7108e96f770c2263266aa3bb0cde917f7f35634f0e3cd972e81d66d346c6e2ba02fdaa1ad864c44e049548e8a0a8c9632ea6928f6236bf2504b74ba4a0fe75d"
+                    "2a9eba0cdf561d802a759159fb7ff337f5cae3bf3729c619c60a3cab359eeefb015c33b2df1461aaf8eb18b90074513021da8978206f5c6671e0c07e9e115e4b"
+                    "9e30691c238642ea126a1e48cc11d357c30d8b7628dbd25e63b229f1c4069545de11cc9dea959c212e9c82b1478c281d687c966c377b9aa2bb2edb20035b7399"
+                    "3fd4235992edcf451a1afe878b33e968617959ce3f1f65a8de5271007814e8a25f2dd97f1cfb10f62827688de6a16a3b0d464138a62332553fc1ea36f17fd375")};
+            const auto message = from_hex<2048>(
+                                     "1f7fc59fc177f1131e782196324f3e81f453324ef486ab739faba8272e50bd4eb52fa53c0bf64ef773ec28d00252f615d75b1e249419cf4d60597bdc5dbe4409"
+                                     "6b384309c9a937a68c8f95ef04a012e8677fd139d84a1d3a5b8e8fb2bff29101f3001cee05da8467f06313fff9a01fe8419521fe0e979cf32d1634b4b4653252"
+                                     "78f845f57b3120df2f4d4c8650d7d13fb24891917b121dc54e5a3a26d18a669a5af84e6b4f59672710e6d8e6568068b9b52a43abad8d194a9892139600ddb74d"
+                                     "960d5a8f9a656aafd14125844d25deb354f46a6910acff0043892dfc254cb864ef901b932a7c18806a3753915c76f18a0585a01c4c7d6df0621aef57e4cc4132");
+            BOOST_CHECK( rsa.from_montgomery(rsa.power(rsa.to_montgomery(message),arith::uint<64> {65537})) == from_hex<2048>(
+                             "64a706632643d20ff90e44335b9d5dfce62ade81d95b0d2d545fb98b6e2ac69d4628c3ee4adeda385f776c6c81aaf929ee3e51d4029a8302e8038a481c8bcf09"
+                             "731c2854541b324fe4e9422efab403d682075ea4d35a1d98425a49ab6875aa9377f9216e5af40df567f6746b3fa6e727273e06f73f4ca403a82246182bea1206"
+                             "a47e2805300053f1d3f4e49f48f204657544bc9e433f1413038880a2d6046f36c58d0be497d9de828a7b89454f92a3fbd37614de28cf79a248335c5738068e1e"
+                             "d71df94315572e63039e4e3c3c12eeb5e2461b7b7a2ec03b074cb25ee89388b55f0c6e762c7dc2a381c2a661a31defd3bc63e16ac0e6c97830669d1468a27e4") );
+        }
+
+        BOOST_AUTO_TEST_CASE (montgomery_inverse) {
+            fastformat::fmtln(std::cout,"{0}","Montgomery inverse test starts...");
+            boost::random::mt19937_64 generator {17};
+            for (int i = 0; i != 20; ++i) {
+                const arith::uint<1024> n = random_uint<1024>(generator) | arith::uint<1024> {1};
+                const arith::montgomery_context<1024> context {n};
+                const arith::uint<1024> x = random_uint<1024>(generator) % n;
+                const arith::uint<1024> a = context.to_montgomery(x);
+                const arith::uint<1024> inverse = context.invert(a);
+                // random moduli often share small factors with x
+                if (arith::algorithms::euclid::gcd(x,n) == arith::uint<1024> {1}) {
+                    BOOST_CHECK( context.multiply(a,inverse) == context.one() );
+                } else {
+                    BOOST_CHECK( inverse == arith::uint<1024> {} );
+                }
+            }
+            const arith::montgomery_context<64> fifteen {arith::uint<64> {15}};
+            BOOST_CHECK( fifteen.invert(fifteen.to_montgomery(arith::uint<64> {6})) == arith::uint<64> {} );
+            BOOST_CHECK( fifteen.from_montgomery(fifteen.invert(fifteen.to_montgomery(arith::uint<64> {7}))) == arith::uint<64> {13} );
+        }
+
+        BOOST_AUTO_TEST_CASE (context_cache_sharing) {
+            fastformat::fmtln(std::cout,"{0}","Context cache test starts...");
+            typedef arith::montgomery_context<256> context;
+            arith::context_cache<context> cache {2};
+            const auto first = cache.get(arith::uint<256> {101});
+            BOOST_CHECK( first == cache.get(arith::uint<256> {101}) );
+            BOOST_CHECK( first->modulus() == arith::uint<256> {101} );
+            cache.get(arith::uint<256> {103});
+            cache.get(arith::uint<256> {107});
+            BOOST_CHECK( 2 == cache.size() );
+            // evicted, but still alive for its holder
+            BOOST_CHECK( first != cache.get(arith::uint<256> {101}) );
+            BOOST_CHECK( first->multiply(first->one(),first->one()) == first->one() );
+            BOOST_CHECK_THROW( cache.get(arith::uint<256> {100}), std::invalid_argument );
+            cache.clear();
+            BOOST_CHECK( 0 == cache.size() );
+
+            std::vector<std::shared_ptr<const context>> seen(4);
+            std::vector<std::thread> threads;
+            for (std::size_t t = 0; t != seen.size(); ++t) {
+                threads.emplace_back([t,&seen]() {
+                    seen[t] = arith::shared_context<context>(arith::uint<256> {65537});
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            for (const auto& shared : seen) {
+                BOOST_CHECK( shared == arith::shared_context<context>(arith::uint<256> {65537}) );
+            }
+        }
+
+    }
+}
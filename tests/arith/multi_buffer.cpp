@@ -0,0 +1,163 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License with Cpp11crypto.
+   If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// tests/arith/multi_buffer.cpp - Tests arith/multi_buffer.hpp
+
+#include "arith/multi_buffer.hpp"
+#include "../utils/test_uint.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/mpl/list.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <fastformat/fastformat.hpp>
+
+namespace cpp11crypto {
+    namespace tests {
+
+        namespace {
+            const arith::lane_engine all_engines[] = {
+                arith::lane_engine::scalar,arith::lane_engine::avx2,arith::lane_engine::avx512ifma
+            };
+
+            /// Random odd moduli, some of them shorter than Bits, some repeated
+            template <std::size_t Bits>
+            struct lane_inputs {
+                typedef arith::uint<Bits> value;
+                typedef arith::montgomery_context<Bits> context;
+
+                lane_inputs(boost::random::mt19937_64& generator,const std::size_t count) {
+                    for (std::size_t i = 0; i != count; ++i) {
+                        if (0 != i && 0 == i%5) {
+                            contexts.push_back(contexts[i-1]);
+                        } else {
+                            const value n = (random_uint<Bits>(generator) >> (i%3 == 2 ? generator()%Bits : 0)) | value {3};
+                            contexts.push_back(std::make_shared<const context>(n));
+                        }
+                        pointers.push_back(contexts.back().get());
+                        const value& n = contexts.back()->modulus();
+                        // extreme values first
+                        a.push_back(i == 0 ? value {} : i == 1 ? n-value {1} : random_uint<Bits>(generator) % n);
+                        b.push_back(i == 0 ? n-value {1} : i == 1 ? n-value {1} : random_uint<Bits>(generator) % n);
+                    }
+                }
+
+                std::vector<std::shared_ptr<const context>> contexts;
+                std::vector<const context *> pointers;
+                std::vector<value> a, b;
+            };
+        }
+
+        typedef boost::mpl::list<std::integral_constant<std::size_t,64>,std::integral_constant<std::size_t,256>,
+                std::integral_constant<std::size_t,1024>,std::integral_constant<std::size_t,2048>> lane_widths;
+
+        BOOST_AUTO_TEST_CASE_TEMPLATE (multi_buffer_products_fuzz, Width, lane_widths) {
+            constexpr std::size_t Bits = Width::value;
+            typedef arith::uint<Bits> value;
+            fastformat::fmtln(std::cout,"Multi-buffer {0}-bit products on every kernel test starts...",Bits);
+            boost::random::mt19937_64 generator {Bits};
+            for (int round = 0; round != 10; ++round) {
+                // never a multiple of the lanes, so that batches are padded
+                const std::size_t count = 1+generator()%19;
+                const lane_inputs<Bits> inputs {generator,count};
+                std::vector<value> expected(count);
+                for (std::size_t i = 0; i != count; ++i) {
+                    expected[i] = value(wide_multiply(inputs.a[i],inputs.b[i]) % arith::uint<2*Bits>(inputs.contexts[i]->modulus()));
+                }
+                for (const arith::lane_engine engine : all_engines) {
+                    if (!arith::is_supported(engine)) {
+                        continue;
+                    }
+                    std::vector<value> results(count);
+                    arith::multi_multiply(results.data(),inputs.pointers.data(),inputs.a.data(),inputs.b.data(),count,engine);
+                    for (std::size_t i = 0; i != count; ++i) {
+                        BOOST_CHECK( results[i] == expected[i] );
+                    }
+                }
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE_TEMPLATE (multi_buffer_modexp_fuzz, Width, lane_widths) {
+            constexpr std::size_t Bits = Width::value;
+            typedef arith::uint<Bits> value;
+            fastformat::fmtln(std::cout,"Multi-buffer {0}-bit exponentiations on every kernel test starts...",Bits);
+            boost::random::mt19937_64 generator {Bits+1};
+            const std::size_t count = 11;
+            const lane_inputs<Bits> inputs {generator,count};
+            std::vector<value> exponents;
+            for (std::size_t i = 0; i != count; ++i) {
+                exponents.push_back(i == 0 ? value {} : i == 1 ? value {65537} : random_uint<Bits>(generator) >> (i%4));
+            }
+            std::vector<value> expected(count);
+            for (std::size_t i = 0; i != count; ++i) {
+                expected[i] = arith::modexp(*inputs.contexts[i],inputs.a[i],exponents[i]);
+            }
+            for (const arith::lane_engine engine : all_engines) {
+                if (!arith::is_supported(engine)) {
+                    continue;
+                }
+                std::vector<value> results(count);
+                arith::multi_modexp(results.data(),inputs.pointers.data(),inputs.a.data(),exponents.data(),count,engine);
+                for (std::size_t i = 0; i != count; ++i) {
+                    BOOST_CHECK( results[i] == expected[i] );
+                }
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE_TEMPLATE (multi_buffer_public_exponent, Width, lane_widths) {
+            constexpr std::size_t Bits = Width::value;
+            typedef arith::uint<Bits> value;
+            fastformat::fmtln(std::cout,"Multi-buffer {0}-bit public exponent test starts...",Bits);
+            boost::random::mt19937_64 generator {Bits+2};
+            const std::size_t count = 13;
+            const lane_inputs<Bits> inputs {generator,count};
+            for (const unsigned long long e : {0ULL,1ULL,3ULL,65537ULL,static_cast<unsigned long long>(generator())}) {
+                std::vector<value> expected(count);
+                for (std::size_t i = 0; i != count; ++i) {
+                    expected[i] = arith::modexp(*inputs.contexts[i],inputs.a[i],arith::uint<64> {e});
+                }
+                for (const arith::lane_engine engine : all_engines) {
+                    if (!arith::is_supported(engine)) {
+                        continue;
+                    }
+                    std::vector<value> results(count);
+                    arith::multi_modexp_public(results.data(),inputs.pointers.data(),inputs.a.data(),e,count,engine);
+                    BOOST_CHECK( results == expected );
+                }
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (multi_buffer_short_exponents) {
+            fastformat::fmtln(std::cout,"{0}","Multi-buffer exponentiations with short exponents test starts...");
+            boost::random::mt19937_64 generator {2013};
+            const lane_inputs<1024> inputs {generator,9};
+            std::vector<arith::uint<64>> exponents(9,arith::uint<64> {65537});
+            exponents[3] = arith::uint<64> {3};
+            std::vector<arith::uint<1024>> expected(9), results(9);
+            arith::multi_modexp(expected.data(),inputs.pointers.data(),inputs.a.data(),exponents.data(),9,arith::lane_engine::scalar);
+            arith::multi_modexp(results.data(),inputs.pointers.data(),inputs.a.data(),exponents.data(),9);
+            BOOST_CHECK( results == expected );
+            BOOST_CHECK( arith::is_supported(arith::best_lane_engine()) );
+            BOOST_CHECK( arith::lane_count(arith::lane_engine::avx512ifma) == 8 );
+        }
+
+    }
+}
@@ -0,0 +1,100 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License with Cpp11crypto.
+   If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// tests/arith/natural.cpp - Tests arith/natural.hpp and arith/algorithms/multiplication.hpp
+
+#include "arith/natural.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include <fastformat/fastformat.hpp>
+
+namespace cpp11crypto {
+    namespace tests {
+
+        namespace {
+            namespace multiplication = arith::algorithms::multiplication;
+
+            /// Random value of n limbs, some of them all zeros or all ones
+            arith::natural random_natural(boost::random::mt19937_64& generator,const std::size_t n) {
+                std::vector<std::uint64_t> limbs(n);
+                for (auto& limb : limbs) {
+                    const std::uint64_t shape = generator() % 8;
+                    limb = 0 == shape ? 0 : 1 == shape ? ~std::uint64_t {0} : generator();
+                }
+                if (0 != n) {
+                    limbs.back() |= 1;
+                }
+                return arith::natural(limbs.data(),n);
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (natural_arithmetic) {
+            fastformat::fmtln(std::cout,"{0}","Variable length integer arithmetic test starts...");
+            boost::random::mt19937_64 generator {41};
+            for (int i = 0; i != 200; ++i) {
+                const arith::uint<256> a {random_natural(generator,4)};
+                const arith::uint<256> b {random_natural(generator,1+i%4)};
+                const arith::natural na {a}, nb {b};
+                BOOST_REQUIRE( arith::uint<512>(na*nb) == wide_multiply(a,b) );
+                BOOST_REQUIRE( arith::uint<512>(na+nb) == arith::uint<512>(a)+arith::uint<512>(b) );
+                BOOST_REQUIRE( na+nb-nb == na );
+                BOOST_REQUIRE( (na < nb) == (a < b) );
+                BOOST_REQUIRE( bit_length(na) == bit_length(a) );
+            }
+            BOOST_CHECK( arith::natural {} == arith::natural {0} );
+            BOOST_CHECK( 0 == (arith::natural {5}*arith::natural {}).size() );
+            BOOST_CHECK_THROW( arith::natural {3}-arith::natural {4}, std::domain_error );
+        }
+
+        BOOST_AUTO_TEST_CASE (natural_multiplication_algorithms) {
+            fastformat::fmtln(std::cout,"{0}","Karatsuba and Toom-3 against schoolbook test starts...");
+            boost::random::mt19937_64 generator {42};
+            const multiplication::thresholds schoolbook {~std::size_t {0},~std::size_t {0}};
+            const multiplication::thresholds variants[] = {
+                multiplication::thresholds {},
+                multiplication::thresholds {2,~std::size_t {0}},
+                multiplication::thresholds {2,5},
+                multiplication::thresholds {4,9},
+                multiplication::thresholds {~std::size_t {0},5}
+            };
+            for (std::size_t na = 1; na <= 150; na += 1+na/8) {
+                for (std::size_t nb = 1; nb <= na; nb += 1+nb/3) {
+                    const arith::natural a = random_natural(generator,na);
+                    const arith::natural b = random_natural(generator,nb);
+                    const arith::natural expected = multiply(a,b,schoolbook);
+                    for (const auto& limits : variants) {
+                        BOOST_REQUIRE( multiply(a,b,limits) == expected );
+                        BOOST_REQUIRE( multiply(b,a,limits) == expected );
+                    }
+                }
+            }
+            // the all ones operands stress every carry
+            const std::vector<std::uint64_t> ones(200,~std::uint64_t {0});
+            const arith::natural all_ones {ones.data(),ones.size()};
+            const arith::natural square = all_ones*all_ones;
+            BOOST_CHECK( square == multiply(all_ones,all_ones,schoolbook) );
+            BOOST_CHECK( square+all_ones+all_ones+1 == multiply(all_ones+1,all_ones+1,schoolbook) );
+        }
+
+    }
+}
@@ -0,0 +1,190 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License with Cpp11crypto.
+   If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// tests/arith/p256.cpp - Tests arith/p256.hpp
+
+#include "arith/p256.hpp"
+#include "../utils/test_uint.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <fastformat/fastformat.hpp>
+
+namespace cpp11crypto {
+    namespace tests {
+
+        namespace {
+            typedef arith::p256::value_type value_type;
+            typedef arith::p256::point point;
+
+            /// Big endian bytes of a value
+            std::array<std::uint8_t,32> to_bytes(const value_type& x) {
+                std::array<std::uint8_t,32> bytes;
+                for (std::size_t i = 0; i != 32; ++i) {
+                    bytes[31-i] = static_cast<std::uint8_t>(x.limb(i/8) >> (8*(i%8)));
+                }
+                return bytes;
+            }
+
+            /// Generator giving the limbs of a fixed value, lowest first
+            struct fixed_generator {
+                typedef std::uint64_t result_type;
+                std::uint64_t operator()() {
+                    return value.limb(next++ % value_type::limb_count);
+                }
+                value_type value;
+                unsigned next;
+            };
+
+            arith::p256::affine_point affine(const char * const x,const char * const y) {
+                return arith::p256::affine_point {from_hex<256>(x),from_hex<256>(y)};
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (p256_group_law) {
+            fastformat::fmtln(std::cout,"{0}","P-256 group law test starts...");
+            const point g = point::generator();
+            const point identity;
+            BOOST_CHECK( identity.is_identity() );
+            BOOST_CHECK( !g.is_identity() );
+            BOOST_CHECK( g+identity == g );
+            BOOST_CHECK( identity+g == g );
+            BOOST_CHECK( (g-g).is_identity() );
+            BOOST_CHECK( identity.doubled().is_identity() );
+            BOOST_CHECK( g+g == g.doubled() );
+            BOOST_CHECK( g.doubled()+g == g+g.doubled() );
+            BOOST_CHECK( g != g.doubled() );
+            BOOST_CHECK_THROW( identity.to_affine(), std::domain_error );
+            // a non-residue right hand side, and a coordinate past p
+            BOOST_CHECK_THROW( point::from_affine(arith::p256::affine_point {value_type {},value_type {}}), std::invalid_argument );
+            BOOST_CHECK_THROW( point::from_affine(arith::p256::affine_point {arith::p256::field().modulus(),value_type {}}),
+                               std::invalid_argument );
+            const arith::p256::affine_point a = g.to_affine();
+            BOOST_CHECK( point::from_affine(a) == g );
+        }
+
+        BOOST_AUTO_TEST_CASE (p256_known_multiples) {
+            fastformat::fmtln(std::cout,"{0}","P-256 known multiples test starts...");
+            // multiples from an independent implementation
+            const struct {
+                const char * k;
+                const char * x;
+                const char * y;
+            } vectors[] = {
+                {"1","6b17d1f2e12c4247f8bce6e563a440f277037d812deb33a0f4a13945d898c296",
+                 "4fe342e2fe1a7f9b8ee7eb4a7c0f9e162bce33576b315ececbb6406837bf51f5"},
+                {"2","7cf27b188d034f7e8a52380304b51ac3c08969e277f21b35a60b48fc47669978",
+                 "07775510db8ed040293d9ac69f7430dbba7dade63ce982299e04b79d227873d1"},
+                {"ffffffff00000000ffffffffffffffffbce6faada7179e84f3b9cac2fc632550",
+                 "6b17d1f2e12c4247f8bce6e563a440f277037d812deb33a0f4a13945d898c296",
+                 "b01cbd1c01e58065711814b583f061e9d431cca994cea1313449bf97c840ae0a"},
+                {"ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff",
+                 "f72cbd240e26c0d21b1023179586eb532c6102c49c3677cc1a3d132b9db9d31a",
+                 "43e4ca77e2a36621dc0dbd91bfe7a5d223250ef0cdca831ee453d93fa83408a7"},
+                {"d76d4330f1446beab0c11fdecb91ce375bc8fbbcbde5c0994164d8399f767c45",
+                 "fd60dca3efc3e05294f463a6c34ecf8a32beeba14ac17fe57b9d28976b9b91dc",
+                 "e38b0fdf86a59d5cddb79d8f24907fc9ee013a1c58a59e259b5cfce9608dae13"}
+            };
+            const point g = point::generator();
+            for (const auto& v: vectors) {
+                const value_type k = from_hex<256>(v.k);
+                const point expected = point::from_affine(affine(v.x,v.y));
+                BOOST_CHECK( arith::p256::multiply(k,g) == expected );
+                BOOST_CHECK( arith::p256::multiply_base(k) == expected );
+                BOOST_CHECK( arith::p256::multiply_public(k,value_type {},g) == expected );
+                BOOST_CHECK( arith::p256::multiply_public(value_type {},k,g) == expected );
+                const arith::p256::affine_point a = expected.to_affine();
+                BOOST_CHECK( a.x == from_hex<256>(v.x) && a.y == from_hex<256>(v.y) );
+            }
+            BOOST_CHECK( arith::p256::multiply(arith::p256::order(),g).is_identity() );
+            BOOST_CHECK( arith::p256::multiply_base(arith::p256::order()).is_identity() );
+            BOOST_CHECK( arith::p256::multiply_base(value_type {}).is_identity() );
+            BOOST_CHECK( arith::p256::multiply_public(arith::p256::order(),value_type {},g).is_identity() );
+        }
+
+        BOOST_AUTO_TEST_CASE (p256_multiplication_agreement) {
+            fastformat::fmtln(std::cout,"{0}","P-256 scalar multiplication agreement test starts...");
+            boost::random::mt19937_64 generator {256};
+            const point g = point::generator();
+            for (int i = 0; i != 20; ++i) {
+                const value_type a = random_uint<256>(generator), b = random_uint<256>(generator);
+                const point q = arith::p256::multiply_base(b);
+                const point expected = arith::p256::multiply_base(a)+arith::p256::multiply(b,q);
+                BOOST_CHECK( arith::p256::multiply(a,g) == arith::p256::multiply_base(a) );
+                BOOST_CHECK( arith::p256::multiply_public(a,b,q) == expected );
+                // a*(b*G) == b*(a*G)
+                BOOST_CHECK( arith::p256::multiply(a,q) == arith::p256::multiply(b,arith::p256::multiply_base(a)) );
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (p256_ecdsa) {
+            fastformat::fmtln(std::cout,"{0}","P-256 ECDSA test starts...");
+            // RFC 6979, A.2.5, SHA-256 of "sample"
+            const arith::p256::private_key key {from_hex<256>("c9afa9d845ba75166b5c215767b1d6934e50c3db36e89b127b8a622b120f6721")};
+            const arith::p256::affine_point& q = key.public_key().coordinates();
+            BOOST_CHECK( q.x == from_hex<256>("60fed4ba255a9d31c961eb74c6356d68c049b8923b61fa6ce669622e60f29fb6") );
+            BOOST_CHECK( q.y == from_hex<256>("7903fe1008b8bc99a41ae9e95628bc64f2f1b20c2d7e9f5177a3c294d4462299") );
+            const std::array<std::uint8_t,32> digest = to_bytes(from_hex<256>("af2bdbe1aa9b6ec1e2ade1d694f41fc71a831d0268e9891562113d8a62add1bf"));
+            fixed_generator nonce {from_hex<256>("a6e3c57dd01abe90086538398355dd4c3b17aa873382b0f24d6129493d8aad60"),0};
+            const arith::p256::signature sig = key.sign(digest,nonce);
+            BOOST_CHECK( sig.r == from_hex<256>("efd48b2aacb6a8fd1140dd9cd45e81d69d2c877b56aaf991c34d0ea84eaf3716") );
+            BOOST_CHECK( sig.s == from_hex<256>("f7cb1c942d657c41d436c7a1b6e29f65f3e900dbb9aff4064dc4ab2f843acda8") );
+            BOOST_CHECK( key.public_key().verify(digest,sig) );
+
+            std::array<std::uint8_t,32> altered = digest;
+            altered[31] ^= 1;
+            BOOST_CHECK( !key.public_key().verify(altered,sig) );
+            BOOST_CHECK( !key.public_key().verify(digest,arith::p256::signature {sig.r,sig.s+value_type {1}}) );
+            BOOST_CHECK( !key.public_key().verify(digest,arith::p256::signature {value_type {},sig.s}) );
+            BOOST_CHECK( !key.public_key().verify(digest,arith::p256::signature {sig.r,arith::p256::order()}) );
+
+            boost::random::mt19937_64 generator {6979};
+            for (int i = 0; i != 10; ++i) {
+                const arith::p256::private_key other = arith::p256::generate_key(generator);
+                const std::array<std::uint8_t,32> d = to_bytes(random_uint<256>(generator));
+                const arith::p256::signature s = other.sign(d,generator);
+                BOOST_CHECK( other.public_key().verify(d,s) );
+                BOOST_CHECK( !key.public_key().verify(d,s) );
+            }
+            BOOST_CHECK_THROW( arith::p256::private_key {value_type {}}, std::invalid_argument );
+            BOOST_CHECK_THROW( arith::p256::private_key {arith::p256::order()}, std::invalid_argument );
+        }
+
+        BOOST_AUTO_TEST_CASE (p256_ecdh) {
+            fastformat::fmtln(std::cout,"{0}","P-256 ECDH test starts...");
+            // shared secret from an independent implementation
+            const arith::p256::private_key a {from_hex<256>("7d7dc5f71eb29ddaf80d6214632eeae03d9058af1fb6d22ed80badb62bc1a534")};
+            const arith::p256::public_key b {affine("119f2f047902782ab0c9e27a54aff5eb9b964829ca99c06b02ddba95b0a3f6d0",
+                                                    "8f52b726664cac366fc98ac7a012b2682cbd962e5acb544671d41b9445704d1d")};
+            BOOST_CHECK( a.agree(b) == from_hex<256>("69854de86f85d63854b189cd4f7a556c668977ed93277edc449e9f7655b28175") );
+
+            boost::random::mt19937_64 generator {1976};
+            for (int i = 0; i != 10; ++i) {
+                const arith::p256::private_key x = arith::p256::generate_key(generator);
+                const arith::p256::private_key y = arith::p256::generate_key(generator);
+                BOOST_CHECK( x.agree(y.public_key()) == y.agree(x.public_key()) );
+            }
+            BOOST_CHECK_THROW( arith::p256::public_key {affine("1","2")}, std::invalid_argument );
+        }
+
+    }
+}
@@ -0,0 +1,106 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License with Cpp11crypto.
+   If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// tests/arith/prime.cpp - Tests arith/prime.hpp
+
+#include "arith/prime.hpp"
+#include "../utils/test_uint.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <cstdint>
+#include <stdexcept>
+#include <fastformat/fastformat.hpp>
+
+namespace cpp11crypto {
+    namespace tests {
+
+        namespace {
+            /// Generator failing after a given number of words
+            struct failing_generator {
+                typedef std::uint64_t result_type;
+                std::uint64_t operator()() {
+                    if (0 == left--) {
+                        throw std::runtime_error("entropy exhausted");
+                    }
+                    return generator();
+                }
+                boost::random::mt19937_64 generator;
+                unsigned left;
+            };
+        }
+
+        BOOST_AUTO_TEST_CASE (prime_small_primes) {
+            fastformat::fmtln(std::cout,"{0}","Small prime table test starts...");
+            const std::vector<std::uint32_t>& primes = arith::details::small_primes();
+            // pi(8192) is 1028, 2 included
+            BOOST_CHECK( primes.size() == 1027 );
+            BOOST_CHECK( primes.front() == 3 );
+            BOOST_CHECK( primes.back() == 8191 );
+            // 2^13 == 1 mod 8191, so (2^64-1)*2^64 == 4095*4096
+            BOOST_CHECK( arith::details::remainder(arith::uint<128> {~0ULL} << 64,8191) == 4095ULL*4096 % 8191 );
+        }
+
+        BOOST_AUTO_TEST_CASE (prime_known_values) {
+            fastformat::fmtln(std::cout,"{0}","Primality of known values test starts...");
+            boost::random::mt19937_64 generator {7};
+            for (unsigned long long n = 0; n != 200; ++n) {
+                bool prime = n > 1;
+                for (unsigned long long d = 2; d*d <= n; ++d) {
+                    prime &= 0 != n%d;
+                }
+                BOOST_CHECK( arith::is_probable_prime(arith::uint<64> {n},generator) == prime );
+            }
+            BOOST_CHECK( arith::is_probable_prime(arith::uint<64> {8191},generator) );
+            BOOST_CHECK( arith::is_probable_prime((arith::uint<128> {1} << 127)-arith::uint<128> {1},generator) );
+            BOOST_CHECK( arith::is_probable_prime((arith::uint<256> {1} << 255)-arith::uint<256> {19},generator) );
+            BOOST_CHECK( arith::is_probable_prime((arith::uint<576> {1} << 521)-arith::uint<576> {1},generator) );
+            // strong pseudoprime to every base up to 23, with factors past the sieve
+            BOOST_CHECK( !arith::is_probable_prime(arith::uint<64> {3825123056546413051ULL},generator) );
+            // product of two primes
+            BOOST_CHECK( !arith::is_probable_prime(from_hex<256>("20000000000000000000000000000ebf4000000000000000000000000101aa8f"),generator) );
+            BOOST_CHECK( !arith::is_probable_prime((arith::uint<128> {1} << 127)+arith::uint<128> {1},generator) );
+        }
+
+        BOOST_AUTO_TEST_CASE (prime_generation) {
+            fastformat::fmtln(std::cout,"{0}","Prime generation test starts...");
+            boost::random::mt19937_64 generator {2013};
+            for (unsigned threads = 1; threads != 4; ++threads) {
+                arith::prime_statistics statistics;
+                const arith::uint<256> p = arith::generate_prime<256>(generator,arith::prime_options {threads},statistics);
+                BOOST_CHECK( p.bit(255) && p.bit(254) );
+                BOOST_CHECK( arith::is_probable_prime(p,generator,40) );
+                BOOST_CHECK( 0 != arith::details::remainder(p-arith::uint<256> {1},65537) );
+                BOOST_CHECK( statistics.tested >= 1 );
+                BOOST_CHECK( statistics.candidates >= statistics.tested );
+            }
+            // any p-1 once the exponent check is off
+            const arith::uint<128> q = arith::generate_prime<128>(generator,arith::prime_options {2,0,0});
+            BOOST_CHECK( arith::is_probable_prime(q,generator,40) );
+            BOOST_CHECK( q.bit(127) && q.bit(126) );
+        }
+
+        BOOST_AUTO_TEST_CASE (prime_generation_failure) {
+            fastformat::fmtln(std::cout,"{0}","Prime generation with a failing generator test starts...");
+            failing_generator generator {boost::random::mt19937_64 {5},20};
+            BOOST_CHECK_THROW( arith::generate_prime<1024>(generator,arith::prime_options {3}), std::runtime_error );
+        }
+
+    }
+}
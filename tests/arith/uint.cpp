@@ -0,0 +1,162 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License with Cpp11crypto.
+   If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// tests/arith/uint.cpp - Tests arith/uint.hpp
+
+#include "arith/uint.hpp"
+#include "arith/algorithms/euclid.hpp"
+#include "../utils/test_uint.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/mpl/list.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <fastformat/fastformat.hpp>
+
+namespace cpp11crypto {
+    namespace tests {
+
+        namespace {
+            using u128 = arith::uint<128>;
+            using u256 = arith::uint<256>;
+            typedef boost::mpl::list<arith::uint<192>,arith::uint<384>,arith::uint<2048>> division_widths;
+            typedef boost::mpl::list<arith::uint<64>,arith::uint<256>,arith::uint<384>,arith::uint<512>> mulx_widths;
+
+            /// Built-in equivalent of a 128-bit value
+            utils::uint128_t native(const u128& x) {
+                return (static_cast<utils::uint128_t>(x.limb(1)) << 64) | x.limb(0);
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (uint_against_builtin) {
+            fastformat::fmtln(std::cout,"{0}","Fixed width integer against built-in 128 bits test starts...");
+            boost::random::mt19937_64 generator {11};
+            for (int i = 0; i != 20000; ++i) {
+                const u128 a = random_edgy_uint<128>(generator);
+                const u128 b = random_edgy_uint<128>(generator);
+                const utils::uint128_t na = native(a), nb = native(b);
+                const std::size_t shift = generator() % 128;
+                BOOST_REQUIRE( native(a+b) == na+nb );
+                BOOST_REQUIRE( native(a-b) == na-nb );
+                BOOST_REQUIRE( native(-a) == -na );
+                BOOST_REQUIRE( native(a*b) == na*nb );
+                BOOST_REQUIRE( native(a&b) == (na&nb) );
+                BOOST_REQUIRE( native(a|b) == (na|nb) );
+                BOOST_REQUIRE( native(a^b) == (na^nb) );
+                BOOST_REQUIRE( native(~a) == ~na );
+                BOOST_REQUIRE( native(a << shift) == na << shift );
+                BOOST_REQUIRE( native(a >> shift) == na >> shift );
+                BOOST_REQUIRE( (a == b) == (na == nb) );
+                BOOST_REQUIRE( (a < b) == (na < nb) );
+                BOOST_REQUIRE( (a >= b) == (na >= nb) );
+                BOOST_REQUIRE( bit_length(a) == utils::bit_length(na) );
+                if (0 != nb) {
+                    BOOST_REQUIRE( native(a/b) == na/nb );
+                    BOOST_REQUIRE( native(a%b) == na%nb );
+                    BOOST_REQUIRE( trailing_zeros(b) == utils::trailing_zeros(nb) );
+                }
+                const arith::uint<256> product = wide_multiply(a,b);
+                BOOST_REQUIRE( native(u128(product)) == na*nb );
+                BOOST_REQUIRE( product == u256(a)*u256(b) );
+            }
+            BOOST_CHECK( std::numeric_limits<u256>::digits == 256 );
+            BOOST_CHECK( (std::numeric_limits<u256>::max()+1) == u256 {} );
+            BOOST_CHECK_THROW( u256 {5}/u256 {}, std::domain_error );
+        }
+
+        BOOST_AUTO_TEST_CASE_TEMPLATE (uint_division_identity, T, division_widths) {
+            fastformat::fmtln(std::cout,"Fixed width integer division test for {0} bits starts...",std::numeric_limits<T>::digits);
+            boost::random::mt19937_64 generator {12};
+            for (int i = 0; i != 500; ++i) {
+                const T a = random_edgy_uint<std::numeric_limits<T>::digits>(generator);
+                T b = random_edgy_uint<std::numeric_limits<T>::digits>(generator) >> (generator() % std::numeric_limits<T>::digits);
+                if (T {} == b) {
+                    b = 3;
+                }
+                T q, r;
+                divide(a,b,q,r);
+                BOOST_REQUIRE( r < b );
+                BOOST_REQUIRE( q*b+r == a );
+                const auto wide = wide_multiply(q,b);
+                BOOST_REQUIRE( T(wide >> std::numeric_limits<T>::digits) == T {} );
+            }
+        }
+
+#if defined(CPP11CRYPTO_X86_INTRINSICS) && defined(__x86_64__)
+        BOOST_AUTO_TEST_CASE_TEMPLATE (uint_mulx_kernel, T, mulx_widths) {
+            if (!arith::details::has_mulx()) {
+                return;
+            }
+            fastformat::fmtln(std::cout,"Fixed width integer mulx kernel test for {0} bits starts...",std::numeric_limits<T>::digits);
+            constexpr std::size_t N = T::limb_count;
+            boost::random::mt19937_64 generator {14};
+            for (int i = 0; i != 5000; ++i) {
+                const T a = random_edgy_uint<std::numeric_limits<T>::digits>(generator);
+                const T b = random_edgy_uint<std::numeric_limits<T>::digits>(generator);
+                arith::details::limb expected[2*N] = {}, product[2*N] = {};
+                arith::details::schoolbook_unrolled<N,true>(a.data(),b.data(),expected);
+                arith::details::schoolbook_mulx<N,true>(a.data(),b.data(),product);
+                BOOST_REQUIRE( std::equal(expected,expected+2*N,product) );
+                std::fill(product,product+N,0);
+                arith::details::schoolbook_mulx<N,false>(a.data(),b.data(),product);
+                BOOST_REQUIRE( std::equal(expected,expected+N,product) );
+            }
+        }
+#endif
+
+        BOOST_AUTO_TEST_CASE (uint_wiped) {
+            fastformat::fmtln(std::cout,"{0}","Fixed width integer wipe test starts...");
+            typename std::aligned_storage<sizeof(u256),alignof(u256)>::type storage;
+            u256 * const x = new (&storage) u256 {~std::uint64_t {0}};
+            *x = -*x;
+            x->~u256();
+            const unsigned char * const bytes = reinterpret_cast<const unsigned char *>(&storage);
+            for (std::size_t i = 0; i != sizeof(u256); ++i) {
+                BOOST_REQUIRE( 0 == bytes[i] );
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (uint_euclid) {
+            fastformat::fmtln(std::cout,"{0}","Fixed width integer Euclid test starts...");
+            namespace euclid = arith::algorithms::euclid;
+            boost::random::mt19937_64 generator {13};
+            for (int i = 0; i != 200; ++i) {
+                const u256 common = u256 {generator() % 1000+1};
+                const u256 a = (random_edgy_uint<256>(generator) >> 12)*common;
+                const u256 b = (random_edgy_uint<256>(generator) >> 12)*common;
+                const u256 g = euclid::gcd(a,b);
+                BOOST_REQUIRE( g == euclid::gcd(a,b,euclid::binary_tag {}) );
+                BOOST_REQUIRE( g == euclid::gcd(a,b,euclid::lehmer_tag {}) );
+                BOOST_REQUIRE( g%common == u256 {} );
+                BOOST_REQUIRE( a%g == u256 {} && b%g == u256 {} );
+                u256 x, y;
+                std::tie(x,y) = euclid::extended_gcd(a,b,euclid::lehmer_tag {});
+                BOOST_REQUIRE( a*x+b*y == g );
+                std::tie(x,y) = euclid::extended_gcd(a,b);
+                BOOST_REQUIRE( a*x+b*y == g );
+            }
+        }
+
+    }
+}
@@ -0,0 +1,122 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License with Cpp11crypto.
+   If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// tests/block/aes.cpp - Tests block/aes.hpp
+
+#include "block/aes.hpp"
+#include "../utils/test_bytes.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/mpl/list.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include <fastformat/fastformat.hpp>
+
+namespace cpp11crypto {
+    namespace tests {
+
+        namespace {
+            const block::aes_engine all_engines[] = {
+                block::aes_engine::bitsliced,block::aes_engine::bitsliced_sse2,block::aes_engine::bitsliced_avx2,
+                block::aes_engine::aesni,block::aes_engine::vaes
+            };
+
+            /// Checks one vector on every implementation, both ways and in place
+            template <typename Cipher>
+            void check_vector(const char * const key,const char * const plain,const char * const cipher) {
+                const std::vector<std::uint8_t> k = from_hex(key), p = from_hex(plain), c = from_hex(cipher);
+                const std::size_t blocks = p.size()/16;
+                for (const block::aes_engine engine : all_engines) {
+                    if (!block::is_supported(engine)) {
+                        continue;
+                    }
+                    const Cipher aes {k,engine};
+                    BOOST_CHECK( aes.engine() == engine );
+                    std::vector<std::uint8_t> out(p.size());
+                    aes.encrypt(p.data(),out.data(),blocks);
+                    BOOST_CHECK( out == c );
+                    aes.decrypt(out.data(),out.data(),blocks);
+                    BOOST_CHECK( out == p );
+                }
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (aes_known_answers) {
+            fastformat::fmtln(std::cout,"{0}","AES known answer test starts...");
+            // FIPS 197, appendix C
+            check_vector<block::aes128>("000102030405060708090a0b0c0d0e0f","00112233445566778899aabbccddeeff",
+                                        "69c4e0d86a7b0430d8cdb78070b4c55a");
+            check_vector<block::aes192>("000102030405060708090a0b0c0d0e0f1011121314151617","00112233445566778899aabbccddeeff",
+                                        "dda97ca4864cdfe06eaf70a0ec0d7191");
+            check_vector<block::aes256>("000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f",
+                                        "00112233445566778899aabbccddeeff","8ea2b7ca516745bfeafc49904b496089");
+            // SP 800-38A, F.1.1, several blocks at once
+            check_vector<block::aes128>("2b7e151628aed2a6abf7158809cf4f3c",
+                                        "6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+                                        "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710",
+                                        "3ad77bb40d7a3660a89ecaf32466ef97f5d3d58503b9699de785895a96fdbaaf"
+                                        "43b1cd7f598ece23881b00e3ed0306887b0c785e27e8ad3f8223207104725dd4");
+        }
+
+        typedef boost::mpl::list<block::aes128,block::aes192,block::aes256> aes_ciphers;
+
+        BOOST_AUTO_TEST_CASE_TEMPLATE (aes_engines_agree, Cipher, aes_ciphers) {
+            fastformat::fmtln(std::cout,"AES-{0} on every implementation test starts...",8*Cipher::key_size);
+            boost::random::mt19937_64 generator {Cipher::key_size};
+            for (int round = 0; round != 20; ++round) {
+                const std::vector<std::uint8_t> key = random_bytes(generator,Cipher::key_size);
+                // every remainder of the 4, 8 and 16 block groups
+                const std::size_t blocks = 1+generator()%40;
+                const std::vector<std::uint8_t> plain = random_bytes(generator,16*blocks);
+                const Cipher reference {key,block::aes_engine::bitsliced};
+                std::vector<std::uint8_t> expected(plain.size());
+                reference.encrypt(plain.data(),expected.data(),blocks);
+                for (const block::aes_engine engine : all_engines) {
+                    if (!block::is_supported(engine)) {
+                        continue;
+                    }
+                    const Cipher aes {key,engine};
+                    std::vector<std::uint8_t> out(plain.size());
+                    aes.encrypt(plain.data(),out.data(),blocks);
+                    BOOST_CHECK( out == expected );
+                    aes.decrypt(out.data(),out.data(),blocks);
+                    BOOST_CHECK( out == plain );
+                }
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (aes_invalid_arguments) {
+            fastformat::fmtln(std::cout,"{0}","AES invalid arguments test starts...");
+            const std::vector<std::uint8_t> key(24);
+            BOOST_CHECK_THROW( block::aes128 {key}, std::invalid_argument );
+            BOOST_CHECK_THROW( block::aes256 {key}, std::invalid_argument );
+            BOOST_CHECK_NO_THROW( block::aes192 {key} );
+            for (const block::aes_engine engine : all_engines) {
+                if (!block::is_supported(engine)) {
+                    BOOST_CHECK_THROW( (block::aes192 {key,engine}), std::invalid_argument );
+                }
+            }
+            BOOST_CHECK( block::is_supported(block::best_aes_engine()) );
+        }
+
+    }
+}
@@ -0,0 +1,240 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License with Cpp11crypto.
+   If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// tests/block/modes.cpp - Tests block/modes.hpp
+
+#include "block/modes.hpp"
+#include "block/aes.hpp"
+#include "../utils/test_bytes.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include <fastformat/fastformat.hpp>
+
+namespace cpp11crypto {
+    namespace tests {
+
+        namespace {
+            std::vector<std::uint8_t> sequence(const std::size_t count,const unsigned step) {
+                std::vector<std::uint8_t> bytes(count);
+                for (std::size_t i = 0; i != count; ++i) {
+                    bytes[i] = static_cast<std::uint8_t>(step*i);
+                }
+                return bytes;
+            }
+
+            const block::aes_engine all_engines[] = {
+                block::aes_engine::bitsliced,block::aes_engine::bitsliced_sse2,block::aes_engine::bitsliced_avx2,
+                block::aes_engine::aesni,block::aes_engine::vaes
+            };
+
+            /// A cipher seen through encrypt and decrypt only, which keeps the modes
+            /// off its own kernels
+            template <typename Cipher>
+            struct generic_cipher {
+                static constexpr std::size_t block_size = Cipher::block_size;
+                void encrypt(const std::uint8_t * const in,std::uint8_t * const out,const std::size_t blocks) const noexcept {
+                    cipher.encrypt(in,out,blocks);
+                }
+                void decrypt(const std::uint8_t * const in,std::uint8_t * const out,const std::size_t blocks) const noexcept {
+                    cipher.decrypt(in,out,blocks);
+                }
+                const Cipher& cipher;
+            };
+
+            // SP 800-38A, appendix F
+            const char * const sp800_38a_key = "2b7e151628aed2a6abf7158809cf4f3c";
+            const char * const sp800_38a_plain = "6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+                                                 "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710";
+        }
+
+        BOOST_AUTO_TEST_CASE (ecb_cbc_known_answers) {
+            fastformat::fmtln(std::cout,"{0}","ECB and CBC known answer test starts...");
+            const std::vector<std::uint8_t> key = from_hex(sp800_38a_key), plain = from_hex(sp800_38a_plain);
+            const std::vector<std::uint8_t> iv = sequence(16,1);
+            const std::vector<std::uint8_t> ecb_cipher = from_hex("3ad77bb40d7a3660a89ecaf32466ef97f5d3d58503b9699de785895a96fdbaaf"
+                                                                  "43b1cd7f598ece23881b00e3ed0306887b0c785e27e8ad3f8223207104725dd4");
+            const std::vector<std::uint8_t> cbc_cipher = from_hex("7649abac8119b246cee98e9b12e9197d5086cb9b507219ee95db113a917678b2"
+                                                                  "73bed6b8e3c1743b7116e69e222295163ff1caa1681fac09120eca307586e1a7");
+            for (const block::aes_engine engine : all_engines) {
+                if (!block::is_supported(engine)) {
+                    continue;
+                }
+                const block::aes128 aes {key,engine};
+                std::vector<std::uint8_t> out(plain.size());
+                const block::ecb<block::aes128> ecb {aes};
+                ecb.encrypt(plain.data(),out.data(),out.size());
+                BOOST_CHECK( out == ecb_cipher );
+                ecb.decrypt(out.data(),out.data(),out.size());
+                BOOST_CHECK( out == plain );
+
+                // in two pieces, the chain carrying over
+                block::cbc<block::aes128> encryptor {aes,iv};
+                encryptor.encrypt(plain.data(),out.data(),16);
+                encryptor.encrypt(plain.data()+16,out.data()+16,48);
+                BOOST_CHECK( out == cbc_cipher );
+                block::cbc<block::aes128> decryptor {aes,iv};
+                decryptor.decrypt(out.data(),out.data(),32);
+                decryptor.decrypt(out.data()+32,out.data()+32,32);
+                BOOST_CHECK( out == plain );
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (xts_known_answers) {
+            fastformat::fmtln(std::cout,"{0}","XTS known answer test starts...");
+            // IEEE 1619, vector 4, first and last 32 bytes of a 512 byte unit
+            {
+                const block::aes128 data {from_hex("27182818284590452353602874713526")};
+                const block::aes128 tweak {from_hex("31415926535897932384626433832795")};
+                const block::xts<block::aes128> xts {data,tweak};
+                const std::vector<std::uint8_t> plain = sequence(512,1);
+                std::vector<std::uint8_t> out(plain.size());
+                xts.encrypt(0,plain.data(),out.data(),out.size());
+                BOOST_CHECK( std::vector<std::uint8_t>(out.begin(),out.begin()+32)
+                             == from_hex("27a7479befa1d476489f308cd4cfa6e2a96e4bbe3208ff25287dd3819616e89c") );
+                BOOST_CHECK( std::vector<std::uint8_t>(out.end()-32,out.end())
+                             == from_hex("eb4a427d1923ce3ff262735779a418f20a282df920147beabe421ee5319d0568") );
+                xts.decrypt(0,out.data(),out.data(),out.size());
+                BOOST_CHECK( out == plain );
+            }
+            // ciphertext stealing, from an independent implementation
+            const struct {
+                std::size_t bytes;
+                const char * cipher;
+            } vectors[] = {
+                {17,"641610679dcbf92e505c41333fb06c2a95"},
+                {20,"a8ba0048d75084603eb8423a09b7bf7595c871f6"},
+                {37,"95c871f6522469cc737109594ab0fedad44080cdbc328cddd62ea33a29b04636383a90c332"}
+            };
+            for (const block::aes_engine engine : all_engines) {
+                if (!block::is_supported(engine)) {
+                    continue;
+                }
+                const block::aes128 data {from_hex("fffefdfcfbfaf9f8f7f6f5f4f3f2f1f0"),engine};
+                const block::aes128 tweak {from_hex("bfbebdbcbbbab9b8b7b6b5b4b3b2b1b0"),engine};
+                const block::xts<block::aes128> xts {data,tweak};
+                for (const auto& v: vectors) {
+                    const std::vector<std::uint8_t> plain = sequence(v.bytes,1);
+                    std::vector<std::uint8_t> out(plain.size());
+                    xts.encrypt(0x9a78563412,plain.data(),out.data(),out.size());
+                    BOOST_CHECK( out == from_hex(v.cipher) );
+                    xts.decrypt(0x9a78563412,out.data(),out.data(),out.size());
+                    BOOST_CHECK( out == plain );
+                }
+
+                // several batches and a stolen tail, with 256-bit keys
+                const std::vector<std::uint8_t> key = sequence(64,1);
+                const block::aes256 data256 {utils::span<std::uint8_t>(key.data(),32),engine};
+                const block::aes256 tweak256 {utils::span<std::uint8_t>(key.data()+32,32),engine};
+                const block::xts<block::aes256> xts256 {data256,tweak256};
+                const std::vector<std::uint8_t> plain = sequence(16*19+11,7);
+                std::vector<std::uint8_t> out(plain.size());
+                xts256.encrypt(0xff,plain.data(),out.data(),out.size());
+                BOOST_CHECK( out == from_hex("47e955d3376327fb8da94e80b0cd9fa269af4acc94482339ef0f21a49aa59e21"
+                                             "9c6f2fe52156041d84b556ebef57f8ed506c901981722a0685f21d94f3e1a365"
+                                             "238ab3806d70493524e9cbd22d263e0a6f0ffce10a89c2e772d2a37eea85dac4"
+                                             "733d1e4e216e7ac67220e0546d817b19694c3c7302abd2e9e295717a47c7bb94"
+                                             "9d160e57f729e183e7f2b778082cb90b1f89a7b72f74e33cfd8d5fa024c6d02b"
+                                             "c7f2838defd6424bc88ef48a4a45525299c3ebdadc3100f60ea2e44de30546cd"
+                                             "2acb6f2e424363d35fd58892ae890967ed6b731ed947782dfd39980eba8b2e90"
+                                             "40d4eb2311547ad19a1ca996f25baecb7f2d63bf877e5dd2cc3bd08c1441f294"
+                                             "f64c8d5fd616696216772a900115cdf568e794ec2f245143fa3c7383d9177a80"
+                                             "3cad8c8fce4830ee69a28e80bc0bd0c4d0e847ee6680fa955e7c4e") );
+                xts256.decrypt(0xff,out.data(),out.data(),out.size());
+                BOOST_CHECK( out == plain );
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (modes_batches) {
+            fastformat::fmtln(std::cout,"{0}","Batched modes against one block at a time test starts...");
+            boost::random::mt19937_64 generator {38};
+            for (int round = 0; round != 40; ++round) {
+                const std::vector<std::uint8_t> key = random_bytes(generator,16), iv = random_bytes(generator,16);
+                // every remainder of the batches
+                const std::size_t blocks = 1+generator()%40;
+                const std::vector<std::uint8_t> plain = random_bytes(generator,16*blocks);
+                const block::aes128 aes {key};
+
+                // CBC one block per call
+                std::vector<std::uint8_t> expected(plain.size());
+                block::cbc<block::aes128> serial {aes,iv};
+                for (std::size_t i = 0; i != blocks; ++i) {
+                    serial.encrypt(plain.data()+16*i,expected.data()+16*i,16);
+                }
+                std::vector<std::uint8_t> out(plain.size());
+                block::cbc<block::aes128> {aes,iv}.encrypt(plain.data(),out.data(),out.size());
+                BOOST_CHECK( out == expected );
+                block::cbc<block::aes128> {aes,iv}.decrypt(out.data(),out.data(),out.size());
+                BOOST_CHECK( out == plain );
+
+                // XTS units with and without stolen tails
+                const block::aes128 tweak {iv};
+                const block::xts<block::aes128> xts {aes,tweak};
+                const std::size_t bytes = 16+generator()%(plain.size()-15);
+                const std::uint64_t unit = generator();
+                xts.encrypt(unit,plain.data(),out.data(),bytes);
+                xts.decrypt(unit,out.data(),out.data(),bytes);
+                BOOST_CHECK( std::equal(plain.begin(),plain.begin()+bytes,out.begin()) );
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (xts_kernels) {
+            fastformat::fmtln(std::cout,"{0}","XTS kernels against batches of the cipher test starts...");
+            boost::random::mt19937_64 generator {1619};
+            for (const block::aes_engine engine : all_engines) {
+                if (!block::is_supported(engine)) {
+                    continue;
+                }
+                const block::aes128 data {random_bytes(generator,16),engine}, tweak {random_bytes(generator,16),engine};
+                const block::xts<block::aes128> xts {data,tweak};
+                const generic_cipher<block::aes128> generic_data {data}, generic_tweak {tweak};
+                const block::xts<generic_cipher<block::aes128>> reference {generic_data,generic_tweak};
+                // every remainder of the eight and sixteen block passes, with and without a stolen tail
+                for (std::size_t bytes = 16; bytes <= 16*40+15; bytes += 1+generator()%8) {
+                    const std::vector<std::uint8_t> plain = random_bytes(generator,bytes);
+                    const std::uint64_t unit = generator();
+                    std::vector<std::uint8_t> out(bytes), expected(bytes);
+                    xts.encrypt(unit,plain.data(),out.data(),bytes);
+                    reference.encrypt(unit,plain.data(),expected.data(),bytes);
+                    BOOST_CHECK( out == expected );
+                    xts.decrypt(unit,out.data(),out.data(),bytes);
+                    BOOST_CHECK( out == plain );
+                }
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (modes_invalid_arguments) {
+            fastformat::fmtln(std::cout,"{0}","Modes invalid arguments test starts...");
+            const block::aes128 aes {std::vector<std::uint8_t>(16)};
+            std::vector<std::uint8_t> buffer(40);
+            const block::ecb<block::aes128> ecb {aes};
+            BOOST_CHECK_THROW( ecb.encrypt(buffer.data(),buffer.data(),20), std::invalid_argument );
+            BOOST_CHECK_THROW( (block::cbc<block::aes128> {aes,std::vector<std::uint8_t>(15)}), std::invalid_argument );
+            block::cbc<block::aes128> cbc {aes,std::vector<std::uint8_t>(16)};
+            BOOST_CHECK_THROW( cbc.decrypt(buffer.data(),buffer.data(),40), std::invalid_argument );
+            const block::xts<block::aes128> xts {aes,aes};
+            BOOST_CHECK_THROW( xts.encrypt(0,buffer.data(),buffer.data(),15), std::invalid_argument );
+            BOOST_CHECK_NO_THROW( xts.encrypt(0,buffer.data(),buffer.data(),17) );
+        }
+
+    }
+}
@@ -0,0 +1,51 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License with Cpp11crypto.
+   If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// tests/core/bump_arena.cpp - Tests core/bump_arena.hpp
+
+#include "core/bump_arena.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <cstdint>
+#include <new>
+#include <fastformat/fastformat.hpp>
+
+namespace cpp11crypto {
+    namespace tests {
+
+        BOOST_AUTO_TEST_CASE (bump_arena_scopes) {
+            fastformat::fmtln(std::cout,"{0}","Bump arena test starts...");
+            core::bump_arena<std::uint64_t> arena {10};
+            BOOST_CHECK( 10 == arena.capacity() );
+            std::uint64_t * const first = arena.allocate(4);
+            {
+                const core::bump_arena<std::uint64_t>::scope frame {arena};
+                std::uint64_t * const second = arena.allocate(6);
+                BOOST_CHECK( second == first+4 );
+                BOOST_CHECK( 10 == arena.size() );
+                BOOST_CHECK_THROW( arena.allocate(1), std::bad_alloc );
+            }
+            // blocks of a closed scope are reused
+            BOOST_CHECK( 4 == arena.size() );
+            BOOST_CHECK( arena.allocate(6) == first+4 );
+            BOOST_CHECK_NO_THROW( arena.allocate(0) );
+        }
+
+    }
+}
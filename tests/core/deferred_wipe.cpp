@@ -0,0 +1,193 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License with Cpp11crypto.
+   If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// tests/core/deferred_wipe.cpp - Tests core/deferred_wipe.hpp
+
+#include "core/deferred_wipe.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include <array>
+#include <memory>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <fastformat/fastformat.hpp>
+
+namespace cpp11crypto {
+    namespace tests {
+
+        namespace {
+            /// Base operator checking that every block it gets back is already wiped
+            struct release_checker {
+                static std::atomic<unsigned> released;
+                static std::atomic<unsigned> dirty;
+
+                static void *get_new(const std::size_t size) {
+                    return ::operator new(size);
+                }
+                static void do_delete(void * const p,const std::size_t size) {
+                    const auto bytes = static_cast<const std::uint8_t *>(p);
+                    if (!std::all_of(bytes,bytes+size,[](std::uint8_t c) {
+                    return 0 == c;
+                })) {
+                        ++dirty;
+                    }
+                    ++released;
+                    ::operator delete(p);
+                }
+                static void *get_new_array(const std::size_t size) {
+                    return get_new(size);
+                }
+                static void do_delete_array(void * const p,const std::size_t size) {
+                    do_delete(p,size);
+                }
+            };
+            std::atomic<unsigned> release_checker::released {0};
+            std::atomic<unsigned> release_checker::dirty {0};
+
+            template <std::size_t N>
+            class DeferredKey : public core::ZeroizingBase<core::deferred<release_checker>> {
+            public:
+                DeferredKey() {
+                    key.fill(0xa5);
+                }
+                std::array<std::uint8_t,N> key;
+            };
+        }
+
+        BOOST_AUTO_TEST_CASE (deferred_wipe_base_class) {
+            static_assert(core::defers_wipe<core::deferred<>>::value,"deferred operator must defer");
+            static_assert(!core::defers_wipe<core::standard>::value,"standard operator must not defer");
+
+            auto& quarantine = core::wipe_quarantine::instance();
+            quarantine.flush();
+            const auto before = quarantine.statistics();
+            release_checker::released = 0;
+            {
+                std::vector<std::unique_ptr<DeferredKey<32>>> small;
+                for (auto i = 0u; i != 100u; ++i) {
+                    small.emplace_back(new DeferredKey<32>());
+                }
+                std::unique_ptr<DeferredKey<5*4096>> large {new DeferredKey<5*4096>()};
+                std::unique_ptr<DeferredKey<64>[]> array {new DeferredKey<64>[4]};
+            }
+            const auto during = quarantine.statistics();
+            fastformat::fmtln(std::cout,"Quarantine depth {0} blocks, {1} bytes, {2} protected",
+                              during.depth_blocks,during.depth_bytes,during.protected_bytes);
+            // the large object spans whole pages that must be unreadable by now
+            BOOST_CHECK( during.protected_bytes >= 3*4096 || 0 == during.depth_blocks );
+
+            quarantine.flush();
+            const auto after = quarantine.statistics();
+            BOOST_CHECK( 0 == after.depth_blocks && 0 == after.depth_bytes && 0 == after.protected_bytes );
+            BOOST_CHECK( 102 == release_checker::released );
+            BOOST_CHECK( 0 == release_checker::dirty );
+            BOOST_CHECK( after.wiped_bytes >= before.wiped_bytes + 100*32 + 5*4096 + 4*64 );
+            fastformat::fmtln(std::cout,"Wiped {0} bytes in {1} batches",after.wiped_bytes,after.batches);
+        }
+
+        BOOST_AUTO_TEST_CASE (deferred_wipe_allocator) {
+            using allocator = core::allocator<std::uint64_t,core::deferred_over<>::allocator>;
+            auto& quarantine = core::wipe_quarantine::instance();
+            const auto before = quarantine.statistics();
+            {
+                std::vector<std::uint64_t,allocator> data;
+                for (auto i = 0u; i != 10000u; ++i) {
+                    data.push_back(i);
+                }
+                // a destroyed element is wiped at once, although its block stays allocated
+                data.push_back(~std::uint64_t {0});
+                const std::uint64_t * const last = &data.back();
+                data.pop_back();
+                const auto bytes = reinterpret_cast<const std::uint8_t *>(last);
+                BOOST_CHECK( std::all_of(bytes,bytes+sizeof *last,[](std::uint8_t c) {
+                    return 0 == c;
+                }) );
+            }
+            quarantine.flush();
+            const auto after = quarantine.statistics();
+            BOOST_CHECK( after.wiped_bytes >= before.wiped_bytes + 10000*sizeof(std::uint64_t) );
+            BOOST_CHECK( 0 == after.depth_blocks );
+        }
+
+        BOOST_AUTO_TEST_CASE (deferred_wipe_allocator_on_arena) {
+            using allocator = core::allocator<std::uint64_t,core::deferred_over<core::secure_arena_allocator>::allocator>;
+            auto& quarantine = core::wipe_quarantine::instance();
+            quarantine.flush();
+            const auto before = core::secure_arena::instance().statistics();
+            {
+                std::vector<std::uint64_t,allocator> data;
+                for (auto i = 0u; i != 100u; ++i) {
+                    data.push_back(i);
+                }
+                BOOST_CHECK( core::secure_arena::instance().statistics().in_use_bytes > before.in_use_bytes );
+            }
+            // the blocks go back to the arena once the quarantine has wiped them
+            quarantine.flush();
+            BOOST_CHECK( core::secure_arena::instance().statistics().in_use_bytes == before.in_use_bytes );
+        }
+
+        BOOST_AUTO_TEST_CASE (deferred_wipe_bound) {
+            auto& quarantine = core::wipe_quarantine::instance();
+            quarantine.flush();
+            quarantine.set_limit(10*32);
+            const auto before = quarantine.statistics();
+            release_checker::released = 0;
+            {
+                std::vector<std::unique_ptr<DeferredKey<32>>> small;
+                for (auto i = 0u; i != 100u; ++i) {
+                    small.emplace_back(new DeferredKey<32>());
+                }
+            }
+            const auto after = quarantine.statistics();
+            BOOST_CHECK( after.max_depth_bytes <= std::max<std::uint64_t>(before.max_depth_bytes,10*32) );
+            BOOST_CHECK( after.synchronous_wipes > before.synchronous_wipes );
+            quarantine.flush();
+            quarantine.set_limit(std::size_t {64} << 20);
+            BOOST_CHECK( 100 == release_checker::released );
+            BOOST_CHECK( 0 == release_checker::dirty );
+            fastformat::fmtln(std::cout,"Wipe throughput {0} MB/s",
+                              static_cast<unsigned long>(quarantine.statistics().wipe_throughput()/1e6));
+        }
+
+        BOOST_AUTO_TEST_CASE (deferred_wipe_capacity) {
+            auto& quarantine = core::wipe_quarantine::instance();
+            quarantine.flush();
+            // far below the byte limit, but more blocks than the quarantine holds
+            quarantine.set_batch(std::size_t {64} << 20);
+            const auto before = quarantine.statistics();
+            release_checker::released = 0;
+            {
+                std::vector<std::unique_ptr<DeferredKey<32>>> small;
+                for (auto i = 0u; i != 10000u; ++i) {
+                    small.emplace_back(new DeferredKey<32>());
+                }
+            }
+            const auto after = quarantine.statistics();
+            BOOST_CHECK( after.synchronous_wipes > before.synchronous_wipes );
+            quarantine.flush();
+            quarantine.set_batch(std::size_t {1} << 20);
+            BOOST_CHECK( 10000 == release_checker::released );
+            BOOST_CHECK( 0 == release_checker::dirty );
+        }
+
+    }
+
+}
@@ -0,0 +1,143 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License with Cpp11crypto.
+   If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// tests/core/secure_arena.cpp - Tests core/secure_arena.hpp
+
+#include "core/secure_arena.hpp"
+#include "core/zeroizing.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <boost/mpl/list.hpp>
+#include <vector>
+#include <list>
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <fastformat/fastformat.hpp>
+
+#include <libcwd/type_info.h>
+
+namespace cpp11crypto {
+    namespace tests {
+
+        using arena_list = boost::mpl::list<
+                           std::uint8_t,
+                           std::uint16_t,
+                           std::uint32_t,
+                           std::uint64_t
+                           >;
+
+        BOOST_AUTO_TEST_CASE_TEMPLATE (secure_arena_containers, T, arena_list ) {
+            fastformat::fmtln(std::cout,"Secure arena test on {0}:{1} starts...",
+                              libcwd::type_info_of<T>().demangled_name(),
+                              8*sizeof(T));
+
+            using allocator = core::allocator<T,core::secure_arena_allocator>;
+            const auto before = core::secure_arena::instance().statistics();
+            {
+                std::mt19937 generator;
+                std::uniform_int_distribution<T> distributor;
+                std::vector<T,allocator> data;
+                std::list<T,allocator> nodes;
+                for (auto i = 0u; i != 1000u; ++i) {
+                    data.push_back(distributor(generator));
+                    nodes.push_back(distributor(generator));
+                }
+                BOOST_CHECK( data.size() == nodes.size() );
+            }
+            const auto after = core::secure_arena::instance().statistics();
+            fastformat::fmtln(std::cout,"Hits {0}, misses {1}, resident {2} bytes",
+                              after.hits,after.misses,after.resident_bytes);
+            BOOST_CHECK( after.hits > before.hits );
+            BOOST_CHECK( after.in_use_bytes == before.in_use_bytes );
+            BOOST_CHECK( after.resident_bytes >= core::secure_arena::region_bytes );
+        }
+
+        BOOST_AUTO_TEST_CASE (secure_arena_reuse_is_wiped) {
+            auto& arena = core::secure_arena::instance();
+            for (std::size_t bytes = 1; bytes <= core::secure_arena::max_block; bytes = 2*bytes+1) {
+                auto * const first = static_cast<std::uint8_t *>(arena.allocate(bytes));
+                BOOST_CHECK( 0 == reinterpret_cast<std::uintptr_t>(first) % core::secure_arena::min_block );
+                std::fill_n(first,bytes,0xa5);
+                arena.deallocate(first,bytes);
+
+                const auto hits = arena.statistics().hits;
+                auto * const second = static_cast<std::uint8_t *>(arena.allocate(bytes));
+                BOOST_CHECK( first == second );
+                BOOST_CHECK( hits+1 == arena.statistics().hits );
+                BOOST_CHECK( std::all_of(second,second+bytes,[](std::uint8_t c) {
+                    return 0 == c;
+                }) );
+                arena.deallocate(second,bytes);
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (secure_arena_region_rest) {
+            fastformat::fmtln(std::cout,"{0}","Secure arena region rest test starts...");
+            auto& arena = core::secure_arena::instance();
+            const std::size_t large = core::secure_arena::max_block, small = large/2;
+            std::vector<std::pair<void *,std::size_t>> held;
+            const auto allocate = [&](const std::size_t bytes) {
+                held.emplace_back(arena.allocate(bytes),bytes);
+                return static_cast<std::uint8_t *>(held.back().first);
+            };
+            // empty the free list of the largest class, up to the start of a new region
+            std::uint64_t misses = arena.statistics().misses;
+            std::uint8_t * base = allocate(large);
+            while (misses == arena.statistics().misses) {
+                base = allocate(large);
+            }
+            // one half block from that region leaves half a block at its end
+            std::uint8_t * half = allocate(small);
+            while (half != base+large) {
+                half = allocate(small);
+            }
+            misses = arena.statistics().misses;
+            while (misses == arena.statistics().misses) {
+                allocate(large);
+            }
+            // the rest went to the free list of its class
+            misses = arena.statistics().misses;
+            BOOST_CHECK( base+core::secure_arena::region_bytes-small == allocate(small) );
+            BOOST_CHECK( misses == arena.statistics().misses );
+            for (const auto& block : held) {
+                arena.deallocate(block.first,block.second);
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (secure_arena_large_blocks) {
+            auto& arena = core::secure_arena::instance();
+            const auto before = arena.statistics();
+            const std::size_t bytes = 3*core::secure_arena::max_block+5;
+            auto * const p = static_cast<std::uint8_t *>(arena.allocate(bytes));
+            std::fill_n(p,bytes,0xa5);
+            const auto during = arena.statistics();
+            BOOST_CHECK( during.misses == before.misses+1 );
+            BOOST_CHECK( during.resident_bytes >= before.resident_bytes+bytes );
+            arena.deallocate(p,bytes);
+            BOOST_CHECK( arena.statistics().resident_bytes == before.resident_bytes );
+            BOOST_CHECK( arena.statistics().in_use_bytes == before.in_use_bytes );
+            fastformat::fmtln(std::cout,"Unlocked mappings so far: {0}",arena.statistics().unlocked_mappings);
+        }
+
+    }
+
+}
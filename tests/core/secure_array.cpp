@@ -0,0 +1,102 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License with Cpp11crypto.
+   If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// tests/core/secure_array.cpp - Tests core/secure_array.hpp
+
+#include "core/secure_array.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <boost/mpl/list.hpp>
+#include <array>
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include <fastformat/fastformat.hpp>
+
+#include <libcwd/type_info.h>
+
+namespace cpp11crypto {
+    namespace tests {
+
+        using secure_array_list = boost::mpl::list<
+                                  core::secure_array<std::uint8_t,16>,
+                                  core::secure_array<std::uint32_t,11>,
+                                  core::secure_array<std::uint64_t,4,64>,
+                                  core::secure_buffer<32>
+                                  >;
+
+        namespace {
+            template <typename A>
+            bool all_zero_bytes(const void * const p) {
+                const auto bytes = static_cast<const std::uint8_t *>(p);
+                return std::all_of(bytes,bytes+A::bytes(),[](std::uint8_t c) {
+                    return 0 == c;
+                });
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE_TEMPLATE (secure_array_lifetime, A, secure_array_list ) {
+            fastformat::fmtln(std::cout,"Secure array test on {0} starts...",
+                              libcwd::type_info_of<A>().demangled_name());
+            using T = typename A::value_type;
+
+            // size is usable at compile time
+            std::array<char,A::size()> same_size;
+            BOOST_CHECK( same_size.size() == A::size() );
+            BOOST_CHECK( 0 == reinterpret_cast<std::uintptr_t>(A().data()) % alignof(A) );
+
+            // wiped on destruction
+            typename std::aligned_storage<sizeof(A),alignof(A)>::type storage;
+            A * const a = new(&storage) A();
+            a->fill(static_cast<T>(0xa5));
+            BOOST_CHECK( !all_zero_bytes<A>(a->data()) );
+            a->~A();
+            BOOST_CHECK( all_zero_bytes<A>(&storage) );
+
+            // wiped when moved from, copies are independent
+            A source;
+            std::iota(source.begin(),source.end(),T {1});
+            const A copy {source};
+            BOOST_CHECK( copy == source );
+            A target {std::move(source)};
+            BOOST_CHECK( target == copy );
+            BOOST_CHECK( all_zero_bytes<A>(source.data()) );
+            A assigned;
+            assigned = std::move(target);
+            BOOST_CHECK( assigned == copy );
+            BOOST_CHECK( all_zero_bytes<A>(target.data()) );
+            BOOST_CHECK( assigned != target );
+        }
+
+        BOOST_AUTO_TEST_CASE (secure_array_access) {
+            core::secure_array<std::uint16_t,4> a {1,2,3};
+            BOOST_CHECK( 1 == a[0] && 2 == a.at(1) && 3 == a[2] && 0 == a[3] );
+            BOOST_CHECK_THROW( a.at(4), std::out_of_range );
+            static_assert(std::is_nothrow_move_constructible<core::secure_buffer<16>>::value,
+                          "moves must not throw");
+            static_assert(16 == alignof(core::secure_buffer<7>),"buffers are vector aligned");
+        }
+
+    }
+
+}
@@ -0,0 +1,155 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License with Cpp11crypto.
+   If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// tests/core/secure_pool.cpp - Tests core/secure_pool.hpp
+
+#include "core/secure_pool.hpp"
+#include "core/zeroizing.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <boost/mpl/list.hpp>
+#include <vector>
+#include <set>
+#include <thread>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <fastformat/fastformat.hpp>
+
+#include <libcwd/type_info.h>
+
+namespace cpp11crypto {
+    namespace tests {
+
+        namespace {
+            template <std::size_t N>
+            class PooledKey : public core::ZeroizingBase<core::thread_cached> {
+            public:
+                PooledKey() {
+                    std::fill(key.begin(),key.end(),0xa5);
+                }
+                std::array<std::uint8_t,N> key;
+            };
+
+            /// Checks that freshly allocated storage reads as zero
+            class Probe : public core::ZeroizingBase<core::thread_cached> {
+            public:
+                static void *operator new(const std::size_t size) {
+                    void * const p = core::ZeroizingBase<core::thread_cached>::operator new(size);
+                    const auto bytes = static_cast<const std::uint8_t *>(p);
+                    clean = clean && std::all_of(bytes,bytes+size,[](std::uint8_t c) {
+                        return 0 == c;
+                    });
+                    return p;
+                }
+                std::array<std::uint8_t,48> data {{}};
+                static bool clean;
+            };
+            bool Probe::clean = true;
+
+            /// Frees its object from a thread_local destructor, which runs after the
+            /// magazine of the thread is gone when it was constructed before it
+            struct LateOwner {
+                ~LateOwner() {
+                    given_before = core::secure_pool::instance().statistics().batches_given;
+                    object.reset();
+                    given_after = core::secure_pool::instance().statistics().batches_given;
+                    // allocating is still possible, also straight from the shared pool
+                    object.reset(new PooledKey<32>());
+                    object.reset();
+                }
+                std::unique_ptr<PooledKey<32>> object;
+                static std::uint64_t given_before;
+                static std::uint64_t given_after;
+            };
+            std::uint64_t LateOwner::given_before = 0;
+            std::uint64_t LateOwner::given_after = 0;
+
+            typedef boost::mpl::list<PooledKey<16>,PooledKey<32>,PooledKey<200>,PooledKey<5000>> pooled_list;
+        }
+
+        BOOST_AUTO_TEST_CASE_TEMPLATE (secure_pool_single_thread, T, pooled_list ) {
+            fastformat::fmtln(std::cout,"Secure pool test on {0} starts...",
+                              libcwd::type_info_of<T>().demangled_name());
+            std::vector<std::unique_ptr<T>> objects;
+            for (auto i = 0u; i != 500u; ++i) {
+                objects.emplace_back(new T());
+            }
+            std::set<const T *> addresses;
+            for (const auto& o : objects) {
+                addresses.insert(o.get());
+            }
+            BOOST_CHECK( addresses.size() == objects.size() );
+            objects.clear();
+            for (auto i = 0u; i != 500u; ++i) {
+                std::unique_ptr<Probe> probe {new Probe()};
+                probe->data.fill(0xa5);
+            }
+            BOOST_CHECK( Probe::clean );
+            fastformat::fmtln(std::cout,"Secure pool test on {0} complete.",
+                              libcwd::type_info_of<T>().demangled_name());
+        }
+
+        BOOST_AUTO_TEST_CASE (secure_pool_threads) {
+            const auto before = core::secure_pool::instance().statistics();
+            std::vector<std::thread> threads;
+            for (auto t = 0u; t != 8u; ++t) {
+                threads.emplace_back([]() {
+                    std::vector<std::unique_ptr<PooledKey<32>>> objects;
+                    for (auto round = 0u; round != 20u; ++round) {
+                        for (auto i = 0u; i != 300u; ++i) {
+                            objects.emplace_back(new PooledKey<32>());
+                        }
+                        objects.resize(objects.size()/2);
+                    }
+                });
+            }
+            for (auto& t : threads) {
+                t.join();
+            }
+            const auto after = core::secure_pool::instance().statistics();
+            fastformat::fmtln(std::cout,"Carved {0}, taken {1}, given {2}",
+                              after.carved_blocks,after.batches_taken,after.batches_given);
+            BOOST_CHECK( after.carved_blocks > before.carved_blocks );
+            // threads hand their magazines back when they end
+            BOOST_CHECK( after.batches_given > before.batches_given );
+
+            // and those batches are reused instead of carving new ones
+            std::thread reuse([]() {
+                std::unique_ptr<PooledKey<32>> object {new PooledKey<32>()};
+            });
+            reuse.join();
+            BOOST_CHECK( core::secure_pool::instance().statistics().carved_blocks == after.carved_blocks );
+        }
+
+        BOOST_AUTO_TEST_CASE (secure_pool_thread_exit) {
+            std::thread late([]() {
+                static thread_local LateOwner owner;
+                // the magazine is constructed here, after owner, so it is destroyed first
+                owner.object.reset(new PooledKey<32>());
+            });
+            late.join();
+            // the block went straight back to the shared pool
+            BOOST_CHECK( LateOwner::given_after == LateOwner::given_before+1 );
+        }
+
+    }
+
+}
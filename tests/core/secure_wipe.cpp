@@ -0,0 +1,97 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License with Cpp11crypto.
+   If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// tests/core/secure_wipe.cpp - Tests core/secure_wipe.hpp
+
+#include "core/secure_wipe.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <fastformat/fastformat.hpp>
+
+namespace cpp11crypto {
+    namespace tests {
+
+        namespace {
+            constexpr std::uint8_t canary = 0xa5;
+            constexpr std::size_t guard = 80;
+
+            /// Wipes every [offset,offset+len) window inside a canary filled buffer
+            /// @return true if exactly the window was wiped
+            bool wipes_exactly(const core::wipe_engine engine,const std::size_t offset,const std::size_t len) {
+                std::vector<std::uint8_t> buffer(offset+len+guard,canary);
+                core::secure_wipe(buffer.data()+offset,len,engine);
+                const auto first = buffer.begin()+offset;
+                const auto last = first+len;
+                return std::all_of(buffer.begin(),first,[](std::uint8_t c) {
+                    return canary == c;
+                }) && std::all_of(first,last,[](std::uint8_t c) {
+                    return 0 == c;
+                }) && std::all_of(last,buffer.end(),[](std::uint8_t c) {
+                    return canary == c;
+                });
+            }
+
+            const core::wipe_engine all_engines[] = {
+                core::wipe_engine::scalar,core::wipe_engine::sse2,
+                core::wipe_engine::avx2,core::wipe_engine::avx512
+            };
+        }
+
+        BOOST_AUTO_TEST_CASE (secure_wipe_windows) {
+            for (const auto engine : all_engines) {
+                if (!core::is_supported(engine)) {
+                    fastformat::fmtln(std::cout,"Wipe engine {0} not supported, skipped",static_cast<int>(engine));
+                    continue;
+                }
+                fastformat::fmtln(std::cout,"Wipe engine {0} test starts...",static_cast<int>(engine));
+                bool ok = true;
+                for (std::size_t offset = 0; offset != 64; ++offset) {
+                    for (std::size_t len = 0; len != 600; ++len) {
+                        ok = ok && wipes_exactly(engine,offset,len);
+                    }
+                }
+                for (const std::size_t len : {4095u,4096u,65537u,1u<<20}) {
+                    ok = ok && wipes_exactly(engine,3,len);
+                }
+                BOOST_CHECK( ok );
+                fastformat::fmtln(std::cout,"Wipe engine {0} test complete.",static_cast<int>(engine));
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (secure_wipe_default) {
+            fastformat::fmtln(std::cout,"Best wipe engine is {0}",static_cast<int>(core::best_wipe_engine()));
+            BOOST_CHECK( core::is_supported(core::best_wipe_engine()) );
+            BOOST_CHECK( core::wipe_engine::scalar == core::best_wipe_engine(core::vector_wipe_limit) );
+            // both sides of the switch to memset
+            for (const std::size_t len : {std::size_t {998},core::vector_wipe_limit-1,core::vector_wipe_limit+1}) {
+                std::vector<std::uint8_t> buffer(len+2,canary);
+                core::secure_wipe(buffer.data()+1,len);
+                BOOST_CHECK( canary == buffer.front() && canary == buffer.back() );
+                BOOST_CHECK( std::all_of(buffer.begin()+1,buffer.end()-1,[](std::uint8_t c) {
+                    return 0 == c;
+                }) );
+            }
+        }
+
+    }
+
+}
@@ -0,0 +1,185 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License with Cpp11crypto.
+   If not, see <http://www.gnu.org/licenses/>.
+**/
+
+
+// tests/hash/sha2.cpp - Tests hash/sha2.hpp
+
+#include "hash/sha2.hpp"
+#include "../utils/test_bytes.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fastformat/fastformat.hpp>
+
+namespace cpp11crypto {
+    namespace tests {
+
+        namespace {
+            struct known_answer {
+                std::string message;
+                const char * sha256;
+                const char * sha512;
+            };
+
+            // FIPS 180-4 examples, and a million times 'a'
+            const known_answer known_answers[] = {
+                {"",
+                 "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855",
+                 "cf83e1357eefb8bdf1542850d66d8007d620e4050b5715dc83f4a921d36ce9ce"
+                 "47d0d13c5d85f2b0ff8318d2877eec2f63b931bd47417a81a538327af927da3e"},
+                {"abc",
+                 "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",
+                 "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"
+                 "2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f"},
+                {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+                 "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1",
+                 "204a8fc6dda82f0a0ced7beb8e08a41657c16ef468b228a8279be331a703c335"
+                 "96fd15c13b1b07f9aa1d3bea57789ca031ad85c7a71dd70354ec631238ca3445"},
+                {"abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu",
+                 "cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1",
+                 "8e959b75dae313da8cf4f72814fc143f8f7779c6eb9f7fa17299aeadb6889018"
+                 "501d289e4900f7e4331b99dec4b5433ac7d329eeb6dd26545e96e55b874be909"},
+                {std::string(1000000,'a'),
+                 "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0",
+                 "e718483d0ce769644e2e42c7bc15b4638e1f98b13b2044285632a803afa973eb"
+                 "de0ff244877ea60a4cb0432ce577c31beb009c5c2c49aa2e4eadb217ad8cc09b"}
+            };
+
+            const hash::multi_engine all_multi_engines[] = {
+                hash::multi_engine::scalar,hash::multi_engine::sse2,hash::multi_engine::avx2,
+                hash::multi_engine::avx512
+            };
+
+            template <typename Hash>
+            std::vector<std::uint8_t> digest_of(const std::vector<std::uint8_t>& message,
+                                                const hash::sha_engine engine = hash::sha_engine::scalar) {
+                std::vector<std::uint8_t> digest(Hash::digest_size);
+                Hash::digest(message.data(),message.size(),digest.data(),engine);
+                return digest;
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (sha2_known_answers) {
+            fastformat::fmtln(std::cout,"{0}","SHA-2 known answer test starts...");
+            for (const known_answer& answer : known_answers) {
+                const std::vector<std::uint8_t> message(answer.message.begin(),answer.message.end());
+                for (const hash::sha_engine engine : {hash::sha_engine::scalar,hash::sha_engine::shani}) {
+                    if (!hash::is_supported(engine)) {
+                        continue;
+                    }
+                    BOOST_CHECK(digest_of<hash::sha256>(message,engine) == from_hex(answer.sha256));
+                }
+                BOOST_CHECK(digest_of<hash::sha512>(message) == from_hex(answer.sha512));
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (sha2_engines) {
+            fastformat::fmtln(std::cout,"{0}","SHA-2 implementations test starts...");
+            BOOST_CHECK_THROW(hash::sha512 {hash::sha_engine::shani},std::invalid_argument);
+            BOOST_CHECK(hash::sha_engine::scalar == hash::sha512::best_engine());
+            BOOST_CHECK(hash::best_sha_engine() == hash::sha256::best_engine());
+            if (!hash::is_supported(hash::sha_engine::shani)) {
+                BOOST_CHECK_THROW(hash::sha256 {hash::sha_engine::shani},std::invalid_argument);
+                return;
+            }
+            boost::random::mt19937_64 generator {11};
+            for (std::size_t bytes = 0; bytes != 300; ++bytes) {
+                const std::vector<std::uint8_t> message = random_bytes(generator,bytes);
+                BOOST_CHECK(digest_of<hash::sha256>(message,hash::sha_engine::shani) == digest_of<hash::sha256>(message));
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (sha2_pieces) {
+            fastformat::fmtln(std::cout,"{0}","SHA-2 incremental hashing test starts...");
+            boost::random::mt19937_64 generator {12};
+            const std::vector<std::uint8_t> message = random_bytes(generator,2000);
+            const std::vector<std::uint8_t> expected256 = digest_of<hash::sha256>(message);
+            const std::vector<std::uint8_t> expected512 = digest_of<hash::sha512>(message);
+            hash::sha256 sha256;
+            hash::sha512 sha512;
+            std::vector<std::uint8_t> digest256(hash::sha256::digest_size), digest512(hash::sha512::digest_size);
+            // the same objects hash the message again and again, in random pieces
+            for (unsigned round = 0; round != 20; ++round) {
+                for (std::size_t done = 0; done != message.size();) {
+                    const std::size_t n = std::min<std::size_t>(generator()%300,message.size()-done);
+                    sha256.update(message.data()+done,n);
+                    sha512.update(message.data()+done,n);
+                    done += n;
+                }
+                sha256.finalize(digest256.data());
+                sha512.finalize(digest512.data());
+                BOOST_CHECK(expected256 == digest256);
+                BOOST_CHECK(expected512 == digest512);
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (sha2_multi_buffer) {
+            fastformat::fmtln(std::cout,"{0}","SHA-2 multi-buffer test starts...");
+            boost::random::mt19937_64 generator {13};
+            // lengths around the one and two-block paddings, and a few long ones
+            std::vector<std::vector<std::uint8_t>> messages;
+            for (std::size_t bytes = 0; bytes != 260; ++bytes) {
+                messages.push_back(random_bytes(generator,bytes));
+            }
+            for (std::size_t bytes : {1000,5000,20000}) {
+                messages.push_back(random_bytes(generator,bytes));
+            }
+            std::vector<utils::span<std::uint8_t>> spans;
+            std::vector<std::uint8_t> expected256, expected512;
+            for (const std::vector<std::uint8_t>& message : messages) {
+                spans.push_back(utils::make_span(message.data(),message.size()));
+                const std::vector<std::uint8_t> digest256 = digest_of<hash::sha256>(message);
+                const std::vector<std::uint8_t> digest512 = digest_of<hash::sha512>(message);
+                expected256.insert(expected256.end(),digest256.begin(),digest256.end());
+                expected512.insert(expected512.end(),digest512.begin(),digest512.end());
+            }
+            for (const hash::multi_engine engine : all_multi_engines) {
+                if (!hash::is_supported(engine)) {
+                    continue;
+                }
+                if (hash::multi_engine::scalar == engine) {
+                    BOOST_CHECK_EQUAL(1u,hash::multi_lanes<hash::sha256>(engine));
+                    BOOST_CHECK_EQUAL(1u,hash::multi_lanes<hash::sha512>(engine));
+                } else {
+                    BOOST_CHECK_EQUAL(utils::lane_bytes(engine)/4,hash::multi_lanes<hash::sha256>(engine));
+                    BOOST_CHECK_EQUAL(utils::lane_bytes(engine)/8,hash::multi_lanes<hash::sha512>(engine));
+                }
+                // every count up to a few groups of lanes, then all of them
+                for (std::size_t count : {std::size_t(1),std::size_t(3),std::size_t(17),std::size_t(40),spans.size()}) {
+                    std::vector<std::uint8_t> digests256(count*hash::sha256::digest_size);
+                    std::vector<std::uint8_t> digests512(count*hash::sha512::digest_size);
+                    hash::multi_sha256(spans.data()+spans.size()-count,digests256.data(),count,engine);
+                    hash::multi_sha512(spans.data()+spans.size()-count,digests512.data(),count,engine);
+                    BOOST_CHECK(std::equal(digests256.begin(),digests256.end(),expected256.end()-digests256.size()));
+                    BOOST_CHECK(std::equal(digests512.begin(),digests512.end(),expected512.end()-digests512.size()));
+                }
+            }
+            BOOST_CHECK(hash::is_supported(hash::best_multi_sha256_engine()));
+            std::vector<std::uint8_t> digests(spans.size()*hash::sha256::digest_size);
+            hash::multi_sha256(spans.data(),digests.data(),spans.size());
+            BOOST_CHECK(expected256 == digests);
+        }
+
+    }
+}
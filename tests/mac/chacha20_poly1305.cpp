@@ -0,0 +1,188 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License with Cpp11crypto.
+   If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// tests/mac/chacha20_poly1305.cpp - Tests mac/poly1305.hpp and mac/chacha20_poly1305.hpp
+
+#include "mac/chacha20_poly1305.hpp"
+#include "mac/poly1305.hpp"
+#include "../utils/test_bytes.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fastformat/fastformat.hpp>
+
+namespace cpp11crypto {
+    namespace tests {
+
+        namespace {
+            std::vector<std::uint8_t> counting(const std::size_t count,const unsigned first,const unsigned step) {
+                std::vector<std::uint8_t> bytes(count);
+                for (std::size_t i = 0; i != count; ++i) {
+                    bytes[i] = static_cast<std::uint8_t>(first+step*i);
+                }
+                return bytes;
+            }
+
+            const stream::chacha_engine all_engines[] = {
+                stream::chacha_engine::scalar,stream::chacha_engine::sse2,stream::chacha_engine::avx2,
+                stream::chacha_engine::avx512
+            };
+            const mac::poly1305_engine all_hashes[] = {
+                mac::poly1305_engine::scalar,mac::poly1305_engine::avx2
+            };
+
+            /// Tag of a message added in pieces of the given length
+            std::vector<std::uint8_t> tag(const std::vector<std::uint8_t>& key,const std::vector<std::uint8_t>& message,
+                                          const mac::poly1305_engine engine,const std::size_t piece) {
+                mac::poly1305 poly {key,engine};
+                for (std::size_t done = 0; done != message.size();) {
+                    const std::size_t n = std::min(piece,message.size()-done);
+                    poly.update(message.data()+done,n);
+                    done += n;
+                }
+                std::vector<std::uint8_t> result(mac::poly1305::tag_size);
+                poly.finalize(result.data());
+                return result;
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (poly1305_known_answers) {
+            fastformat::fmtln(std::cout,"{0}","Poly1305 known answer test starts...");
+            const std::string text = "Cryptographic Forum Research Group";
+            for (const mac::poly1305_engine engine : all_hashes) {
+                if (!mac::is_supported(engine)) {
+                    continue;
+                }
+                for (const std::size_t piece : {1,5,16,64,4096}) {
+                    // RFC 8439, 2.5.2
+                    BOOST_CHECK(from_hex("a8061dc1305136c6c22b8baf0c0127a9")
+                                == tag(from_hex("85d6be7857556d337f4452fe42d506a80103808afb0db2fd4abff6af4149f51b"),
+                                       std::vector<std::uint8_t>(text.begin(),text.end()),engine,piece));
+                    // from an independent implementation: long enough for the vector code,
+                    // and with the largest limbs
+                    BOOST_CHECK(from_hex("caed11d54a760ea1bdc6d02a56566757")
+                                == tag(counting(32,5,13),counting(1000,7,31),engine,piece));
+                    BOOST_CHECK(from_hex("beca435411b886820a62efed859587a2")
+                                == tag(std::vector<std::uint8_t>(32,0xff),std::vector<std::uint8_t>(2000,0xff),engine,piece));
+                }
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (poly1305_engines_agree) {
+            fastformat::fmtln(std::cout,"{0}","Poly1305 engine consistency test starts...");
+            boost::random::mt19937_64 generator {26};
+            for (const std::size_t bytes : {0,1,63,64,127,128,129,1023,1024,5000}) {
+                const std::vector<std::uint8_t> key = random_bytes(generator,32), message = random_bytes(generator,bytes);
+                const std::vector<std::uint8_t> expected = tag(key,message,mac::poly1305_engine::scalar,bytes+1);
+                for (const mac::poly1305_engine engine : all_hashes) {
+                    if (mac::is_supported(engine)) {
+                        BOOST_CHECK(expected == tag(key,message,engine,bytes+1));
+                        BOOST_CHECK(expected == tag(key,message,engine,200));
+                    }
+                }
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (chacha20_poly1305_known_answers) {
+            fastformat::fmtln(std::cout,"{0}","ChaCha20-Poly1305 known answer test starts...");
+            const std::string text = "Ladies and Gentlemen of the class of '99: If I could offer you only one tip for "
+                                     "the future, sunscreen would be it.";
+            const std::vector<std::uint8_t> plain(text.begin(),text.end()), long_plain = counting(1100,3,7);
+            for (const stream::chacha_engine engine : all_engines) {
+                for (const mac::poly1305_engine hash : all_hashes) {
+                    if (!stream::is_supported(engine) || !mac::is_supported(hash)) {
+                        continue;
+                    }
+                    // RFC 8439, 2.8.2
+                    const mac::chacha20_poly1305 aead {counting(32,0x80,1),engine,hash};
+                    const std::vector<std::uint8_t> nonce = from_hex("070000004041424344454647");
+                    const std::vector<std::uint8_t> aad = from_hex("50515253c0c1c2c3c4c5c6c7");
+                    std::vector<std::uint8_t> sealed(plain.size()+16);
+                    aead.encrypt(nonce,aad,plain.data(),sealed.data(),plain.size(),sealed.data()+plain.size());
+                    BOOST_CHECK(from_hex("d31a8d34648e60db7b86afbc53ef7ec2a4aded51296e08fea9e2b5a736ee62d6"
+                                         "3dbea45e8ca9671282fafb69da92728b1a71de0a9e060b2905d6a5b67ecd3b36"
+                                         "92ddbd7f2d778b8c9803aee328091b58fab324e4fad675945585808b4831d7bc"
+                                         "3ff4def08e4b7a9de576d26586cec64b61161ae10b594f09e26a7e902ecbd060"
+                                         "0691") == sealed);
+                    std::vector<std::uint8_t> opened(plain.size());
+                    BOOST_CHECK(aead.decrypt(nonce,aad,sealed.data(),opened.data(),plain.size(),sealed.data()+plain.size()));
+                    BOOST_CHECK(plain == opened);
+                    // from an independent implementation, in place
+                    const mac::chacha20_poly1305 other {counting(32,0,1),engine,hash};
+                    std::vector<std::uint8_t> data(long_plain);
+                    std::uint8_t t[16];
+                    other.encrypt(counting(12,0,1),counting(7,0,1),data.data(),data.data(),data.size(),t);
+                    BOOST_CHECK(from_hex("8af11918363188748cc176a3cf436b0f") == std::vector<std::uint8_t>(data.begin(),data.begin()+16));
+                    BOOST_CHECK(from_hex("45d1a77dd48cb5fe5205d4339b0ee832") == std::vector<std::uint8_t>(data.begin()+1024,data.begin()+1040));
+                    BOOST_CHECK(from_hex("b2fede360090030c76202af97aa1baa5") == std::vector<std::uint8_t>(t,t+16));
+                    BOOST_CHECK(other.decrypt(counting(12,0,1),counting(7,0,1),data.data(),data.data(),data.size(),t));
+                    BOOST_CHECK(long_plain == data);
+                }
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (chacha20_poly1305_forgeries) {
+            fastformat::fmtln(std::cout,"{0}","ChaCha20-Poly1305 forgery test starts...");
+            boost::random::mt19937_64 generator {27};
+            const mac::chacha20_poly1305 aead {random_bytes(generator,32)};
+            const std::vector<std::uint8_t> nonce = random_bytes(generator,12), aad = random_bytes(generator,20);
+            const std::vector<std::uint8_t> plain = random_bytes(generator,300);
+            std::vector<std::uint8_t> sealed(plain.size());
+            std::uint8_t t[16];
+            aead.encrypt(nonce,aad,plain.data(),sealed.data(),plain.size(),t);
+            const auto opens = [&](const std::vector<std::uint8_t>& data,const std::vector<std::uint8_t>& n,
+                                   const std::vector<std::uint8_t>& a) {
+                std::vector<std::uint8_t> out(data.size(),0x5a);
+                const bool right = aead.decrypt(n,a,data.data(),out.data(),data.size(),t);
+                // nothing is written out of a forgery
+                BOOST_CHECK(right ? plain == out : std::vector<std::uint8_t>(data.size(),0x5a) == out);
+                return right;
+            };
+            BOOST_CHECK(opens(sealed,nonce,aad));
+            std::vector<std::uint8_t> other(sealed);
+            other[299] ^= 0x80;
+            BOOST_CHECK(!opens(other,nonce,aad));
+            other = aad;
+            other[19] ^= 1;
+            BOOST_CHECK(!opens(sealed,nonce,other));
+            other = nonce;
+            other[0] ^= 1;
+            BOOST_CHECK(!opens(sealed,other,aad));
+            t[0] ^= 1;
+            BOOST_CHECK(!opens(sealed,nonce,aad));
+        }
+
+        BOOST_AUTO_TEST_CASE (chacha20_poly1305_invalid_arguments) {
+            fastformat::fmtln(std::cout,"{0}","ChaCha20-Poly1305 invalid argument test starts...");
+            BOOST_CHECK_THROW(mac::poly1305(std::vector<std::uint8_t>(16)),std::invalid_argument);
+            BOOST_CHECK_THROW(mac::chacha20_poly1305(std::vector<std::uint8_t>(16)),std::invalid_argument);
+            const mac::chacha20_poly1305 aead {std::vector<std::uint8_t>(32)};
+            std::uint8_t t[16];
+            BOOST_CHECK_THROW(aead.encrypt(std::vector<std::uint8_t>(8),{},nullptr,nullptr,0,t),std::invalid_argument);
+            BOOST_CHECK_THROW(aead.encrypt(std::vector<std::uint8_t>(12),{},nullptr,nullptr,mac::chacha20_poly1305::max_bytes+1,t),
+                              std::invalid_argument);
+        }
+
+    }
+}
@@ -0,0 +1,176 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License with Cpp11crypto.
+   If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// tests/mac/gcm.cpp - Tests mac/gcm.hpp
+
+#include "mac/gcm.hpp"
+#include "../utils/test_bytes.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include <fastformat/fastformat.hpp>
+
+namespace cpp11crypto {
+    namespace tests {
+
+        namespace {
+            std::vector<std::uint8_t> counting(const std::size_t count,const unsigned first,const unsigned step) {
+                std::vector<std::uint8_t> bytes(count);
+                for (std::size_t i = 0; i != count; ++i) {
+                    bytes[i] = static_cast<std::uint8_t>(first+step*i);
+                }
+                return bytes;
+            }
+
+            const block::aes_engine all_engines[] = {
+                block::aes_engine::bitsliced,block::aes_engine::bitsliced_sse2,block::aes_engine::bitsliced_avx2,
+                block::aes_engine::aesni,block::aes_engine::vaes
+            };
+            const mac::ghash_engine all_hashes[] = {
+                mac::ghash_engine::table,mac::ghash_engine::pclmul
+            };
+
+            /// Encrypts with every supported combination of engines, checking the
+            /// result and its decryption
+            template <std::size_t KeyBits>
+            void check_all(const std::vector<std::uint8_t>& key,const std::vector<std::uint8_t>& nonce,
+                           const std::vector<std::uint8_t>& aad,const std::vector<std::uint8_t>& plain,
+                           const std::vector<std::uint8_t>& expected) {
+                for (const block::aes_engine engine : all_engines) {
+                    for (const mac::ghash_engine hash : all_hashes) {
+                        if (!block::is_supported(engine) || !mac::is_supported(hash)) {
+                            continue;
+                        }
+                        const mac::aes_gcm<KeyBits> gcm {key,engine,hash};
+                        std::vector<std::uint8_t> sealed(plain.size()+16);
+                        gcm.encrypt(nonce,aad,plain.data(),sealed.data(),plain.size(),sealed.data()+plain.size());
+                        BOOST_CHECK(expected == sealed);
+                        std::vector<std::uint8_t> opened(plain.size());
+                        BOOST_CHECK(gcm.decrypt(nonce,aad,sealed.data(),opened.data(),plain.size(),sealed.data()+plain.size()));
+                        BOOST_CHECK(plain == opened);
+                    }
+                }
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (gcm_known_answers) {
+            fastformat::fmtln(std::cout,"{0}","AES-GCM known answer test starts...");
+            // GCM specification, test cases 4 and 6
+            const std::vector<std::uint8_t> key = from_hex("feffe9928665731c6d6a8f9467308308");
+            const std::vector<std::uint8_t> aad = from_hex("feedfacedeadbeeffeedfacedeadbeefabaddad2");
+            const std::vector<std::uint8_t> plain = from_hex("d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"
+                                                             "1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39");
+            check_all<128>(key,from_hex("cafebabefacedbaddecaf888"),aad,plain,
+                           from_hex("42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329aca12e"
+                                    "21d514b25466931c7d8f6a5aac84aa051ba30b396a0aac973d58e091"
+                                    "5bc94fbc3221a5db94fae95ae7121a47"));
+            check_all<128>(key,from_hex("9313225df88406e555909c5aff5269aa6a7a9538534f7da1e4c303d2a318a728"
+                                        "c3c0c95156809539fcf0e2429a6b525416aedbf5a0de6a57a637b39b"),aad,plain,
+                           from_hex("8ce24998625615b603a033aca13fb894be9112a5c3a211a8ba262a3cca7e2ca7"
+                                    "01e4a9a4fba43c90ccdcb281d48c7c6fd62875d2aca417034c34aee5"
+                                    "619cc5aefffe0bfa462af43c1699d050"));
+            // nothing to encrypt nor to authenticate, but the tag
+            check_all<192>(counting(24,0,1),std::vector<std::uint8_t>(12),{},{},from_hex("494e385a4b3fafb713eaeca808626717"));
+            // two batches of eight blocks and a partial block, from an independent implementation
+            check_all<256>(counting(32,0,1),counting(12,100,1),counting(13,200,1),counting(300,3,7),
+                           from_hex("4b11cf7e66cf7baa052016b88d3b0f9131b8878204fa6ed60c6315883c6d7094"
+                                    "7703b138b3149610e6d1510fca7c8f834801f98f4f3c3cac71633576482f1036"
+                                    "cb460ad609add6f1706de453069414ca57425e7ce893d0a2b4834f44fc9ddbcd"
+                                    "2ddb23c6d48b75aa6818373555f3bde43131a137ee4f8470f92bcad1bdda7dbb"
+                                    "b1150930f694ef9f728b9fd55e5eb96e653dfc4e5f5d9bb61aa3470da75ff0a6"
+                                    "f35b5624ef5a6c74f0fa08475bca6602452b2c41d845afcb73130868e5ae2af2"
+                                    "896557b2f773197539fde2f3d2a457a4f3f257ca488ed15919eafbd4ebeb04f7"
+                                    "6d0d93c39dc3666a41ce35a1df2b055dc34ca6035c72500f0c22c38bc5d00f67"
+                                    "74799b98620fb9e2864a9fd4aff87b7cdbf1cca22aa9edc172f1ff92a8b491af"
+                                    "301ee4938763b0fc7bba7fac95242a9741b2df67e7d4f591493a4ed0"));
+        }
+
+        BOOST_AUTO_TEST_CASE (gcm_engines_agree) {
+            fastformat::fmtln(std::cout,"{0}","AES-GCM engine consistency test starts...");
+            boost::random::mt19937_64 generator {23};
+            const std::vector<std::uint8_t> key = random_bytes(generator,16);
+            const mac::aes128_gcm reference {key,block::aes_engine::bitsliced,mac::ghash_engine::table};
+            for (const std::size_t bytes : {1,15,16,17,127,128,129,255,256,1000,4096+5}) {
+                const std::vector<std::uint8_t> nonce = random_bytes(generator,12);
+                const std::vector<std::uint8_t> aad = random_bytes(generator,bytes%37);
+                const std::vector<std::uint8_t> plain = random_bytes(generator,bytes);
+                std::vector<std::uint8_t> expected(bytes+16);
+                reference.encrypt(nonce,aad,plain.data(),expected.data(),bytes,expected.data()+bytes);
+                check_all<128>(key,nonce,aad,plain,expected);
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (gcm_forgeries) {
+            fastformat::fmtln(std::cout,"{0}","AES-GCM forgery test starts...");
+            boost::random::mt19937_64 generator {29};
+            const std::vector<std::uint8_t> nonce = random_bytes(generator,12);
+            const std::vector<std::uint8_t> aad = random_bytes(generator,20);
+            const std::vector<std::uint8_t> plain = random_bytes(generator,200);
+            for (const mac::ghash_engine hash : all_hashes) {
+                if (!mac::is_supported(hash)) {
+                    continue;
+                }
+                const mac::aes128_gcm gcm {random_bytes(generator,16),block::best_aes_engine(),hash};
+                std::vector<std::uint8_t> sealed(plain);
+                std::uint8_t tag[16];
+                // in place
+                gcm.encrypt(nonce,aad,sealed.data(),sealed.data(),sealed.size(),tag);
+                BOOST_CHECK(plain != sealed);
+                const auto opens = [&](std::vector<std::uint8_t> data,const std::vector<std::uint8_t>& n,
+                                       const std::vector<std::uint8_t>& a,const std::uint8_t * const t) {
+                    const bool right = gcm.decrypt(n,a,data.data(),data.data(),data.size(),t);
+                    BOOST_CHECK(right ? plain == data : std::vector<std::uint8_t>(data.size()) == data);
+                    return right;
+                };
+                BOOST_CHECK(opens(sealed,nonce,aad,tag));
+                std::vector<std::uint8_t> other(sealed);
+                other[150] ^= 1;
+                BOOST_CHECK(!opens(other,nonce,aad,tag));
+                other = aad;
+                other[0] ^= 0x80;
+                BOOST_CHECK(!opens(sealed,nonce,other,tag));
+                other = nonce;
+                other[11] ^= 1;
+                BOOST_CHECK(!opens(sealed,other,aad,tag));
+                tag[15] ^= 1;
+                BOOST_CHECK(!opens(sealed,nonce,aad,tag));
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (gcm_invalid_arguments) {
+            fastformat::fmtln(std::cout,"{0}","AES-GCM invalid argument test starts...");
+            const std::vector<std::uint8_t> key(16);
+            BOOST_CHECK_THROW(mac::aes128_gcm(std::vector<std::uint8_t>(15)),std::invalid_argument);
+            if (!mac::is_supported(mac::ghash_engine::pclmul)) {
+                BOOST_CHECK_THROW(mac::aes128_gcm(key,block::aes_engine::bitsliced,mac::ghash_engine::pclmul),
+                                  std::invalid_argument);
+            }
+            const mac::aes128_gcm gcm {key};
+            std::uint8_t tag[16];
+            BOOST_CHECK_THROW(gcm.encrypt({},{},nullptr,nullptr,0,tag),std::invalid_argument);
+            const std::vector<std::uint8_t> nonce(12);
+            BOOST_CHECK_THROW(gcm.encrypt(nonce,{},nullptr,nullptr,mac::aes128_gcm::max_bytes+1,tag),
+                              std::invalid_argument);
+        }
+
+    }
+}
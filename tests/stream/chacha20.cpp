@@ -0,0 +1,132 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License with Cpp11crypto.
+   If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// tests/stream/chacha20.cpp - Tests stream/chacha20.hpp
+
+#include "stream/chacha20.hpp"
+#include "stream/parallel.hpp"
+#include "../utils/test_bytes.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fastformat/fastformat.hpp>
+
+namespace cpp11crypto {
+    namespace tests {
+
+        namespace {
+            const stream::chacha_engine all_engines[] = {
+                stream::chacha_engine::scalar,stream::chacha_engine::sse2,stream::chacha_engine::avx2,
+                stream::chacha_engine::avx512
+            };
+        }
+
+        BOOST_AUTO_TEST_CASE (chacha20_known_answers) {
+            fastformat::fmtln(std::cout,"{0}","ChaCha20 known answer test starts...");
+            const std::vector<std::uint8_t> key = from_hex("000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f");
+            const std::vector<std::uint8_t> nonce = from_hex("000000000000004a00000000");
+            const std::string text = "Ladies and Gentlemen of the class of '99: If I could offer you only one tip for "
+                                     "the future, sunscreen would be it.";
+            const std::vector<std::uint8_t> plain(text.begin(),text.end());
+            // RFC 8439, 2.4.2
+            const std::vector<std::uint8_t> cipher = from_hex("6e2e359a2568f98041ba0728dd0d6981e97e7aec1d4360c20a27afccfd9fae0b"
+                                                              "f91b65c5524733ab8f593dabcd62b3571639d624e65152ab8f530c359f0861d8"
+                                                              "07ca0dbf500d6a6156a38e088a22b65e52bc514d16ccf806818ce91ab7793736"
+                                                              "5af90bbf74a35be6b40b8eedf2785e42874d");
+            for (const stream::chacha_engine engine : all_engines) {
+                if (!stream::is_supported(engine)) {
+                    continue;
+                }
+                stream::chacha20 chacha {key,nonce,1,engine};
+                std::vector<std::uint8_t> out(plain.size());
+                chacha.process(plain.data(),out.data(),out.size());
+                BOOST_CHECK(cipher == out);
+                BOOST_CHECK_EQUAL(plain.size(),chacha.position());
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (chacha20_engines_agree) {
+            fastformat::fmtln(std::cout,"{0}","ChaCha20 engine consistency test starts...");
+            boost::random::mt19937_64 generator {24};
+            const std::vector<std::uint8_t> key = random_bytes(generator,32), nonce = random_bytes(generator,12);
+            const std::vector<std::uint8_t> plain = random_bytes(generator,5000);
+            // the counter wraps around within the message
+            stream::chacha20 reference {key,nonce,0xfffffff0u,stream::chacha_engine::scalar};
+            std::vector<std::uint8_t> expected(plain.size());
+            reference.process(plain.data(),expected.data(),plain.size());
+            for (const stream::chacha_engine engine : all_engines) {
+                if (!stream::is_supported(engine)) {
+                    continue;
+                }
+                // pieces of every length ending within, on and across blocks
+                stream::chacha20 chacha {key,nonce,0xfffffff0u,engine};
+                std::vector<std::uint8_t> out(plain);
+                std::size_t done = 0;
+                for (std::size_t piece = 1; done != out.size(); piece = piece*3+1) {
+                    const std::size_t n = std::min(piece%1100,out.size()-done);
+                    chacha.process(out.data()+done,out.data()+done,n);
+                    done += n;
+                }
+                BOOST_CHECK(expected == out);
+                // backwards, one block and a half at a time
+                for (std::size_t end = out.size(); 0 != end;) {
+                    const std::size_t n = std::min<std::size_t>(end,96);
+                    chacha.seek(end-n);
+                    chacha.process(out.data()+end-n,out.data()+end-n,n);
+                    end -= n;
+                }
+                BOOST_CHECK(plain == out);
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (chacha20_parallel) {
+            fastformat::fmtln(std::cout,"{0}","ChaCha20 parallel test starts...");
+            boost::random::mt19937_64 generator {25};
+            const std::vector<std::uint8_t> key = random_bytes(generator,32), nonce = random_bytes(generator,12);
+            const std::vector<std::uint8_t> plain = random_bytes(generator,100000);
+            stream::chacha20 serial {key,nonce}, parallel {key,nonce};
+            std::vector<std::uint8_t> expected(plain.size()), out(plain.size());
+            serial.process(plain.data(),expected.data(),7);
+            serial.process(plain.data()+7,expected.data()+7,plain.size()-7);
+            parallel.process(plain.data(),out.data(),7);
+            utils::work_stealing_pool pool {4};
+            stream::process_parallel(parallel,plain.data()+7,out.data()+7,plain.size()-7,pool,4096+3);
+            BOOST_CHECK(expected == out);
+            BOOST_CHECK_EQUAL(serial.position(),parallel.position());
+        }
+
+        BOOST_AUTO_TEST_CASE (chacha20_invalid_arguments) {
+            fastformat::fmtln(std::cout,"{0}","ChaCha20 invalid argument test starts...");
+            const std::vector<std::uint8_t> key(32), nonce(12);
+            BOOST_CHECK_THROW(stream::chacha20(std::vector<std::uint8_t>(16),nonce),std::invalid_argument);
+            BOOST_CHECK_THROW(stream::chacha20(key,std::vector<std::uint8_t>(8)),std::invalid_argument);
+            for (const stream::chacha_engine engine : all_engines) {
+                if (!stream::is_supported(engine)) {
+                    BOOST_CHECK_THROW(stream::chacha20(key,nonce,0,engine),std::invalid_argument);
+                }
+            }
+        }
+
+    }
+}
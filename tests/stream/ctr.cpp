@@ -0,0 +1,176 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License with Cpp11crypto.
+   If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// tests/stream/ctr.cpp - Tests stream/ctr.hpp
+
+#include "stream/ctr.hpp"
+#include "block/aes.hpp"
+#include "../utils/test_bytes.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include <fastformat/fastformat.hpp>
+
+namespace cpp11crypto {
+    namespace tests {
+
+        namespace {
+            /// Keystream of a counter mode, as the encryption of zeros
+            template <typename Mode>
+            std::vector<std::uint8_t> keystream(Mode mode,const std::size_t bytes) {
+                std::vector<std::uint8_t> out(bytes);
+                mode.process(out.data(),out.data(),bytes);
+                return out;
+            }
+
+            /// A cipher seen through encrypt only, which keeps counter mode off its
+            /// own kernels
+            template <typename Cipher>
+            struct generic_cipher {
+                static constexpr std::size_t block_size = Cipher::block_size;
+                void encrypt(const std::uint8_t * const in,std::uint8_t * const out,const std::size_t blocks) const noexcept {
+                    cipher.encrypt(in,out,blocks);
+                }
+                const Cipher& cipher;
+            };
+
+            /// Counter mode through the cipher's kernels against counter mode through
+            /// batches of encrypt, from a counter whose low 32 or 64 bits are about to wrap
+            template <unsigned CounterBits>
+            void check_kernels(const block::aes128& aes,std::vector<std::uint8_t> iv,boost::random::mt19937_64& generator) {
+                std::fill(iv.end()-(32 == CounterBits ? 4 : 8),iv.end()-1,0xff);
+                iv.back() = static_cast<std::uint8_t>(0xf0+generator()%16);
+                const generic_cipher<block::aes128> generic {aes};
+                for (std::size_t bytes = 0; bytes <= 16*40+15; bytes += 1+generator()%16) {
+                    const std::vector<std::uint8_t> plain = random_bytes(generator,bytes);
+                    std::vector<std::uint8_t> out(bytes), expected(bytes);
+                    stream::ctr<block::aes128,CounterBits> {aes,iv}.process(plain.data(),out.data(),bytes);
+                    stream::ctr<generic_cipher<block::aes128>,CounterBits> {generic,iv}.process(plain.data(),expected.data(),bytes);
+                    BOOST_CHECK( out == expected );
+                }
+            }
+
+            const block::aes_engine all_engines[] = {
+                block::aes_engine::bitsliced,block::aes_engine::bitsliced_sse2,block::aes_engine::bitsliced_avx2,
+                block::aes_engine::aesni,block::aes_engine::vaes
+            };
+        }
+
+        BOOST_AUTO_TEST_CASE (ctr_known_answers) {
+            fastformat::fmtln(std::cout,"{0}","CTR known answer test starts...");
+            const std::vector<std::uint8_t> key = from_hex("2b7e151628aed2a6abf7158809cf4f3c");
+            // SP 800-38A, F.5.1
+            const std::vector<std::uint8_t> plain = from_hex("6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+                                                             "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710");
+            const std::vector<std::uint8_t> cipher = from_hex("874d6191b620e3261bef6864990db6ce9806f66b7970fdff8617187bb9fffdff"
+                                                              "5ae4df3edbd5d35e5b4f09020db03eab1e031dda2fbe03d1792170a0f3009cee");
+            for (const block::aes_engine engine : all_engines) {
+                if (!block::is_supported(engine)) {
+                    continue;
+                }
+                const block::aes128 aes {key,engine};
+                stream::ctr<block::aes128> ctr {aes,from_hex("f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff")};
+                std::vector<std::uint8_t> out(plain.size());
+                ctr.process(plain.data(),out.data(),out.size());
+                BOOST_CHECK( out == cipher );
+                BOOST_CHECK( ctr.position() == 64 );
+
+                // counters wrapping at each width, from an independent implementation
+                BOOST_CHECK( keystream(stream::ctr<block::aes128,32> {aes,from_hex("f0f1f2f3f4f5f6f7f8f9fafbfffffffe")},48)
+                             == from_hex("2f5dcd912d142c3d47192b41d1f723453ce1608360d83bf378aa6f000f6182c2"
+                                         "492491535998fa241efbcb031abe0667") );
+                BOOST_CHECK( keystream(stream::ctr<block::aes128,64> {aes,from_hex("f0f1f2f3f4f5f6f7fffffffffffffffe")},48)
+                             == from_hex("3d476977446478427fbae8c015320b73712e91130a0ec6d8ac7db29700e12699"
+                                         "0c2fbbb65ad9672a19fefd359bf34b02") );
+                BOOST_CHECK( keystream(stream::ctr<block::aes128> {aes,from_hex("f0f1f2f3f4f5f6f7fffffffffffffffe")},48)
+                             == from_hex("3d476977446478427fbae8c015320b73712e91130a0ec6d8ac7db29700e12699"
+                                         "cffb109cd4f3b372e9ec67e8fd60db99") );
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (ctr_pieces) {
+            fastformat::fmtln(std::cout,"{0}","CTR in pieces test starts...");
+            boost::random::mt19937_64 generator {1980};
+            for (int round = 0; round != 20; ++round) {
+                const block::aes256 aes {random_bytes(generator,32)};
+                const std::vector<std::uint8_t> iv = random_bytes(generator,16);
+                const std::vector<std::uint8_t> plain = random_bytes(generator,1+generator()%700);
+                std::vector<std::uint8_t> expected(plain.size());
+                stream::ctr<block::aes256> {aes,iv}.process(plain.data(),expected.data(),plain.size());
+
+                // pieces of any length, in place, straddling blocks and batches
+                std::vector<std::uint8_t> out = plain;
+                stream::ctr<block::aes256> ctr {aes,iv};
+                for (std::size_t done = 0; done != out.size();) {
+                    const std::size_t n = std::min<std::size_t>(out.size()-done,generator()%150);
+                    ctr.process(out.data()+done,out.data()+done,n);
+                    done += n;
+                }
+                BOOST_CHECK( out == expected );
+                BOOST_CHECK( ctr.position() == plain.size() );
+                stream::ctr<block::aes256> {aes,iv}.process(out.data(),out.data(),out.size());
+                BOOST_CHECK( out == plain );
+            }
+            const block::aes128 aes {std::vector<std::uint8_t>(16)};
+            BOOST_CHECK_THROW( (stream::ctr<block::aes128> {aes,std::vector<std::uint8_t>(12)}), std::invalid_argument );
+        }
+
+        BOOST_AUTO_TEST_CASE (ctr_kernels) {
+            fastformat::fmtln(std::cout,"{0}","CTR kernels against batches of the cipher test starts...");
+            boost::random::mt19937_64 generator {2001};
+            for (const block::aes_engine engine : all_engines) {
+                if (!block::is_supported(engine)) {
+                    continue;
+                }
+                const block::aes128 aes {random_bytes(generator,16),engine};
+                const std::vector<std::uint8_t> iv = random_bytes(generator,16);
+                check_kernels<32>(aes,iv,generator);
+                check_kernels<64>(aes,iv,generator);
+                // a 128-bit counter carrying between its halves leaves the kernels
+                check_kernels<128>(aes,iv,generator);
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (ctr_seek) {
+            fastformat::fmtln(std::cout,"{0}","CTR seek test starts...");
+            boost::random::mt19937_64 generator {1998};
+            const block::aes128 aes {random_bytes(generator,16)};
+            // a 64-bit counter about to wrap, so that ranges straddle it
+            std::vector<std::uint8_t> iv = random_bytes(generator,16);
+            std::fill(iv.begin()+8,iv.begin()+15,0xff);
+            const std::vector<std::uint8_t> expected = keystream(stream::ctr<block::aes128,64> {aes,iv},4096);
+            for (int round = 0; round != 50; ++round) {
+                const std::size_t first = generator()%expected.size();
+                const std::size_t bytes = generator()%(expected.size()-first+1);
+                stream::ctr<block::aes128,64> ctr {aes,iv};
+                ctr.seek(first);
+                BOOST_CHECK( ctr.position() == first );
+                std::vector<std::uint8_t> out(bytes);
+                ctr.process(out.data(),out.data(),bytes);
+                BOOST_CHECK( std::equal(out.begin(),out.end(),expected.begin()+first) );
+                BOOST_CHECK( ctr.position() == first+bytes );
+            }
+        }
+
+    }
+}
@@ -0,0 +1,77 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License with Cpp11crypto.
+   If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// tests/stream/parallel.cpp - Tests stream/parallel.hpp
+
+#include "stream/parallel.hpp"
+#include "stream/ctr.hpp"
+#include "block/aes.hpp"
+#include "../utils/test_bytes.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include <fastformat/fastformat.hpp>
+
+namespace cpp11crypto {
+    namespace tests {
+
+        BOOST_AUTO_TEST_CASE (parallel_ctr_matches_serial) {
+            fastformat::fmtln(std::cout,"{0}","Parallel CTR against one thread test starts...");
+            boost::random::mt19937_64 generator {2022};
+            utils::work_stealing_pool pool {4};
+            const block::aes128 aes {random_bytes(generator,16)};
+            const std::vector<std::uint8_t> iv = random_bytes(generator,16);
+            for (const std::size_t chunk_bytes : {1u,17u,64u,1000u,4096u}) {
+                for (int round = 0; round != 5; ++round) {
+                    const std::vector<std::uint8_t> plain = random_bytes(generator,generator()%50000);
+                    const std::uint64_t start = generator()%100000;
+
+                    stream::ctr<block::aes128> serial {aes,iv};
+                    serial.seek(start);
+                    std::vector<std::uint8_t> expected(plain.size());
+                    serial.process(plain.data(),expected.data(),plain.size());
+
+                    // in place, then a second piece continuing the stream
+                    stream::ctr<block::aes128> ctr {aes,iv};
+                    ctr.seek(start);
+                    std::vector<std::uint8_t> out = plain;
+                    const std::size_t half = out.size()/2;
+                    stream::process_parallel(ctr,out.data(),out.data(),half,pool,chunk_bytes);
+                    BOOST_CHECK( ctr.position() == start+half );
+                    stream::process_parallel(ctr,out.data()+half,out.data()+half,out.size()-half,pool,chunk_bytes);
+                    BOOST_CHECK( out == expected );
+                    BOOST_CHECK( ctr.position() == serial.position() );
+                }
+            }
+
+            // the shared pool and the default chunks
+            const std::vector<std::uint8_t> plain = random_bytes(generator,1 << 20);
+            std::vector<std::uint8_t> expected(plain.size()), out(plain.size());
+            stream::ctr<block::aes128> {aes,iv}.process(plain.data(),expected.data(),plain.size());
+            stream::ctr<block::aes128> ctr {aes,iv};
+            stream::process_parallel(ctr,plain.data(),out.data(),plain.size());
+            BOOST_CHECK( out == expected );
+            BOOST_CHECK_THROW( stream::process_parallel(ctr,plain.data(),out.data(),plain.size(),pool,0), std::invalid_argument );
+        }
+
+    }
+}
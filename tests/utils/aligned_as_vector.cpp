@@ -0,0 +1,87 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License with Cpp11crypto.
+   If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// tests/utils/aligned_as_vector.cpp - Tests utils/aligned_as_vector.hpp and utils/cpu_features.hpp
+
+#include "utils/aligned_as_vector.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <boost/mpl/list.hpp>
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include <fastformat/fastformat.hpp>
+
+#include <libcwd/type_info.h>
+
+namespace cpp11crypto {
+    namespace tests {
+
+        struct alignas(32) avx_block {
+            std::uint32_t words[8];
+        };
+
+        using vector_aligning_list = boost::mpl::list<
+                                     std::uint8_t,std::uint64_t,double,
+                                     utils::lane128,avx_block,utils::lane512,
+                                     utils::cache_aligned<int>>;
+
+        BOOST_AUTO_TEST_CASE_TEMPLATE (aligning_as_a_vector, T, vector_aligning_list ) {
+            using selected_type = typename utils::aligned_as_vector<T>::type;
+            fastformat::fmtln(std::cout,"Vector alignment test {0}({1}) selects {2}({3}).",
+                              libcwd::type_info_of<T>().demangled_name(),
+                              alignof(T),
+                              libcwd::type_info_of<selected_type>().demangled_name(),
+                              alignof(selected_type)
+                             );
+            BOOST_CHECK( 0 == alignof(T) % alignof(selected_type) );
+            // the widest choice: nothing wider would still divide the alignment
+            BOOST_CHECK( alignof(selected_type) == alignof(T)
+                         || alignof(selected_type) == utils::max_lane_size );
+        }
+
+        BOOST_AUTO_TEST_CASE (aligned_storage_and_cache_lines) {
+            using storage = utils::aligned_storage<100,128>::type;
+            static_assert(128 == alignof(storage) && sizeof(storage) >= 100,"storage honours any alignment");
+            static_assert(std::is_pod<storage>::value,"storage is raw memory");
+            static_assert(utils::cache_line_size == alignof(utils::cache_aligned<std::atomic<int>>)
+                          && utils::cache_line_size == sizeof(utils::cache_aligned<std::atomic<int>>),
+                          "neighbours never share a cache line");
+            utils::cache_aligned<std::atomic<int>> counters[2];
+            BOOST_CHECK( reinterpret_cast<std::uintptr_t>(&counters[1])
+                         - reinterpret_cast<std::uintptr_t>(&counters[0]) == utils::cache_line_size );
+        }
+
+        BOOST_AUTO_TEST_CASE (simd_dispatch_level) {
+            const utils::cpu_features& cpu = utils::cpu();
+            fastformat::fmtln(std::cout,"Dispatch level {0}, {1}-byte lanes",
+                              static_cast<int>(utils::simd()),utils::lane_bytes(utils::simd()));
+            BOOST_CHECK( utils::is_supported(utils::simd()) );
+            BOOST_CHECK( utils::is_supported(utils::simd_level::scalar) );
+            // every level implies the previous ones
+            BOOST_CHECK( !utils::is_supported(utils::simd_level::avx512) || cpu.avx2 );
+            BOOST_CHECK( !utils::is_supported(utils::simd_level::avx2) || cpu.sse2 );
+            static_assert(64 == utils::lane_bytes(utils::simd_level::avx512),"zmm width");
+            static_assert(16 == utils::lane_bytes(utils::simd_level::sse2),"xmm width");
+        }
+
+    }
+
+}
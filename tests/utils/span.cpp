@@ -0,0 +1,108 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License with Cpp11crypto.
+   If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// tests/utils/span.cpp - Tests utils/span.hpp
+
+#include "utils/span.hpp"
+#include "core/zeroizing.hpp"
+#include "core/secure_array.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <array>
+#include <vector>
+#include <numeric>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <fastformat/fastformat.hpp>
+
+namespace cpp11crypto {
+    namespace tests {
+
+        namespace {
+            /// A kernel that relies on the alignment carried by the view
+            template <std::size_t Align>
+            std::uint64_t sum_words(const utils::span<std::uint8_t,Align> bytes) {
+                using word = typename utils::span<std::uint8_t,Align>::word_type;
+                const word * const words = reinterpret_cast<const word *>(bytes.data());
+                std::uint64_t sum = 0;
+                for (std::size_t i = 0; i != bytes.size()/sizeof(word); ++i) {
+                    sum += words[i];
+                }
+                return sum;
+            }
+
+            std::size_t total(const utils::span<std::uint32_t> s) {
+                return std::accumulate(s.begin(),s.end(),std::size_t {0});
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (span_sources) {
+            fastformat::fmtln(std::cout,"{0}","Span construction test starts...");
+            std::vector<std::uint32_t,core::allocator<std::uint32_t>> secure_vector {1,2,3,4};
+            std::vector<std::uint32_t> plain_vector {5,6};
+            std::array<std::uint32_t,3> array {{7,8,9}};
+            const std::uint32_t raw[] = {10,11};
+
+            BOOST_CHECK( 10 == total(secure_vector) );
+            BOOST_CHECK( 11 == total(plain_vector) );
+            BOOST_CHECK( 24 == total(array) );
+            BOOST_CHECK( 21 == total(utils::make_span(raw,2)) );
+
+            utils::mutable_span<std::uint32_t> writable {secure_vector};
+            writable[0] = 100;
+            BOOST_CHECK( 100 == secure_vector[0] );
+            BOOST_CHECK( 109 == total(writable) );
+            BOOST_CHECK( 5 == total(writable.subspan(1,2)) );
+            BOOST_CHECK( 3 == writable.first_elements(3).size() );
+        }
+
+        BOOST_AUTO_TEST_CASE (span_alignment) {
+            using byte_span = utils::span<std::uint8_t>;
+            using wide_span = utils::span<std::uint8_t,16>;
+            static_assert(std::is_same<byte_span::word_type,unsigned char>::value,"bytes read as bytes");
+            static_assert(sizeof(wide_span::word_type) == 8,"aligned bytes read as 64-bit words");
+            static_assert(16 == wide_span::alignment,"alignment is part of the type");
+            // stronger alignment converts to weaker, not the other way round
+            static_assert(std::is_convertible<wide_span,byte_span>::value,"weakening allowed");
+            static_assert(!std::is_convertible<byte_span,wide_span>::value,"strengthening forbidden");
+
+            core::secure_buffer<32> key;
+            std::iota(key.begin(),key.end(),std::uint8_t {1});
+            const wide_span view {key};
+            BOOST_CHECK( 32 == view.size_bytes() );
+
+            std::uint64_t expected = 0;
+            for (std::size_t i = 0; i != 32; i += 8) {
+                std::uint64_t w;
+                std::memcpy(&w,key.data()+i,8);
+                expected += w;
+            }
+            BOOST_CHECK( expected == sum_words(view) );
+            BOOST_CHECK( expected == sum_words(utils::assume_aligned<16>(byte_span {key.data(),key.size()})) );
+
+            std::array<std::uint64_t,2> words {{1,2}};
+            const utils::span<std::uint64_t> word_view {words};
+            BOOST_CHECK( 16 == word_view.as_bytes().size() );
+            BOOST_CHECK( 8 == decltype(word_view.as_bytes())::alignment );
+        }
+
+    }
+
+}
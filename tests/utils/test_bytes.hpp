@@ -0,0 +1,57 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// tests/utils/test_bytes.hpp - Test helpers building byte strings
+
+#ifndef CPP11CRYPTO_TESTS_UTILS_TEST_BYTES_HPP
+#define CPP11CRYPTO_TESTS_UTILS_TEST_BYTES_HPP
+
+#include <boost/random/mersenne_twister.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cpp11crypto {
+    namespace tests {
+
+        /// Bytes from their hexadecimal digits
+        inline std::vector<std::uint8_t> from_hex(const char * const digits) {
+            std::vector<std::uint8_t> bytes;
+            for (std::size_t i = 0; digits[i] != 0; i += 2) {
+                const auto nibble = [](const char c) {
+                    return c <= '9' ? c-'0' : c-'a'+10;
+                };
+                bytes.push_back(static_cast<std::uint8_t>(16*nibble(digits[i])+nibble(digits[i+1])));
+            }
+            return bytes;
+        }
+
+        /// Random bytes
+        inline std::vector<std::uint8_t> random_bytes(boost::random::mt19937_64& generator,const std::size_t count) {
+            std::vector<std::uint8_t> bytes(count);
+            for (std::uint8_t& b: bytes) {
+                b = static_cast<std::uint8_t>(generator());
+            }
+            return bytes;
+        }
+
+    }
+}
+
+#endif // CPP11CRYPTO_TESTS_UTILS_TEST_BYTES_HPP
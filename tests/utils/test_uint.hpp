@@ -0,0 +1,80 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Cpp11crypto.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// tests/utils/test_uint.hpp - Test helpers building fixed width integers
+
+#ifndef CPP11CRYPTO_TESTS_UTILS_TEST_UINT_HPP
+#define CPP11CRYPTO_TESTS_UTILS_TEST_UINT_HPP
+
+#include "arith/uint.hpp"
+
+#include <boost/random/mersenne_twister.hpp>
+#include <cstdint>
+#include <cstring>
+
+namespace cpp11crypto {
+    namespace tests {
+
+        /// Value from its hexadecimal digits, most significant first
+        template <std::size_t Bits>
+        arith::uint<Bits> from_hex(const char * const digits) {
+            arith::uint<Bits> x;
+            const std::size_t length = std::strlen(digits);
+            for (std::size_t i = 0; i != length; ++i) {
+                const char c = digits[length-1-i];
+                const std::uint64_t nibble = c <= '9' ? c-'0' : c-'a'+10;
+                x.limb(i/16) |= nibble << (4*(i%16));
+            }
+            return x;
+        }
+
+        /// Value with every limb random
+        template <std::size_t Bits>
+        arith::uint<Bits> random_uint(boost::random::mt19937_64& generator) {
+            arith::uint<Bits> x;
+            for (std::size_t i = 0; i != arith::uint<Bits>::limb_count; ++i) {
+                x.limb(i) = generator();
+            }
+            return x;
+        }
+
+        /// Random value, with whole zero or all-ones limbs now and then to reach
+        /// the edge cases
+        template <std::size_t Bits>
+        arith::uint<Bits> random_edgy_uint(boost::random::mt19937_64& generator) {
+            arith::uint<Bits> x;
+            const std::uint64_t shape = generator();
+            for (std::size_t i = 0; i != arith::uint<Bits>::limb_count; ++i) {
+                switch ((shape >> (2*i)) & 3) {
+                case 0:
+                    break;
+                case 1:
+                    x.limb(i) = ~std::uint64_t {0};
+                    break;
+                default:
+                    x.limb(i) = generator();
+                }
+            }
+            return x;
+        }
+
+    }
+}
+
+#endif // CPP11CRYPTO_TESTS_UTILS_TEST_UINT_HPP
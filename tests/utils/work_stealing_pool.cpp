@@ -0,0 +1,128 @@
+/**
+   Copyright 2013, Juan Antonio Zaratiegui Vallecillo
+
+   This file is part of Cpp11crypto.
+
+   Cpp11crypto is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Cpp11crypto is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License with Cpp11crypto.
+   If not, see <http://www.gnu.org/licenses/>.
+**/
+
+// tests/utils/work_stealing_pool.cpp - Tests utils/work_stealing_pool.hpp
+
+#include "utils/work_stealing_pool.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <fastformat/fastformat.hpp>
+
+namespace cpp11crypto {
+    namespace tests {
+
+        namespace {
+            /// Runs a job and checks that every chunk ran exactly once
+            void check_job(utils::work_stealing_pool& pool,const std::size_t chunks) {
+                std::unique_ptr<std::atomic<unsigned>[]> runs(new std::atomic<unsigned>[chunks+1]);
+                for (std::size_t i = 0; i != chunks+1; ++i) {
+                    runs[i] = 0;
+                }
+                pool.run(chunks,[&](const std::size_t chunk) {
+                    ++runs[chunk];
+                    // uneven chunks, so that ranges get stolen
+                    if (0 == chunk%7) {
+                        std::this_thread::sleep_for(std::chrono::microseconds(200));
+                    }
+                });
+                bool once = true;
+                for (std::size_t i = 0; i != chunks; ++i) {
+                    once &= 1 == runs[i];
+                }
+                BOOST_CHECK( once );
+                BOOST_CHECK( 0 == runs[chunks] );
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE (work_stealing_pool_chunks) {
+            fastformat::fmtln(std::cout,"{0}","Work stealing pool chunks test starts...");
+            for (const unsigned threads : {1u,2u,3u,8u}) {
+                utils::work_stealing_pool pool {threads};
+                BOOST_CHECK( threads == pool.size() );
+                for (const std::size_t chunks : {0u,1u,2u,5u,64u,1000u}) {
+                    check_job(pool,chunks);
+                }
+            }
+            BOOST_CHECK( utils::shared_pool().size() >= 1 );
+            check_job(utils::shared_pool(),100);
+        }
+
+        BOOST_AUTO_TEST_CASE (work_stealing_pool_submitters) {
+            fastformat::fmtln(std::cout,"{0}","Work stealing pool concurrent jobs test starts...");
+            utils::work_stealing_pool pool {4};
+            std::atomic<unsigned long long> total {0};
+            std::vector<std::thread> submitters;
+            for (unsigned s = 0; s != 3; ++s) {
+                submitters.emplace_back([&]() {
+                    for (int job = 0; job != 20; ++job) {
+                        pool.run(50,[&](const std::size_t chunk) {
+                            total += chunk;
+                        });
+                    }
+                });
+            }
+            for (std::thread& submitter : submitters) {
+                submitter.join();
+            }
+            BOOST_CHECK( 3ULL*20*(49*50/2) == total );
+        }
+
+        BOOST_AUTO_TEST_CASE (work_stealing_pool_nested) {
+            fastformat::fmtln(std::cout,"{0}","Work stealing pool nested jobs test starts...");
+            utils::work_stealing_pool pool {4}, other {2};
+            std::atomic<unsigned long long> total {0};
+            // jobs submitted from tasks, of the same pool and of another one
+            pool.run(16,[&](const std::size_t outer) {
+                pool.run(10,[&](const std::size_t inner) {
+                    other.run(3,[&](const std::size_t innermost) {
+                        total += outer*100+inner*10+innermost;
+                    });
+                });
+            });
+            BOOST_CHECK( 30*(15*16/2*100)+16*3*(9*10/2*10)+16*10*3 == total );
+            BOOST_CHECK_THROW( pool.run(4,[&](const std::size_t) {
+                pool.run(4,[](const std::size_t chunk) {
+                    if (2 == chunk) {
+                        throw std::runtime_error("nested chunk failed");
+                    }
+                });
+            }), std::runtime_error );
+            check_job(pool,100);
+        }
+
+        BOOST_AUTO_TEST_CASE (work_stealing_pool_exceptions) {
+            fastformat::fmtln(std::cout,"{0}","Work stealing pool exceptions test starts...");
+            utils::work_stealing_pool pool {4};
+            BOOST_CHECK_THROW( pool.run(100,[](const std::size_t chunk) {
+                if (42 == chunk) {
+                    throw std::runtime_error("chunk failed");
+                }
+            }), std::runtime_error );
+            // the pool is still usable
+            check_job(pool,100);
+        }
+
+    }
+}